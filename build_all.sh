@@ -22,6 +22,7 @@ build_help() {
     echo "                    - hybrid"
     echo "                    - r329"
     echo "                    - x86"
+    echo "                    - mock (host memory device, no simulator or KMD)"
     echo "                    - [other platforms you add]"
     echo "-k, --kversion    kernel version (optional)"
     echo "                    - [major].[minor]"
@@ -90,7 +91,7 @@ if [ "$BUILD_TARGET_PLATFORM"x = "x86"x ]; then
     exit 1
 fi
 
-if [ "$BUILD_TARGET_PLATFORM"x != "sim"x ]; then
+if [ "$BUILD_TARGET_PLATFORM"x != "sim"x ] && [ "$BUILD_TARGET_PLATFORM"x != "mock"x ]; then
     export BUILD_AIPU_VERSION_KMD=BUILD_ZHOUYI_$(echo $BUILD_AIPU_VERSION | tr '[a-z]' '[A-Z]')
     export BUILD_TARGET_PLATFORM_KMD=BUILD_PLATFORM_$(echo $BUILD_TARGET_PLATFORM | tr '[a-z]' '[A-Z]')
 fi
@@ -116,7 +117,7 @@ if [ "$BUILD_UMD_API_TYPE"x = "python_api"x ]; then
 fi
 
 ### export toolchain/kpath env variables of your supported platform(s)
-if [ "$BUILD_TARGET_PLATFORM"x = "sim"x ]; then
+if [ "$BUILD_TARGET_PLATFORM"x = "sim"x ] || [ "$BUILD_TARGET_PLATFORM"x = "mock"x ]; then
     export CXX=$COMPASS_DRV_BTENVAR_X86_CXX
     export LD_LIBRARY_PATH=$CONFIG_DRV_BRENVAR_X86_CLPATH:$LD_LIBRARY_PATH
 else
@@ -158,7 +159,7 @@ echo -e "$COMPASS_DRV_BRENVAR_INFO Target platform is $BUILD_TARGET_PLATFORM"
 echo -e "$COMPASS_DRV_BRENVAR_INFO Target AIPU version is $BUILD_AIPU_VERSION"
 echo -e "$COMPASS_DRV_BRENVAR_INFO UMD API type is $BUILD_UMD_API_TYPE"
 ### Build KMD
-if [ "$BUILD_TARGET_PLATFORM"x != "sim"x ]; then
+if [ "$BUILD_TARGET_PLATFORM"x != "sim"x ] && [ "$BUILD_TARGET_PLATFORM"x != "mock"x ]; then
     cd $COMPASS_DRV_BTENVAR_KMD_DIR
         echo -e "$COMPASS_DRV_BRENVAR_INFO Build KMD..."
         cp include/uapi/misc/armchina_aipu.h $COMPASS_DRV_BTENVAR_KPATH/include/uapi/misc
@@ -192,12 +193,26 @@ ln -bs $COMPASS_DRV_BTENVAR_UMD_SO_NAME_MAJOR   $BUILD_AIPU_DRV_ODIR/$COMPASS_DR
 ### Build Armchina private test application(s)
 rm -rf $COMPASS_DRV_BTENVAR_TEST_BUILD_DIR
 cd $COMPASS_DRV_BTENVAR_TEST_DIR
-# Build for either simulator or arm64
+# Build for simulator, mock device or arm64
 if [ "$BUILD_TARGET_PLATFORM"x = "sim"x ]; then
     make -j32 CXX=$CXX BUILD_TEST_CASE=simulation_test
+elif [ "$BUILD_TARGET_PLATFORM"x = "mock"x ]; then
+    make -j32 CXX=$CXX BUILD_TEST_CASE=alloc_test
+    make -j32 CXX=$CXX BUILD_TEST_CASE=replay_test
+    make -j32 CXX=$CXX BUILD_TEST_CASE=multidev_test
+    make -j32 CXX=$CXX BUILD_TEST_CASE=supergraph_test
+    make -j32 CXX=$CXX BUILD_TEST_CASE=fence_test
+    make -j32 CXX=$CXX BUILD_TEST_CASE=sched_test
+    make -j32 CXX=$CXX BUILD_TEST_CASE=batch_test
+    make -j32 CXX=$CXX BUILD_TEST_CASE=admit_test
+    make -j32 CXX=$CXX BUILD_TEST_CASE=hibernate_test
+    make -j32 CXX=$CXX BUILD_TEST_CASE=unload_test
+    make -j32 CXX=$CXX BUILD_TEST_CASE=wstream_test
+    make -j32 CXX=$CXX BUILD_TEST_CASE=swap_test
 else
     make -j32 CXX=$CXX BUILD_TEST_CASE=benchmark_test
 fi
+make -j32 CXX=$CXX BUILD_TEST_CASE=perf_test
 
 cd -
 echo -e "$COMPASS_DRV_BRENVAR_INFO Build test(s) done: binaries are in $BUILD_AIPU_DRV_ODIR"
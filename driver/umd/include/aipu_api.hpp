@@ -0,0 +1,436 @@
+/**********************************************************************************
+ * This file is CONFIDENTIAL and any use by you is subject to the terms of the
+ * agreement between you and Arm China or the terms of the agreement between you
+ * and the party authorised by Arm China to disclose this file to you.
+ * The confidential and proprietary information contained in this file
+ * may only be used by a person authorised under and to the extent permitted
+ * by a subsisting licensing agreement from Arm China.
+ *
+ *        (C) Copyright 2020 Arm Technology (China) Co. Ltd.
+ *                    All rights reserved.
+ *
+ * This entire notice must be reproduced on all copies of this file and copies of
+ * this file may only be made by a person if such person is permitted to do so
+ * under the terms of a subsisting license agreement from Arm China.
+ *
+ *********************************************************************************/
+
+/**
+ * @file  aipu_api.hpp
+ * @brief AIPU User Mode Driver (UMD) header-only C++ API over standard_api.h
+ * @version 1.0
+ *
+ * @note Context/Graph/Job are move-only RAII owners of the C API handles: a graph is
+ *       unloaded and a job is cleaned when its owner goes out of scope. Graphs and jobs
+ *       should be destroyed before the context they are created from.
+ * @note Tensor descriptors are fetched once when a graph is loaded, so the IO calls of
+ *       a job check tensor IDs and sizes locally. A job takes a job reference when it is
+ *       created (aipu_get_job_ref), so its IO/flush/finish/status calls skip the context
+ *       lookup of the ID based C API.
+ * @note Jobs share the descriptors of their graph, so a graph can be moved or destroyed
+ *       while it has jobs: once the graph is unloaded, the calls of its jobs fail with
+ *       AIPU_STATUS_ERROR_INVALID_JOB_ID.
+ */
+
+#ifndef _AIPU_API_HPP_
+#define _AIPU_API_HPP_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "standard_api.h"
+
+#if (__cplusplus >= 201703L)
+#define AIPU_NODISCARD [[nodiscard]]
+#else
+#define AIPU_NODISCARD
+#endif
+
+namespace aipu
+{
+/**
+ * @brief Non-owning view of a tensor buffer in application memory
+ */
+class TensorView
+{
+private:
+    void*  m_data = nullptr;
+    size_t m_bytes = 0;
+
+public:
+    TensorView() = default;
+    TensorView(void* data, size_t bytes): m_data(data), m_bytes(bytes) {}
+    template <typename T>
+    TensorView(T* data, size_t cnt): m_data((void*)data), m_bytes(cnt * sizeof(T)) {}
+    template <typename T>
+    TensorView(std::vector<T>& vec): m_data(vec.data()), m_bytes(vec.size() * sizeof(T)) {}
+    template <typename T>
+    TensorView(const std::vector<T>& vec): m_data((void*)vec.data()), m_bytes(vec.size() * sizeof(T)) {}
+
+    void* data() const
+    {
+        return m_data;
+    }
+    size_t size_bytes() const
+    {
+        return m_bytes;
+    }
+    template <typename T>
+    T* as() const
+    {
+        return static_cast<T*>(m_data);
+    }
+    template <typename T>
+    size_t count() const
+    {
+        return m_bytes / sizeof(T);
+    }
+};
+
+class Context;
+class Graph;
+
+/**
+ * @brief Tensor descriptors of a graph, shared by its jobs
+ */
+struct GraphTensors
+{
+    std::vector<aipu_tensor_desc_t> inputs;
+    std::vector<aipu_tensor_desc_t> outputs;
+};
+
+class Job
+{
+private:
+    const aipu_ctx_handle_t* m_ctx = nullptr;
+    std::shared_ptr<const GraphTensors> m_tensors;
+    aipu_job_ref_t m_ref = {nullptr, 0};
+    uint64_t m_id = 0;
+
+private:
+    friend class Graph;
+    Job(const aipu_ctx_handle_t* ctx, std::shared_ptr<const GraphTensors> tensors, const aipu_job_ref_t& ref,
+        uint64_t id): m_ctx(ctx), m_tensors(std::move(tensors)), m_ref(ref), m_id(id) {}
+    aipu_status_t check_tensor(aipu_tensor_type_t type, uint32_t tensor, size_t bytes) const
+    {
+        const std::vector<aipu_tensor_desc_t>* descs = nullptr;
+
+        if (m_ref.ctx == nullptr)
+        {
+            return AIPU_STATUS_ERROR_INVALID_JOB_ID;
+        }
+        descs = (type == AIPU_TENSOR_TYPE_INPUT) ? &m_tensors->inputs : &m_tensors->outputs;
+        if (tensor >= descs->size())
+        {
+            return AIPU_STATUS_ERROR_INVALID_TENSOR_ID;
+        }
+        if (bytes < (*descs)[tensor].size)
+        {
+            return AIPU_STATUS_ERROR_INVALID_SIZE;
+        }
+        return AIPU_STATUS_SUCCESS;
+    }
+
+public:
+    AIPU_NODISCARD aipu_status_t load_input(uint32_t tensor, const TensorView& view)
+    {
+        aipu_status_t ret = check_tensor(AIPU_TENSOR_TYPE_INPUT, tensor, view.size_bytes());
+        if (ret != AIPU_STATUS_SUCCESS)
+        {
+            return ret;
+        }
+        return aipu_job_ref_load_tensor(&m_ref, tensor, view.data());
+    }
+    AIPU_NODISCARD aipu_status_t get_output(uint32_t tensor, const TensorView& view)
+    {
+        aipu_status_t ret = check_tensor(AIPU_TENSOR_TYPE_OUTPUT, tensor, view.size_bytes());
+        if (ret != AIPU_STATUS_SUCCESS)
+        {
+            return ret;
+        }
+        return aipu_job_ref_get_tensor(&m_ref, AIPU_TENSOR_TYPE_OUTPUT, tensor, view.data());
+    }
+    AIPU_NODISCARD aipu_status_t finish(int32_t time_out = -1)
+    {
+        if (m_ref.ctx == nullptr)
+        {
+            return AIPU_STATUS_ERROR_INVALID_JOB_ID;
+        }
+        return aipu_job_ref_finish(&m_ref, time_out);
+    }
+    AIPU_NODISCARD aipu_status_t flush(aipu_job_handler_callback callback = nullptr, void* priv = nullptr)
+    {
+        if ((m_ref.ctx == nullptr) || (callback != nullptr))
+        {
+            return aipu_flush_job(m_ctx, m_id, callback, priv);
+        }
+        return aipu_job_ref_flush(&m_ref);
+    }
+    AIPU_NODISCARD aipu_status_t get_status(aipu_job_status_t* status)
+    {
+        if (m_ref.ctx == nullptr)
+        {
+            return AIPU_STATUS_ERROR_INVALID_JOB_ID;
+        }
+        return aipu_job_ref_get_status(&m_ref, status);
+    }
+    AIPU_NODISCARD aipu_status_t config(uint64_t types, void* cfg)
+    {
+        return aipu_config_job(m_ctx, m_id, types, cfg);
+    }
+    aipu_status_t reset()
+    {
+        aipu_status_t ret = AIPU_STATUS_SUCCESS;
+        if (m_id != 0)
+        {
+            ret = aipu_clean_job(m_ctx, m_id);
+            m_id = 0;
+        }
+        m_ref.ctx = nullptr;
+        m_tensors.reset();
+        return ret;
+    }
+    uint64_t id() const
+    {
+        return m_id;
+    }
+    bool valid() const
+    {
+        return m_id != 0;
+    }
+
+public:
+    Job() = default;
+    ~Job()
+    {
+        reset();
+    }
+    Job(Job&& job) noexcept: m_ctx(job.m_ctx), m_tensors(std::move(job.m_tensors)), m_ref(job.m_ref),
+        m_id(job.m_id)
+    {
+        job.m_ref.ctx = nullptr;
+        job.m_id = 0;
+    }
+    Job& operator=(Job&& job) noexcept
+    {
+        if (this != &job)
+        {
+            reset();
+            m_ctx = job.m_ctx;
+            m_tensors = std::move(job.m_tensors);
+            m_ref = job.m_ref;
+            m_id = job.m_id;
+            job.m_ref.ctx = nullptr;
+            job.m_id = 0;
+        }
+        return *this;
+    }
+    Job(const Job& job) = delete;
+    Job& operator=(const Job& job) = delete;
+};
+
+class Graph
+{
+private:
+    const aipu_ctx_handle_t* m_ctx = nullptr;
+    uint64_t m_id = 0;
+    /* shared with the jobs, which may outlive the graph */
+    std::shared_ptr<GraphTensors> m_tensors;
+
+private:
+    friend class Context;
+    aipu_status_t load_descs(aipu_tensor_type_t type, std::vector<aipu_tensor_desc_t>& descs)
+    {
+        aipu_status_t ret = AIPU_STATUS_SUCCESS;
+        uint32_t cnt = 0;
+
+        ret = aipu_get_tensor_count(m_ctx, m_id, type, &cnt);
+        if (ret != AIPU_STATUS_SUCCESS)
+        {
+            return ret;
+        }
+        descs.resize(cnt);
+        for (uint32_t i = 0; i < cnt; i++)
+        {
+            ret = aipu_get_tensor_descriptor(m_ctx, m_id, type, i, &descs[i]);
+            if (ret != AIPU_STATUS_SUCCESS)
+            {
+                return ret;
+            }
+        }
+        return ret;
+    }
+    aipu_status_t init(const aipu_ctx_handle_t* ctx, uint64_t id)
+    {
+        aipu_status_t ret = AIPU_STATUS_SUCCESS;
+
+        reset();
+        m_ctx = ctx;
+        m_id = id;
+        m_tensors = std::make_shared<GraphTensors>();
+        ret = load_descs(AIPU_TENSOR_TYPE_INPUT, m_tensors->inputs);
+        if (ret == AIPU_STATUS_SUCCESS)
+        {
+            ret = load_descs(AIPU_TENSOR_TYPE_OUTPUT, m_tensors->outputs);
+        }
+        if (ret != AIPU_STATUS_SUCCESS)
+        {
+            reset();
+        }
+        return ret;
+    }
+
+public:
+    AIPU_NODISCARD aipu_status_t create_job(Job& job) const
+    {
+        aipu_status_t ret = AIPU_STATUS_SUCCESS;
+        aipu_job_ref_t ref;
+        uint64_t id = 0;
+
+        ret = aipu_create_job(m_ctx, m_id, &id);
+        if (ret != AIPU_STATUS_SUCCESS)
+        {
+            return ret;
+        }
+        ret = aipu_get_job_ref(m_ctx, id, &ref);
+        if (ret != AIPU_STATUS_SUCCESS)
+        {
+            aipu_clean_job(m_ctx, id);
+            return ret;
+        }
+        job = Job(m_ctx, m_tensors, ref, id);
+        return ret;
+    }
+    const std::vector<aipu_tensor_desc_t>& inputs() const
+    {
+        static const std::vector<aipu_tensor_desc_t> none;
+        return m_tensors ? m_tensors->inputs : none;
+    }
+    const std::vector<aipu_tensor_desc_t>& outputs() const
+    {
+        static const std::vector<aipu_tensor_desc_t> none;
+        return m_tensors ? m_tensors->outputs : none;
+    }
+    aipu_status_t reset()
+    {
+        aipu_status_t ret = AIPU_STATUS_SUCCESS;
+        if (m_id != 0)
+        {
+            ret = aipu_unload_graph(m_ctx, m_id);
+            m_id = 0;
+        }
+        m_tensors.reset();
+        return ret;
+    }
+    uint64_t id() const
+    {
+        return m_id;
+    }
+    bool valid() const
+    {
+        return m_id != 0;
+    }
+
+public:
+    Graph() = default;
+    ~Graph()
+    {
+        reset();
+    }
+    Graph(Graph&& graph) noexcept: m_ctx(graph.m_ctx), m_id(graph.m_id),
+        m_tensors(std::move(graph.m_tensors))
+    {
+        graph.m_id = 0;
+    }
+    Graph& operator=(Graph&& graph) noexcept
+    {
+        if (this != &graph)
+        {
+            reset();
+            m_ctx = graph.m_ctx;
+            m_id = graph.m_id;
+            m_tensors = std::move(graph.m_tensors);
+            graph.m_id = 0;
+        }
+        return *this;
+    }
+    Graph(const Graph& graph) = delete;
+    Graph& operator=(const Graph& graph) = delete;
+};
+
+class Context
+{
+private:
+    aipu_ctx_handle_t* m_ctx = nullptr;
+
+public:
+    AIPU_NODISCARD aipu_status_t init()
+    {
+        reset();
+        return aipu_init_context(&m_ctx);
+    }
+    AIPU_NODISCARD aipu_status_t config(uint64_t types, void* cfg)
+    {
+        return aipu_config_global(m_ctx, types, cfg);
+    }
+    AIPU_NODISCARD aipu_status_t load_graph(const char* file, Graph& graph)
+    {
+        aipu_status_t ret = AIPU_STATUS_SUCCESS;
+        uint64_t id = 0;
+
+        ret = aipu_load_graph(m_ctx, file, &id);
+        if (ret == AIPU_STATUS_SUCCESS)
+        {
+            ret = graph.init(m_ctx, id);
+        }
+        return ret;
+    }
+    const char* error_message(aipu_status_t status) const
+    {
+        const char* msg = nullptr;
+        aipu_get_error_message(m_ctx, status, &msg);
+        return msg;
+    }
+    aipu_status_t reset()
+    {
+        aipu_status_t ret = AIPU_STATUS_SUCCESS;
+        if (m_ctx != nullptr)
+        {
+            ret = aipu_deinit_context(m_ctx);
+            m_ctx = nullptr;
+        }
+        return ret;
+    }
+    const aipu_ctx_handle_t* handle() const
+    {
+        return m_ctx;
+    }
+
+public:
+    Context() = default;
+    ~Context()
+    {
+        reset();
+    }
+    Context(Context&& ctx) noexcept: m_ctx(ctx.m_ctx)
+    {
+        ctx.m_ctx = nullptr;
+    }
+    Context& operator=(Context&& ctx) noexcept
+    {
+        if (this != &ctx)
+        {
+            reset();
+            m_ctx = ctx.m_ctx;
+            ctx.m_ctx = nullptr;
+        }
+        return *this;
+    }
+    Context(const Context& ctx) = delete;
+    Context& operator=(const Context& ctx) = delete;
+};
+}
+
+#endif /* _AIPU_API_HPP_ */
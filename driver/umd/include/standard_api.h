@@ -54,6 +54,26 @@ typedef struct
     aipu_data_type_t data_type;
 } aipu_tensor_desc_t;
 
+/**
+ * device memory (in bytes, rounded to the pages allocated) used by a graph and its jobs
+ */
+typedef struct
+{
+    uint64_t text_size;    /**< shared by the jobs: code */
+    uint64_t weight_size;  /**< shared by the jobs: weights */
+    uint64_t shared_size;  /**< shared by the jobs: total, allocated at graph load */
+    uint64_t rodata_size;  /**< per job: rodata (parameters) */
+    uint64_t dcr_size;     /**< per job: descriptors */
+    uint64_t tcb_size;     /**< per job: task control blocks */
+    uint64_t reuse_size;   /**< per job: reuse (feature map & IO tensor) sections */
+    uint64_t stack_size;   /**< per job: stacks of all the tasks (TECs) */
+    uint64_t data_size;    /**< per job: data (CC) sections of all the tasks (TECs) */
+    uint64_t job_size;     /**< per job: total, allocated at job creation */
+    uint64_t align_slack;  /**< per job: pages at most skipped to align its buffers */
+    uint64_t dev_budget;   /**< device: memory budget for admission, 0 if not known */
+    uint64_t dev_used;     /**< device: memory allocated or reserved by jobs being created */
+} aipu_graph_memory_info_t;
+
 /**
  * @brief AIPU job status; returned by status querying API aipu_get_job_status().
  */
@@ -86,6 +106,13 @@ typedef enum {
     AIPU_CONFIG_TYPE_SIMULATION               = 0x100,
     AIPU_GLOBAL_CONFIG_TYPE_DISABLE_VER_CHECK = 0x200,
     AIPU_GLOBAL_CONFIG_TYPE_ENABLE_VER_CHECK  = 0x400,
+    AIPU_GLOBAL_CONFIG_TYPE_WEIGHT_STREAMING  = 0x800,
+    AIPU_GLOBAL_CONFIG_TYPE_PARALLEL_LOAD     = 0x1000,
+    AIPU_GLOBAL_CONFIG_TYPE_DEFERRED_UNLOAD   = 0x2000,
+    AIPU_GLOBAL_CONFIG_TYPE_MOCK_DEVICE       = 0x4000,
+    AIPU_GLOBAL_CONFIG_TYPE_PLACEMENT         = 0x8000,
+    AIPU_GLOBAL_CONFIG_TYPE_SCHEDULER         = 0x10000,
+    AIPU_GLOBAL_CONFIG_TYPE_ADMISSION         = 0x20000,
 } aipu_config_type_t;
 
 typedef struct {
@@ -120,6 +147,177 @@ typedef struct {
     bool enable_calloc;
 } aipu_global_config_simulation_t;
 
+typedef struct {
+    /**
+     * host staging window (in bytes) used to stream the weight section of a graph
+     * binary into device memory chunk by chunk; set to be 0 to read the whole section
+     * into host memory before writing it (default behavior)
+     */
+    uint32_t window_size;
+    /**
+     * use a reader thread to overlap graph file reading with device memory writing;
+     * the window is split into two chunks in this case
+     */
+    bool async_read;
+} aipu_global_config_weight_streaming_t;
+
+typedef struct {
+    /**
+     * number of UMD internal threads used to load graphs; set to be 0 to
+     * load graphs serially in the caller's thread (default behavior)
+     */
+    uint32_t thread_cnt;
+    /**
+     * text/weight sections are copied into device memory in chunks of this
+     * size (in bytes) in parallel; set to be 0 to use the UMD default (4MB)
+     */
+    uint32_t chunk_size;
+} aipu_global_config_parallel_load_t;
+
+typedef struct {
+    /**
+     * true: aipu_unload_graph retires the graph and returns at once, and a UMD internal
+     * thread reclaims it later; false: aipu_unload_graph reclaims the graph before returning
+     * (default behavior)
+     */
+    bool enable;
+    /**
+     * maximum number of jobs destroyed by the reclaimer per round; 0 for the UMD default
+     */
+    uint32_t batch_cnt;
+} aipu_global_config_deferred_unload_t;
+
+typedef enum {
+    AIPU_MOCK_JITTER_NONE,        /**< every job takes exactly service_time_us */
+    AIPU_MOCK_JITTER_UNIFORM,     /**< service_time_us +/- jitter_us, uniformly distributed */
+    AIPU_MOCK_JITTER_EXPONENTIAL, /**< service_time_us + exponential tail with mean jitter_us */
+} aipu_mock_jitter_t;
+
+typedef struct {
+    /**
+     * number of virtual cores executing jobs in parallel; 0 for 1 core
+     */
+    uint32_t core_cnt;
+    /**
+     * service time (in microseconds) of a job on a virtual core; 0 to complete jobs at once
+     */
+    uint32_t service_time_us;
+    /**
+     * jitter distribution and magnitude (in microseconds) added to the service time
+     */
+    aipu_mock_jitter_t jitter;
+    uint32_t jitter_us;
+    /**
+     * seed of the jitter random sequence; the same seed reproduces the same service times
+     */
+    uint64_t seed;
+} aipu_global_config_mock_device_t;
+
+typedef enum {
+    AIPU_PLACEMENT_ROUND_ROBIN,  /**< graphs and model jobs go to the devices in turn (default) */
+    AIPU_PLACEMENT_LEAST_LOADED, /**< graphs go to the device with the fewest resident graphs,
+                                      model jobs to the device with the fewest jobs in use */
+    AIPU_PLACEMENT_PINNED,       /**< everything goes to one device */
+} aipu_placement_policy_t;
+
+typedef struct {
+    /**
+     * how graphs loaded afterwards and jobs of models are spread over the devices
+     */
+    aipu_placement_policy_t policy;
+    /**
+     * device used by AIPU_PLACEMENT_PINNED, numbered within [0, device_cnt)
+     */
+    uint32_t device;
+} aipu_global_config_placement_t;
+
+typedef struct {
+    /**
+     * number of jobs of job queues admitted onto a device per core at a time, the others
+     * waiting in their queues; 0 for the UMD default (1)
+     */
+    uint32_t jobs_per_core;
+} aipu_global_config_scheduler_t;
+
+typedef struct {
+    /**
+     * budget (in bytes) of the device memory of each device against which jobs are admitted,
+     * including the graphs loaded; 0 for the device memory size, or no admission control if
+     * the size is not known to UMD (e.g. memory managed by KMD)
+     */
+    uint64_t mem_limit;
+} aipu_global_config_admission_t;
+
+typedef struct {
+    /**
+     * jobs of a queue are always admitted before those of queues of lower priority;
+     * 0 is the lowest
+     */
+    uint32_t priority;
+    /**
+     * share of the device among the backlogged queues of the same priority; 0 is taken as 1
+     */
+    uint32_t weight;
+} aipu_job_queue_config_t;
+
+typedef struct {
+    uint64_t submitted_cnt;  /**< number of jobs flushed into the queue */
+    uint64_t dispatched_cnt; /**< number of jobs admitted onto the device */
+    uint64_t done_cnt;       /**< number of jobs done or ended with exception */
+    uint32_t queued_cnt;     /**< number of jobs waiting in the queue now */
+    uint32_t in_flight_cnt;  /**< number of jobs of the queue on the device now */
+    uint64_t avg_wait_us;    /**< average time from flushing a job to admitting it */
+    uint64_t max_wait_us;    /**< maximum time from flushing a job to admitting it */
+    uint64_t avg_latency_us; /**< average time from flushing a job to its completion */
+    uint64_t max_latency_us; /**< maximum time from flushing a job to its completion */
+} aipu_job_queue_stat_t;
+
+typedef struct {
+    /**
+     * maximum number of requests dispatched as one batch; 0 for the UMD default (8)
+     */
+    uint32_t max_batch_size;
+    /**
+     * maximum time (in microseconds) the first request of a batch waits for others before
+     * the batch is dispatched; 0 to dispatch the requests already there at once
+     */
+    uint32_t max_delay_us;
+} aipu_batcher_config_t;
+
+typedef struct {
+    uint64_t request_cnt;  /**< number of requests dispatched */
+    uint64_t batch_cnt;    /**< number of batches dispatched */
+    uint64_t avg_delay_us; /**< average time from a request to the dispatch of its batch */
+    uint64_t max_delay_us; /**< maximum time from a request to the dispatch of its batch */
+} aipu_batcher_stat_t;
+
+typedef struct {
+    uint32_t src_graph;  /**< index (in the graph list of a super graph) of the producer graph */
+    uint32_t src_output; /**< output tensor of the producer graph */
+    uint32_t dst_graph;  /**< index of the consumer graph, which must come after the producer */
+    uint32_t dst_input;  /**< input tensor of the consumer graph, of the same size as the output */
+} aipu_tensor_binding_t;
+
+typedef struct {
+    uint32_t stage_cnt;   /**< number of graphs the super graph job runs */
+    uint32_t bound_cnt;   /**< number of bindings read by the consumer in place */
+    uint32_t copied_cnt;  /**< number of bindings copied before the consumer is started */
+    uint32_t chained_cnt; /**< number of graphs started by the device at the last scheduling */
+} aipu_super_job_stat_t;
+
+typedef struct {
+    uint32_t job_cnt;        /**< number of jobs replayed */
+    uint32_t exception_cnt;  /**< number of jobs which ended with exception */
+    uint64_t total_time_us;  /**< time used to replay the whole trace */
+    uint64_t avg_latency_us; /**< average latency from scheduling a job to its completion */
+    uint64_t max_latency_us; /**< maximum latency from scheduling a job to its completion */
+} aipu_replay_stat_t;
+
+typedef struct aipu_job_ref {
+    void* ctx;    /**< private to UMD: context the job belongs to */
+    uint64_t job; /**< job ID, checked by UMD on every use */
+} aipu_job_ref_t;
+
 typedef struct aipu_io_tensors {
     uint32_t count;
     struct aipu_io_tensor {
@@ -166,7 +364,10 @@ typedef enum {
     AIPU_STATUS_ERROR_INVALID_TENSOR_ID    = 0x1A,
     AIPU_STATUS_ERROR_INVALID_CLUSTER_ID   = 0x1B,
     AIPU_STATUS_ERROR_PRINTF_FAIL          = 0x1C,
-    AIPU_STATUS_MAX = 0x1D
+    AIPU_STATUS_ERROR_INVALID_MODEL_ID     = 0x1D,
+    AIPU_STATUS_ERROR_INVALID_QUEUE_ID     = 0x1E,
+    AIPU_STATUS_ERROR_INVALID_BATCHER_ID   = 0x1F,
+    AIPU_STATUS_MAX = 0x20
 } aipu_status_t;
 
 /**
@@ -179,6 +380,7 @@ typedef enum {
  * @retval AIPU_STATUS_ERROR_NULL_PTR
  * @retval AIPU_STATUS_ERROR_OPEN_DEV_FAIL
  * @retval AIPU_STATUS_ERROR_DEV_ABNORMAL
+ * @retval AIPU_STATUS_ERROR_BUF_ALLOC_FAIL
  *
  * @note Before invoking any other UMD API calls, any UMD application must initialize a context first.
  */
@@ -219,10 +421,28 @@ aipu_status_t aipu_get_error_message(const aipu_ctx_handle_t* ctx, aipu_status_t
  * @retval AIPU_STATUS_ERROR_NULL_PTR
  * @retval AIPU_STATUS_ERROR_INVALID_CTX
  * @retval AIPU_STATUS_ERROR_INVALID_CONFIG
+ * @retval AIPU_STATUS_ERROR_INVALID_OP
  *
  * @note accepted types/config: AIPU_CONFIG_TYPE_SIMULATION/aipu_global_config_simulation_t
  * @note accepted types/config: AIPU_GLOBAL_CONFIG_TYPE_DISABLE_VER_CHECK/none
  * @note accepted types/config: AIPU_GLOBAL_CONFIG_TYPE_ENABLE_VER_CHECK/none
+ * @note accepted types/config: AIPU_GLOBAL_CONFIG_TYPE_WEIGHT_STREAMING/aipu_global_config_weight_streaming_t
+ * @note accepted types/config: AIPU_GLOBAL_CONFIG_TYPE_PARALLEL_LOAD/aipu_global_config_parallel_load_t
+ * @note accepted types/config: AIPU_GLOBAL_CONFIG_TYPE_DEFERRED_UNLOAD/aipu_global_config_deferred_unload_t
+ * @note accepted types/config: AIPU_GLOBAL_CONFIG_TYPE_MOCK_DEVICE/aipu_global_config_mock_device_t
+ * @note accepted types/config: AIPU_GLOBAL_CONFIG_TYPE_PLACEMENT/aipu_global_config_placement_t
+ * @note accepted types/config: AIPU_GLOBAL_CONFIG_TYPE_SCHEDULER/aipu_global_config_scheduler_t
+ * @note accepted types/config: AIPU_GLOBAL_CONFIG_TYPE_ADMISSION/aipu_global_config_admission_t
+ * @note config is interpreted as the struct of one type: types with a config struct cannot be
+ *       combined in one call (AIPU_STATUS_ERROR_INVALID_CONFIG), while the version check
+ *       types, which take no config, can be combined with any of them
+ * @note weight streaming only takes effect for graphs loaded after this configuration and
+ *       bounds the host memory used for the weight section to window_size bytes
+ * @note parallel load is refused with AIPU_STATUS_ERROR_INVALID_OP while graphs are being
+ *       loaded, or while it is being configured by another thread
+ * @note mock device latency can only be configured if the context runs on the mock device
+ *       (UMD built for mock platform, or environment variable AIPU_UMD_DEVICE=mock set before
+ *       aipu_init_context) and there is no job being executed
  */
 aipu_status_t aipu_config_global(const aipu_ctx_handle_t* ctx, uint64_t types, void* config);
 /**
@@ -246,6 +466,27 @@ aipu_status_t aipu_config_global(const aipu_ctx_handle_t* ctx, uint64_t types, v
  * @retval AIPU_STATUS_ERROR_RESERVE_SRAM_FAIL
  */
 aipu_status_t aipu_load_graph(const aipu_ctx_handle_t* ctx, const char* graph, uint64_t* id);
+/**
+ * @brief This API loads multiple offline built AIPU executable graph binaries concurrently.
+ *
+ * @param[in]  ctx    Pointer to a context handle struct returned by aipu_init_context
+ * @param[in]  graphs Array of executable graph binary file paths
+ * @param[in]  cnt    Number of graph binaries in graphs
+ * @param[out] ids    Pointer to an array of cnt elements allocated by application where UMD stores
+ *                        the graph IDs, in the same order as graphs
+ *
+ * @retval AIPU_STATUS_SUCCESS
+ * @retval AIPU_STATUS_ERROR_NULL_PTR
+ * @retval AIPU_STATUS_ERROR_INVALID_CTX
+ * @retval AIPU_STATUS_ERROR_INVALID_SIZE
+ * @retval other failure status returned by aipu_load_graph
+ *
+ * @note graphs are loaded by the UMD internal threads configured with
+ *       AIPU_GLOBAL_CONFIG_TYPE_PARALLEL_LOAD, or serially if there is none
+ * @note if any of the graphs fails to be loaded, the ones already loaded are unloaded and
+ *       the status of the first failed graph is returned
+ */
+aipu_status_t aipu_load_graphs(const aipu_ctx_handle_t* ctx, const char* graphs[], uint32_t cnt, uint64_t ids[]);
 /**
  * @brief This API is used to unload a loaded graph
  *
@@ -256,8 +497,217 @@ aipu_status_t aipu_load_graph(const aipu_ctx_handle_t* ctx, const char* graph, u
  * @retval AIPU_STATUS_ERROR_NULL_PTR
  * @retval AIPU_STATUS_ERROR_INVALID_CTX
  * @retval AIPU_STATUS_ERROR_INVALID_GRAPH_ID
+ *
+ * @note If deferred unload is enabled by AIPU_GLOBAL_CONFIG_TYPE_DEFERRED_UNLOAD, this API only
+ *       retires the graph: no more jobs can be created for it, and its jobs in flight run to
+ *       completion. UMD destroys each job in background once it is not in flight any more
+ *       (its ID is invalid from then on), and the graph after its last job, or when the context
+ *       is de-initialized.
  */
 aipu_status_t aipu_unload_graph(const aipu_ctx_handle_t* ctx, uint64_t graph);
+/**
+ * @brief This API composes loaded graphs into a super graph: a pipeline whose jobs run the
+ *        graphs one after another, with each bound output read by the next graphs in place
+ *
+ * @param[in]  ctx         Pointer to a context handle struct returned by aipu_init_context
+ * @param[in]  graphs      Graph IDs returned by aipu_load_graph, in execution order
+ * @param[in]  cnt         Number of graphs
+ * @param[in]  bindings    Output-to-input bindings between the graphs
+ * @param[in]  binding_cnt Number of bindings
+ * @param[out] id          Pointer to a memory location allocated by application where UMD stores
+ *                             the super graph ID
+ *
+ * @retval AIPU_STATUS_SUCCESS
+ * @retval AIPU_STATUS_ERROR_NULL_PTR
+ * @retval AIPU_STATUS_ERROR_INVALID_CTX
+ * @retval AIPU_STATUS_ERROR_INVALID_GRAPH_ID
+ * @retval AIPU_STATUS_ERROR_INVALID_TENSOR_ID
+ * @retval AIPU_STATUS_ERROR_INVALID_SIZE
+ * @retval AIPU_STATUS_ERROR_INVALID_OP
+ *
+ * @note The super graph ID is used like a graph ID: its inputs are the unbound inputs and its
+ *       outputs are the unbound outputs of the graphs, in graph order; a job created for it is
+ *       scheduled and queried as one job. All the graphs should be resident on the same device.
+ * @note When a job is scheduled, the graphs are chained on the device one behind another if
+ *       it can do so. A graph fed by a copy, or any graph on a device that cannot chain jobs,
+ *       is started by UMD only when the job status is got (aipu_get_job_status or
+ *       aipu_finish_job) and shows the previous graph done; see aipu_get_super_job_stat.
+ * @note A bound input read by the graph code in a way UMD cannot redirect is copied from the
+ *       output before its graph is started, instead of being read in place.
+ * @note The graphs cannot be unloaded before the super graph is unloaded by aipu_unload_graph.
+ */
+aipu_status_t aipu_create_super_graph(const aipu_ctx_handle_t* ctx, const uint64_t graphs[], uint32_t cnt,
+    const aipu_tensor_binding_t bindings[], uint32_t binding_cnt, uint64_t* id);
+/**
+ * @brief This API gets how the graphs of a super graph job are fed and started
+ *
+ * @param[in]  ctx  Pointer to a context handle struct returned by aipu_init_context
+ * @param[in]  job  Job ID returned by aipu_create_job for a super graph
+ * @param[out] stat Pointer to a memory location allocated by application where UMD stores
+ *                      the statistics
+ *
+ * @retval AIPU_STATUS_SUCCESS
+ * @retval AIPU_STATUS_ERROR_NULL_PTR
+ * @retval AIPU_STATUS_ERROR_INVALID_CTX
+ * @retval AIPU_STATUS_ERROR_INVALID_JOB_ID
+ * @retval AIPU_STATUS_ERROR_OP_NOT_SUPPORTED
+ *
+ * @note The bindings are settled when the job is created; chained_cnt is that of the last
+ *       aipu_flush_job or aipu_finish_job of the job.
+ */
+aipu_status_t aipu_get_super_job_stat(const aipu_ctx_handle_t* ctx, uint64_t job, aipu_super_job_stat_t* stat);
+/**
+ * @brief This API loads a graph binary as the first version of a model, and pre-creates
+ *        a pool of jobs for it.
+ *
+ * @param[in]  ctx     Pointer to a context handle struct returned by aipu_init_context
+ * @param[in]  graph   Executable graph binary file path
+ * @param[in]  job_cnt Number of jobs pre-created for each version of the model
+ * @param[out] model   Pointer to a memory location allocated by application where UMD stores the
+ *                         model handle, which stays valid across aipu_swap_model calls
+ *
+ * @retval AIPU_STATUS_SUCCESS
+ * @retval AIPU_STATUS_ERROR_NULL_PTR
+ * @retval AIPU_STATUS_ERROR_INVALID_CTX
+ * @retval other failure status returned by aipu_load_graph/aipu_create_job
+ */
+aipu_status_t aipu_load_model(const aipu_ctx_handle_t* ctx, const char* graph, uint32_t job_cnt, uint64_t* model);
+/**
+ * @brief This API loads a new graph binary version for a model and atomically redirects
+ *        the model to it.
+ *
+ * @param[in] ctx   Pointer to a context handle struct returned by aipu_init_context
+ * @param[in] model Model handle returned by aipu_load_model
+ * @param[in] graph Executable graph binary file path of the new version
+ *
+ * @retval AIPU_STATUS_SUCCESS
+ * @retval AIPU_STATUS_ERROR_NULL_PTR
+ * @retval AIPU_STATUS_ERROR_INVALID_CTX
+ * @retval AIPU_STATUS_ERROR_INVALID_MODEL_ID
+ * @retval other failure status returned by aipu_load_graph/aipu_create_job
+ *
+ * @note The new version and its job pool are prepared before the switch; jobs acquired
+ *       afterwards come from the new version. If this fails, the model is left unchanged.
+ * @note Jobs of the old version acquired before the switch can still be used; the old
+ *       graph is unloaded after the last of them is released by aipu_release_model_job.
+ */
+aipu_status_t aipu_swap_model(const aipu_ctx_handle_t* ctx, uint64_t model, const char* graph);
+/**
+ * @brief This API unloads all the versions of a model together with their jobs
+ *
+ * @param[in] ctx   Pointer to a context handle struct returned by aipu_init_context
+ * @param[in] model Model handle returned by aipu_load_model
+ *
+ * @retval AIPU_STATUS_SUCCESS
+ * @retval AIPU_STATUS_ERROR_NULL_PTR
+ * @retval AIPU_STATUS_ERROR_INVALID_CTX
+ * @retval AIPU_STATUS_ERROR_INVALID_MODEL_ID
+ */
+aipu_status_t aipu_unload_model(const aipu_ctx_handle_t* ctx, uint64_t model);
+/**
+ * @brief This API takes an idle job of the current version of a model
+ *
+ * @param[in]  ctx   Pointer to a context handle struct returned by aipu_init_context
+ * @param[in]  model Model handle returned by aipu_load_model
+ * @param[out] job   Pointer to a memory location allocated by application where UMD stores the
+ *                       job ID, which is used as the ones returned by aipu_create_job
+ *
+ * @retval AIPU_STATUS_SUCCESS
+ * @retval AIPU_STATUS_ERROR_NULL_PTR
+ * @retval AIPU_STATUS_ERROR_INVALID_CTX
+ * @retval AIPU_STATUS_ERROR_INVALID_MODEL_ID
+ *
+ * @note A new job is created if all the pre-created ones are in use.
+ * @note The job should be given back by aipu_release_model_job instead of aipu_clean_job.
+ */
+aipu_status_t aipu_acquire_model_job(const aipu_ctx_handle_t* ctx, uint64_t model, uint64_t* job);
+/**
+ * @brief This API gives back a job taken by aipu_acquire_model_job
+ *
+ * @param[in] ctx   Pointer to a context handle struct returned by aipu_init_context
+ * @param[in] model Model handle returned by aipu_load_model
+ * @param[in] job   Job ID returned by aipu_acquire_model_job
+ *
+ * @retval AIPU_STATUS_SUCCESS
+ * @retval AIPU_STATUS_ERROR_NULL_PTR
+ * @retval AIPU_STATUS_ERROR_INVALID_CTX
+ * @retval AIPU_STATUS_ERROR_INVALID_MODEL_ID
+ * @retval AIPU_STATUS_ERROR_INVALID_JOB_ID
+ */
+aipu_status_t aipu_release_model_job(const aipu_ctx_handle_t* ctx, uint64_t model, uint64_t job);
+/**
+ * @brief This API creates a batcher, which coalesces single-frame inference requests of a graph
+ *        from application threads into batches
+ *
+ * @param[in]  ctx     Pointer to a context handle struct returned by aipu_init_context
+ * @param[in]  graph   Graph ID returned by aipu_load_graph
+ * @param[in]  config  Batch size and queueing delay limits
+ * @param[out] batcher Pointer to a memory location allocated by application where UMD stores
+ *                         the batcher handle
+ *
+ * @retval AIPU_STATUS_SUCCESS
+ * @retval AIPU_STATUS_ERROR_NULL_PTR
+ * @retval AIPU_STATUS_ERROR_INVALID_CTX
+ * @retval AIPU_STATUS_ERROR_INVALID_GRAPH_ID
+ * @retval other failure status returned by aipu_create_job
+ *
+ * @note max_batch_size jobs of the graph are pre-created. A batch is dispatched when
+ *       max_batch_size requests are collected or its first request has waited for max_delay_us:
+ *       each request runs as one of the jobs, all flushed back to back, and the outputs are
+ *       copied to the requesters when the whole batch is done.
+ * @note The graph cannot be unloaded before the batcher is destroyed.
+ */
+aipu_status_t aipu_create_batcher(const aipu_ctx_handle_t* ctx, uint64_t graph,
+    const aipu_batcher_config_t* config, uint64_t* batcher);
+/**
+ * @brief This API runs one frame through a batcher, and returns when its outputs are got
+ *
+ * @param[in] ctx     Pointer to a context handle struct returned by aipu_init_context
+ * @param[in] batcher Batcher handle returned by aipu_create_batcher
+ * @param[in] inputs  Input tensor data, one per input tensor of the graph
+ * @param[in] outputs Buffers for output tensor data, one per output tensor of the graph;
+ *                    an output is not copied if its buffer is NULL
+ *
+ * @retval AIPU_STATUS_SUCCESS
+ * @retval AIPU_STATUS_ERROR_NULL_PTR
+ * @retval AIPU_STATUS_ERROR_INVALID_CTX
+ * @retval AIPU_STATUS_ERROR_INVALID_BATCHER_ID
+ * @retval AIPU_STATUS_ERROR_JOB_EXCEPTION
+ * @retval other failure status returned by aipu_load_tensor/aipu_flush_job
+ *
+ * @note This API can be called from many threads at the same time.
+ */
+aipu_status_t aipu_batcher_infer(const aipu_ctx_handle_t* ctx, uint64_t batcher, const void* const inputs[],
+    void* const outputs[]);
+/**
+ * @brief This API gets the statistics of a batcher
+ *
+ * @param[in]  ctx     Pointer to a context handle struct returned by aipu_init_context
+ * @param[in]  batcher Batcher handle returned by aipu_create_batcher
+ * @param[out] stat    Pointer to a memory location allocated by application where UMD stores
+ *                         the batcher statistics
+ *
+ * @retval AIPU_STATUS_SUCCESS
+ * @retval AIPU_STATUS_ERROR_NULL_PTR
+ * @retval AIPU_STATUS_ERROR_INVALID_CTX
+ * @retval AIPU_STATUS_ERROR_INVALID_BATCHER_ID
+ */
+aipu_status_t aipu_get_batcher_stat(const aipu_ctx_handle_t* ctx, uint64_t batcher, aipu_batcher_stat_t* stat);
+/**
+ * @brief This API destroys a batcher together with its jobs
+ *
+ * @param[in] ctx     Pointer to a context handle struct returned by aipu_init_context
+ * @param[in] batcher Batcher handle returned by aipu_create_batcher
+ *
+ * @retval AIPU_STATUS_SUCCESS
+ * @retval AIPU_STATUS_ERROR_NULL_PTR
+ * @retval AIPU_STATUS_ERROR_INVALID_CTX
+ * @retval AIPU_STATUS_ERROR_INVALID_BATCHER_ID
+ *
+ * @note Requests already queued are run before it returns; no request should be made
+ *       through the batcher afterwards.
+ */
+aipu_status_t aipu_destroy_batcher(const aipu_ctx_handle_t* ctx, uint64_t batcher);
 /**
  * @brief This API is used to create a new job for a graph with provided buffer handle.
  *
@@ -275,8 +725,33 @@ aipu_status_t aipu_unload_graph(const aipu_ctx_handle_t* ctx, uint64_t graph);
  * @note The application can create one or multiple jobs by calling this API one or multiple times.
  * @note The application can schedule one created job one or multiple times by calling
  *           aipu_finish_job/aipu_flush_job, and at last clean it by calling aipu_clean_job.
+ * @note The device memory of the job is reserved before any of it is allocated: if it does not
+ *       fit into the device memory left (see AIPU_GLOBAL_CONFIG_TYPE_ADMISSION), this API
+ *       fails with AIPU_STATUS_ERROR_BUF_ALLOC_FAIL at once.
  */
 aipu_status_t aipu_create_job(const aipu_ctx_handle_t* ctx, uint64_t graph, uint64_t* job);
+/**
+ * @brief This API is used to create a new job for a graph, waiting for device memory to be
+ *        freed if the job does not fit into the memory left.
+ *
+ * @param[in]  ctx      Pointer to a context handle struct returned by aipu_init_context
+ * @param[in]  graph    Graph ID returned by aipu_load_graph
+ * @param[out] job      Pointer to a memory location allocated by application where UMD stores
+ *                          the new created job ID
+ * @param[in]  time_out Time out (in millisecond) to wait for device memory; < 0 means an
+ *                      infinite timeout and 0 means no wait (as aipu_create_job)
+ *
+ * @retval AIPU_STATUS_SUCCESS
+ * @retval AIPU_STATUS_ERROR_NULL_PTR
+ * @retval AIPU_STATUS_ERROR_INVALID_CTX
+ * @retval AIPU_STATUS_ERROR_INVALID_GRAPH_ID
+ * @retval AIPU_STATUS_ERROR_BUF_ALLOC_FAIL
+ *
+ * @note Memory is waited for only while jobs are cleaned or graphs unloaded by other threads;
+ *       a job larger than the whole budget fails at once.
+ */
+aipu_status_t aipu_create_job_timed(const aipu_ctx_handle_t* ctx, uint64_t graph, uint64_t* job,
+    int32_t time_out);
 /**
  * @brief This API is used to flush a new computation job onto AIPU (blocking)
  *
@@ -292,6 +767,9 @@ aipu_status_t aipu_create_job(const aipu_ctx_handle_t* ctx, uint64_t graph, uint
  * @retval AIPU_STATUS_ERROR_INVALID_OP
  * @retval AIPU_STATUS_ERROR_JOB_EXCEPTION
  * @retval AIPU_STATUS_ERROR_JOB_TIMEOUT
+ *
+ * @note A job already flushed (e.g. by aipu_flush_job_after) is not flushed again: this API
+ *       waits for it to be done.
  */
 aipu_status_t aipu_finish_job(const aipu_ctx_handle_t* ctx, uint64_t job, int32_t time_out);
 /**
@@ -315,6 +793,32 @@ aipu_status_t aipu_finish_job(const aipu_ctx_handle_t* ctx, uint64_t job, int32_
  */
 aipu_status_t aipu_flush_job(const aipu_ctx_handle_t* ctx, uint64_t job, aipu_job_handler_callback callback,
     void* priv);
+/**
+ * @brief This API is used to flush a computation job which consumes the results of other
+ *        jobs, without waiting for them in the application (non-blocking)
+ *
+ * @param[in] ctx  Pointer to a context handle struct returned by aipu_init_context
+ * @param[in] job  Job ID returned by aipu_create_job
+ * @param[in] deps Jobs which should be done before this job starts
+ * @param[in] cnt  Number of jobs in deps
+ *
+ * @retval AIPU_STATUS_SUCCESS
+ * @retval AIPU_STATUS_ERROR_NULL_PTR
+ * @retval AIPU_STATUS_ERROR_INVALID_CTX
+ * @retval AIPU_STATUS_ERROR_INVALID_JOB_ID
+ * @retval AIPU_STATUS_ERROR_INVALID_OP
+ *
+ * @note Jobs in deps which are done (or ended with exception) already are not waited for;
+ *       a job in deps which was never flushed makes this API return AIPU_STATUS_ERROR_INVALID_OP
+ *       and this job is not flushed. A job behind one flushed job
+ *       is chained after it on the device if the device supports it (z5 simulator command
+ *       pools, mock device); otherwise it is held by UMD and flushed when the status of the jobs it waits
+ *       for is got, which aipu_get_job_status/aipu_finish_job of this job do by themselves,
+ *       so that a DAG of jobs is run by waiting for its last job only.
+ * @note If a job waited for ends with exception, this job is not run and ends with exception.
+ */
+aipu_status_t aipu_flush_job_after(const aipu_ctx_handle_t* ctx, uint64_t job, const uint64_t deps[],
+    uint32_t cnt);
 /**
  * @brief This API is used to get the execution status of a flushed job (non-blocking)
  *
@@ -342,6 +846,101 @@ aipu_status_t aipu_get_job_status(const aipu_ctx_handle_t* ctx, uint64_t job, ai
  * @retval AIPU_STATUS_ERROR_INVALID_JOB_ID
  */
 aipu_status_t aipu_clean_job(const aipu_ctx_handle_t* ctx, uint64_t job);
+/**
+ * @brief This API releases the stack and reuse buffers of an idle job, leaving only its
+ *        rodata/descriptor/TCBs allocated, so that a parked job costs little device memory
+ *
+ * @param[in] ctx Pointer to a context handle struct returned by aipu_init_context
+ * @param[in] job Job ID returned by aipu_create_job
+ *
+ * @retval AIPU_STATUS_SUCCESS
+ * @retval AIPU_STATUS_ERROR_NULL_PTR
+ * @retval AIPU_STATUS_ERROR_INVALID_CTX
+ * @retval AIPU_STATUS_ERROR_INVALID_JOB_ID
+ * @retval AIPU_STATUS_ERROR_INVALID_OP
+ * @retval AIPU_STATUS_ERROR_OP_NOT_SUPPORTED
+ *
+ * @note The input and output tensors of the job are lost. The buffers are allocated again,
+ *       within the admission budget, by the next aipu_load_tensor or scheduling of the job,
+ *       which returns AIPU_STATUS_ERROR_BUF_ALLOC_FAIL if device memory is not available.
+ * @note A job being scheduled or queued is not hibernated (AIPU_STATUS_ERROR_INVALID_OP);
+ *       neither is a job of a super graph (AIPU_STATUS_ERROR_OP_NOT_SUPPORTED).
+ */
+aipu_status_t aipu_hibernate_job(const aipu_ctx_handle_t* ctx, uint64_t job);
+/**
+ * @brief This API creates a job queue, through which UMD admits the jobs of the graphs
+ *        assigned to it onto their device
+ *
+ * @param[in]  ctx    Pointer to a context handle struct returned by aipu_init_context
+ * @param[in]  config Priority and weight of the queue
+ * @param[out] queue  Pointer to a memory location allocated by application where UMD stores
+ *                        the queue ID
+ *
+ * @retval AIPU_STATUS_SUCCESS
+ * @retval AIPU_STATUS_ERROR_NULL_PTR
+ * @retval AIPU_STATUS_ERROR_INVALID_CTX
+ *
+ * @note Jobs of graphs without a queue are scheduled onto the device as soon as they are
+ *       flushed, in FIFO order. Jobs flushed into queues wait there while their device has
+ *       jobs_per_core (see AIPU_GLOBAL_CONFIG_TYPE_SCHEDULER) of them per core in flight;
+ *       a slot freed is taken by the queue of the highest priority, and the queues of the
+ *       same priority share the device in proportion to their weights (weighted fair queuing).
+ * @note Queued jobs are admitted and their completions are taken by UMD when the status of a
+ *       job of a queue is got (aipu_get_job_status/aipu_finish_job), in the order they were
+ *       admitted onto each device; graphs of a device should be assigned either all or none
+ *       to queues.
+ */
+aipu_status_t aipu_create_job_queue(const aipu_ctx_handle_t* ctx, const aipu_job_queue_config_t* config,
+    uint64_t* queue);
+/**
+ * @brief This API destroys a job queue; graphs assigned to it are left without a queue.
+ *
+ * @param[in] ctx   Pointer to a context handle struct returned by aipu_init_context
+ * @param[in] queue Queue ID returned by aipu_create_job_queue
+ *
+ * @retval AIPU_STATUS_SUCCESS
+ * @retval AIPU_STATUS_ERROR_NULL_PTR
+ * @retval AIPU_STATUS_ERROR_INVALID_CTX
+ * @retval AIPU_STATUS_ERROR_INVALID_QUEUE_ID
+ * @retval AIPU_STATUS_ERROR_INVALID_OP
+ *
+ * @note A queue with jobs queued or in flight cannot be destroyed.
+ */
+aipu_status_t aipu_destroy_job_queue(const aipu_ctx_handle_t* ctx, uint64_t queue);
+/**
+ * @brief This API assigns a graph to a job queue: jobs of the graph flushed afterwards go
+ *        through the queue. One queue can be shared by the graphs of a tenant.
+ *
+ * @param[in] ctx   Pointer to a context handle struct returned by aipu_init_context
+ * @param[in] graph Graph ID returned by aipu_load_graph
+ * @param[in] queue Queue ID returned by aipu_create_job_queue, or 0 to leave the graph without
+ *                  a queue
+ *
+ * @retval AIPU_STATUS_SUCCESS
+ * @retval AIPU_STATUS_ERROR_NULL_PTR
+ * @retval AIPU_STATUS_ERROR_INVALID_CTX
+ * @retval AIPU_STATUS_ERROR_INVALID_GRAPH_ID
+ * @retval AIPU_STATUS_ERROR_INVALID_QUEUE_ID
+ * @retval AIPU_STATUS_ERROR_OP_NOT_SUPPORTED
+ *
+ * @note Super graphs cannot be assigned to queues.
+ */
+aipu_status_t aipu_set_graph_queue(const aipu_ctx_handle_t* ctx, uint64_t graph, uint64_t queue);
+/**
+ * @brief This API gets the statistics of a job queue
+ *
+ * @param[in]  ctx   Pointer to a context handle struct returned by aipu_init_context
+ * @param[in]  queue Queue ID returned by aipu_create_job_queue
+ * @param[out] stat  Pointer to a memory location allocated by application where UMD stores
+ *                       the queue statistics
+ *
+ * @retval AIPU_STATUS_SUCCESS
+ * @retval AIPU_STATUS_ERROR_NULL_PTR
+ * @retval AIPU_STATUS_ERROR_INVALID_CTX
+ * @retval AIPU_STATUS_ERROR_INVALID_QUEUE_ID
+ */
+aipu_status_t aipu_get_job_queue_stat(const aipu_ctx_handle_t* ctx, uint64_t queue,
+    aipu_job_queue_stat_t* stat);
 /**
  * @brief This API is used to get tensor count of specified type
  *
@@ -373,6 +972,26 @@ aipu_status_t aipu_get_tensor_count(const aipu_ctx_handle_t* ctx, uint64_t id, a
  */
 aipu_status_t aipu_get_tensor_descriptor(const aipu_ctx_handle_t* ctx, uint64_t id, aipu_tensor_type_t type,
     uint32_t tensor, aipu_tensor_desc_t* desc);
+/**
+ * @brief This API is used to get the device memory used by a graph and by each of its jobs
+ *
+ * @param[in]  ctx   Pointer to a context handle struct returned by aipu_init_context
+ * @param[in]  graph Graph ID returned by aipu_load_graph or aipu_create_super_graph
+ * @param[out] info  Pointer to a memory location allocated by application where UMD stores the
+ *                       memory info
+ *
+ * @retval AIPU_STATUS_SUCCESS
+ * @retval AIPU_STATUS_ERROR_NULL_PTR
+ * @retval AIPU_STATUS_ERROR_INVALID_CTX
+ * @retval AIPU_STATUS_ERROR_INVALID_GRAPH_ID
+ *
+ * @note job_size is what a job of the graph is admitted against (see aipu_create_job), so
+ *       (dev_budget - dev_used) / job_size more jobs fit onto the device of the graph; with
+ *       fragmented memory a job may take up to align_slack more to be placed.
+ * @note The sizes of a super graph are the sums over its graphs.
+ */
+aipu_status_t aipu_get_graph_memory_info(const aipu_ctx_handle_t* ctx, uint64_t graph,
+    aipu_graph_memory_info_t* info);
 /**
  * @brief This API is used to load input tensor data
  *
@@ -406,6 +1025,40 @@ aipu_status_t aipu_load_tensor(const aipu_ctx_handle_t* ctx, uint64_t job, uint3
  * @retval AIPU_STATUS_ERROR_INVALID_OP
  */
 aipu_status_t aipu_get_tensor(const aipu_ctx_handle_t* ctx, uint64_t job, aipu_tensor_type_t type, uint32_t tensor, void* data);
+/**
+ * @brief This API resolves a job ID into a job reference, for the aipu_job_ref_[*] APIs
+ *        below which skip the context handle lookup on every call
+ *
+ * @param[in]  ctx Pointer to a context handle struct returned by aipu_init_context
+ * @param[in]  job Job ID returned by aipu_create_job
+ * @param[out] ref Pointer to a memory location allocated by application where UMD stores
+ *                 the job reference
+ *
+ * @retval AIPU_STATUS_SUCCESS
+ * @retval AIPU_STATUS_ERROR_NULL_PTR
+ * @retval AIPU_STATUS_ERROR_INVALID_CTX
+ * @retval AIPU_STATUS_ERROR_INVALID_JOB_ID
+ *
+ * @note A job reference may be used as long as its context is not deinitialized; once the
+ *       job is cleaned by aipu_clean_job (or its graph is unloaded), the aipu_job_ref_[*]
+ *       APIs fail with AIPU_STATUS_ERROR_INVALID_JOB_ID.
+ * @note A job reference does not pin the job: each aipu_job_ref_[*] call still looks the
+ *       job up by its ID (generation checked) and holds it for that call only. A pinned job
+ *       would make aipu_clean_job/aipu_unload_graph wait for every reference to be dropped,
+ *       and a C reference has no owner to drop it.
+ */
+aipu_status_t aipu_get_job_ref(const aipu_ctx_handle_t* ctx, uint64_t job, aipu_job_ref_t* ref);
+/**
+ * @brief Same as aipu_load_tensor/aipu_get_tensor/aipu_flush_job/aipu_finish_job/
+ *        aipu_get_job_status, on a job reference filled by aipu_get_job_ref
+ *
+ * @retval AIPU_STATUS_ERROR_NULL_PTR if ref is NULL, or as the ID based APIs
+ */
+aipu_status_t aipu_job_ref_load_tensor(aipu_job_ref_t* ref, uint32_t tensor, const void* data);
+aipu_status_t aipu_job_ref_get_tensor(aipu_job_ref_t* ref, aipu_tensor_type_t type, uint32_t tensor, void* data);
+aipu_status_t aipu_job_ref_flush(aipu_job_ref_t* ref);
+aipu_status_t aipu_job_ref_finish(aipu_job_ref_t* ref, int32_t time_out);
+aipu_status_t aipu_job_ref_get_status(aipu_job_ref_t* ref, aipu_job_status_t* status);
 /**
  * @brief This API is used to configure a specified option of a job.
  *
@@ -437,6 +1090,21 @@ aipu_status_t aipu_config_job(const aipu_ctx_handle_t* ctx, uint64_t job, uint64
  * @retval AIPU_STATUS_ERROR_INVALID_OP
  */
 aipu_status_t aipu_get_cluster_count(const aipu_ctx_handle_t* ctx, uint32_t* cnt);
+/**
+ * @brief This API is used to get the number of AIPU devices (NPUs) used by a context.
+ *
+ * @param[in]  ctx Pointer to a context handle struct returned by aipu_init_context
+ * @param[out] cnt Pointer to a memory location allocated by application where UMD stores the device count
+ *
+ * @retval AIPU_STATUS_SUCCESS
+ * @retval AIPU_STATUS_ERROR_NULL_PTR
+ * @retval AIPU_STATUS_ERROR_INVALID_CTX
+ *
+ * @note Every graph is resident on one device, chosen by the placement policy configured with
+ *       AIPU_GLOBAL_CONFIG_TYPE_PLACEMENT; a model keeps a copy of its graph on every device and
+ *       spreads its jobs over them. Cluster/core counts are those of device 0.
+ */
+aipu_status_t aipu_get_device_count(const aipu_ctx_handle_t* ctx, uint32_t* cnt);
 /**
  * @brief This API is used to get AIPU core count in a specific cluster.
  *
@@ -453,6 +1121,34 @@ aipu_status_t aipu_get_cluster_count(const aipu_ctx_handle_t* ctx, uint32_t* cnt
  * @note Cluster ID is numbered within [0, cluster_cnt).
  */
 aipu_status_t aipu_get_core_count(const aipu_ctx_handle_t* ctx, uint32_t cluster, uint32_t* cnt);
+/**
+ * @brief This API replays a job stream recorded from a device onto the device of a context
+ *
+ * @param[in]  ctx         Pointer to a context handle struct returned by aipu_init_context
+ * @param[in]  trace       Trace file recorded with environment variable AIPU_UMD_RECORD=<trace>
+ * @param[in]  keep_timing true: keep the recorded intervals between jobs; false: schedule jobs
+ *                         as fast as the device completes them
+ * @param[out] stat        Pointer to a memory location allocated by application where UMD stores
+ *                         the replay statistics
+ *
+ * @retval AIPU_STATUS_SUCCESS
+ * @retval AIPU_STATUS_ERROR_NULL_PTR
+ * @retval AIPU_STATUS_ERROR_INVALID_CTX
+ * @retval AIPU_STATUS_ERROR_INVALID_OP
+ * @retval AIPU_STATUS_ERROR_OPEN_FILE_FAIL
+ * @retval AIPU_STATUS_ERROR_UNKNOWN_BIN
+ * @retval AIPU_STATUS_ERROR_INVALID_GBIN
+ * @retval AIPU_STATUS_ERROR_BUF_ALLOC_FAIL
+ *
+ * @note When AIPU_UMD_RECORD is set before aipu_init_context, all the device memory allocations,
+ *       the memory contents seen by each job, job scheduling and completions are recorded
+ *       with their timing until the device is released.
+ * @note A trace can only be replayed by a context without any graph loaded, because the
+ *       recorded device addresses are reproduced; replaying onto the mock device is supported
+ *       on any host.
+ */
+aipu_status_t aipu_replay_trace(const aipu_ctx_handle_t* ctx, const char* trace, bool keep_timing,
+    aipu_replay_stat_t* stat);
 /**
  * @brief This API is used by debugger to get information of a job
  *
@@ -0,0 +1,301 @@
+/**********************************************************************************
+ * This file is CONFIDENTIAL and any use by you is subject to the terms of the
+ * agreement between you and Arm China or the terms of the agreement between you
+ * and the party authorised by Arm China to disclose this file to you.
+ * The confidential and proprietary information contained in this file
+ * may only be used by a person authorised under and to the extent permitted
+ * by a subsisting licensing agreement from Arm China.
+ *
+ *        (C) Copyright 2020 Arm Technology (China) Co. Ltd.
+ *                    All rights reserved.
+ *
+ * This entire notice must be reproduced on all copies of this file and copies of
+ * this file may only be made by a person if such person is permitted to do so
+ * under the terms of a subsisting license agreement from Arm China.
+ *
+ *********************************************************************************/
+
+
+/**
+ * @file  batcher.cpp
+ * @brief AIPU User Mode Driver (UMD) request batcher module implementation
+ */
+
+#include <time.h>
+#include "batcher.h"
+#include "context.h"
+#include "job_base.h"
+#include "utils/helper.h"
+#include "utils/log.h"
+
+#define DEFAULT_MAX_BATCH_SIZE  8
+
+aipudrv::Batcher::Batcher(BATCHER_ID id, MainContext& ctx, GRAPH_ID graph,
+    const aipu_batcher_config_t& config):
+    m_id(id),
+    m_ctx(ctx),
+    m_graph(graph),
+    m_cfg(config)
+{
+    pthread_condattr_t attr;
+
+    m_ref_cnt = 1;
+    if (0 == m_cfg.max_batch_size)
+    {
+        m_cfg.max_batch_size = DEFAULT_MAX_BATCH_SIZE;
+    }
+    pthread_mutex_init(&m_lock, NULL);
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&m_cond, &attr);
+    pthread_condattr_destroy(&attr);
+    pthread_cond_init(&m_done_cond, NULL);
+}
+
+aipudrv::Batcher::~Batcher()
+{
+    pthread_cond_destroy(&m_done_cond);
+    pthread_cond_destroy(&m_cond);
+    pthread_mutex_destroy(&m_lock);
+}
+
+aipu_status_t aipudrv::Batcher::init()
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    GraphBase* p_gobj = m_ctx.get_graph_object(m_graph);
+
+    if (nullptr == p_gobj)
+    {
+        return AIPU_STATUS_ERROR_INVALID_GRAPH_ID;
+    }
+
+    p_gobj->get_tensor_count(AIPU_TENSOR_TYPE_INPUT, &m_input_cnt);
+    p_gobj->get_tensor_count(AIPU_TENSOR_TYPE_OUTPUT, &m_output_cnt);
+
+    /* one job per frame of a batch, reused by every batch */
+    for (uint32_t i = 0; i < m_cfg.max_batch_size; i++)
+    {
+        JOB_ID job = 0;
+        ret = m_ctx.create_job(m_graph, &job);
+        if (AIPU_STATUS_SUCCESS != ret)
+        {
+            goto fail;
+        }
+        m_jobs.push_back(job);
+    }
+
+    if (pthread_create(&m_dispatcher, NULL, dispatcher_loop, this) != 0)
+    {
+        LOG(LOG_ERR, "batcher 0x%lx: create dispatcher thread failed", m_id);
+        ret = AIPU_STATUS_ERROR_INVALID_OP;
+        goto fail;
+    }
+    m_running = true;
+    p_gobj->pin();
+    m_ctx.put_graph_object(p_gobj);
+    return ret;
+
+fail:
+    for (uint32_t i = 0; i < m_jobs.size(); i++)
+    {
+        p_gobj->destroy_job(m_jobs[i]);
+    }
+    m_jobs.clear();
+    m_ctx.put_graph_object(p_gobj);
+    return ret;
+}
+
+void aipudrv::Batcher::deinit()
+{
+    GraphBase* p_gobj = m_ctx.get_graph_object(m_graph);
+
+    pthread_mutex_lock(&m_lock);
+    m_exit = true;
+    pthread_cond_signal(&m_cond);
+    pthread_mutex_unlock(&m_lock);
+    if (m_running)
+    {
+        pthread_join(m_dispatcher, NULL);
+        m_running = false;
+    }
+
+    if (nullptr == p_gobj)
+    {
+        return;
+    }
+
+    for (uint32_t i = 0; i < m_jobs.size(); i++)
+    {
+        m_ctx.drop_fence(m_jobs[i]);
+        m_ctx.dequeue_job(m_jobs[i]);
+        p_gobj->destroy_job(m_jobs[i]);
+    }
+    m_jobs.clear();
+    p_gobj->unpin();
+    m_ctx.put_graph_object(p_gobj);
+}
+
+void aipudrv::Batcher::run_batch(std::vector<BatchRequest*>& batch)
+{
+    std::vector<JobBase*> jobs(batch.size(), nullptr);
+
+    for (uint32_t i = 0; i < batch.size(); i++)
+    {
+        BatchRequest* req = batch[i];
+
+        jobs[i] = m_ctx.get_job_object(m_jobs[i]);
+        for (uint32_t t = 0; (t < m_input_cnt) && (AIPU_STATUS_SUCCESS == req->ret); t++)
+        {
+            req->ret = jobs[i]->load_tensor(t, req->inputs[t]);
+        }
+        if (AIPU_STATUS_SUCCESS == req->ret)
+        {
+            req->ret = m_ctx.flush_job(jobs[i]);
+        }
+    }
+
+    /* the outputs of a job are read as soon as its own completion is got */
+    for (uint32_t i = 0; i < batch.size(); i++)
+    {
+        BatchRequest* req = batch[i];
+        aipu_job_status_t status = AIPU_JOB_STATUS_NO_STATUS;
+
+        if (AIPU_STATUS_SUCCESS != req->ret)
+        {
+            continue;
+        }
+
+        req->ret = m_ctx.get_job_status(jobs[i], -1, &status);
+        if ((AIPU_STATUS_SUCCESS == req->ret) && (AIPU_JOB_STATUS_DONE != status))
+        {
+            req->ret = AIPU_STATUS_ERROR_JOB_EXCEPTION;
+        }
+
+        for (uint32_t t = 0; (t < m_output_cnt) && (AIPU_STATUS_SUCCESS == req->ret); t++)
+        {
+            if (req->outputs[t] != nullptr)
+            {
+                req->ret = jobs[i]->get_tensor(AIPU_TENSOR_TYPE_OUTPUT, t, req->outputs[t]);
+            }
+        }
+    }
+
+    for (uint32_t i = 0; i < jobs.size(); i++)
+    {
+        m_ctx.put_job_object(jobs[i]);
+    }
+}
+
+void* aipudrv::Batcher::dispatcher_loop(void* arg)
+{
+    Batcher* batcher = (Batcher*)arg;
+    std::vector<BatchRequest*> batch;
+    struct timespec ts;
+
+    batch.reserve(batcher->m_cfg.max_batch_size);
+    pthread_mutex_lock(&batcher->m_lock);
+    while (true)
+    {
+        uint64_t now = 0;
+        uint64_t deadline = 0;
+
+        if (batcher->m_requests.empty())
+        {
+            if (batcher->m_exit)
+            {
+                break;
+            }
+            pthread_cond_wait(&batcher->m_cond, &batcher->m_lock);
+            continue;
+        }
+
+        /* the first request waits for at most max_delay_us for others to join its batch */
+        deadline = batcher->m_requests.front()->arrive_ns + (uint64_t)batcher->m_cfg.max_delay_us * 1000;
+        now = umd_get_time_ns_helper();
+        while ((batcher->m_requests.size() < batcher->m_cfg.max_batch_size) &&
+            !batcher->m_exit && (now < deadline))
+        {
+            ts.tv_sec = deadline / 1000000000ULL;
+            ts.tv_nsec = deadline % 1000000000ULL;
+            pthread_cond_timedwait(&batcher->m_cond, &batcher->m_lock, &ts);
+            now = umd_get_time_ns_helper();
+        }
+
+        while (!batcher->m_requests.empty() && (batch.size() < batcher->m_cfg.max_batch_size))
+        {
+            uint64_t delay = now - batcher->m_requests.front()->arrive_ns;
+            batcher->m_delay_ns += delay;
+            batcher->m_max_delay_ns = (delay > batcher->m_max_delay_ns) ? delay : batcher->m_max_delay_ns;
+            batch.push_back(batcher->m_requests.front());
+            batcher->m_requests.pop_front();
+        }
+        batcher->m_request_cnt += batch.size();
+        batcher->m_batch_cnt++;
+
+        pthread_mutex_unlock(&batcher->m_lock);
+        batcher->run_batch(batch);
+        pthread_mutex_lock(&batcher->m_lock);
+
+        for (uint32_t i = 0; i < batch.size(); i++)
+        {
+            batch[i]->done = true;
+        }
+        batch.clear();
+        pthread_cond_broadcast(&batcher->m_done_cond);
+    }
+    pthread_mutex_unlock(&batcher->m_lock);
+
+    return nullptr;
+}
+
+aipu_status_t aipudrv::Batcher::infer(const void* const inputs[], void* const outputs[])
+{
+    BatchRequest req;
+
+    if (((nullptr == inputs) && (0 != m_input_cnt)) || ((nullptr == outputs) && (0 != m_output_cnt)))
+    {
+        return AIPU_STATUS_ERROR_NULL_PTR;
+    }
+
+    req.inputs = inputs;
+    req.outputs = outputs;
+    req.arrive_ns = umd_get_time_ns_helper();
+    req.ret = AIPU_STATUS_SUCCESS;
+    req.done = false;
+
+    pthread_mutex_lock(&m_lock);
+    if (!m_running || m_exit)
+    {
+        pthread_mutex_unlock(&m_lock);
+        return AIPU_STATUS_ERROR_INVALID_OP;
+    }
+
+    m_requests.push_back(&req);
+    if ((1 == m_requests.size()) || (m_requests.size() >= m_cfg.max_batch_size))
+    {
+        pthread_cond_signal(&m_cond);
+    }
+    while (!req.done)
+    {
+        pthread_cond_wait(&m_done_cond, &m_lock);
+    }
+    pthread_mutex_unlock(&m_lock);
+
+    return req.ret;
+}
+
+aipu_status_t aipudrv::Batcher::get_stat(aipu_batcher_stat_t* stat)
+{
+    if (nullptr == stat)
+    {
+        return AIPU_STATUS_ERROR_NULL_PTR;
+    }
+
+    pthread_mutex_lock(&m_lock);
+    stat->request_cnt = m_request_cnt;
+    stat->batch_cnt = m_batch_cnt;
+    stat->avg_delay_us = (m_request_cnt != 0) ? m_delay_ns / m_request_cnt / 1000 : 0;
+    stat->max_delay_us = m_max_delay_ns / 1000;
+    pthread_mutex_unlock(&m_lock);
+    return AIPU_STATUS_SUCCESS;
+}
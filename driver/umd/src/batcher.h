@@ -0,0 +1,111 @@
+/**********************************************************************************
+ * This file is CONFIDENTIAL and any use by you is subject to the terms of the
+ * agreement between you and Arm China or the terms of the agreement between you
+ * and the party authorised by Arm China to disclose this file to you.
+ * The confidential and proprietary information contained in this file
+ * may only be used by a person authorised under and to the extent permitted
+ * by a subsisting licensing agreement from Arm China.
+ *
+ *        (C) Copyright 2020 Arm Technology (China) Co. Ltd.
+ *                    All rights reserved.
+ *
+ * This entire notice must be reproduced on all copies of this file and copies of
+ * this file may only be made by a person if such person is permitted to do so
+ * under the terms of a subsisting license agreement from Arm China.
+ *
+ *********************************************************************************/
+
+
+/**
+ * @file  batcher.h
+ * @brief AIPU User Mode Driver (UMD) request batcher module header
+ */
+
+#ifndef _BATCHER_H_
+#define _BATCHER_H_
+
+#include <atomic>
+#include <deque>
+#include <vector>
+#include <pthread.h>
+#include "standard_api.h"
+#include "type.h"
+
+namespace aipudrv
+{
+typedef uint64_t BATCHER_ID;
+
+/**
+ * @brief a single-frame request waiting in a batcher for its outputs
+ */
+struct BatchRequest
+{
+    const void* const* inputs;
+    void* const* outputs;
+    uint64_t arrive_ns;
+    aipu_status_t ret;
+    bool done;
+};
+
+class MainContext;
+/**
+ * @brief coalesces single-frame requests of a graph into batches run by pre-created jobs
+ *
+ * Requesters queue their frames and sleep; a dispatcher thread takes up to max_batch_size
+ * of them once the batch is full or its first request has waited for max_delay_us, flushes
+ * one job per frame back to back, waits for all of them and copies the outputs back.
+ * Requests arriving meanwhile form the next batch.
+ */
+class Batcher
+{
+private:
+    BATCHER_ID m_id;
+    MainContext& m_ctx;
+    GRAPH_ID m_graph;
+    aipu_batcher_config_t m_cfg;
+    std::vector<JOB_ID> m_jobs;
+    uint32_t m_input_cnt = 0;
+    uint32_t m_output_cnt = 0;
+    std::deque<BatchRequest*> m_requests;
+    pthread_t m_dispatcher;
+    bool m_running = false;
+    bool m_exit = false;
+    pthread_mutex_t m_lock;
+    pthread_cond_t m_cond;
+    pthread_cond_t m_done_cond;
+    std::atomic<uint32_t> m_ref_cnt;
+
+private:
+    uint64_t m_request_cnt = 0;
+    uint64_t m_batch_cnt = 0;
+    uint64_t m_delay_ns = 0;
+    uint64_t m_max_delay_ns = 0;
+
+private:
+    void run_batch(std::vector<BatchRequest*>& batch);
+    static void* dispatcher_loop(void* arg);
+
+public:
+    aipu_status_t init();
+    void deinit();
+    aipu_status_t infer(const void* const inputs[], void* const outputs[]);
+    aipu_status_t get_stat(aipu_batcher_stat_t* stat);
+    void get()
+    {
+        m_ref_cnt++;
+    }
+    /* true if the caller dropped the last reference and should delete the batcher */
+    bool put()
+    {
+        return --m_ref_cnt == 0;
+    }
+
+public:
+    Batcher(BATCHER_ID id, MainContext& ctx, GRAPH_ID graph, const aipu_batcher_config_t& config);
+    ~Batcher();
+    Batcher(const Batcher& batcher) = delete;
+    Batcher& operator=(const Batcher& batcher) = delete;
+};
+}
+
+#endif /* _BATCHER_H_ */
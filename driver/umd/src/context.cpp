@@ -22,6 +22,7 @@
 
 #include <unistd.h>
 #include <string.h>
+#include <time.h>
 #include <sys/time.h>
 #include "context.h"
 #include "type.h"
@@ -35,10 +36,25 @@
 #include "job_base.h"
 #include "parser_base.h"
 
+#define DEFAULT_RECLAIM_BATCH     16
+#define RECLAIM_INTERVAL_MS       10
+
 aipudrv::MainContext::MainContext()
 {
+    pthread_condattr_t attr;
+
     m_dev = nullptr;
     pthread_rwlock_init(&m_glock, NULL);
+    pthread_rwlock_init(&m_mlock, NULL);
+    pthread_rwlock_init(&m_block, NULL);
+    pthread_rwlock_init(&m_plock, NULL);
+    pthread_mutex_init(&m_rlock, NULL);
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&m_rcond, &attr);
+    pthread_condattr_destroy(&attr);
+    pthread_mutex_init(&m_flock, NULL);
+    m_reclaim_batch = DEFAULT_RECLAIM_BATCH;
     m_sim_cfg.z1_simulator = nullptr;
     m_sim_cfg.z2_simulator = nullptr;
     m_sim_cfg.z3_simulator = nullptr;
@@ -48,10 +64,25 @@ aipudrv::MainContext::MainContext()
     m_sim_cfg.verbose = false;
     m_sim_cfg.enable_avx = false;
     m_sim_cfg.enable_calloc = false;
+    m_wstream_cfg.window_size = 0;
+    m_wstream_cfg.async_read = false;
+    m_pload_cfg.thread_cnt = 0;
+    m_pload_cfg.chunk_size = 0;
+    m_place_cfg.policy = AIPU_PLACEMENT_ROUND_ROBIN;
+    m_place_cfg.device = 0;
+    m_admit_cfg.mem_limit = 0;
 }
 
 aipudrv::MainContext::~MainContext()
 {
+    m_load_pool.deinit();
+    stop_reclaimer();
+    pthread_cond_destroy(&m_rcond);
+    pthread_mutex_destroy(&m_rlock);
+    pthread_mutex_destroy(&m_flock);
+    pthread_rwlock_destroy(&m_plock);
+    pthread_rwlock_destroy(&m_block);
+    pthread_rwlock_destroy(&m_mlock);
     pthread_rwlock_destroy(&m_glock);
     if (m_sim_cfg.z1_simulator != nullptr)
     {
@@ -78,26 +109,61 @@ aipu_status_t aipudrv::MainContext::init()
     aipu_status_t ret = AIPU_STATUS_SUCCESS;
 
     /* arm64 platform init m_dev here; simulation init m_dev later */
-    ret = get_device(&m_dev);
+    ret = get_devices(m_devs);
+    if ((AIPU_STATUS_SUCCESS == ret) && !m_devs.empty())
+    {
+        m_dev = m_devs[0];
+        m_dev_graph_cnt.assign(m_devs.size(), 0);
+    }
     return ret;
 }
 
 void aipudrv::MainContext::force_deinit()
 {
-    GraphTable::iterator iter;
+    std::vector<uint32_t> handles;
+    GraphBase* p_gobj = nullptr;
+    ModelTable::iterator miter;
+    BatcherTable::iterator biter;
 
-    pthread_rwlock_wrlock(&m_glock);
-    for (iter = m_graphs.begin(); iter != m_graphs.end(); iter++)
+    /* batchers run jobs of graphs: stop them first */
+    pthread_rwlock_wrlock(&m_block);
+    for (biter = m_batchers.begin(); biter != m_batchers.end(); biter++)
     {
-        iter->second->unload();
+        biter->second->deinit();
+        put_batcher_object(biter->second);
     }
-    m_graphs.clear();
-    pthread_rwlock_unlock(&m_glock);
-    if (m_dev != nullptr)
+    m_batchers.clear();
+    pthread_rwlock_unlock(&m_block);
+
+    /* models own graphs: unload them first */
+    pthread_rwlock_wrlock(&m_mlock);
+    for (miter = m_models.begin(); miter != m_models.end(); miter++)
+    {
+        miter->second->unload();
+        put_model_object(miter->second);
+    }
+    m_models.clear();
+    pthread_rwlock_unlock(&m_mlock);
+
+    /* retired graphs are still in graph table and unloaded together with others */
+    stop_reclaimer();
+    m_retired_graphs.clear();
+
+    m_graphs.get_handles(handles);
+    for (uint32_t i = 0; i < handles.size(); i++)
+    {
+        if (m_graphs.remove(handles[i], &p_gobj) && (p_gobj != nullptr))
+        {
+            p_gobj->unload();
+        }
+    }
+    for (uint32_t i = 0; i < m_devs.size(); i++)
     {
-        put_device(m_dev);
-        m_dev = nullptr;
+        put_device(m_devs[i]);
     }
+    m_devs.clear();
+    m_dev_graph_cnt.clear();
+    m_dev = nullptr;
 }
 
 aipu_status_t aipudrv::MainContext::deinit()
@@ -132,21 +198,40 @@ finish:
     return ret;
 }
 
-uint64_t aipudrv::MainContext::create_unique_graph_id_inner() const
+uint32_t aipudrv::MainContext::select_device()
 {
-    uint64_t id_candidate = (1UL << 32);
-    while (m_graphs.count(id_candidate) == 1)
+    uint32_t dev = 0;
+
+    /* called with m_glock held for write */
+    switch (m_place_cfg.policy)
     {
-        id_candidate++;
+        case AIPU_PLACEMENT_PINNED:
+            dev = m_place_cfg.device;
+            break;
+
+        case AIPU_PLACEMENT_LEAST_LOADED:
+            for (uint32_t i = 1; i < m_devs.size(); i++)
+            {
+                if (m_dev_graph_cnt[i] < m_dev_graph_cnt[dev])
+                {
+                    dev = i;
+                }
+            }
+            break;
+
+        default:
+            dev = m_next_dev++ % m_devs.size();
+            break;
     }
-    return id_candidate;
+    return dev;
 }
 
 aipu_status_t aipudrv::MainContext::create_graph_object(std::ifstream& gbin, uint32_t size,
-    uint64_t id, GraphBase** gobj)
+    uint64_t id, GraphBase** gobj, int32_t dev)
 {
     aipu_status_t ret = AIPU_STATUS_SUCCESS;
     GraphBase* p_gobj = nullptr;
+    DeviceBase* p_dev = nullptr;
     uint32_t g_version = 0;
 
     if (nullptr == gobj)
@@ -156,33 +241,70 @@ aipu_status_t aipudrv::MainContext::create_graph_object(std::ifstream& gbin, uin
     }
 
     g_version = ParserBase::get_graph_bin_version(gbin);
+
+    /* graphs may be loaded concurrently: device is got only once */
+    pthread_rwlock_wrlock(&m_glock);
     ret = test_get_device(g_version, &m_dev, &m_sim_cfg);
+    if (AIPU_STATUS_SUCCESS == ret)
+    {
+        m_dram = m_dev->get_mem();
+        if (m_devs.empty())
+        {
+            /* simulator got at the first graph load */
+            m_devs.push_back(m_dev);
+            m_dev_graph_cnt.push_back(0);
+        }
+        if (dev < 0)
+        {
+            dev = select_device();
+        }
+        if ((uint32_t)dev < m_devs.size())
+        {
+            p_dev = m_devs[dev];
+            m_dev_graph_cnt[dev]++;
+            if (m_admit_cfg.mem_limit != 0)
+            {
+                p_dev->get_mem()->set_limit(m_admit_cfg.mem_limit);
+            }
+        }
+        else
+        {
+            ret = AIPU_STATUS_ERROR_TARGET_NOT_FOUND;
+        }
+    }
+    pthread_rwlock_unlock(&m_glock);
     if (AIPU_STATUS_SUCCESS != ret)
     {
         goto finish;
     }
 
-    m_dram = m_dev->get_mem();
-
 #if (defined ZHOUYI_V123)
     if (AIPU_LOADABLE_GRAPH_V0005 == g_version)
     {
-        p_gobj = new GraphLegacy(id, m_dev);
+        p_gobj = new GraphLegacy(id, p_dev);
     }
 #endif
 #if (defined ZHOUYI_V5)
     if (AIPU_LOADABLE_GRAPH_ELF_V0 == g_version)
     {
-        p_gobj = new GraphZ5(id, m_dev);
+        p_gobj = new GraphZ5(id, p_dev);
     }
 #endif
 
     if (nullptr == p_gobj)
     {
+        pthread_rwlock_wrlock(&m_glock);
+        m_dev_graph_cnt[dev]--;
+        pthread_rwlock_unlock(&m_glock);
         ret = AIPU_STATUS_ERROR_GVERSION_UNSUPPORTED;
         goto finish;
     }
 
+    p_gobj->set_weight_streaming(m_wstream_cfg);
+    if (m_load_pool.get_thread_count() != 0)
+    {
+        p_gobj->set_load_pool(&m_load_pool, m_pload_cfg.chunk_size);
+    }
     ret = p_gobj->load(gbin, size, m_do_vcheck);
     if (AIPU_STATUS_SUCCESS != ret)
     {
@@ -199,24 +321,38 @@ finish:
 
 aipudrv::GraphBase* aipudrv::MainContext::get_graph_object(GRAPH_ID id)
 {
-    GraphBase* p_gobj = nullptr;
-    pthread_rwlock_rdlock(&m_glock);
-    if (0 != m_graphs.count(id))
-    {
-        p_gobj = m_graphs[id];
-    }
-    pthread_rwlock_unlock(&m_glock);
-    return p_gobj;
+    return m_graphs.acquire(get_graph_handle(id));
+}
+
+void aipudrv::MainContext::put_graph_object(GraphBase* gobj)
+{
+    m_graphs.release(get_graph_handle(gobj->get_id()));
 }
 
 aipudrv::JobBase* aipudrv::MainContext::get_job_object(JOB_ID id)
 {
     GraphBase* p_gobj = get_graph_object(job_id2graph_id(id));
+    JobBase* job = nullptr;
+
     if (p_gobj == nullptr)
     {
         return nullptr;
     }
-    return p_gobj->get_job(id);
+
+    /* the graph is referenced as long as its job: it is unloaded only after the job is put */
+    job = p_gobj->get_job(id);
+    if (job == nullptr)
+    {
+        put_graph_object(p_gobj);
+    }
+    return job;
+}
+
+void aipudrv::MainContext::put_job_object(JobBase* job)
+{
+    /* the graph may be being unloaded: it is not resolved by its handle any more */
+    job->get_graph_base().put_job(job->get_id());
+    m_graphs.release(get_graph_handle(job_id2graph_id(job->get_id())));
 }
 
 aipu_status_t aipudrv::MainContext::destroy_graph_object(GraphBase** gobj)
@@ -235,6 +371,17 @@ aipu_status_t aipudrv::MainContext::destroy_graph_object(GraphBase** gobj)
         goto finish;
     }
 
+    pthread_rwlock_wrlock(&m_glock);
+    for (uint32_t i = 0; i < m_devs.size(); i++)
+    {
+        if (m_devs[i] == (*gobj)->get_device())
+        {
+            m_dev_graph_cnt[i]--;
+            break;
+        }
+    }
+    pthread_rwlock_unlock(&m_glock);
+
     /* success */
     delete *gobj;
     *gobj = nullptr;
@@ -243,11 +390,12 @@ finish:
     return ret;
 }
 
-aipu_status_t aipudrv::MainContext::load_graph(const char* graph_file, GRAPH_ID* id)
+aipu_status_t aipudrv::MainContext::load_graph(const char* graph_file, GRAPH_ID* id, int32_t dev)
 {
     aipu_status_t ret = AIPU_STATUS_SUCCESS;
     GraphBase* gobj = nullptr;
     uint64_t _id = 0;
+    uint32_t handle = 0;
     std::ifstream gbin;
     int fsize = 0;
 
@@ -267,25 +415,27 @@ aipu_status_t aipudrv::MainContext::load_graph(const char* graph_file, GRAPH_ID*
     fsize = gbin.tellg();
     gbin.seekg (0, gbin.beg);
 
-    /* push nullptr into graphs to pin this graph ID */
-    pthread_rwlock_wrlock(&m_glock);
-    _id = create_unique_graph_id_inner();
-    m_graphs[_id] = nullptr;
-    pthread_rwlock_unlock(&m_glock);
+    /* reserve a handle with nullptr to pin this graph ID */
+    handle = m_graphs.alloc(nullptr);
+    if (0 == handle)
+    {
+        LOG(LOG_ERR, "too many graphs loaded");
+        ret = AIPU_STATUS_ERROR_BUF_ALLOC_FAIL;
+        goto finish;
+    }
+    _id = create_graph_id(handle);
 
-    ret = create_graph_object(gbin, fsize, _id, &gobj);
+    pthread_rwlock_rdlock(&m_plock);
+    ret = create_graph_object(gbin, fsize, _id, &gobj, dev);
+    pthread_rwlock_unlock(&m_plock);
     if (AIPU_STATUS_SUCCESS != ret)
     {
-        pthread_rwlock_wrlock(&m_glock);
-        m_graphs.erase(_id);
-        pthread_rwlock_unlock(&m_glock);
+        m_graphs.remove(handle);
         goto finish;
     }
 
-    /* success: update graphs[_id] */
-    pthread_rwlock_wrlock(&m_glock);
-    m_graphs[_id] = gobj;
-    pthread_rwlock_unlock(&m_glock);
+    /* success: publish the graph object */
+    m_graphs.set(handle, gobj);
     *id = _id;
 
     /* TBD */
@@ -296,6 +446,58 @@ finish:
     return ret;
 }
 
+aipu_status_t aipudrv::MainContext::load_graphs(const char* graph_files[], uint32_t cnt, GRAPH_ID ids[])
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    std::vector<aipu_status_t> status(cnt, AIPU_STATUS_SUCCESS);
+    TaskGroup group;
+
+    if ((nullptr == graph_files) || (nullptr == ids))
+    {
+        return AIPU_STATUS_ERROR_NULL_PTR;
+    }
+
+    if (0 == cnt)
+    {
+        return AIPU_STATUS_ERROR_INVALID_SIZE;
+    }
+
+    pthread_rwlock_rdlock(&m_plock);
+    for (uint32_t i = 0; i < cnt; i++)
+    {
+        ids[i] = 0;
+        m_load_pool.submit(&group, [this, graph_files, ids, &status, i]() {
+            status[i] = load_graph(graph_files[i], &ids[i]);
+        });
+    }
+    m_load_pool.wait(&group);
+    pthread_rwlock_unlock(&m_plock);
+
+    for (uint32_t i = 0; i < cnt; i++)
+    {
+        if (AIPU_STATUS_SUCCESS != status[i])
+        {
+            ret = status[i];
+            break;
+        }
+    }
+
+    /* all or nothing */
+    if (AIPU_STATUS_SUCCESS != ret)
+    {
+        for (uint32_t i = 0; i < cnt; i++)
+        {
+            if (AIPU_STATUS_SUCCESS == status[i])
+            {
+                unload_graph(ids[i]);
+            }
+            ids[i] = 0;
+        }
+    }
+
+    return ret;
+}
+
 aipu_status_t aipudrv::MainContext::unload_graph(GRAPH_ID id)
 {
     aipu_status_t ret = AIPU_STATUS_SUCCESS;
@@ -303,137 +505,974 @@ aipu_status_t aipudrv::MainContext::unload_graph(GRAPH_ID id)
 
     p_gobj = get_graph_object(id);
     if (nullptr == p_gobj)
+    {
+        return AIPU_STATUS_ERROR_INVALID_GRAPH_ID;
+    }
+    if (p_gobj->is_pinned())
+    {
+        LOG(LOG_ERR, "graph 0x%lx: still used by a super graph", id);
+        ret = AIPU_STATUS_ERROR_INVALID_OP;
+    }
+    else if (!p_gobj->retire())
     {
         ret = AIPU_STATUS_ERROR_INVALID_GRAPH_ID;
-        goto finish;
     }
 
-    ret = destroy_graph_object(&p_gobj);
+    /* put back before it is removed: remove() waits for every reference to be put back */
+    put_graph_object(p_gobj);
     if (AIPU_STATUS_SUCCESS != ret)
     {
         goto finish;
     }
 
-    /* p_gobj becomes NULL after destroy */
+    /* the graph is retired by this caller only: nobody else removes or frees it */
+    m_sched.remove_graph(id);
 
-    /* success */
-    pthread_rwlock_wrlock(&m_glock);
-    m_graphs.erase(id);
-    pthread_rwlock_unlock(&m_glock);
+    if (m_deferred_unload)
+    {
+        pthread_mutex_lock(&m_rlock);
+        m_retired_graphs.push_back(id);
+        pthread_cond_signal(&m_rcond);
+        pthread_mutex_unlock(&m_rlock);
+        goto finish;
+    }
+
+    /* unpublish the handle first: it returns after the graph is put back by everyone else */
+    m_graphs.remove(get_graph_handle(id));
+    ret = destroy_graph_object(&p_gobj);
 
 finish:
     return ret;
 }
 
-aipu_status_t aipudrv::MainContext::create_job(GRAPH_ID graph, JOB_ID* id)
+aipu_status_t aipudrv::MainContext::create_super_graph(const GRAPH_ID graphs[], uint32_t cnt,
+    const aipu_tensor_binding_t bindings[], uint32_t binding_cnt, GRAPH_ID* id)
 {
     aipu_status_t ret = AIPU_STATUS_SUCCESS;
-    GraphBase* p_gobj = nullptr;
+    std::vector<GraphBase*> members;
+    std::vector<aipu_tensor_binding_t> binds;
+    SuperGraph* p_gobj = nullptr;
+    DeviceBase* p_dev = nullptr;
+    uint32_t handle = 0;
+    uint64_t _id = 0;
 
-    if (nullptr == id)
+    if ((nullptr == graphs) || (nullptr == id) || ((nullptr == bindings) && (0 != binding_cnt)))
     {
-        ret = AIPU_STATUS_ERROR_NULL_PTR;
+        return AIPU_STATUS_ERROR_NULL_PTR;
+    }
+
+    /* members are referenced until they are pinned by the super graph */
+    for (uint32_t i = 0; i < cnt; i++)
+    {
+        GraphBase* member = get_graph_object(graphs[i]);
+        if (nullptr == member)
+        {
+            ret = AIPU_STATUS_ERROR_INVALID_GRAPH_ID;
+            goto finish;
+        }
+        members.push_back(member);
+        if (member->is_retired())
+        {
+            ret = AIPU_STATUS_ERROR_INVALID_GRAPH_ID;
+            goto finish;
+        }
+    }
+    if (members.empty())
+    {
+        return AIPU_STATUS_ERROR_INVALID_SIZE;
+    }
+    binds.assign(bindings, bindings + binding_cnt);
+    p_dev = members[0]->get_device();
+
+    handle = m_graphs.alloc(nullptr);
+    if (0 == handle)
+    {
+        LOG(LOG_ERR, "too many graphs loaded");
+        ret = AIPU_STATUS_ERROR_BUF_ALLOC_FAIL;
         goto finish;
     }
+    _id = create_graph_id(handle);
 
-    p_gobj = get_graph_object(graph);
-    if (nullptr == p_gobj)
+    p_gobj = new SuperGraph(_id, p_dev);
+    ret = p_gobj->init(members, binds);
+    if (AIPU_STATUS_SUCCESS != ret)
     {
-        ret = AIPU_STATUS_ERROR_INVALID_GRAPH_ID;
+        delete p_gobj;
+        m_graphs.remove(handle);
         goto finish;
     }
 
-    ret = p_gobj->create_job(id, &m_sim_cfg);
+    /* counted as resident like other graphs: destroy_graph_object() counts it down */
+    pthread_rwlock_wrlock(&m_glock);
+    for (uint32_t i = 0; i < m_devs.size(); i++)
+    {
+        if (m_devs[i] == p_dev)
+        {
+            m_dev_graph_cnt[i]++;
+            break;
+        }
+    }
+    pthread_rwlock_unlock(&m_glock);
+
+    /* success: publish the graph object */
+    m_graphs.set(handle, p_gobj);
+    *id = _id;
 
 finish:
+    for (uint32_t i = 0; i < members.size(); i++)
+    {
+        put_graph_object(members[i]);
+    }
     return ret;
 }
 
-aipu_status_t aipudrv::MainContext::get_simulation_instance(void** simulator, void** memory)
+aipudrv::Model* aipudrv::MainContext::get_model_object(MODEL_ID id)
 {
-    return m_dev->get_simulation_instance(simulator, memory);
+    Model* model = nullptr;
+
+    pthread_rwlock_rdlock(&m_mlock);
+    if (0 != m_models.count(id))
+    {
+        model = m_models[id];
+        model->get();
+    }
+    pthread_rwlock_unlock(&m_mlock);
+    return model;
 }
 
-aipu_status_t aipudrv::MainContext::get_cluster_count(uint32_t* cnt)
+void aipudrv::MainContext::put_model_object(Model* model)
 {
-    return m_dev->get_cluster_count(cnt);
+    if ((nullptr != model) && model->put())
+    {
+        delete model;
+    }
 }
 
-aipu_status_t aipudrv::MainContext::get_core_count(uint32_t cluster, uint32_t* cnt)
+aipu_status_t aipudrv::MainContext::load_model(const char* graph_file, uint32_t job_cnt, MODEL_ID* id)
 {
-    return m_dev->get_core_count(cluster, cnt);
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    Model* model = nullptr;
+    MODEL_ID _id = 0;
+
+    if ((nullptr == graph_file) || (nullptr == id))
+    {
+        return AIPU_STATUS_ERROR_NULL_PTR;
+    }
+
+    pthread_rwlock_wrlock(&m_mlock);
+    _id = m_next_model_id++;
+    pthread_rwlock_unlock(&m_mlock);
+
+    model = new Model(_id, *this, job_cnt);
+    ret = model->load(graph_file);
+    if (AIPU_STATUS_SUCCESS != ret)
+    {
+        delete model;
+        return ret;
+    }
+
+    pthread_rwlock_wrlock(&m_mlock);
+    m_models[_id] = model;
+    pthread_rwlock_unlock(&m_mlock);
+    *id = _id;
+
+    return ret;
 }
 
-aipu_status_t aipudrv::MainContext::debugger_get_job_info(uint64_t job, aipu_debugger_job_info_t* info)
+aipu_status_t aipudrv::MainContext::swap_model(MODEL_ID id, const char* graph_file)
 {
     aipu_status_t ret = AIPU_STATUS_SUCCESS;
-    GraphBase* p_gobj = get_graph_object(get_graph_id(job));
-    if (nullptr == p_gobj)
+    Model* model = nullptr;
+
+    if (nullptr == graph_file)
     {
-        ret = AIPU_STATUS_ERROR_INVALID_JOB_ID;
-        goto finish;
+        return AIPU_STATUS_ERROR_NULL_PTR;
     }
 
-    if (nullptr == info)
+    model = get_model_object(id);
+    if (nullptr == model)
     {
-        ret = AIPU_STATUS_ERROR_NULL_PTR;
-        goto finish;
+        return AIPU_STATUS_ERROR_INVALID_MODEL_ID;
     }
 
-    ret = get_simulation_instance(&info->simulation_aipu, &info->simulation_mem_engine);
-    if (AIPU_STATUS_SUCCESS != ret)
+    ret = model->swap(graph_file);
+    put_model_object(model);
+    return ret;
+}
+
+aipu_status_t aipudrv::MainContext::unload_model(MODEL_ID id)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    Model* model = nullptr;
+
+    pthread_rwlock_wrlock(&m_mlock);
+    if (0 != m_models.count(id))
     {
-        goto finish;
+        model = m_models[id];
+        m_models.erase(id);
     }
+    pthread_rwlock_unlock(&m_mlock);
 
-    info->instr_base = p_gobj->debugger_get_instr_base();
+    if (nullptr == model)
+    {
+        return AIPU_STATUS_ERROR_INVALID_MODEL_ID;
+    }
 
-finish:
+    /* API calls still using the model drop the last reference */
+    ret = model->unload();
+    put_model_object(model);
     return ret;
 }
 
-aipu_status_t aipudrv::MainContext::config_simulation(uint64_t types, aipu_global_config_simulation_t* config)
+aipudrv::Batcher* aipudrv::MainContext::get_batcher_object(BATCHER_ID id)
+{
+    Batcher* batcher = nullptr;
+
+    pthread_rwlock_rdlock(&m_block);
+    if (0 != m_batchers.count(id))
+    {
+        batcher = m_batchers[id];
+        batcher->get();
+    }
+    pthread_rwlock_unlock(&m_block);
+    return batcher;
+}
+
+void aipudrv::MainContext::put_batcher_object(Batcher* batcher)
+{
+    if ((nullptr != batcher) && batcher->put())
+    {
+        delete batcher;
+    }
+}
+
+aipu_status_t aipudrv::MainContext::create_batcher(GRAPH_ID graph, const aipu_batcher_config_t* config,
+    BATCHER_ID* id)
 {
     aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    Batcher* batcher = nullptr;
+    BATCHER_ID _id = 0;
 
-    if (nullptr == config)
+    if ((nullptr == config) || (nullptr == id))
     {
-        return AIPU_STATUS_ERROR_INVALID_JOB_ID;
+        return AIPU_STATUS_ERROR_NULL_PTR;
     }
 
-    if (config->z1_simulator != nullptr)
+    pthread_rwlock_wrlock(&m_block);
+    _id = m_next_batcher_id++;
+    pthread_rwlock_unlock(&m_block);
+
+    batcher = new Batcher(_id, *this, graph, *config);
+    ret = batcher->init();
+    if (AIPU_STATUS_SUCCESS != ret)
     {
-        if (m_sim_cfg.z1_simulator == nullptr)
-        {
-            m_sim_cfg.z1_simulator = new char[1024];
-        }
-        strcpy((char*)m_sim_cfg.z1_simulator, config->z1_simulator);
+        delete batcher;
+        return ret;
     }
-    if (config->z2_simulator != nullptr)
+
+    pthread_rwlock_wrlock(&m_block);
+    m_batchers[_id] = batcher;
+    pthread_rwlock_unlock(&m_block);
+    *id = _id;
+
+    return ret;
+}
+
+aipu_status_t aipudrv::MainContext::destroy_batcher(BATCHER_ID id)
+{
+    Batcher* batcher = nullptr;
+
+    pthread_rwlock_wrlock(&m_block);
+    if (0 != m_batchers.count(id))
     {
-        if (m_sim_cfg.z2_simulator == nullptr)
-        {
-            m_sim_cfg.z2_simulator = new char[1024];
-        }
-        strcpy((char*)m_sim_cfg.z2_simulator, config->z2_simulator);
+        batcher = m_batchers[id];
+        m_batchers.erase(id);
     }
-    if (config->z3_simulator != nullptr)
+    pthread_rwlock_unlock(&m_block);
+
+    if (nullptr == batcher)
     {
-        if (m_sim_cfg.z3_simulator == nullptr)
-        {
-            m_sim_cfg.z3_simulator = new char[1024];
-        }
-        strcpy((char*)m_sim_cfg.z3_simulator, config->z3_simulator);
+        return AIPU_STATUS_ERROR_INVALID_BATCHER_ID;
     }
-    if (config->log_file_path != nullptr)
+
+    /* requests in flight are served by deinit; their callers drop the last reference */
+    batcher->deinit();
+    put_batcher_object(batcher);
+    return AIPU_STATUS_SUCCESS;
+}
+
+aipu_status_t aipudrv::MainContext::create_job(GRAPH_ID graph, JOB_ID* id, int32_t time_out)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    GraphBase* p_gobj = nullptr;
+    MemoryBase* mem = nullptr;
+    uint64_t footprint = 0;
+
+    if (nullptr == id)
     {
-        strcpy((char*)m_sim_cfg.log_file_path, config->log_file_path);
+        ret = AIPU_STATUS_ERROR_NULL_PTR;
+        goto finish;
     }
-    m_sim_cfg.log_level = config->log_level;
-    m_sim_cfg.verbose = config->verbose;
-    m_sim_cfg.enable_avx = config->enable_avx;
-    m_sim_cfg.enable_calloc = config->enable_calloc;
-    return ret;
+
+    p_gobj = get_graph_object(graph);
+    if (nullptr == p_gobj)
+    {
+        ret = AIPU_STATUS_ERROR_INVALID_GRAPH_ID;
+        goto finish;
+    }
+    if (p_gobj->is_retired())
+    {
+        ret = AIPU_STATUS_ERROR_INVALID_GRAPH_ID;
+        goto put;
+    }
+
+    /* admit the job before any of its buffers is allocated */
+    mem = p_gobj->get_device()->get_mem();
+    footprint = p_gobj->get_job_footprint();
+    ret = mem->reserve(footprint, time_out);
+    if (AIPU_STATUS_SUCCESS != ret)
+    {
+        goto put;
+    }
+
+    ret = p_gobj->create_job(id, &m_sim_cfg);
+    mem->unreserve();
+
+put:
+    put_graph_object(p_gobj);
+
+finish:
+    return ret;
+}
+
+aipu_status_t aipudrv::MainContext::flush_job(JobBase* job)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    bool queued = false;
+
+    /* jobs of graphs assigned to a job queue are admitted by the scheduler */
+    ret = m_sched.submit(job, &queued);
+    if ((AIPU_STATUS_SUCCESS != ret) || queued)
+    {
+        return ret;
+    }
+
+    return job->schedule();
+}
+
+aipu_status_t aipudrv::MainContext::get_job_status(JobBase* job, int32_t time_out, aipu_job_status_t* status)
+{
+    if (m_sched.is_managed(job))
+    {
+        return m_sched.get_status(job, time_out, status);
+    }
+
+    /* a fence released by another caller may not be scheduled yet */
+    if (job->is_fenced())
+    {
+        *status = AIPU_JOB_STATUS_NO_STATUS;
+        return AIPU_STATUS_SUCCESS;
+    }
+
+    if (0 == time_out)
+    {
+        return job->get_status(status);
+    }
+    return job->get_status_blocking(status, time_out);
+}
+
+aipu_status_t aipudrv::MainContext::flush_job_after(JOB_ID id, const JOB_ID deps[], uint32_t cnt)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    JobBase* job = get_job_object(id);
+    JobBase* dep = nullptr;
+    std::vector<JobBase*> got;
+    std::vector<JOB_ID> waits;
+
+    if (nullptr == job)
+    {
+        return AIPU_STATUS_ERROR_INVALID_JOB_ID;
+    }
+
+    if ((nullptr == deps) && (0 != cnt))
+    {
+        ret = AIPU_STATUS_ERROR_NULL_PTR;
+        goto finish;
+    }
+
+    /* jobs already finished are not waited for; jobs never flushed would never finish */
+    for (uint32_t i = 0; i < cnt; i++)
+    {
+        JobBase* p_job = (deps[i] == id) ? nullptr : get_job_object(deps[i]);
+        if (nullptr == p_job)
+        {
+            ret = AIPU_STATUS_ERROR_INVALID_JOB_ID;
+            goto finish;
+        }
+        got.push_back(p_job);
+        if (p_job->is_in_flight())
+        {
+            waits.push_back(deps[i]);
+            dep = p_job;
+        }
+        else if (!p_job->is_finished())
+        {
+            ret = AIPU_STATUS_ERROR_INVALID_OP;
+            goto finish;
+        }
+    }
+
+    if (waits.empty())
+    {
+        ret = flush_job(job);
+        goto finish;
+    }
+
+    /* behind a single scheduled job: chained on the device if it can do it */
+    if ((1 == waits.size()) && dep->is_scheduled() && !m_sched.is_managed(job))
+    {
+        ret = job->schedule_after(dep);
+        if (AIPU_STATUS_ERROR_OP_NOT_SUPPORTED != ret)
+        {
+            goto finish;
+        }
+    }
+
+    /* otherwise scheduled by UMD when the status of the jobs waited for is got */
+    ret = job->fence();
+    if (AIPU_STATUS_SUCCESS != ret)
+    {
+        goto finish;
+    }
+    pthread_mutex_lock(&m_flock);
+    m_fences[id] = waits;
+    pthread_mutex_unlock(&m_flock);
+
+finish:
+    for (uint32_t i = 0; i < got.size(); i++)
+    {
+        put_job_object(got[i]);
+    }
+    put_job_object(job);
+    return ret;
+}
+
+aipu_status_t aipudrv::MainContext::release_fence(JOB_ID id, int32_t time_out, bool* fenced)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    std::vector<JOB_ID> waits;
+    JobBase* job = nullptr;
+    bool failed = false;
+    bool claimed = false;
+    bool queued = false;
+
+    *fenced = false;
+    pthread_mutex_lock(&m_flock);
+    if (m_fences.count(id) != 0)
+    {
+        waits = m_fences[id];
+        *fenced = true;
+    }
+    pthread_mutex_unlock(&m_flock);
+    if (!*fenced)
+    {
+        return ret;
+    }
+
+    /* drive the jobs waited for: fenced ones recursively, flushed ones by their status */
+    for (uint32_t i = 0; i < waits.size(); i++)
+    {
+        JobBase* dep = get_job_object(waits[i]);
+        aipu_job_status_t status = AIPU_JOB_STATUS_NO_STATUS;
+        bool dep_fenced = false;
+        bool pending = false;
+
+        if (nullptr == dep)
+        {
+            continue;
+        }
+
+        ret = release_fence(waits[i], time_out, &dep_fenced);
+        if ((AIPU_STATUS_SUCCESS == ret) && !dep_fenced && dep->is_in_flight())
+        {
+            ret = get_job_status(dep, time_out, &status);
+            pending = (AIPU_JOB_STATUS_NO_STATUS == status);
+        }
+        failed |= dep->is_failed();
+        put_job_object(dep);
+        if ((AIPU_STATUS_SUCCESS != ret) || dep_fenced || pending)
+        {
+            return ret;
+        }
+    }
+
+    /* only one caller releases a fence */
+    pthread_mutex_lock(&m_flock);
+    claimed = (m_fences.erase(id) != 0);
+    pthread_mutex_unlock(&m_flock);
+
+    job = get_job_object(id);
+    if (claimed && (nullptr != job) && failed)
+    {
+        ret = job->unfence(false);
+    }
+    else if (claimed && (nullptr != job))
+    {
+        ret = m_sched.submit(job, &queued);
+        if ((AIPU_STATUS_SUCCESS == ret) && !queued)
+        {
+            ret = job->unfence(true);
+        }
+    }
+    if (nullptr != job)
+    {
+        put_job_object(job);
+    }
+    *fenced = false;
+    return ret;
+}
+
+void aipudrv::MainContext::drop_fence(JOB_ID id)
+{
+    pthread_mutex_lock(&m_flock);
+    m_fences.erase(id);
+    pthread_mutex_unlock(&m_flock);
+}
+
+aipu_status_t aipudrv::MainContext::create_job_queue(const aipu_job_queue_config_t* config, QUEUE_ID* id)
+{
+    return m_sched.create_queue(config, id);
+}
+
+aipu_status_t aipudrv::MainContext::destroy_job_queue(QUEUE_ID id)
+{
+    return m_sched.destroy_queue(id);
+}
+
+aipu_status_t aipudrv::MainContext::set_graph_queue(GRAPH_ID graph, QUEUE_ID queue)
+{
+    GraphBase* p_gobj = get_graph_object(graph);
+    bool super = false;
+
+    if (nullptr == p_gobj)
+    {
+        return AIPU_STATUS_ERROR_INVALID_GRAPH_ID;
+    }
+    super = (dynamic_cast<SuperGraph*>(p_gobj) != nullptr);
+    put_graph_object(p_gobj);
+
+    /* a super job is completed stage by stage by its own status queries */
+    if (super)
+    {
+        return AIPU_STATUS_ERROR_OP_NOT_SUPPORTED;
+    }
+
+    return m_sched.set_graph_queue(graph, queue);
+}
+
+aipu_status_t aipudrv::MainContext::get_job_queue_stat(QUEUE_ID id, aipu_job_queue_stat_t* stat)
+{
+    return m_sched.get_stat(id, stat);
+}
+
+void aipudrv::MainContext::dequeue_job(JOB_ID id)
+{
+    m_sched.remove(id);
+}
+
+aipu_status_t aipudrv::MainContext::get_simulation_instance(void** simulator, void** memory)
+{
+    return m_dev->get_simulation_instance(simulator, memory);
+}
+
+aipu_status_t aipudrv::MainContext::get_cluster_count(uint32_t* cnt)
+{
+    return m_dev->get_cluster_count(cnt);
+}
+
+aipu_status_t aipudrv::MainContext::get_core_count(uint32_t cluster, uint32_t* cnt)
+{
+    return m_dev->get_core_count(cluster, cnt);
+}
+
+aipu_status_t aipudrv::MainContext::debugger_get_job_info(uint64_t job, aipu_debugger_job_info_t* info)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    GraphBase* p_gobj = get_graph_object(get_graph_id(job));
+    if (nullptr == p_gobj)
+    {
+        ret = AIPU_STATUS_ERROR_INVALID_JOB_ID;
+        goto finish;
+    }
+
+    if (nullptr == info)
+    {
+        ret = AIPU_STATUS_ERROR_NULL_PTR;
+        goto put;
+    }
+
+    ret = get_simulation_instance(&info->simulation_aipu, &info->simulation_mem_engine);
+    if (AIPU_STATUS_SUCCESS != ret)
+    {
+        goto put;
+    }
+
+    info->instr_base = p_gobj->debugger_get_instr_base();
+
+put:
+    put_graph_object(p_gobj);
+
+finish:
+    return ret;
+}
+
+aipu_status_t aipudrv::MainContext::config_simulation(uint64_t types, aipu_global_config_simulation_t* config)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+
+    if (nullptr == config)
+    {
+        return AIPU_STATUS_ERROR_INVALID_JOB_ID;
+    }
+
+    if (config->z1_simulator != nullptr)
+    {
+        if (m_sim_cfg.z1_simulator == nullptr)
+        {
+            m_sim_cfg.z1_simulator = new char[1024];
+        }
+        strcpy((char*)m_sim_cfg.z1_simulator, config->z1_simulator);
+    }
+    if (config->z2_simulator != nullptr)
+    {
+        if (m_sim_cfg.z2_simulator == nullptr)
+        {
+            m_sim_cfg.z2_simulator = new char[1024];
+        }
+        strcpy((char*)m_sim_cfg.z2_simulator, config->z2_simulator);
+    }
+    if (config->z3_simulator != nullptr)
+    {
+        if (m_sim_cfg.z3_simulator == nullptr)
+        {
+            m_sim_cfg.z3_simulator = new char[1024];
+        }
+        strcpy((char*)m_sim_cfg.z3_simulator, config->z3_simulator);
+    }
+    if (config->log_file_path != nullptr)
+    {
+        strcpy((char*)m_sim_cfg.log_file_path, config->log_file_path);
+    }
+    m_sim_cfg.log_level = config->log_level;
+    m_sim_cfg.verbose = config->verbose;
+    m_sim_cfg.enable_avx = config->enable_avx;
+    m_sim_cfg.enable_calloc = config->enable_calloc;
+    return ret;
+}
+
+aipu_status_t aipudrv::MainContext::config_weight_streaming(const aipu_global_config_weight_streaming_t* config)
+{
+    if (nullptr == config)
+    {
+        return AIPU_STATUS_ERROR_NULL_PTR;
+    }
+
+    /* a streaming window should at least hold one page per staging chunk */
+    if ((config->window_size != 0) &&
+        (config->window_size < (config->async_read ? 2 * PAGE_SIZE : PAGE_SIZE)))
+    {
+        return AIPU_STATUS_ERROR_INVALID_CONFIG;
+    }
+
+    m_wstream_cfg = *config;
+    return AIPU_STATUS_SUCCESS;
+}
+
+aipu_status_t aipudrv::MainContext::config_parallel_load(const aipu_global_config_parallel_load_t* config)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+
+    if (nullptr == config)
+    {
+        return AIPU_STATUS_ERROR_NULL_PTR;
+    }
+
+    if ((config->chunk_size != 0) && (config->chunk_size < PAGE_SIZE))
+    {
+        return AIPU_STATUS_ERROR_INVALID_CONFIG;
+    }
+
+    /* the workers are replaced only when no load is using them, never waited for */
+    if (pthread_rwlock_trywrlock(&m_plock) != 0)
+    {
+        LOG(LOG_ERR, "parallel load: graphs being loaded");
+        return AIPU_STATUS_ERROR_INVALID_OP;
+    }
+
+    ret = m_load_pool.init(config->thread_cnt);
+    if (AIPU_STATUS_SUCCESS == ret)
+    {
+        m_pload_cfg = *config;
+    }
+    pthread_rwlock_unlock(&m_plock);
+    return ret;
+}
+
+aipu_status_t aipudrv::MainContext::config_deferred_unload(const aipu_global_config_deferred_unload_t* config)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+
+    if (nullptr == config)
+    {
+        return AIPU_STATUS_ERROR_NULL_PTR;
+    }
+
+    pthread_mutex_lock(&m_rlock);
+    m_reclaim_batch = (config->batch_cnt != 0) ? config->batch_cnt : DEFAULT_RECLAIM_BATCH;
+
+    /* once started, the reclaimer keeps running until deinit to drain retired graphs */
+    if (config->enable && !m_reclaimer_running)
+    {
+        m_reclaimer_exit = false;
+        if (pthread_create(&m_reclaimer, NULL, reclaimer_loop, this) != 0)
+        {
+            LOG(LOG_ERR, "create graph reclaimer thread failed");
+            ret = AIPU_STATUS_ERROR_INVALID_CONFIG;
+            goto unlock;
+        }
+        m_reclaimer_running = true;
+    }
+    m_deferred_unload = config->enable;
+
+unlock:
+    pthread_mutex_unlock(&m_rlock);
+    return ret;
+}
+
+aipu_status_t aipudrv::MainContext::config_mock_device(const aipu_global_config_mock_device_t* config)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+
+    if (nullptr == config)
+    {
+        return AIPU_STATUS_ERROR_NULL_PTR;
+    }
+
+    pthread_rwlock_rdlock(&m_glock);
+    if ((nullptr == m_dev) || (m_dev->get_dev_type() != DEV_TYPE_MOCK))
+    {
+        ret = AIPU_STATUS_ERROR_INVALID_CONFIG;
+    }
+    for (uint32_t i = 0; (AIPU_STATUS_SUCCESS == ret) && (i < m_devs.size()); i++)
+    {
+        ret = static_cast<MockDevice*>(m_devs[i]->get_backend())->config(config);
+    }
+    pthread_rwlock_unlock(&m_glock);
+
+    return ret;
+}
+
+aipu_status_t aipudrv::MainContext::config_placement(const aipu_global_config_placement_t* config)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+
+    if (nullptr == config)
+    {
+        return AIPU_STATUS_ERROR_NULL_PTR;
+    }
+
+    if ((config->policy != AIPU_PLACEMENT_ROUND_ROBIN) &&
+        (config->policy != AIPU_PLACEMENT_LEAST_LOADED) &&
+        (config->policy != AIPU_PLACEMENT_PINNED))
+    {
+        return AIPU_STATUS_ERROR_INVALID_CONFIG;
+    }
+
+    pthread_rwlock_wrlock(&m_glock);
+    if ((AIPU_PLACEMENT_PINNED == config->policy) &&
+        (config->device >= (m_devs.empty() ? 1 : m_devs.size())))
+    {
+        ret = AIPU_STATUS_ERROR_INVALID_CONFIG;
+    }
+    else
+    {
+        m_place_cfg = *config;
+    }
+    pthread_rwlock_unlock(&m_glock);
+
+    return ret;
+}
+
+aipu_status_t aipudrv::MainContext::config_scheduler(const aipu_global_config_scheduler_t* config)
+{
+    return m_sched.config(config);
+}
+
+aipu_status_t aipudrv::MainContext::config_admission(const aipu_global_config_admission_t* config)
+{
+    if (nullptr == config)
+    {
+        return AIPU_STATUS_ERROR_NULL_PTR;
+    }
+
+    /* a simulator got later takes the limit at the graph load */
+    pthread_rwlock_wrlock(&m_glock);
+    m_admit_cfg = *config;
+    for (uint32_t i = 0; i < m_devs.size(); i++)
+    {
+        m_devs[i]->get_mem()->set_limit(config->mem_limit);
+    }
+    pthread_rwlock_unlock(&m_glock);
+
+    return AIPU_STATUS_SUCCESS;
+}
+
+uint32_t aipudrv::MainContext::get_device_count()
+{
+    uint32_t cnt = 0;
+
+    /* a simulator is got at the first graph load but is counted before */
+    pthread_rwlock_rdlock(&m_glock);
+    cnt = m_devs.empty() ? 1 : m_devs.size();
+    pthread_rwlock_unlock(&m_glock);
+    return cnt;
+}
+
+aipu_status_t aipudrv::MainContext::replay_trace(const char* trace, bool keep_timing,
+    aipu_replay_stat_t* stat)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+
+    /* recorded device addresses can only be reproduced if no graph occupies device memory */
+    pthread_rwlock_rdlock(&m_glock);
+    if ((nullptr == m_dev) || (m_graphs.size() != 0))
+    {
+        ret = AIPU_STATUS_ERROR_INVALID_OP;
+    }
+    else
+    {
+        TraceReplayer replayer(m_dev);
+        ret = replayer.replay(trace, keep_timing, stat);
+    }
+    pthread_rwlock_unlock(&m_glock);
+
+    return ret;
+}
+
+bool aipudrv::MainContext::reclaim_retired_graphs()
+{
+    std::vector<GRAPH_ID> retired;
+    std::vector<GRAPH_ID> done;
+    GraphBase* p_gobj = nullptr;
+    uint32_t batch = 0;
+    uint32_t left = 0;
+    bool pending = false;
+
+    pthread_mutex_lock(&m_rlock);
+    retired = m_retired_graphs;
+    batch = m_reclaim_batch;
+    pthread_mutex_unlock(&m_rlock);
+
+    for (uint32_t i = 0; i < retired.size(); i++)
+    {
+        p_gobj = get_graph_object(retired[i]);
+        if (nullptr == p_gobj)
+        {
+            done.push_back(retired[i]);
+            continue;
+        }
+
+        /* jobs in flight are kept until they are done */
+        if (p_gobj->reclaim_jobs(batch, &left) != AIPU_STATUS_SUCCESS)
+        {
+            LOG(LOG_ERR, "graph 0x%lx: reclaim jobs failed", retired[i]);
+        }
+
+        /* put back before it is removed: remove() waits for every reference to be put back */
+        put_graph_object(p_gobj);
+        if (left != 0)
+        {
+            continue;
+        }
+
+        m_graphs.remove(get_graph_handle(retired[i]));
+        if (destroy_graph_object(&p_gobj) != AIPU_STATUS_SUCCESS)
+        {
+            LOG(LOG_ERR, "graph 0x%lx: reclaim graph failed", retired[i]);
+        }
+        done.push_back(retired[i]);
+    }
+
+    pthread_mutex_lock(&m_rlock);
+    for (uint32_t i = 0; i < done.size(); i++)
+    {
+        for (auto iter = m_retired_graphs.begin(); iter != m_retired_graphs.end(); iter++)
+        {
+            if (*iter == done[i])
+            {
+                m_retired_graphs.erase(iter);
+                break;
+            }
+        }
+    }
+    pending = !m_retired_graphs.empty();
+    pthread_mutex_unlock(&m_rlock);
+
+    return pending;
+}
+
+void* aipudrv::MainContext::reclaimer_loop(void* arg)
+{
+    MainContext* ctx = (MainContext*)arg;
+    struct timespec ts;
+    uint64_t deadline = 0;
+    bool pending = false;
+
+    pthread_mutex_lock(&ctx->m_rlock);
+    while (!ctx->m_reclaimer_exit)
+    {
+        if (ctx->m_retired_graphs.empty())
+        {
+            pthread_cond_wait(&ctx->m_rcond, &ctx->m_rlock);
+            continue;
+        }
+
+        pthread_mutex_unlock(&ctx->m_rlock);
+        pending = ctx->reclaim_retired_graphs();
+        pthread_mutex_lock(&ctx->m_rlock);
+
+        /**
+         * only retired graphs with jobs in flight (or more jobs than a batch) are polled
+         * again; otherwise the loop blocks until a graph is retired
+         */
+        if (pending && !ctx->m_reclaimer_exit)
+        {
+            deadline = umd_get_time_ns_helper() + RECLAIM_INTERVAL_MS * 1000000ULL;
+            ts.tv_sec = deadline / 1000000000ULL;
+            ts.tv_nsec = deadline % 1000000000ULL;
+            pthread_cond_timedwait(&ctx->m_rcond, &ctx->m_rlock, &ts);
+        }
+    }
+    pthread_mutex_unlock(&ctx->m_rlock);
+
+    return nullptr;
+}
+
+void aipudrv::MainContext::stop_reclaimer()
+{
+    pthread_mutex_lock(&m_rlock);
+    if (!m_reclaimer_running)
+    {
+        pthread_mutex_unlock(&m_rlock);
+        return;
+    }
+    m_reclaimer_exit = true;
+    m_reclaimer_running = false;
+    m_deferred_unload = false;
+    pthread_cond_signal(&m_rcond);
+    pthread_mutex_unlock(&m_rlock);
+
+    pthread_join(m_reclaimer, NULL);
 }
 
 aipu_status_t aipudrv::MainContext::debugger_malloc(uint32_t size, void** va)
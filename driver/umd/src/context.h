@@ -24,24 +24,46 @@
 #define _CONTEXT_H_
 
 #include <map>
+#include <vector>
 #include <fstream>
 #include <pthread.h>
 #include "standard_api.h"
 #include "graph_base.h"
 #include "device_base.h"
 #include "memory_base.h"
+#include "model.h"
+#include "job_scheduler.h"
+#include "batcher.h"
+#include "utils/thread_pool.h"
+#include "utils/handle_table.h"
 
 namespace aipudrv
 {
-typedef std::map<uint32_t, GraphBase*> GraphTable;
+typedef HandleTable<GraphBase, 16> GraphTable;
+typedef std::map<MODEL_ID, Model*> ModelTable;
+typedef std::map<BATCHER_ID, Batcher*> BatcherTable;
+typedef std::map<JOB_ID, std::vector<JOB_ID>> FenceTable;
 
 class MainContext
 {
 private:
     DeviceBase* m_dev = nullptr;
     MemoryBase* m_dram = nullptr;
+    /* all devices (m_dev is m_devs[0]) and the number of graphs resident on each */
+    std::vector<DeviceBase*> m_devs;
+    std::vector<uint32_t> m_dev_graph_cnt;
+    uint32_t m_next_dev = 0;
+    aipu_global_config_placement_t m_place_cfg;
+    aipu_global_config_admission_t m_admit_cfg;
+    /* graph handles are resolved lock-free; m_glock serializes device acquisition */
     GraphTable  m_graphs;
     pthread_rwlock_t m_glock;
+    ModelTable  m_models;
+    MODEL_ID    m_next_model_id = 1;
+    pthread_rwlock_t m_mlock;
+    BatcherTable m_batchers;
+    BATCHER_ID   m_next_batcher_id = 1;
+    pthread_rwlock_t m_block;
     bool m_do_vcheck = true;
     std::map<void*, BufferDesc> m_dbg_buffers;
 
@@ -50,11 +72,40 @@ private:
 
 private:
     aipu_global_config_simulation_t m_sim_cfg;
+    aipu_global_config_weight_streaming_t m_wstream_cfg;
+    aipu_global_config_parallel_load_t m_pload_cfg;
+    ThreadPool m_load_pool;
+    /* held for read by graph loads using m_load_pool, for write to reconfigure it */
+    pthread_rwlock_t m_plock;
 
 private:
-    uint64_t create_unique_graph_id_inner() const;
-    aipu_status_t create_graph_object(std::ifstream& gbin, uint32_t size, uint64_t id, GraphBase** gobj);
+    /* deferred unload: retired graphs waiting to be reclaimed in background */
+    bool m_deferred_unload = false;
+    uint32_t m_reclaim_batch;
+    std::vector<GRAPH_ID> m_retired_graphs;
+    pthread_t m_reclaimer;
+    bool m_reclaimer_running = false;
+    bool m_reclaimer_exit = false;
+    pthread_mutex_t m_rlock;
+    pthread_cond_t m_rcond;
+
+private:
+    /* fenced jobs and the unfinished jobs they wait for, see flush_job_after() */
+    FenceTable m_fences;
+    pthread_mutex_t m_flock;
+
+private:
+    /* job queues admitting the jobs of their graphs onto the devices */
+    JobScheduler m_sched;
+
+private:
+    uint32_t select_device();
+    aipu_status_t create_graph_object(std::ifstream& gbin, uint32_t size, uint64_t id, GraphBase** gobj,
+        int32_t dev);
     aipu_status_t destroy_graph_object(GraphBase** gobj);
+    bool reclaim_retired_graphs();
+    void stop_reclaimer();
+    static void* reclaimer_loop(void* arg);
 
 private:
     bool is_deinit_ok();
@@ -64,17 +115,57 @@ public:
     aipu_status_t init();
     void force_deinit();
     aipu_status_t deinit();
+    /* a graph or job got is referenced until it is put back: it is not freed meanwhile */
     GraphBase*    get_graph_object(GRAPH_ID id);
+    void          put_graph_object(GraphBase* gobj);
     JobBase*      get_job_object(JOB_ID id);
+    void          put_job_object(JobBase* job);
     aipu_status_t get_status_msg(aipu_status_t status, const char** msg);
-    aipu_status_t load_graph(const char* graph_file, GRAPH_ID* id);
+    aipu_status_t load_graph(const char* graph_file, GRAPH_ID* id, int32_t dev = -1);
+    aipu_status_t load_graphs(const char* graph_files[], uint32_t cnt, GRAPH_ID ids[]);
     aipu_status_t unload_graph(GRAPH_ID id);
+    aipu_status_t create_super_graph(const GRAPH_ID graphs[], uint32_t cnt,
+        const aipu_tensor_binding_t bindings[], uint32_t binding_cnt, GRAPH_ID* id);
+    /* a model got is referenced until it is put back, even if unloaded meanwhile */
+    Model*        get_model_object(MODEL_ID id);
+    void          put_model_object(Model* model);
+    aipu_status_t load_model(const char* graph_file, uint32_t job_cnt, MODEL_ID* id);
+    aipu_status_t swap_model(MODEL_ID id, const char* graph_file);
+    aipu_status_t unload_model(MODEL_ID id);
+    /* a batcher got is referenced until it is put back, even if destroyed meanwhile */
+    Batcher*      get_batcher_object(BATCHER_ID id);
+    void          put_batcher_object(Batcher* batcher);
+    aipu_status_t create_batcher(GRAPH_ID graph, const aipu_batcher_config_t* config, BATCHER_ID* id);
+    aipu_status_t destroy_batcher(BATCHER_ID id);
     aipu_status_t get_simulation_instance(void** simulator, void** memory);
-    aipu_status_t create_job(GRAPH_ID graph, JOB_ID* id);
+    aipu_status_t create_job(GRAPH_ID graph, JOB_ID* id, int32_t time_out = 0);
+    aipu_status_t flush_job(JobBase* job);
+    aipu_status_t flush_job_after(JOB_ID id, const JOB_ID deps[], uint32_t cnt);
+    aipu_status_t get_job_status(JobBase* job, int32_t time_out, aipu_job_status_t* status);
+    aipu_status_t release_fence(JOB_ID id, int32_t time_out, bool* fenced);
+    void drop_fence(JOB_ID id);
+    aipu_status_t create_job_queue(const aipu_job_queue_config_t* config, QUEUE_ID* id);
+    aipu_status_t destroy_job_queue(QUEUE_ID id);
+    aipu_status_t set_graph_queue(GRAPH_ID graph, QUEUE_ID queue);
+    aipu_status_t get_job_queue_stat(QUEUE_ID id, aipu_job_queue_stat_t* stat);
+    void dequeue_job(JOB_ID id);
     aipu_status_t get_cluster_count(uint32_t* cnt);
     aipu_status_t get_core_count(uint32_t cluster, uint32_t* cnt);
     aipu_status_t debugger_get_job_info(JOB_ID job, aipu_debugger_job_info_t* info);
     aipu_status_t config_simulation(uint64_t types, aipu_global_config_simulation_t* config);
+    aipu_status_t config_weight_streaming(const aipu_global_config_weight_streaming_t* config);
+    aipu_status_t config_parallel_load(const aipu_global_config_parallel_load_t* config);
+    aipu_status_t config_deferred_unload(const aipu_global_config_deferred_unload_t* config);
+    aipu_status_t config_mock_device(const aipu_global_config_mock_device_t* config);
+    aipu_status_t config_placement(const aipu_global_config_placement_t* config);
+    aipu_status_t config_scheduler(const aipu_global_config_scheduler_t* config);
+    aipu_status_t config_admission(const aipu_global_config_admission_t* config);
+    uint32_t get_device_count();
+    aipu_global_config_placement_t get_placement()
+    {
+        return m_place_cfg;
+    }
+    aipu_status_t replay_trace(const char* trace, bool keep_timing, aipu_replay_stat_t* stat);
     void disable_version_check()
     {
         m_do_vcheck = false;
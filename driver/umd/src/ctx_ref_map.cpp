@@ -24,57 +24,39 @@
 
 aipudrv::CtxRefMap::CtxRefMap()
 {
-    data.clear();
-    pthread_mutex_init(&lock, NULL);
 }
 
 aipudrv::CtxRefMap::~CtxRefMap()
 {
-    std::map<uint32_t, MainContext*>::iterator iter;
-    pthread_mutex_lock(&lock);
-    for (iter = data.begin(); iter != data.end(); iter++)
+    std::vector<uint32_t> handles;
+    MainContext* ctx = nullptr;
+
+    data.get_handles(handles);
+    for (uint32_t i = 0; i < handles.size(); i++)
     {
-        iter->second->force_deinit();
-        delete iter->second;
-        iter->second = nullptr;
+        if (data.remove(handles[i], &ctx) && (ctx != nullptr))
+        {
+            ctx->force_deinit();
+            delete ctx;
+        }
     }
-    data.clear();
-    pthread_mutex_unlock(&lock);
-    pthread_mutex_destroy(&lock);
 }
 
 uint32_t aipudrv::CtxRefMap::create_ctx_ref()
 {
-    uint32_t handle = 0xFFFFFFFF;
+    MainContext* ctx = new MainContext;
+    uint32_t handle = data.alloc(ctx);
 
-    pthread_mutex_lock(&lock);
-    while(nullptr != get_ctx_ref_inner(handle))
+    if (0 == handle)
     {
-        handle--;
+        delete ctx;
     }
-    data[handle] = new MainContext;
-    pthread_mutex_unlock(&lock);
-
     return handle;
 }
 
-aipudrv::MainContext* aipudrv::CtxRefMap::get_ctx_ref_inner(uint32_t handle)
-{
-    MainContext* ctx = nullptr;
-    if (data.count(handle) == 1)
-    {
-        ctx = data[handle];
-    }
-    return ctx;
-}
-
 aipudrv::MainContext* aipudrv::CtxRefMap::get_ctx_ref(uint32_t handle)
 {
-    MainContext* ctx = nullptr;
-    pthread_mutex_lock(&lock);
-    ctx = get_ctx_ref_inner(handle);
-    pthread_mutex_unlock(&lock);
-    return ctx;
+    return data.get(handle);
 }
 
 aipu_status_t aipudrv::CtxRefMap::destroy_ctx_ref(uint32_t handle)
@@ -82,18 +64,14 @@ aipu_status_t aipudrv::CtxRefMap::destroy_ctx_ref(uint32_t handle)
     aipu_status_t ret = AIPU_STATUS_SUCCESS;
     MainContext* ctx = nullptr;
 
-    pthread_mutex_lock(&lock);
-    ctx = get_ctx_ref_inner(handle);
-    if (nullptr != ctx)
+    if (data.remove(handle, &ctx))
     {
         delete ctx;
-        data.erase(handle);
     }
     else
     {
         ret = AIPU_STATUS_ERROR_INVALID_CTX;
     }
-    pthread_mutex_unlock(&lock);
 
     return ret;
-}
\ No newline at end of file
+}
@@ -23,21 +23,19 @@
 #ifndef _CTX_REF_MAP_H_
 #define _CTX_REF_MAP_H_
 
-#include <map>
-#include <pthread.h>
 #include "standard_api.h"
 #include "context.h"
+#include "utils/handle_table.h"
 
 namespace aipudrv
 {
+typedef HandleTable<MainContext, 16> CtxTable;
+
 class CtxRefMap
 {
 private:
-    std::map<uint32_t, MainContext*> data;
-    pthread_mutex_t lock;
-
-private:
-    MainContext*  get_ctx_ref_inner(uint32_t handle);
+    /* context handles are resolved lock-free */
+    CtxTable data;
 
 public:
     uint32_t      create_ctx_ref();
@@ -30,26 +30,49 @@
 #include "aipu.h"
 #include "ukmemory.h"
 
-aipudrv::Aipu* aipudrv::Aipu::m_aipu = nullptr;
+aipudrv::Aipu* aipudrv::Aipu::m_aipus[AIPU_MAX_DEVICE_CNT] = {nullptr};
+std::vector<std::string> aipudrv::Aipu::m_paths;
 
-aipudrv::Aipu::Aipu()
+aipudrv::Aipu::Aipu(uint32_t index)
 {
     m_dev_type = DEV_TYPE_AIPU;
+    m_index = index;
 }
 
 aipudrv::Aipu::~Aipu()
 {
     deinit();
+    m_aipus[m_index] = nullptr;
 }
 
-aipu_ll_status_t aipudrv::Aipu::init()
+uint32_t aipudrv::Aipu::enumerate()
+{
+    char path[32];
+
+    m_paths.clear();
+    if (access("/dev/aipu", F_OK) == 0)
+    {
+        m_paths.push_back("/dev/aipu");
+    }
+    for (uint32_t i = 0; (i < AIPU_MAX_DEVICE_CNT) && (m_paths.size() < AIPU_MAX_DEVICE_CNT); i++)
+    {
+        snprintf(path, sizeof(path), "/dev/aipu%u", i);
+        if (access(path, F_OK) == 0)
+        {
+            m_paths.push_back(path);
+        }
+    }
+    return m_paths.size();
+}
+
+aipu_ll_status_t aipudrv::Aipu::init(const char* path)
 {
     aipu_ll_status_t ret = AIPU_LL_STATUS_SUCCESS;
     int kret = 0;
     aipu_cap cap;
     aipu_core_cap *core_caps = NULL;
 
-    m_fd = open("/dev/aipu", O_RDWR | O_SYNC);
+    m_fd = open(path, O_RDWR | O_SYNC);
     if (m_fd <= 0)
     {
         m_fd = 0;
@@ -171,8 +194,12 @@ aipu_ll_status_t aipudrv::Aipu::write_reg(uint32_t core_id, uint32_t offset, uin
 aipu_status_t aipudrv::Aipu::schedule(const JobDesc& job)
 {
     int kret = 0;
+    aipu_job_desc kdesc = job.kdesc;
 
-    kret = ioctl(m_fd, AIPU_IOCTL_SCHEDULE_JOB, &job.kdesc);
+    /* KMD wakes a poll of this file for the done jobs of every thread, not only of the
+     * polling one: completions are polled by one thread for all (DeviceBase) */
+    kdesc.enable_poll_opt = 1;
+    kret = ioctl(m_fd, AIPU_IOCTL_SCHEDULE_JOB, &kdesc);
     if (kret)
     {
         return AIPU_STATUS_ERROR_INVALID_OP;
@@ -181,8 +208,8 @@ aipu_status_t aipudrv::Aipu::schedule(const JobDesc& job)
     return AIPU_STATUS_SUCCESS;
 }
 
-aipu_ll_status_t aipudrv::Aipu::get_status(std::vector<aipu_job_status_desc>& jobs_status,
-    uint32_t max_cnt, bool of_this_thread)
+aipu_ll_status_t aipudrv::Aipu::get_status(aipu_job_status_desc* status, uint32_t max_cnt,
+    uint32_t* cnt, bool of_this_thread)
 {
     aipu_ll_status_t ret = AIPU_LL_STATUS_SUCCESS;
     int kret = 0;
@@ -190,34 +217,29 @@ aipu_ll_status_t aipudrv::Aipu::get_status(std::vector<aipu_job_status_desc>& jo
 
     assert(max_cnt > 0);
 
+    /* KMD fills the caller's array directly */
+    *cnt = 0;
     status_query.of_this_thread = of_this_thread;
     status_query.max_cnt = max_cnt;
-    status_query.status = new aipu_job_status_desc[max_cnt];
+    status_query.status = status;
     kret = ioctl(m_fd, AIPU_IOCTL_QUERY_STATUS, &status_query);
     if (kret)
     {
-        ret = AIPU_LL_STATUS_ERROR_IOCTL_QUERY_STATUS_FAIL;
-        goto clean;
-    }
-
-    for (uint32_t i = 0; i < status_query.poll_cnt; i++)
-    {
-        jobs_status.push_back(status_query.status[i]);
+        return AIPU_LL_STATUS_ERROR_IOCTL_QUERY_STATUS_FAIL;
     }
 
-clean:
-    delete[] status_query.status;
+    *cnt = status_query.poll_cnt;
     return ret;
 }
 
-aipu_ll_status_t aipudrv::Aipu::get_status(std::vector<aipu_job_status_desc>& jobs_status,
-    uint32_t max_cnt)
+aipu_ll_status_t aipudrv::Aipu::get_status(aipu_job_status_desc* status, uint32_t max_cnt,
+    uint32_t* cnt)
 {
-    return poll_status(jobs_status, max_cnt, 0, true);
+    return poll_status(status, max_cnt, cnt, 0, true);
 }
 
-aipu_ll_status_t aipudrv::Aipu::poll_status(std::vector<aipu_job_status_desc>& jobs_status,
-    uint32_t max_cnt, int32_t time_out, bool of_this_thread)
+aipu_ll_status_t aipudrv::Aipu::poll_status(aipu_job_status_desc* status, uint32_t max_cnt,
+    uint32_t* cnt, int32_t time_out, bool of_this_thread)
 {
     aipu_ll_status_t ret = AIPU_LL_STATUS_SUCCESS;
     int kret = 0;
@@ -227,6 +249,7 @@ aipu_ll_status_t aipudrv::Aipu::poll_status(std::vector<aipu_job_status_desc>& j
 
     assert(max_cnt > 0);
 
+    *cnt = 0;
     kret = poll(&poll_list, 1, time_out);
     if (kret < 0)
     {
@@ -235,7 +258,7 @@ aipu_ll_status_t aipudrv::Aipu::poll_status(std::vector<aipu_job_status_desc>& j
 
     if ((poll_list.revents & POLLIN) == POLLIN)
     {
-        ret = get_status(jobs_status, max_cnt, of_this_thread);
+        ret = get_status(status, max_cnt, cnt, of_this_thread);
     }
 
     return ret;
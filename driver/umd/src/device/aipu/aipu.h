@@ -24,20 +24,24 @@
 #define _AIPU_H_
 
 #include <vector>
+#include <string>
 
 #include "device_base.h"
 #include "type.h"
 
 namespace aipudrv
 {
+#define AIPU_MAX_DEVICE_CNT 8
+
 class Aipu : public DeviceBase
 {
 protected:
     int m_fd = 0;
+    uint32_t m_index = 0;
     std::vector<aipu_core_cap> m_core_caps;
 
 private:
-    aipu_ll_status_t init();
+    aipu_ll_status_t init(const char* path);
     void deinit();
 
 public:
@@ -45,15 +49,20 @@ public:
     virtual aipu_status_t schedule(const JobDesc& job);
     virtual aipu_ll_status_t read_reg(uint32_t core_id, uint32_t offset, uint32_t* value);
     virtual aipu_ll_status_t write_reg(uint32_t core_id, uint32_t offset, uint32_t value);
-    aipu_ll_status_t get_status(std::vector<aipu_job_status_desc>& jobs_status,
-        uint32_t max_cnt, bool of_this_thread);
-    virtual aipu_ll_status_t get_status(std::vector<aipu_job_status_desc>& jobs_status,
-        uint32_t max_cnt);
-    virtual aipu_ll_status_t poll_status(std::vector<aipu_job_status_desc>& jobs_status,
-        uint32_t max_cnt, int32_t time_out, bool of_this_thread);
+    aipu_ll_status_t get_status(aipu_job_status_desc* status, uint32_t max_cnt,
+        uint32_t* cnt, bool of_this_thread);
+    virtual aipu_ll_status_t get_status(aipu_job_status_desc* status, uint32_t max_cnt,
+        uint32_t* cnt);
+    virtual aipu_ll_status_t poll_status(aipu_job_status_desc* status, uint32_t max_cnt,
+        uint32_t* cnt, int32_t time_out, bool of_this_thread);
 
 public:
-    static aipu_status_t get_aipu(DeviceBase** dev)
+    /**
+     * @brief device files of the NPUs (/dev/aipu, /dev/aipu0, /dev/aipu1...) found in
+     *        this order; index of get_aipu() is the position in this list
+     */
+    static uint32_t enumerate();
+    static aipu_status_t get_aipu(DeviceBase** dev, uint32_t index = 0)
     {
         aipu_status_t ret = AIPU_STATUS_SUCCESS;
 
@@ -62,20 +71,28 @@ public:
             return AIPU_STATUS_ERROR_NULL_PTR;
         }
 
-        if (m_aipu == nullptr)
+        if (m_paths.empty())
+        {
+            enumerate();
+        }
+        if (index >= m_paths.size())
+        {
+            return (0 == index) ? AIPU_STATUS_ERROR_OPEN_DEV_FAIL : AIPU_STATUS_ERROR_TARGET_NOT_FOUND;
+        }
+
+        if (m_aipus[index] == nullptr)
         {
-            m_aipu = new Aipu();
-            ret = convert_ll_status(m_aipu->init());
+            m_aipus[index] = new Aipu(index);
+            ret = convert_ll_status(m_aipus[index]->init(m_paths[index].c_str()));
             if (ret != AIPU_STATUS_SUCCESS)
             {
-                delete m_aipu;
-                m_aipu = nullptr;
+                delete m_aipus[index];
                 return ret;
             }
         }
 
-        m_aipu->inc_ref_cnt();
-        *dev = m_aipu;
+        m_aipus[index]->inc_ref_cnt();
+        *dev = m_aipus[index];
         return AIPU_STATUS_SUCCESS;
     }
     virtual ~Aipu();
@@ -83,8 +100,9 @@ public:
     Aipu& operator=(const Aipu& dev) = delete;
 
 private:
-    Aipu();
-    static Aipu* m_aipu;
+    Aipu(uint32_t index);
+    static Aipu* m_aipus[AIPU_MAX_DEVICE_CNT];
+    static std::vector<std::string> m_paths;
 };
 }
 
@@ -33,7 +33,7 @@
 #include "utils/log.h"
 #include "utils/helper.h"
 
-aipudrv::UKMemory* aipudrv::UKMemory::m_mem = nullptr;
+std::map<int, aipudrv::UKMemory*> aipudrv::UKMemory::m_mems;
 
 aipudrv::UKMemory::UKMemory(int fd): MemoryBase()
 {
@@ -48,6 +48,7 @@ aipudrv::UKMemory::~UKMemory()
         free(&bm_iter->second.desc, nullptr);
     }
     m_allocated.clear();
+    m_mems.erase(m_fd);
 }
 
 aipu_status_t aipudrv::UKMemory::malloc(uint32_t size, uint32_t align, BufferDesc* desc, const char* str)
@@ -86,6 +87,7 @@ aipu_status_t aipudrv::UKMemory::malloc(uint32_t size, uint32_t align, BufferDes
     pthread_rwlock_wrlock(&m_lock);
     m_allocated[buf_req.desc.pa] = buf;
     pthread_rwlock_unlock(&m_lock);
+    notify_alloc(*desc, buf_req.align_in_page);
 
 #if RTDEBUG_TRACKING_MEM_OPERATION
     add_tracking(buf_req.desc.pa, size, MemOperationAlloc, str, false, 0);
@@ -127,6 +129,11 @@ aipu_status_t aipudrv::UKMemory::free(const BufferDesc* desc, const char* str)
 unlock:
     pthread_rwlock_unlock(&m_lock);
 
+    if (ret == AIPU_STATUS_SUCCESS)
+    {
+        notify_free(*desc);
+    }
+
 #if RTDEBUG_TRACKING_MEM_OPERATION
     if (ret == AIPU_STATUS_SUCCESS)
     {
@@ -51,13 +51,14 @@ public:
     };
 
 public:
+    /* one memory per device file */
     static UKMemory* get_memory(int fd)
     {
-        if (nullptr == m_mem)
+        if (0 == m_mems.count(fd))
         {
-            m_mem = new UKMemory(fd);
+            m_mems[fd] = new UKMemory(fd);
         }
-        return m_mem;
+        return m_mems[fd];
     }
     virtual ~UKMemory();
     UKMemory(const UKMemory& mem) = delete;
@@ -65,7 +66,7 @@ public:
 
 private:
     UKMemory(int fd);
-    static UKMemory* m_mem;
+    static std::map<int, UKMemory*> m_mems;
 };
 }
 
@@ -21,13 +21,18 @@
  */
 
 #include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
 #include "standard_api.h"
 #include "device_base.h"
 #include "parser_base.h"
-#ifdef SIMULATION
+#include "mock/mock_device.h"
+#include "trace/trace_device.h"
+#if (defined SIMULATION)
 #include "simulator/simulator.h"
 #include "simulator/z5_simulator.h"
-#else
+#elif !(defined MOCK_DEVICE)
 #include "aipu/aipu.h"
 #endif
 
@@ -36,6 +41,35 @@
 
 namespace aipudrv
 {
+/**
+ * @brief mock device is used if UMD is built for mock platform, or selected at runtime
+ *        by environment variable AIPU_UMD_DEVICE=mock
+ */
+inline bool is_mock_device_selected()
+{
+#if (defined MOCK_DEVICE)
+    return true;
+#else
+    const char* dev = getenv("AIPU_UMD_DEVICE");
+    return (dev != nullptr) && (strcmp(dev, "mock") == 0);
+#endif
+}
+
+/**
+ * @brief job stream scheduled onto a device is recorded into the trace file given by
+ *        environment variable AIPU_UMD_RECORD, which can be replayed by aipu_replay_trace
+ */
+inline DeviceBase* record_device(DeviceBase* dev)
+{
+    const char* trace = getenv("AIPU_UMD_RECORD");
+
+    if ((nullptr == dev) || (nullptr == trace))
+    {
+        return dev;
+    }
+    return RecordDevice::get_record_device(dev, trace);
+}
+
 inline aipu_status_t test_get_device(uint32_t graph_version, DeviceBase** dev,
     const aipu_global_config_simulation_t* cfg)
 {
@@ -49,6 +83,16 @@ inline aipu_status_t test_get_device(uint32_t graph_version, DeviceBase** dev,
         return AIPU_STATUS_ERROR_GVERSION_UNSUPPORTED;
     }
 
+    if ((*dev != nullptr) && ((*dev)->get_dev_type() == DEV_TYPE_MOCK))
+    {
+        return ret;
+    }
+    else if ((nullptr == *dev) && is_mock_device_selected())
+    {
+        *dev = record_device(MockDevice::get_mock_device());
+        return ret;
+    }
+
 #if (defined SIMULATION)
 #if (defined ZHOUYI_V123)
     if (AIPU_LOADABLE_GRAPH_V0005 == graph_version)
@@ -59,7 +103,7 @@ inline aipu_status_t test_get_device(uint32_t graph_version, DeviceBase** dev,
         }
         else if (nullptr == *dev)
         {
-            *dev = Simulator::get_simulator();
+            *dev = record_device(Simulator::get_simulator());
         }
     }
 #endif
@@ -72,12 +116,16 @@ inline aipu_status_t test_get_device(uint32_t graph_version, DeviceBase** dev,
         }
         else if (nullptr == *dev)
         {
-            *dev = Z5Simulator::get_z5_simulator(cfg);
+            *dev = record_device(Z5Simulator::get_z5_simulator(cfg));
         }
     }
 #endif
-#else /* !SIMULATION */
-    ret = Aipu::get_aipu(dev);
+#elif !(defined MOCK_DEVICE)
+    if (nullptr == *dev)
+    {
+        ret = Aipu::get_aipu(dev);
+        *dev = record_device(*dev);
+    }
 #endif
 
     if (nullptr == *dev)
@@ -87,13 +135,79 @@ inline aipu_status_t test_get_device(uint32_t graph_version, DeviceBase** dev,
     return ret;
 }
 
+/**
+ * @brief number of mock devices given by environment variable AIPU_UMD_MOCK_DEVICES (default 1)
+ */
+inline uint32_t get_mock_device_count()
+{
+    const char* cnt = getenv("AIPU_UMD_MOCK_DEVICES");
+
+    if ((nullptr == cnt) || (atoi(cnt) <= 0))
+    {
+        return 1;
+    }
+    return (atoi(cnt) > MOCK_MAX_DEVICE_CNT) ? MOCK_MAX_DEVICE_CNT : atoi(cnt);
+}
+
+/**
+ * @brief all the devices of this platform, in enumeration order; devs[0] is the one
+ *        returned by get_device() and the only one being recorded
+ */
+inline aipu_status_t get_devices(std::vector<DeviceBase*>& devs)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+
+    if (is_mock_device_selected())
+    {
+        devs.push_back(record_device(MockDevice::get_mock_device(0)));
+        for (uint32_t i = 1; i < get_mock_device_count(); i++)
+        {
+            devs.push_back(MockDevice::get_mock_device(i));
+        }
+        return ret;
+    }
+
+#if !(defined SIMULATION) && !(defined MOCK_DEVICE)
+    DeviceBase* dev = nullptr;
+    uint32_t cnt = Aipu::enumerate();
+
+    ret = Aipu::get_aipu(&dev);
+    if (AIPU_STATUS_SUCCESS != ret)
+    {
+        return ret;
+    }
+    devs.push_back(record_device(dev));
+
+    /* a secondary NPU which fails to open is left out */
+    for (uint32_t i = 1; i < cnt; i++)
+    {
+        if (Aipu::get_aipu(&dev, i) == AIPU_STATUS_SUCCESS)
+        {
+            devs.push_back(dev);
+        }
+    }
+#endif
+
+    return ret;
+}
+
 inline aipu_status_t get_device(DeviceBase** dev)
 {
     aipu_status_t ret = AIPU_STATUS_SUCCESS;
 
-#ifndef SIMULATION
     assert(dev != nullptr);
+    if (is_mock_device_selected())
+    {
+        *dev = record_device(MockDevice::get_mock_device());
+        return ret;
+    }
+
+#if !(defined SIMULATION) && !(defined MOCK_DEVICE)
     ret = Aipu::get_aipu(dev);
+    if (AIPU_STATUS_SUCCESS == ret)
+    {
+        *dev = record_device(*dev);
+    }
 #endif
 
     return ret;
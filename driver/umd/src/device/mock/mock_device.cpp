@@ -0,0 +1,288 @@
+/**********************************************************************************
+ * This file is CONFIDENTIAL and any use by you is subject to the terms of the
+ * agreement between you and Arm China or the terms of the agreement between you
+ * and the party authorised by Arm China to disclose this file to you.
+ * The confidential and proprietary information contained in this file
+ * may only be used by a person authorised under and to the extent permitted
+ * by a subsisting licensing agreement from Arm China.
+ *
+ *        (C) Copyright 2020 Arm Technology (China) Co. Ltd.
+ *                    All rights reserved.
+ *
+ * This entire notice must be reproduced on all copies of this file and copies of
+ * this file may only be made by a person if such person is permitted to do so
+ * under the terms of a subsisting license agreement from Arm China.
+ *
+ *********************************************************************************/
+
+/**
+ * @file  mock_device.cpp
+ * @brief AIPU User Mode Driver (UMD) mock device module implementation
+ */
+
+#include <time.h>
+#include <math.h>
+#include <cstring>
+#include "mock_device.h"
+#include "utils/helper.h"
+
+#define MOCK_CORE_RING_INIT_SIZE  16
+#define MOCK_DEFAULT_RAND_SEED    0x9E3779B97F4A7C15ULL
+
+aipudrv::MockDevice* aipudrv::MockDevice::m_mocks[MOCK_MAX_DEVICE_CNT] = {nullptr};
+
+aipudrv::MockDevice::MockDevice(uint32_t index)
+{
+    pthread_condattr_t attr;
+    aipu_global_config_mock_device_t cfg;
+
+    m_dev_type = DEV_TYPE_MOCK;
+    m_index = index;
+    m_dram = (0 == index) ? UMemory::get_memory() : UMemory::create_memory();
+    pthread_mutex_init(&m_lock, NULL);
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&m_cond, &attr);
+    pthread_condattr_destroy(&attr);
+
+    /* by default jobs complete at once on a single core */
+    memset(&cfg, 0, sizeof(cfg));
+    config(&cfg);
+}
+
+aipudrv::MockDevice::~MockDevice()
+{
+    pthread_cond_destroy(&m_cond);
+    pthread_mutex_destroy(&m_lock);
+    delete m_dram;
+    m_mocks[m_index] = nullptr;
+}
+
+aipu_status_t aipudrv::MockDevice::config(const aipu_global_config_mock_device_t* config)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+
+    if (nullptr == config)
+    {
+        return AIPU_STATUS_ERROR_NULL_PTR;
+    }
+
+    if ((config->jitter != AIPU_MOCK_JITTER_NONE) &&
+        (config->jitter != AIPU_MOCK_JITTER_UNIFORM) &&
+        (config->jitter != AIPU_MOCK_JITTER_EXPONENTIAL))
+    {
+        return AIPU_STATUS_ERROR_INVALID_CONFIG;
+    }
+
+    pthread_mutex_lock(&m_lock);
+    if (m_pending_cnt != 0)
+    {
+        ret = AIPU_STATUS_ERROR_INVALID_OP;
+        goto unlock;
+    }
+
+    m_cfg = *config;
+    m_cfg.core_cnt = (config->core_cnt != 0) ? config->core_cnt : 1;
+    m_core_cnt = m_cfg.core_cnt;
+    m_rand_state = (config->seed != 0) ? config->seed : MOCK_DEFAULT_RAND_SEED;
+    m_cores.assign(m_cfg.core_cnt, MockCore());
+    for (uint32_t i = 0; i < m_cores.size(); i++)
+    {
+        m_cores[i].jobs.resize(MOCK_CORE_RING_INIT_SIZE);
+    }
+
+unlock:
+    pthread_mutex_unlock(&m_lock);
+    return ret;
+}
+
+uint64_t aipudrv::MockDevice::get_service_time_ns()
+{
+    uint64_t service = (uint64_t)m_cfg.service_time_us * 1000;
+    uint64_t jitter = (uint64_t)m_cfg.jitter_us * 1000;
+    uint64_t rand = 0;
+    double u = 0;
+
+    if ((AIPU_MOCK_JITTER_NONE == m_cfg.jitter) || (0 == jitter))
+    {
+        return service;
+    }
+
+    /* xorshift64*: cheap and reproducible across platforms for a given seed */
+    m_rand_state ^= m_rand_state >> 12;
+    m_rand_state ^= m_rand_state << 25;
+    m_rand_state ^= m_rand_state >> 27;
+    rand = m_rand_state * 0x2545F4914F6CDD1DULL;
+
+    if (AIPU_MOCK_JITTER_UNIFORM == m_cfg.jitter)
+    {
+        service += rand % (2 * jitter + 1);
+        return (service > jitter) ? (service - jitter) : 0;
+    }
+
+    u = (rand >> 11) * (1.0 / 9007199254740992.0);
+    return service + (uint64_t)(-log(1.0 - u) * jitter);
+}
+
+uint64_t aipudrv::MockDevice::get_next_done_ns() const
+{
+    uint64_t next = UINT64_MAX;
+
+    for (uint32_t i = 0; i < m_cores.size(); i++)
+    {
+        const MockCore& core = m_cores[i];
+        if ((core.cnt != 0) && (core.jobs[core.head].done_ns < next))
+        {
+            next = core.jobs[core.head].done_ns;
+        }
+    }
+    return next;
+}
+
+void aipudrv::MockDevice::pop_done_jobs(uint64_t now_ns, aipu_job_status_desc* status,
+    uint32_t max_cnt, uint32_t* cnt)
+{
+    while (*cnt < max_cnt)
+    {
+        MockCore* first = nullptr;
+
+        /* report jobs in the order they complete across cores */
+        for (uint32_t i = 0; i < m_cores.size(); i++)
+        {
+            MockCore& core = m_cores[i];
+            if ((core.cnt != 0) && (core.jobs[core.head].done_ns <= now_ns) &&
+                ((nullptr == first) || (core.jobs[core.head].done_ns < first->jobs[first->head].done_ns)))
+            {
+                first = &core;
+            }
+        }
+
+        if (nullptr == first)
+        {
+            break;
+        }
+
+        memset(&status[*cnt], 0, sizeof(status[*cnt]));
+        status[*cnt].job_id = first->jobs[first->head].job_id;
+        status[*cnt].state = AIPU_JOB_STATE_DONE;
+        (*cnt)++;
+        first->head = (first->head + 1) % first->jobs.size();
+        first->cnt--;
+        m_pending_cnt--;
+    }
+}
+
+aipudrv::MockCore* aipudrv::MockDevice::find_core(uint32_t job_id)
+{
+    /* m_lock is held by the caller */
+    for (uint32_t i = 0; i < m_cores.size(); i++)
+    {
+        MockCore& core = m_cores[i];
+        for (uint32_t k = 0; k < core.cnt; k++)
+        {
+            if (core.jobs[(core.head + k) % core.jobs.size()].job_id == job_id)
+            {
+                return &core;
+            }
+        }
+    }
+    return nullptr;
+}
+
+aipu_status_t aipudrv::MockDevice::schedule(const JobDesc& job)
+{
+    uint64_t now = 0;
+    uint64_t start = 0;
+    MockCore* core = nullptr;
+    MockJob* slot = nullptr;
+
+    pthread_mutex_lock(&m_lock);
+    now = umd_get_time_ns_helper();
+
+    /* a chained job is queued behind the job it waits for, unless that one is done already;
+     * otherwise the virtual core which becomes free first takes the job */
+    if (0 != job.chain_after)
+    {
+        core = find_core(job.chain_after);
+    }
+    if (nullptr == core)
+    {
+        for (uint32_t i = 0; i < m_cores.size(); i++)
+        {
+            if ((nullptr == core) || (m_cores[i].tail_ns < core->tail_ns))
+            {
+                core = &m_cores[i];
+            }
+        }
+    }
+
+    if (core->cnt == core->jobs.size())
+    {
+        std::vector<MockJob> ring(core->jobs.size() * 2);
+        for (uint32_t i = 0; i < core->cnt; i++)
+        {
+            ring[i] = core->jobs[(core->head + i) % core->jobs.size()];
+        }
+        core->jobs.swap(ring);
+        core->head = 0;
+    }
+
+    start = (core->tail_ns > now) ? core->tail_ns : now;
+    core->tail_ns = start + get_service_time_ns();
+    slot = &core->jobs[(core->head + core->cnt) % core->jobs.size()];
+    slot->done_ns = core->tail_ns;
+    slot->job_id = job.kdesc.job_id;
+    core->cnt++;
+    m_pending_cnt++;
+    pthread_cond_broadcast(&m_cond);
+    pthread_mutex_unlock(&m_lock);
+
+    return AIPU_STATUS_SUCCESS;
+}
+
+aipu_ll_status_t aipudrv::MockDevice::get_status(aipu_job_status_desc* status, uint32_t max_cnt,
+    uint32_t* cnt)
+{
+    return poll_status(status, max_cnt, cnt, 0, true);
+}
+
+aipu_ll_status_t aipudrv::MockDevice::poll_status(aipu_job_status_desc* status, uint32_t max_cnt,
+    uint32_t* cnt, int32_t time_out, bool of_this_thread)
+{
+    struct timespec ts;
+    uint64_t now = 0;
+    uint64_t deadline = UINT64_MAX;
+    uint64_t wake = 0;
+
+    *cnt = 0;
+    pthread_mutex_lock(&m_lock);
+    now = umd_get_time_ns_helper();
+    pop_done_jobs(now, status, max_cnt, cnt);
+
+    if (time_out > 0)
+    {
+        deadline = now + (uint64_t)time_out * 1000000;
+    }
+
+    /* time_out: < 0 blocks until done; 0 returns at once; > 0 waits for at most time_out ms */
+    while ((*cnt == 0) && (time_out != 0) && (now < deadline))
+    {
+        wake = get_next_done_ns();
+        wake = (wake < deadline) ? wake : deadline;
+        if (UINT64_MAX == wake)
+        {
+            pthread_cond_wait(&m_cond, &m_lock);
+        }
+        else
+        {
+            ts.tv_sec = wake / 1000000000ULL;
+            ts.tv_nsec = wake % 1000000000ULL;
+            pthread_cond_timedwait(&m_cond, &m_lock, &ts);
+        }
+        now = umd_get_time_ns_helper();
+        pop_done_jobs(now, status, max_cnt, cnt);
+    }
+    pthread_mutex_unlock(&m_lock);
+
+    return AIPU_LL_STATUS_SUCCESS;
+}
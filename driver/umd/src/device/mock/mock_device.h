@@ -0,0 +1,123 @@
+/**********************************************************************************
+ * This file is CONFIDENTIAL and any use by you is subject to the terms of the
+ * agreement between you and Arm China or the terms of the agreement between you
+ * and the party authorised by Arm China to disclose this file to you.
+ * The confidential and proprietary information contained in this file
+ * may only be used by a person authorised under and to the extent permitted
+ * by a subsisting licensing agreement from Arm China.
+ *
+ *        (C) Copyright 2020 Arm Technology (China) Co. Ltd.
+ *                    All rights reserved.
+ *
+ * This entire notice must be reproduced on all copies of this file and copies of
+ * this file may only be made by a person if such person is permitted to do so
+ * under the terms of a subsisting license agreement from Arm China.
+ *
+ *********************************************************************************/
+
+/**
+ * @file  mock_device.h
+ * @brief AIPU User Mode Driver (UMD) mock device module header
+ */
+
+#ifndef _MOCK_DEVICE_H_
+#define _MOCK_DEVICE_H_
+
+#include <vector>
+#include <pthread.h>
+#include <assert.h>
+#include "standard_api.h"
+#include "device_base.h"
+#include "simulator/umemory.h"
+#include "type.h"
+
+namespace aipudrv
+{
+#define MOCK_MAX_DEVICE_CNT 8
+
+struct MockJob
+{
+    uint64_t done_ns;
+    uint32_t job_id;
+};
+
+/**
+ * @brief jobs queued on a virtual core with their completion times, in FIFO order
+ *
+ * The ring only grows when it is full, so that a steady job stream does not allocate.
+ */
+struct MockCore
+{
+    std::vector<MockJob> jobs;
+    uint32_t head = 0;
+    uint32_t cnt = 0;
+    uint64_t tail_ns = 0;
+};
+
+/**
+ * @brief Host-only device which completes scheduled jobs by a latency model
+ *
+ * Job buffers live in host memory (UMemory) and nothing is executed. Each job is queued
+ * on the virtual core which becomes free first and completes after a configurable service
+ * time plus jitter, so that UMD runtime overhead and scheduling can be measured and tested
+ * without AIPU or simulator. Completion is evaluated lazily when status is queried, and
+ * reported with the job ID of the job descriptor like the real devices do. A job chained
+ * after a queued job is queued behind it on the same core.
+ * Up to MOCK_MAX_DEVICE_CNT instances model a multi-NPU board, each with its own memory.
+ */
+class MockDevice : public DeviceBase
+{
+private:
+    uint32_t m_index = 0;
+    std::vector<MockCore> m_cores;
+    uint32_t m_pending_cnt = 0;
+    aipu_global_config_mock_device_t m_cfg;
+    uint64_t m_rand_state = 0;
+    pthread_mutex_t m_lock;
+    pthread_cond_t  m_cond;
+
+private:
+    uint64_t get_service_time_ns();
+    uint64_t get_next_done_ns() const;
+    MockCore* find_core(uint32_t job_id);
+    void pop_done_jobs(uint64_t now_ns, aipu_job_status_desc* status, uint32_t max_cnt,
+        uint32_t* cnt);
+
+public:
+    bool has_target(uint32_t arch, uint32_t version, uint32_t config, uint32_t rev)
+    {
+        return true;
+    }
+    bool can_chain_jobs()
+    {
+        return true;
+    }
+    aipu_status_t schedule(const JobDesc& job);
+    aipu_ll_status_t get_status(aipu_job_status_desc* status, uint32_t max_cnt,
+        uint32_t* cnt);
+    aipu_ll_status_t poll_status(aipu_job_status_desc* status, uint32_t max_cnt,
+        uint32_t* cnt, int32_t time_out, bool of_this_thread);
+    aipu_status_t config(const aipu_global_config_mock_device_t* config);
+
+public:
+    static MockDevice* get_mock_device(uint32_t index = 0)
+    {
+        assert(index < MOCK_MAX_DEVICE_CNT);
+        if (nullptr == m_mocks[index])
+        {
+            m_mocks[index] = new MockDevice(index);
+        }
+        m_mocks[index]->inc_ref_cnt();
+        return m_mocks[index];
+    }
+    virtual ~MockDevice();
+    MockDevice(const MockDevice& dev) = delete;
+    MockDevice& operator=(const MockDevice& dev) = delete;
+
+private:
+    MockDevice(uint32_t index);
+    static MockDevice* m_mocks[MOCK_MAX_DEVICE_CNT];
+};
+}
+
+#endif /* _MOCK_DEVICE_H_ */
@@ -0,0 +1,198 @@
+/**********************************************************************************
+ * This file is CONFIDENTIAL and any use by you is subject to the terms of the
+ * agreement between you and Arm China or the terms of the agreement between you
+ * and the party authorised by Arm China to disclose this file to you.
+ * The confidential and proprietary information contained in this file
+ * may only be used by a person authorised under and to the extent permitted
+ * by a subsisting licensing agreement from Arm China.
+ *
+ *        (C) Copyright 2020 Arm Technology (China) Co. Ltd.
+ *                    All rights reserved.
+ *
+ * This entire notice must be reproduced on all copies of this file and copies of
+ * this file may only be made by a person if such person is permitted to do so
+ * under the terms of a subsisting license agreement from Arm China.
+ *
+ *********************************************************************************/
+
+/**
+ * @file  sim_session.cpp
+ * @brief AIPU User Mode Driver (UMD) persistent z1/2/3 simulator session implementation
+ */
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include "sim_session.h"
+#include "utils/log.h"
+
+aipudrv::SimulatorSession::~SimulatorSession()
+{
+    close();
+}
+
+int aipudrv::SimulatorSession::send_msg(const char* msg, size_t len)
+{
+    while (len > 0)
+    {
+        /* no SIGPIPE if the simulator is gone */
+        ssize_t n = send(m_sock, msg, len, MSG_NOSIGNAL);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return -1;
+        }
+        msg += n;
+        len -= n;
+    }
+    return 0;
+}
+
+int aipudrv::SimulatorSession::recv_line(int32_t time_out)
+{
+    struct pollfd pfd;
+
+    pfd.fd = m_sock;
+    pfd.events = POLLIN;
+    m_line_len = 0;
+    while (m_line_len < (SIM_SESSION_LINE_LEN - 1))
+    {
+        char c = 0;
+        int pret = poll(&pfd, 1, time_out);
+        if ((pret < 0) && (errno == EINTR))
+        {
+            continue;
+        }
+        else if (pret <= 0)
+        {
+            return -1;
+        }
+
+        if (read(m_sock, &c, 1) != 1)
+        {
+            return -1;
+        }
+        if (c == '\n')
+        {
+            m_line[m_line_len] = '\0';
+            return 0;
+        }
+        m_line[m_line_len++] = c;
+    }
+    return -1;
+}
+
+aipu_status_t aipudrv::SimulatorSession::open(const std::string& simulator, int dram_fd,
+    uint64_t base, uint64_t size)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    int sv[2];
+    char fd_str[16];
+    char msg[SIM_SESSION_LINE_LEN];
+    pid_t pid = 0;
+
+    close();
+
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sv) != 0)
+    {
+        return AIPU_STATUS_ERROR_OPEN_DEV_FAIL;
+    }
+    snprintf(fd_str, sizeof(fd_str), "%d", sv[1]);
+
+    pid = fork();
+    if (pid < 0)
+    {
+        ::close(sv[0]);
+        ::close(sv[1]);
+        return AIPU_STATUS_ERROR_OPEN_DEV_FAIL;
+    }
+    else if (pid == 0)
+    {
+        /* child: only async-signal-safe calls until exec */
+        fcntl(sv[1], F_SETFD, 0);
+        execl(simulator.c_str(), simulator.c_str(), "--session", fd_str, (char*)NULL);
+        _exit(127);
+    }
+
+    ::close(sv[1]);
+    m_sock = sv[0];
+    m_pid = pid;
+    m_simulator = simulator;
+
+    snprintf(msg, sizeof(msg), "DRAM %d 0x%lx 0x%lx\n", dram_fd, base, size);
+    if ((send_msg(msg, strlen(msg)) != 0) ||
+        (recv_line(SIM_SESSION_HANDSHAKE_MS) != 0) ||
+        (strcmp(m_line, "READY") != 0))
+    {
+        ret = AIPU_STATUS_ERROR_OPEN_DEV_FAIL;
+        close();
+    }
+
+    return ret;
+}
+
+aipu_status_t aipudrv::SimulatorSession::run(const std::string& cfg)
+{
+    int sim_ret = 0;
+
+    if (!is_open())
+    {
+        return AIPU_STATUS_ERROR_INVALID_OP;
+    }
+
+    if ((send_msg(cfg.c_str(), cfg.size()) != 0) ||
+        (send_msg("RUN\n", 4) != 0) ||
+        (recv_line(-1) != 0) ||
+        (sscanf(m_line, "DONE %d", &sim_ret) != 1))
+    {
+        LOG(LOG_ERR, "Simulation session of %s terminated!", m_simulator.c_str());
+        close();
+        return AIPU_STATUS_ERROR_DEV_ABNORMAL;
+    }
+
+    if (sim_ret != 0)
+    {
+        LOG(LOG_ERR, "Simulation execution failed! (simulator ret = %d)", sim_ret);
+        return AIPU_STATUS_ERROR_JOB_EXCEPTION;
+    }
+
+    return AIPU_STATUS_SUCCESS;
+}
+
+void aipudrv::SimulatorSession::close()
+{
+    int status = 0;
+
+    if (m_sock >= 0)
+    {
+        send_msg("EXIT\n", 5);
+        ::close(m_sock);
+        m_sock = -1;
+    }
+
+    if (m_pid > 0)
+    {
+        /* the simulator sees EOF at the latest; do not hang on a stuck one */
+        for (uint32_t i = 0; i < 100; i++)
+        {
+            if (waitpid(m_pid, &status, WNOHANG) != 0)
+            {
+                m_pid = -1;
+                return;
+            }
+            usleep(1000);
+        }
+        kill(m_pid, SIGKILL);
+        waitpid(m_pid, &status, 0);
+        m_pid = -1;
+    }
+}
@@ -0,0 +1,86 @@
+/**********************************************************************************
+ * This file is CONFIDENTIAL and any use by you is subject to the terms of the
+ * agreement between you and Arm China or the terms of the agreement between you
+ * and the party authorised by Arm China to disclose this file to you.
+ * The confidential and proprietary information contained in this file
+ * may only be used by a person authorised under and to the extent permitted
+ * by a subsisting licensing agreement from Arm China.
+ *
+ *        (C) Copyright 2020 Arm Technology (China) Co. Ltd.
+ *                    All rights reserved.
+ *
+ * This entire notice must be reproduced on all copies of this file and copies of
+ * this file may only be made by a person if such person is permitted to do so
+ * under the terms of a subsisting license agreement from Arm China.
+ *
+ *********************************************************************************/
+
+/**
+ * @file  sim_session.h
+ * @brief AIPU User Mode Driver (UMD) persistent z1/2/3 simulator session header
+ */
+
+#ifndef _SIM_SESSION_H_
+#define _SIM_SESSION_H_
+
+#include <string>
+#include <sys/types.h>
+#include "standard_api.h"
+
+namespace aipudrv
+{
+#define SIM_SESSION_LINE_LEN     256
+#define SIM_SESSION_HANDSHAKE_MS 2000
+
+/**
+ * @brief long-lived simulator process which runs jobs without file exchange
+ *
+ * The simulator is launched once as "<simulator> --session <fd>", where fd is a unix
+ * stream socket. Session protocol (text lines):
+ *
+ *     UMD -> SIM: DRAM <memfd> <base> <size>    simulated DRAM shared by memfd
+ *     SIM -> UMD: READY
+ *     UMD -> SIM: <runtime config lines>        as in runtime.cfg, with every
+ *                 RUN                           *_FILEn replaced by *_SIZEn
+ *     SIM -> UMD: DONE <ret>                    ret 0: outputs written to DRAM
+ *     UMD -> SIM: EXIT
+ *
+ * The simulator reads job buffers from and writes outputs into the shared DRAM directly,
+ * so a job costs simulation time only. A simulator without session support fails the
+ * handshake and the caller falls back to the runtime.cfg file flow.
+ */
+class SimulatorSession
+{
+private:
+    std::string m_simulator;
+    pid_t m_pid = -1;
+    int m_sock = -1;
+    char m_line[SIM_SESSION_LINE_LEN];
+    uint32_t m_line_len = 0;
+
+private:
+    int send_msg(const char* msg, size_t len);
+    int recv_line(int32_t time_out);
+
+public:
+    aipu_status_t open(const std::string& simulator, int dram_fd, uint64_t base, uint64_t size);
+    aipu_status_t run(const std::string& cfg);
+    void close();
+    bool is_open() const
+    {
+        return m_pid > 0;
+    }
+    const std::string& get_simulator() const
+    {
+        return m_simulator;
+    }
+
+public:
+    SimulatorSession(){};
+    ~SimulatorSession();
+    SimulatorSession(const SimulatorSession& session) = delete;
+    SimulatorSession& operator=(const SimulatorSession& session) = delete;
+};
+}
+
+#endif /* _SIM_SESSION_H_ */
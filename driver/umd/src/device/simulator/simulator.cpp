@@ -21,22 +21,64 @@
  */
 
 #include <cstring>
+#include <errno.h>
+#include <ftw.h>
+#include <stdlib.h>
+#include <time.h>
 #include <unistd.h>
+#include <sys/stat.h>
 #include <assert.h>
 #include "simulator.h"
 #include "parser_base.h"
+#include "utils/helper.h"
 
 aipudrv::Simulator* aipudrv::Simulator::m_sim = nullptr;
 
 aipudrv::Simulator::Simulator()
 {
+    const char* session = getenv("AIPU_UMD_SIM_SESSION");
+    const char* workers = getenv("AIPU_UMD_SIM_WORKERS");
+    long worker_cnt = sysconf(_SC_NPROCESSORS_ONLN);
+    pthread_condattr_t attr;
+
     m_dev_type = DEV_TYPE_SIMULATOR_LEGACY;
     m_dram = UMemory::get_memory();
+    m_session_enabled = (nullptr == session) || (strcmp(session, "0") != 0);
+    pthread_mutex_init(&m_session_lock, NULL);
+    pthread_mutex_init(&m_dump_lock, NULL);
+    pthread_mutex_init(&m_done_lock, NULL);
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&m_done_cond, &attr);
+    pthread_condattr_destroy(&attr);
+
+    /* one simulation per worker at most: by default as many as host CPUs */
+    if (workers != nullptr)
+    {
+        worker_cnt = atol(workers);
+    }
+    worker_cnt = (worker_cnt < 1) ? 1 : worker_cnt;
+    m_pool.init(worker_cnt);
 }
 
 aipudrv::Simulator::~Simulator()
 {
+    /* jobs in flight are run to completion first */
+    m_pool.deinit();
+    for (auto iter = m_idle_sessions.begin(); iter != m_idle_sessions.end(); iter++)
+    {
+        for (uint32_t i = 0; i < iter->second.size(); i++)
+        {
+            delete iter->second[i];
+        }
+    }
+    m_idle_sessions.clear();
+    pthread_cond_destroy(&m_done_cond);
+    pthread_mutex_destroy(&m_done_lock);
+    pthread_mutex_destroy(&m_session_lock);
+    pthread_mutex_destroy(&m_dump_lock);
     delete m_dram;
+    m_sim = nullptr;
 }
 
 bool aipudrv::Simulator::has_target(uint32_t arch, uint32_t version, uint32_t config, uint32_t rev)
@@ -49,41 +91,224 @@ bool aipudrv::Simulator::has_target(uint32_t arch, uint32_t version, uint32_t co
     return true;
 }
 
-aipu_status_t aipudrv::Simulator::create_simulation_input_file(char* fname, const char* interfix,
-    JOB_ID id, DEV_PA_64 pa, uint32_t size, const JobDesc& job)
+bool aipudrv::Simulator::is_dumped(const std::string& key, DEV_PA_64 pa, uint32_t size,
+    uint64_t hash)
+{
+    auto iter = m_dumps.find(key);
+
+    return (iter != m_dumps.end()) && (iter->second.pa == pa) &&
+        (iter->second.size == size) && (iter->second.hash == hash) &&
+        (access(iter->second.fname.c_str(), F_OK) == 0);
+}
+
+void aipudrv::Simulator::set_dumped(const std::string& key, const std::string& fname,
+    DEV_PA_64 pa, uint32_t size, uint64_t hash)
+{
+    /* only a cache: dropping it costs re-dumps */
+    if (m_dumps.size() >= SIM_DUMP_CACHE_MAX)
+    {
+        m_dumps.clear();
+    }
+    m_dumps[key] = { fname, pa, size, hash };
+}
+
+uint64_t aipudrv::Simulator::get_content_hash(DEV_PA_64 pa, uint32_t size) const
+{
+    char* va = nullptr;
+
+    if (m_dram->pa_to_va(pa, size, &va) != 0)
+    {
+        return 0;
+    }
+    return umd_hash64_helper(va, size);
+}
+
+aipu_status_t aipudrv::Simulator::create_graph_input_file(std::string& fname, const char* interfix,
+    DEV_PA_64 pa, uint32_t size, const JobDesc& job)
 {
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    char buf[FNAME_LEN];
+    std::string key;
+    uint64_t hash = 0;
+
+    /* graph sections are immutable after load: hashed once, shared by all jobs of a graph */
+    snprintf(buf, FNAME_LEN, "%s/Simulation_Graph0x%lx_%s", job.output_dir.c_str(),
+        job.graph_id, interfix);
+    key = buf;
+
+    pthread_mutex_lock(&m_dump_lock);
+    auto iter = m_dumps.find(key);
+    if ((iter != m_dumps.end()) && is_dumped(key, pa, size, iter->second.hash))
+    {
+        fname = iter->second.fname;
+        goto unlock;
+    }
+
+    hash = get_content_hash(pa, size);
+    snprintf(buf, FNAME_LEN, "%s/Simulation_Graph0x%lx_%s_Hash0x%016lx_Base0x%lx_Size0x%x.bin",
+        job.output_dir.c_str(), job.graph_id, interfix, hash, pa, size);
+    fname = buf;
+    ret = m_dram->dump_file(pa, buf, size);
+    if (ret == AIPU_STATUS_SUCCESS)
+    {
+        set_dumped(key, fname, pa, size, hash);
+    }
+
+unlock:
+    pthread_mutex_unlock(&m_dump_lock);
+    return ret;
+}
+
+aipu_status_t aipudrv::Simulator::create_simulation_input_file(char* fname, const char* dir,
+    const char* interfix, JOB_ID id, DEV_PA_64 pa, uint32_t size, bool skip_unchanged)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    std::string key;
+    uint64_t hash = 0;
+    bool dumped = false;
+
     snprintf(fname, FNAME_LEN, "%s/Simulation_JOB0x%lx_%s_Base0x%lx_Size0x%x.bin",
-        job.output_dir.c_str(), id, interfix, pa, size);
-    return m_dram->dump_file(pa, fname, size);
+        dir, id, interfix, pa, size);
+    if (!skip_unchanged)
+    {
+        return m_dram->dump_file(pa, fname, size);
+    }
+
+    key = fname;
+    hash = get_content_hash(pa, size);
+    pthread_mutex_lock(&m_dump_lock);
+    dumped = is_dumped(key, pa, size, hash);
+    pthread_mutex_unlock(&m_dump_lock);
+    if (dumped)
+    {
+        return ret;
+    }
+
+    ret = m_dram->dump_file(pa, fname, size);
+    if (ret == AIPU_STATUS_SUCCESS)
+    {
+        pthread_mutex_lock(&m_dump_lock);
+        set_dumped(key, key, pa, size, hash);
+        pthread_mutex_unlock(&m_dump_lock);
+    }
+    return ret;
+}
+
+void aipudrv::Simulator::build_rtcfg(const JobDesc& job, const SimulationJobCtx* ctx,
+    std::string& cfg)
+{
+    char cfg_item[OPT_LEN];
+    uint32_t input_data_cnt = 4 + job.reuses.size();
+
+    assert((nullptr == ctx) || (job.reuses.size() == ctx->reuses.size()));
+
+    /* job buffers are exchanged by files, or are accessed in shared DRAM by a session */
+    auto add_data = [&](const char* type, uint32_t idx, const std::string* fname, DEV_PA_64 pa,
+        uint32_t size)
+    {
+        if (ctx != nullptr)
+        {
+            snprintf(cfg_item, sizeof(cfg_item), "%s_FILE%u=%s\n", type, idx, fname->c_str());
+        }
+        else
+        {
+            snprintf(cfg_item, sizeof(cfg_item), "%s_SIZE%u=0x%x\n", type, idx, size);
+        }
+        cfg.append(cfg_item);
+        snprintf(cfg_item, sizeof(cfg_item), "%s_BASE%u=0x%x\n", type, idx, (uint32_t)pa);
+        cfg.append(cfg_item);
+    };
+
+    cfg.clear();
+    if (job.aipu_revision == 0)
+    {
+        snprintf(cfg_item, sizeof(cfg_item), "CONFIG=Z%d-%04d\n", job.kdesc.aipu_version, job.kdesc.aipu_config);
+        cfg.append(cfg_item);
+    }
+    else if (job.aipu_revision == AIPU_REVISION_P)
+    {
+        snprintf(cfg_item, sizeof(cfg_item), "CONFIG=Z%d-%04dp\n", job.kdesc.aipu_version, job.kdesc.aipu_config);
+        cfg.append(cfg_item);
+    }
+    snprintf(cfg_item, sizeof(cfg_item), "LOG_LEVEL=%u\n", job.log_level);
+    cfg.append(cfg_item);
+    cfg.append("LOG_FILE=log_default\n");
+    cfg.append("FAST_FWD_INST=0\n");
+    cfg.append("INPUT_INST_CNT=1\n");
+    add_data("INPUT_INST", 0, ctx ? &ctx->text : nullptr, job.instruction_base_pa, job.text_size);
+    snprintf(cfg_item, sizeof(cfg_item), "INPUT_INST_STARTPC0=0x%x\n", (uint32_t)job.kdesc.start_pc_addr);
+    cfg.append(cfg_item);
+    snprintf(cfg_item, sizeof(cfg_item), "INT_PC=0x%x\n", (uint32_t)job.kdesc.intr_handler_addr);
+    cfg.append(cfg_item);
+    snprintf(cfg_item, sizeof(cfg_item), "INPUT_DATA_CNT=%u\n", input_data_cnt);
+    cfg.append(cfg_item);
+    add_data("INPUT_DATA", 0, ctx ? &ctx->rodata : nullptr, job.kdesc.data_0_addr, job.rodata_size);
+    add_data("INPUT_DATA", 1, ctx ? &ctx->stack : nullptr, job.kdesc.data_1_addr, job.stack_size);
+    add_data("INPUT_DATA", 2, ctx ? &ctx->dcr : nullptr, job.dcr_pa, job.dcr_size);
+    add_data("INPUT_DATA", 3, ctx ? &ctx->weight : nullptr, job.weight_pa, job.weight_size);
+    for (uint32_t i = 0; i < job.reuses.size(); i++)
+    {
+        add_data("INPUT_DATA", 4 + i, ctx ? &ctx->reuses[i] : nullptr, job.reuses[i].pa,
+            job.reuses[i].size);
+    }
+
+    snprintf(cfg_item, sizeof(cfg_item), "OUTPUT_DATA_CNT=%u\n", (uint32_t)job.outputs.size());
+    cfg.append(cfg_item);
+    for (uint32_t i = 0; i < job.outputs.size(); i++)
+    {
+        if (ctx != nullptr)
+        {
+            snprintf(cfg_item, sizeof(cfg_item), "OUTPUT_DATA_FILE%u=%s\n", i, ctx->outputs[i].c_str());
+            cfg.append(cfg_item);
+        }
+        snprintf(cfg_item, sizeof(cfg_item), "OUTPUT_DATA_BASE%u=0x%x\n", i, (uint32_t)job.outputs[i].pa);
+        cfg.append(cfg_item);
+        snprintf(cfg_item, sizeof(cfg_item), "OUTPUT_DATA_SIZE%u=0x%x\n", i, (uint32_t)job.outputs[i].size);
+        cfg.append(cfg_item);
+    }
+    cfg.append("RUN_DESCRIPTOR=BIN[0]\n");
 }
 
 aipu_status_t aipudrv::Simulator::update_simulation_rtcfg(const JobDesc& job, SimulationJobCtx& ctx)
 {
     aipu_status_t ret = AIPU_STATUS_SUCCESS;
     char fname[FNAME_LEN];
-    char cfg_fname[FNAME_LEN];
-    char cfg_item[OPT_LEN];
+    char cfg_fname[OPT_LEN];
+    char dir[FNAME_LEN];
+    std::string cfg;
     FILE* fp = NULL;
-    uint32_t input_data_cnt;
+
+    /**
+     * graph sections are shared in output_dir; job files, runtime.cfg and simulator
+     * logs go into a scratch directory of the job so that jobs can run concurrently.
+     * It is named by the UMD job ID, so a job rescheduled reuses its unchanged files.
+     */
+    snprintf(dir, FNAME_LEN, "%s/Simulation_JOB0x%lx", job.output_dir.c_str(), job.job_id);
+    if ((mkdir(dir, 0755) != 0) && (errno != EEXIST))
+    {
+        ret = AIPU_STATUS_ERROR_OPEN_FILE_FAIL;
+        goto finish;
+    }
+    pthread_mutex_lock(&m_dump_lock);
+    m_job_dirs[job.job_id] = dir;
+    pthread_mutex_unlock(&m_dump_lock);
 
     /* text */
-    ret = create_simulation_input_file(fname, "Text", job.kdesc.job_id, job.instruction_base_pa, job.text_size, job);
+    ret = create_graph_input_file(ctx.text, "Text", job.instruction_base_pa, job.text_size, job);
     if (ret != AIPU_STATUS_SUCCESS)
     {
         goto finish;
     }
-    ctx.text = fname;
 
     /* weight */
-    ret = create_simulation_input_file(fname, "Weight", job.kdesc.job_id, job.weight_pa, job.weight_size, job);
+    ret = create_graph_input_file(ctx.weight, "Weight", job.weight_pa, job.weight_size, job);
     if (ret != AIPU_STATUS_SUCCESS)
     {
         goto finish;
     }
-    ctx.weight = fname;
 
     /* rodata */
-    ret = create_simulation_input_file(fname, "Rodata", job.kdesc.job_id, job.kdesc.data_0_addr, job.rodata_size, job);
+    ret = create_simulation_input_file(fname, dir, "Rodata", job.job_id, job.kdesc.data_0_addr, job.rodata_size, true);
     if (ret != AIPU_STATUS_SUCCESS)
     {
         goto finish;
@@ -91,7 +316,7 @@ aipu_status_t aipudrv::Simulator::update_simulation_rtcfg(const JobDesc& job, Si
     ctx.rodata = fname;
 
     /* dcr */
-    ret = create_simulation_input_file(fname, "Descriptor", job.kdesc.job_id, job.dcr_pa, job.dcr_size, job);
+    ret = create_simulation_input_file(fname, dir, "Descriptor", job.job_id, job.dcr_pa, job.dcr_size, true);
     if (ret != AIPU_STATUS_SUCCESS)
     {
         goto finish;
@@ -99,7 +324,7 @@ aipu_status_t aipudrv::Simulator::update_simulation_rtcfg(const JobDesc& job, Si
     ctx.dcr = fname;
 
     /* stack */
-    ret = create_simulation_input_file(fname, "Stack", job.kdesc.job_id, job.kdesc.data_1_addr, job.stack_size, job);
+    ret = create_simulation_input_file(fname, dir, "Stack", job.job_id, job.kdesc.data_1_addr, job.stack_size, true);
     if (ret != AIPU_STATUS_SUCCESS)
     {
         goto finish;
@@ -111,7 +336,7 @@ aipu_status_t aipudrv::Simulator::update_simulation_rtcfg(const JobDesc& job, Si
     {
         char inter_fix[32];
         snprintf(inter_fix, 32, "Reuse%u", i);
-        ret = create_simulation_input_file(fname, inter_fix, job.kdesc.job_id, job.reuses[i].pa, job.reuses[i].size, job);
+        ret = create_simulation_input_file(fname, dir, inter_fix, job.job_id, job.reuses[i].pa, job.reuses[i].size, true);
         if (ret != AIPU_STATUS_SUCCESS)
         {
             goto finish;
@@ -124,7 +349,7 @@ aipu_status_t aipudrv::Simulator::update_simulation_rtcfg(const JobDesc& job, Si
     {
         char inter_fix[32];
         snprintf(inter_fix, 32, "Output%u", i);
-        ret = create_simulation_input_file(fname, inter_fix, job.kdesc.job_id, job.outputs[i].pa, job.outputs[i].size, job);
+        ret = create_simulation_input_file(fname, dir, inter_fix, job.job_id, job.outputs[i].pa, job.outputs[i].size);
         if (ret != AIPU_STATUS_SUCCESS)
         {
             goto finish;
@@ -133,95 +358,132 @@ aipu_status_t aipudrv::Simulator::update_simulation_rtcfg(const JobDesc& job, Si
     }
 
     /* create config file */
-    snprintf(cfg_fname, FNAME_LEN, "%s/runtime.cfg", job.output_dir.c_str());
+    build_rtcfg(job, &ctx, cfg);
+    snprintf(cfg_fname, sizeof(cfg_fname), "%s/runtime.cfg", dir);
     fp = fopen(cfg_fname, "w");
     if (NULL == fp)
     {
         ret = AIPU_STATUS_ERROR_OPEN_FILE_FAIL;
         goto finish;
     }
+    fputs(cfg.c_str(), fp);
+    fclose(fp);
+
+    snprintf(ctx.simulation_cmd, sizeof(ctx.simulation_cmd), "cd %s && %s runtime.cfg", dir,
+        job.simulator.c_str());
+
+finish:
+    return ret;
+}
+
+static int remove_sim_file(const char* path, const struct stat* sb, int flag, struct FTW* ftw)
+{
+    return remove(path);
+}
+
+void aipudrv::Simulator::release_job(JOB_ID id)
+{
+    std::string dir;
+
+    pthread_mutex_lock(&m_dump_lock);
+    auto iter = m_job_dirs.find(id);
+    if (iter == m_job_dirs.end())
+    {
+        pthread_mutex_unlock(&m_dump_lock);
+        return;
+    }
+    dir = iter->second;
+    m_job_dirs.erase(iter);
 
-    /* init config file */
-    if (job.aipu_revision == 0)
+    /* the cached dumps of the job are keyed by their file names in its directory */
+    for (auto dump = m_dumps.lower_bound(dir + "/"); dump != m_dumps.end(); )
     {
-        snprintf(cfg_item, sizeof(cfg_item), "CONFIG=Z%d-%04d\n", job.kdesc.aipu_version, job.kdesc.aipu_config);
+        if (dump->first.compare(0, dir.size() + 1, dir + "/") != 0)
+        {
+            break;
+        }
+        dump = m_dumps.erase(dump);
     }
-    else if (job.aipu_revision == AIPU_REVISION_P)
+    pthread_mutex_unlock(&m_dump_lock);
+
+    /* job dumps, runtime.cfg and simulator logs */
+    if (nftw(dir.c_str(), remove_sim_file, 16, FTW_DEPTH | FTW_PHYS) != 0)
     {
-        snprintf(cfg_item, sizeof(cfg_item), "CONFIG=Z%d-%04dp\n", job.kdesc.aipu_version, job.kdesc.aipu_config);
+        LOG(LOG_WARN, "failed to remove %s", dir.c_str());
     }
-    fputs(cfg_item, fp);
-    snprintf(cfg_item, sizeof(cfg_item), "LOG_LEVEL=%u\n", job.log_level);
-    fputs(cfg_item, fp);
-    snprintf(cfg_item, sizeof(cfg_item), "LOG_FILE=log_default\n");
-    fputs(cfg_item, fp);
-    snprintf(cfg_item, sizeof(cfg_item), "FAST_FWD_INST=0\n");
-    fputs(cfg_item, fp);
-    snprintf(cfg_item, sizeof(cfg_item), "INPUT_INST_CNT=1\n");
-    fputs(cfg_item, fp);
-    snprintf(cfg_item, sizeof(cfg_item), "INPUT_INST_FILE0=%s\n", ctx.text.c_str());
-    fputs(cfg_item, fp);
-    snprintf(cfg_item, sizeof(cfg_item), "INPUT_INST_BASE0=0x%x\n", (uint32_t)job.instruction_base_pa);
-    fputs(cfg_item, fp);
-    snprintf(cfg_item, sizeof(cfg_item), "INPUT_INST_STARTPC0=0x%x\n", (uint32_t)job.kdesc.start_pc_addr);
-    fputs(cfg_item, fp);
-    snprintf(cfg_item, sizeof(cfg_item), "INT_PC=0x%x\n", (uint32_t)job.kdesc.intr_handler_addr);
-    fputs(cfg_item, fp);
-    input_data_cnt = 4 + job.reuses.size();
-    assert(job.reuses.size() == ctx.reuses.size());
-    snprintf(cfg_item, sizeof(cfg_item), "INPUT_DATA_CNT=%u\n", input_data_cnt);
-    fputs(cfg_item, fp);
-    snprintf(cfg_item, sizeof(cfg_item), "INPUT_DATA_FILE0=%s\n", ctx.rodata.c_str());
-    fputs(cfg_item, fp);
-    snprintf(cfg_item, sizeof(cfg_item), "INPUT_DATA_BASE0=0x%x\n", (uint32_t)job.kdesc.data_0_addr);
-    fputs(cfg_item, fp);
-    snprintf(cfg_item, sizeof(cfg_item), "INPUT_DATA_FILE1=%s\n", ctx.stack.c_str());
-    fputs(cfg_item, fp);
-    snprintf(cfg_item, sizeof(cfg_item), "INPUT_DATA_BASE1=0x%x\n", (uint32_t)job.kdesc.data_1_addr);
-    fputs(cfg_item, fp);
-    snprintf(cfg_item, sizeof(cfg_item), "INPUT_DATA_FILE2=%s\n", ctx.dcr.c_str());
-    fputs(cfg_item, fp);
-    snprintf(cfg_item, sizeof(cfg_item), "INPUT_DATA_BASE2=0x%x\n", (uint32_t)job.dcr_pa);
-    fputs(cfg_item, fp);
-    snprintf(cfg_item, sizeof(cfg_item), "INPUT_DATA_FILE3=%s\n", ctx.weight.c_str());
-    fputs(cfg_item, fp);
-    snprintf(cfg_item, sizeof(cfg_item), "INPUT_DATA_BASE3=0x%x\n", (uint32_t)job.weight_pa);
-    fputs(cfg_item, fp);
-    for(uint32_t i = 0; i < job.reuses.size(); i++)
-    {
-        snprintf(cfg_item, sizeof(cfg_item), "INPUT_DATA_FILE%u=%s\n", 4 + i, ctx.reuses[i].c_str());
-        fputs(cfg_item, fp);
-        snprintf(cfg_item, sizeof(cfg_item), "INPUT_DATA_BASE%u=0x%x\n", 4 + i, (uint32_t)job.reuses[i].pa);
-        fputs(cfg_item, fp);
+}
+
+bool aipudrv::Simulator::run_session(const JobDesc& job, aipu_status_t* ret)
+{
+    UMemory* mem = static_cast<UMemory*>(m_dram);
+    SimulatorSession* session = nullptr;
+    std::string cfg;
+
+    if (!m_session_enabled || (mem->get_arena_fd() < 0))
+    {
+        return false;
     }
 
-    snprintf(cfg_item, sizeof(cfg_item), "OUTPUT_DATA_CNT=%u\n", (uint32_t)job.outputs.size());
-    fputs(cfg_item, fp);
-    for (uint32_t i = 0; i < job.outputs.size(); i++)
+    /* an idle session of the simulator is taken, or a new one for a concurrent job */
+    pthread_mutex_lock(&m_session_lock);
+    if (m_no_session.count(job.simulator) != 0)
     {
-        snprintf(cfg_item, sizeof(cfg_item), "OUTPUT_DATA_FILE%u=%s\n", i, ctx.outputs[i].c_str());
-        fputs(cfg_item, fp);
-        snprintf(cfg_item, sizeof(cfg_item), "OUTPUT_DATA_BASE%u=0x%x\n", i, (uint32_t)job.outputs[i].pa);
-        fputs(cfg_item, fp);
-        snprintf(cfg_item, sizeof(cfg_item), "OUTPUT_DATA_SIZE%u=0x%x\n", i, (uint32_t)job.outputs[i].size);
-        fputs(cfg_item, fp);
+        pthread_mutex_unlock(&m_session_lock);
+        return false;
     }
-    snprintf(cfg_item, sizeof(cfg_item), "RUN_DESCRIPTOR=BIN[0]\n");
-    fputs(cfg_item, fp);
-    fclose(fp);
+    std::vector<SimulatorSession*>& idle = m_idle_sessions[job.simulator];
+    if (!idle.empty())
+    {
+        session = idle.back();
+        idle.pop_back();
+    }
+    pthread_mutex_unlock(&m_session_lock);
 
-    snprintf(ctx.simulation_cmd, sizeof(ctx.simulation_cmd), "%s %s", job.simulator.c_str(), cfg_fname);
+    if (nullptr == session)
+    {
+        session = new SimulatorSession();
+        if (session->open(job.simulator, mem->get_arena_fd(), mem->get_base(), mem->size()) !=
+            AIPU_STATUS_SUCCESS)
+        {
+            LOG(LOG_WARN, "%s has no session support, using runtime.cfg", job.simulator.c_str());
+            *ret = AIPU_STATUS_ERROR_DEV_ABNORMAL;
+            goto fallback;
+        }
+        LOG(LOG_DEFAULT, "[UMD SIMULATION] session opened: %s", job.simulator.c_str());
+    }
 
-finish:
-    return ret;
+    build_rtcfg(job, nullptr, cfg);
+    *ret = session->run(cfg);
+    if (AIPU_STATUS_ERROR_DEV_ABNORMAL == *ret)
+    {
+        /* session lost: rerun this job and all later ones by file flow */
+        goto fallback;
+    }
+
+    pthread_mutex_lock(&m_session_lock);
+    m_idle_sessions[job.simulator].push_back(session);
+    pthread_mutex_unlock(&m_session_lock);
+    return true;
+
+fallback:
+    delete session;
+    pthread_mutex_lock(&m_session_lock);
+    m_no_session.insert(job.simulator);
+    pthread_mutex_unlock(&m_session_lock);
+    return false;
 }
 
-aipu_status_t aipudrv::Simulator::schedule(const JobDesc& job)
+aipu_status_t aipudrv::Simulator::run_job(const JobDesc& job)
 {
     aipu_status_t ret = AIPU_STATUS_SUCCESS;
     int sys_ret = 0;
     SimulationJobCtx ctx;
 
+    if (run_session(job, &ret))
+    {
+        return ret;
+    }
+
     ret = update_simulation_rtcfg(job, ctx);
     if (ret != AIPU_STATUS_SUCCESS)
     {
@@ -233,16 +495,19 @@ aipu_status_t aipudrv::Simulator::schedule(const JobDesc& job)
     if (sys_ret == -1)
     {
         LOG(LOG_ERR, "Simulation execution failed!");
+        ret = AIPU_STATUS_ERROR_JOB_EXCEPTION;
         goto error;
     }
     else if (WIFEXITED(sys_ret) && (WEXITSTATUS(sys_ret) != 0))
     {
         LOG(LOG_ERR, "Simulation execution failed! (simulator ret = %d)", WEXITSTATUS(sys_ret));
+        ret = AIPU_STATUS_ERROR_JOB_EXCEPTION;
         goto error;
     }
     else if (WIFSIGNALED(sys_ret))
     {
         LOG(LOG_ERR, "Simulation terminated by signal %d!", WTERMSIG(sys_ret));
+        ret = AIPU_STATUS_ERROR_JOB_EXCEPTION;
         goto error;
     }
 
@@ -259,6 +524,92 @@ error:
     return ret;
 }
 
+aipu_status_t aipudrv::Simulator::schedule(const JobDesc& job)
+{
+    pthread_t thread = pthread_self();
+
+    /* the job is run by a worker and reported via get_status/poll_status when done */
+    m_pool.submit(nullptr, [this, job, thread]()
+    {
+        SimulationDone done;
+
+        memset(&done.status, 0, sizeof(done.status));
+        done.status.job_id = job.kdesc.job_id;
+        done.status.state = (run_job(job) == AIPU_STATUS_SUCCESS) ?
+            AIPU_JOB_STATE_DONE : AIPU_JOB_STATE_EXCEPTION;
+        done.thread = thread;
+
+        pthread_mutex_lock(&m_done_lock);
+        m_done.push_back(done);
+        pthread_cond_broadcast(&m_done_cond);
+        pthread_mutex_unlock(&m_done_lock);
+    });
+
+    return AIPU_STATUS_SUCCESS;
+}
+
+void aipudrv::Simulator::pop_done_jobs(aipu_job_status_desc* status, uint32_t max_cnt,
+    uint32_t* cnt, bool of_this_thread)
+{
+    pthread_t self = pthread_self();
+
+    for (auto iter = m_done.begin(); (iter != m_done.end()) && (*cnt < max_cnt); )
+    {
+        if (of_this_thread && !pthread_equal(iter->thread, self))
+        {
+            iter++;
+            continue;
+        }
+        status[(*cnt)++] = iter->status;
+        iter = m_done.erase(iter);
+    }
+}
+
+aipu_ll_status_t aipudrv::Simulator::get_status(aipu_job_status_desc* status, uint32_t max_cnt,
+    uint32_t* cnt)
+{
+    return poll_status(status, max_cnt, cnt, 0, true);
+}
+
+aipu_ll_status_t aipudrv::Simulator::poll_status(aipu_job_status_desc* status, uint32_t max_cnt,
+    uint32_t* cnt, int32_t time_out, bool of_this_thread)
+{
+    struct timespec ts;
+
+    *cnt = 0;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    if (time_out > 0)
+    {
+        ts.tv_sec += time_out / 1000;
+        ts.tv_nsec += (time_out % 1000) * 1000000L;
+        if (ts.tv_nsec >= 1000000000L)
+        {
+            ts.tv_sec++;
+            ts.tv_nsec -= 1000000000L;
+        }
+    }
+
+    /* time_out: < 0 blocks until done; 0 returns at once; > 0 waits for at most time_out ms */
+    pthread_mutex_lock(&m_done_lock);
+    pop_done_jobs(status, max_cnt, cnt, of_this_thread);
+    while ((*cnt == 0) && (time_out != 0))
+    {
+        if (time_out < 0)
+        {
+            pthread_cond_wait(&m_done_cond, &m_done_lock);
+        }
+        else if (pthread_cond_timedwait(&m_done_cond, &m_done_lock, &ts) == ETIMEDOUT)
+        {
+            pop_done_jobs(status, max_cnt, cnt, of_this_thread);
+            break;
+        }
+        pop_done_jobs(status, max_cnt, cnt, of_this_thread);
+    }
+    pthread_mutex_unlock(&m_done_lock);
+
+    return AIPU_LL_STATUS_SUCCESS;
+}
+
 aipu_status_t aipudrv::Simulator::set_sim_log_level(uint32_t level)
 {
     return AIPU_STATUS_SUCCESS;
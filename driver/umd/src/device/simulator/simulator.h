@@ -24,11 +24,16 @@
 #define _SIMULATOR_H_
 
 #include <map>
+#include <set>
+#include <deque>
 #include <vector>
 #include <string>
+#include <pthread.h>
 #include "standard_api.h"
 #include "device_base.h"
 #include "umemory.h"
+#include "sim_session.h"
+#include "utils/thread_pool.h"
 #include "type.h"
 #include "utils/debug.h"
 
@@ -37,12 +42,14 @@ namespace aipudrv
 #define FNAME_LEN 2048
 #define OPT_LEN   2148
 #define CMD_MEN   4096
+#define SIM_DUMP_CACHE_MAX 4096
 
 struct SimulationData
 {
     std::string fname;
     DEV_PA_64   pa;
     uint32_t    size;
+    uint64_t    hash;
 };
 
 struct SimulationJobCtx
@@ -57,21 +64,71 @@ struct SimulationJobCtx
     char simulation_cmd[CMD_MEN];
 };
 
+struct SimulationDone
+{
+    aipu_job_status_desc status;
+    pthread_t thread;
+};
+
+/**
+ * @brief z1/2/3 simulator device
+ *
+ * Jobs run in a persistent session of the simulator binary which shares the simulated
+ * DRAM (see SimulatorSession). Simulators without session support, or all simulators
+ * if AIPU_UMD_SIM_SESSION=0, run one process per job with buffers exchanged by files.
+ * In the file flow, text & weight are dumped once per graph and job buffers are only
+ * dumped again when their content changed; the scratch directory of a job is reused by
+ * all its runs and removed when the job is destroyed.
+ *
+ * Scheduled jobs run concurrently on a bounded worker pool (AIPU_UMD_SIM_WORKERS, by
+ * default one per host CPU) and are reported by get_status/poll_status when done.
+ */
 class Simulator : public DeviceBase
 {
 private:
-    aipu_status_t create_simulation_input_file(char* fname, const char* interfix,
-        JOB_ID id, DEV_PA_64 pa, uint32_t size, const JobDesc& job);
+    bool m_session_enabled = true;
+    std::map<std::string, std::vector<SimulatorSession*>> m_idle_sessions;
+    std::set<std::string> m_no_session;
+    pthread_mutex_t m_session_lock;
+    /* dumped input files: graph sections by graph & section, job buffers by file name */
+    std::map<std::string, SimulationData> m_dumps;
+    /* scratch directories of the jobs, removed when a job is destroyed */
+    std::map<JOB_ID, std::string> m_job_dirs;
+    pthread_mutex_t m_dump_lock;
+    ThreadPool m_pool;
+    std::deque<SimulationDone> m_done;
+    pthread_mutex_t m_done_lock;
+    pthread_cond_t  m_done_cond;
+
+private:
+    bool is_dumped(const std::string& key, DEV_PA_64 pa, uint32_t size, uint64_t hash);
+    void set_dumped(const std::string& key, const std::string& fname, DEV_PA_64 pa,
+        uint32_t size, uint64_t hash);
+    uint64_t get_content_hash(DEV_PA_64 pa, uint32_t size) const;
+    aipu_status_t create_graph_input_file(std::string& fname, const char* interfix,
+        DEV_PA_64 pa, uint32_t size, const JobDesc& job);
+    aipu_status_t create_simulation_input_file(char* fname, const char* dir, const char* interfix,
+        JOB_ID id, DEV_PA_64 pa, uint32_t size, bool skip_unchanged = false);
+    void build_rtcfg(const JobDesc& job, const SimulationJobCtx* ctx, std::string& cfg);
     aipu_status_t update_simulation_rtcfg(const JobDesc& job, SimulationJobCtx& ctx);
+    bool run_session(const JobDesc& job, aipu_status_t* ret);
+    aipu_status_t run_job(const JobDesc& job);
+    void pop_done_jobs(aipu_job_status_desc* status, uint32_t max_cnt, uint32_t* cnt,
+        bool of_this_thread);
 
 public:
     bool has_target(uint32_t arch, uint32_t version, uint32_t config, uint32_t rev);
     aipu_status_t schedule(const JobDesc& job);
+    aipu_ll_status_t get_status(aipu_job_status_desc* status, uint32_t max_cnt,
+        uint32_t* cnt);
+    aipu_ll_status_t poll_status(aipu_job_status_desc* status, uint32_t max_cnt,
+        uint32_t* cnt, int32_t time_out, bool of_this_thread);
     aipu_status_t get_simulation_instance(void** simulator, void** memory)
     {
         return AIPU_STATUS_ERROR_INVALID_OP;
     }
     aipu_status_t set_sim_log_level(uint32_t level);
+    void release_job(JOB_ID id);
 
 public:
     static Simulator* get_simulator()
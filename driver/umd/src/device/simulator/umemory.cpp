@@ -21,6 +21,9 @@
  */
 
 #include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
 #include <cstring>
 #include <assert.h>
 #include "umemory.h"
@@ -37,15 +40,54 @@ aipudrv::UMemory::UMemory(): MemoryBase(), sim_aipu::IMemEngine()
     m_bit_cnt = m_size / PAGE_SIZE;
     m_bitmap = new bool[m_bit_cnt];
     memset(m_bitmap, 1, m_bit_cnt);
+    create_arena();
+}
+
+void aipudrv::UMemory::create_arena()
+{
+#if (defined __NR_memfd_create)
+    /* pages of a memfd are only committed when touched, so the arena is cheap */
+    m_arena_fd = syscall(__NR_memfd_create, "aipu_umemory", 0);
+    if (m_arena_fd < 0)
+    {
+        return;
+    }
+
+    if (ftruncate(m_arena_fd, m_size) == 0)
+    {
+        m_arena = (char*)mmap(NULL, m_size, PROT_READ | PROT_WRITE, MAP_SHARED, m_arena_fd, 0);
+        if (m_arena != MAP_FAILED)
+        {
+            return;
+        }
+    }
+
+    LOG(LOG_WARN, "memfd arena unavailable, using heap buffers");
+    close(m_arena_fd);
+    m_arena_fd = -1;
+    m_arena = nullptr;
+#endif
 }
 
 aipudrv::UMemory::~UMemory()
 {
     auto bm_iter = m_allocated.begin();
     delete[] m_bitmap;
-    for (; bm_iter != m_allocated.end(); bm_iter++)
+    if (m_arena != nullptr)
+    {
+        munmap(m_arena, m_size);
+        close(m_arena_fd);
+    }
+    else
+    {
+        for (; bm_iter != m_allocated.end(); bm_iter++)
+        {
+            delete[] bm_iter->second.va;
+        }
+    }
+    if (m_mem == this)
     {
-        delete[] bm_iter->second.va;
+        m_mem = nullptr;
     }
 }
 
@@ -113,7 +155,14 @@ aipu_status_t aipudrv::UMemory::malloc(uint32_t size, uint32_t align, BufferDesc
         {
             desc->init(m_base + i * 4096, malloc_size, size);
             buf.desc = *desc;
-            buf.va = new char[malloc_size];
+            if (m_arena != nullptr)
+            {
+                buf.va = m_arena + (desc->pa - m_base);
+            }
+            else
+            {
+                buf.va = new char[malloc_size];
+            }
             memset(buf.va, 0, malloc_size);
             m_allocated[desc->pa] = buf;
             for (uint32_t j = 0; j < malloc_page; j++)
@@ -126,6 +175,11 @@ aipu_status_t aipudrv::UMemory::malloc(uint32_t size, uint32_t align, BufferDesc
     }
     pthread_rwlock_unlock(&m_lock);
 
+    if (ret == AIPU_STATUS_SUCCESS)
+    {
+        notify_alloc(*desc, align);
+    }
+
 #if RTDEBUG_TRACKING_MEM_OPERATION
     if (ret == AIPU_STATUS_SUCCESS)
     {
@@ -166,12 +220,25 @@ aipu_status_t aipudrv::UMemory::free(const BufferDesc* desc, const char* str)
     {
         m_bitmap[i] = 1;
     }
-    delete[] iter->second.va;
+    if (m_arena != nullptr)
+    {
+        /* give the pages back: the arena is sparse */
+        madvise(iter->second.va, iter->second.desc.size, MADV_REMOVE);
+    }
+    else
+    {
+        delete[] iter->second.va;
+    }
     m_allocated.erase(desc->pa);
 
 unlock:
     pthread_rwlock_unlock(&m_lock);
 
+    if (ret == AIPU_STATUS_SUCCESS)
+    {
+        notify_free(*desc);
+    }
+
 #if RTDEBUG_TRACKING_MEM_OPERATION
     if (ret == AIPU_STATUS_SUCCESS)
     {
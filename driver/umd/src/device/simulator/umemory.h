@@ -35,9 +35,12 @@ private:
     uint64_t m_size = 512 * MB_SIZE;
     uint64_t m_bit_cnt;
     bool*    m_bitmap;
+    int      m_arena_fd = -1;
+    char*    m_arena = nullptr;
 
 private:
     uint32_t get_next_alinged_page_no(uint32_t start, uint32_t align);
+    void     create_arena();
     auto     get_allocated_buffer(uint64_t addr) const;
 
 public:
@@ -63,6 +66,24 @@ public:
     {
         return (addr < m_base) || (addr >= (m_base + m_size));
     };
+    virtual uint64_t get_capacity() const
+    {
+        return m_size;
+    }
+
+public:
+    /**
+     * @brief memfd backing the whole simulated DRAM (buffer at PA is at offset PA - base),
+     *        which can be mapped by a simulator process; -1 if buffers are heap allocated
+     */
+    int get_arena_fd() const
+    {
+        return m_arena_fd;
+    }
+    uint64_t get_base() const
+    {
+        return m_base;
+    }
 
 public:
     static UMemory* get_memory()
@@ -73,6 +94,11 @@ public:
         }
         return m_mem;
     }
+    /* private memory of a device other than the one sharing get_memory() */
+    static UMemory* create_memory()
+    {
+        return new UMemory();
+    }
     virtual ~UMemory();
     UMemory(const UMemory& mem) = delete;
     UMemory& operator=(const UMemory& mem) = delete;
@@ -21,6 +21,7 @@
  */
 
 #include <cstring>
+#include <stdlib.h>
 #include <unistd.h>
 #include <assert.h>
 #include "z5_simulator.h"
@@ -29,6 +30,8 @@ aipudrv::Z5Simulator* aipudrv::Z5Simulator::m_sim = nullptr;
 
 aipudrv::Z5Simulator::Z5Simulator(const aipu_global_config_simulation_t* cfg)
 {
+    const char* instances = getenv("AIPU_UMD_SIM_INSTANCES");
+
     m_dev_type = DEV_TYPE_SIMULATOR_Z5;
     m_dram = UMemory::get_memory();
     if (nullptr == cfg)
@@ -41,21 +44,33 @@ aipudrv::Z5Simulator::Z5Simulator(const aipu_global_config_simulation_t* cfg)
         m_log_level = cfg->log_level;
         m_verbose = cfg->verbose;
     }
+    if ((instances != nullptr) && (atoi(instances) > 0))
+    {
+        m_instance_cnt = atoi(instances);
+    }
     pthread_rwlock_init(&m_lock, NULL);
+    pthread_mutex_init(&m_job_lock, NULL);
 }
 
 aipudrv::Z5Simulator::~Z5Simulator()
 {
-    if (m_aipu != nullptr)
+    for (uint32_t i = 0; i < m_instances.size(); i++)
     {
-        if (cmd_pool_created())
+        Z5SimInstance* inst = m_instances[i];
+        if (inst->cmd_pool.pool != nullptr)
         {
-            m_aipu->write_register(TSM_CMD_SCHED_CTRL, DESTROY_CMD_POOL);
+            inst->aipu->write_register(TSM_CMD_SCHED_CTRL, DESTROY_CMD_POOL);
+            delete inst->cmd_pool.pool;
         }
-        delete m_aipu;
+        delete inst->aipu;
+        pthread_mutex_destroy(&inst->lock);
+        delete inst;
     }
+    m_instances.clear();
+    pthread_mutex_destroy(&m_job_lock);
     pthread_rwlock_destroy(&m_lock);
     delete m_dram;
+    m_sim = nullptr;
 }
 
 bool aipudrv::Z5Simulator::has_target(uint32_t arch, uint32_t version, uint32_t config, uint32_t rev)
@@ -74,22 +89,23 @@ bool aipudrv::Z5Simulator::has_target(uint32_t arch, uint32_t version, uint32_t
     }
 
     pthread_rwlock_wrlock(&m_lock);
-    if (m_aipu != nullptr)
+    if (!m_instances.empty())
     {
         ret = (code == m_code);
         goto unlock;
     }
 
     m_config = z5_sim_create_config(code, m_log_level, m_verbose);
-    m_aipu = new sim_aipu::Aipu(m_config, static_cast<UMemory&>(*m_dram));
-    if (m_aipu == nullptr)
+    for (uint32_t i = 0; i < m_instance_cnt; i++)
     {
-        ret = false;
-        goto unlock;
+        Z5SimInstance* inst = new Z5SimInstance();
+        inst->aipu = new sim_aipu::Aipu(m_config, static_cast<UMemory&>(*m_dram));
+        pthread_mutex_init(&inst->lock, NULL);
+        m_instances.push_back(inst);
     }
 
     m_code = code;
-    m_aipu->read_register(CLUSTER0_CONFIG, m_core_cnt);
+    m_instances[0]->aipu->read_register(CLUSTER0_CONFIG, m_core_cnt);
     m_core_cnt = (m_core_cnt >> 8) & 0xF;
     ret = true;
 
@@ -98,66 +114,242 @@ unlock:
     return ret;
 }
 
+aipudrv::Z5SimInstance* aipudrv::Z5Simulator::find_instance(uint32_t job_id)
+{
+    /* m_job_lock is held by the caller */
+    for (uint32_t i = 0; i < m_instances.size(); i++)
+    {
+        const Z5SimCmdPool& cmd_pool = m_instances[i]->cmd_pool;
+        for (uint32_t k = 0; k < cmd_pool.pending.size(); k++)
+        {
+            if (cmd_pool.pending[k].status.job_id == job_id)
+            {
+                return m_instances[i];
+            }
+        }
+        for (uint32_t k = 0; k < cmd_pool.waiting.size(); k++)
+        {
+            if (cmd_pool.waiting[k].status.job_id == job_id)
+            {
+                return m_instances[i];
+            }
+        }
+    }
+    return nullptr;
+}
+
 aipu_status_t aipudrv::Z5Simulator::schedule(const JobDesc& job)
 {
     aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    Z5SimInstance* inst = nullptr;
+    Z5SimInstance* chained = nullptr;
+    Z5SimCmdPool* cmd_pool = nullptr;
+    uint32_t value = 0;
+    uint32_t waited_us = 0;
+    bool kick = false;
+    bool wait = false;
+    Z5SimJob entry;
 
-    assert(m_aipu != nullptr);
+    assert(!m_instances.empty());
 
-    pthread_rwlock_wrlock(&m_lock);
-    if (cmd_pool_created() == false)
+    memset(&entry.status, 0, sizeof(entry.status));
+    entry.status.job_id = job.kdesc.job_id;
+    entry.status.state = AIPU_JOB_STATE_DONE;
+    entry.thread = pthread_self();
+    entry.tcb_head = job.tcb_head;
+    entry.tcb_tail = job.tcb_tail;
+
+    /* dispatcher: an idle instance takes the job, otherwise the one with the fewest jobs;
+     * a job chained after a job not done yet goes to the instance of that job */
+    pthread_mutex_lock(&m_job_lock);
+    if (0 != job.chain_after)
+    {
+        chained = find_instance(job.chain_after);
+    }
+    inst = chained;
+    for (uint32_t i = 0; (nullptr == chained) && (i < m_instances.size()); i++)
+    {
+        if ((nullptr == inst) || (m_instances[i]->cmd_pool.occupancy() < inst->cmd_pool.occupancy()))
+        {
+            inst = m_instances[i];
+        }
+        if (0 == inst->cmd_pool.occupancy())
+        {
+            break;
+        }
+    }
+    pthread_mutex_unlock(&m_job_lock);
+    cmd_pool = &inst->cmd_pool;
+
+    /* the jobs of a pool change only under its instance lock; a full ring is retired and
+     * refilled here once it drains, and a full waiting list blocks the producer */
+    pthread_mutex_lock(&inst->lock);
+    while ((nullptr != cmd_pool->pool) && (cmd_pool->pending.size() >= Z5_SIM_CMD_RING_SIZE))
+    {
+        retire_jobs(inst);
+        if ((cmd_pool->pending.size() < Z5_SIM_CMD_RING_SIZE) ||
+            (cmd_pool->waiting.size() < Z5_SIM_CMD_WAIT_SIZE))
+        {
+            break;
+        }
+        if (waited_us >= Z5_SIM_SCHED_TIMEOUT_MS * 1000)
+        {
+            pthread_mutex_unlock(&inst->lock);
+            LOG(LOG_ERR, "command pool still full after %u ms", Z5_SIM_SCHED_TIMEOUT_MS);
+            return AIPU_STATUS_ERROR_JOB_TIMEOUT;
+        }
+        pthread_mutex_unlock(&inst->lock);
+        usleep(Z5_SIM_POLL_US);
+        waited_us += Z5_SIM_POLL_US;
+        pthread_mutex_lock(&inst->lock);
+    }
+
+    if (nullptr == cmd_pool->pool)
+    {
+        cmd_pool->pool = new CmdPool(m_dram, job.tcb_tail);
+        inst->aipu->write_register(TSM_CMD_SCHED_ADDR_HI, get_high_32(job.tcb_head));
+        inst->aipu->write_register(TSM_CMD_SCHED_ADDR_LO, get_low_32(job.tcb_head));
+        inst->aipu->write_register(TSM_CMD_SCHED_CTRL, CREATE_CMD_POOL);
+        kick = true;
+    }
+    else if (!cmd_pool->waiting.empty() || (cmd_pool->pending.size() >= Z5_SIM_CMD_RING_SIZE))
     {
-        CmdPool pool(m_dram, job.tcb_head, job.tcb_tail);
-        m_cmd_pools.push_back(pool);
-        m_aipu->write_register(TSM_CMD_SCHED_ADDR_HI, get_high_32(job.tcb_head));
-        m_aipu->write_register(TSM_CMD_SCHED_ADDR_LO, get_low_32(job.tcb_head));
-        m_aipu->write_register(TSM_CMD_SCHED_CTRL, CREATE_CMD_POOL);
+        /* linked by the poller when the ring drains, behind the jobs waiting before it */
+        wait = true;
     }
     else
     {
-        m_cmd_pools[0].update_tcb(job.tcb_head, job.tcb_tail);
+        kick = cmd_pool->pool->drained();
+        cmd_pool->pool->update_tcb(job.tcb_head, job.tcb_tail);
+        if (!kick)
+        {
+            /* the device may have stopped at the old tail before the link was written */
+            inst->aipu->read_register(CMD_POOL0_STATUS, value);
+            kick = (value & CMD_POOL0_IDLE);
+        }
     }
-    pthread_rwlock_unlock(&m_lock);
 
-    LOG(LOG_INFO, "triggering simulator...");
-    m_aipu->write_register(TSM_CMD_SCHED_CTRL, DISPATCH_CMD_POOL);
+    /* pending before dispatch: an idle pool is only evaluated under the instance lock */
+    pthread_mutex_lock(&m_job_lock);
+    if (wait)
+    {
+        cmd_pool->waiting.push_back(entry);
+    }
+    else
+    {
+        cmd_pool->pending.push_back(entry);
+    }
+    pthread_mutex_unlock(&m_job_lock);
+
+    if (kick)
+    {
+        LOG(LOG_INFO, "triggering simulator...");
+        inst->aipu->write_register(TSM_CMD_SCHED_CTRL, DISPATCH_CMD_POOL);
+    }
+    pthread_mutex_unlock(&inst->lock);
 
     return ret;
 }
 
-aipu_ll_status_t aipudrv::Z5Simulator::get_status(std::vector<aipu_job_status_desc>& jobs_status,
-    uint32_t max_cnt)
+void aipudrv::Z5Simulator::retire_jobs(Z5SimInstance* inst)
 {
+    Z5SimCmdPool* cmd_pool = &inst->cmd_pool;
     uint32_t value = 0;
-    aipu_job_status_desc desc;
 
-    m_aipu->read_register(CMD_POOL0_STATUS, value);
-    if (value & CMD_POOL0_IDLE)
+    /* inst->lock is held by the caller */
+    inst->aipu->read_register(CMD_POOL0_STATUS, value);
+    if (!(value & CMD_POOL0_IDLE))
     {
-        desc.state = AIPU_JOB_STATE_DONE;
-        jobs_status.push_back(desc);
+        return;
+    }
+
+    pthread_mutex_lock(&m_job_lock);
+    cmd_pool->pool->retire(cmd_pool->pending.size());
+    m_done.insert(m_done.end(), cmd_pool->pending.begin(), cmd_pool->pending.end());
+    cmd_pool->pending.clear();
+
+    /* the drained ring is fed with the waiting jobs and dispatched again */
+    while (!cmd_pool->waiting.empty() && (cmd_pool->pending.size() < Z5_SIM_CMD_RING_SIZE))
+    {
+        const Z5SimJob& next = cmd_pool->waiting.front();
+        cmd_pool->pool->update_tcb(next.tcb_head, next.tcb_tail);
+        cmd_pool->pending.push_back(next);
+        cmd_pool->waiting.pop_front();
+    }
+    pthread_mutex_unlock(&m_job_lock);
+
+    if (!cmd_pool->pending.empty())
+    {
+        LOG(LOG_INFO, "triggering simulator...");
+        inst->aipu->write_register(TSM_CMD_SCHED_CTRL, DISPATCH_CMD_POOL);
     }
-    return AIPU_LL_STATUS_SUCCESS;
 }
 
-aipu_ll_status_t aipudrv::Z5Simulator::poll_status(std::vector<aipu_job_status_desc>& jobs_status,
-    uint32_t max_cnt, int32_t time_out, bool of_this_thread)
+void aipudrv::Z5Simulator::collect_done_jobs(aipu_job_status_desc* status, uint32_t max_cnt,
+    uint32_t* cnt, bool of_this_thread)
 {
-    uint32_t value = 0;
-    aipu_job_status_desc desc;
+    pthread_t self = pthread_self();
 
-    while (m_aipu->read_register(CMD_POOL0_STATUS, value) > 0)
+    for (uint32_t i = 0; i < m_instances.size(); i++)
     {
-        if (value & CMD_POOL0_IDLE)
+        Z5SimInstance* inst = m_instances[i];
+        bool has_pending = false;
+
+        pthread_mutex_lock(&m_job_lock);
+        has_pending = !inst->cmd_pool.pending.empty();
+        pthread_mutex_unlock(&m_job_lock);
+
+        /* an instance being dispatched is checked next time */
+        if (!has_pending || (pthread_mutex_trylock(&inst->lock) != 0))
         {
-            LOG(LOG_INFO, "simulation done.");
-            break;
+            continue;
         }
-        sleep(1);
-        LOG(LOG_INFO, "wait for simulation execution...");
+
+        if (inst->cmd_pool.pool != nullptr)
+        {
+            retire_jobs(inst);
+        }
+        pthread_mutex_unlock(&inst->lock);
+    }
+
+    pthread_mutex_lock(&m_job_lock);
+    for (auto iter = m_done.begin(); (iter != m_done.end()) && (*cnt < max_cnt); )
+    {
+        if (of_this_thread && !pthread_equal(iter->thread, self))
+        {
+            iter++;
+            continue;
+        }
+        status[(*cnt)++] = iter->status;
+        iter = m_done.erase(iter);
     }
+    pthread_mutex_unlock(&m_job_lock);
+}
 
-    desc.state = AIPU_JOB_STATE_DONE;
-    jobs_status.push_back(desc);
+aipu_ll_status_t aipudrv::Z5Simulator::get_status(aipu_job_status_desc* status, uint32_t max_cnt,
+    uint32_t* cnt)
+{
+    return poll_status(status, max_cnt, cnt, 0, true);
+}
+
+aipu_ll_status_t aipudrv::Z5Simulator::poll_status(aipu_job_status_desc* status, uint32_t max_cnt,
+    uint32_t* cnt, int32_t time_out, bool of_this_thread)
+{
+    int64_t waited_us = 0;
+
+    /* time_out: < 0 blocks until done; 0 returns at once; > 0 waits for at most time_out ms */
+    *cnt = 0;
+    collect_done_jobs(status, max_cnt, cnt, of_this_thread);
+    while ((*cnt == 0) && ((time_out < 0) || (waited_us < (int64_t)time_out * 1000)))
+    {
+        usleep(Z5_SIM_POLL_US);
+        waited_us += Z5_SIM_POLL_US;
+        collect_done_jobs(status, max_cnt, cnt, of_this_thread);
+    }
+
+    if (*cnt != 0)
+    {
+        LOG(LOG_INFO, "simulation done.");
+    }
     return AIPU_LL_STATUS_SUCCESS;
-}
\ No newline at end of file
+}
@@ -24,7 +24,11 @@
 #define _Z5_SIMULATOR_H_
 
 #include <map>
+#include <deque>
+#include <stddef.h>
+#include <vector>
 #include <pthread.h>
+#include <assert.h>
 #include "standard_api.h"
 #include "device_base.h"
 #include "umemory.h"
@@ -35,70 +39,158 @@
 
 namespace aipudrv
 {
+#define Z5_SIM_CMD_RING_SIZE 16
+
+/**
+ * @brief long-lived command pool used as a ring of TCB chains
+ *
+ * The host produces by linking a chain behind the tail and the device consumes along the
+ * next pointers without being kicked again; only a drained ring needs a dispatch.
+ * Completion is observed pool-wide (idle): neither a TCB nor a register of the simulator
+ * tells how far the device is along the ring, so retire() consumes the chains linked so far.
+ */
 class CmdPool
 {
 private:
     MemoryBase* m_dram = nullptr;
-    DEV_PA_64 m_tcb_head = 0;
     DEV_PA_64 m_tcb_tail = 0;
+    uint32_t m_prod = 0;
+    uint32_t m_cons = 0;
 
 public:
+    /* only the next pointer of the previous tail is written: no read-modify-write */
     void update_tcb(DEV_PA_64 head, DEV_PA_64 tail)
     {
-        tcb_t prev;
-        m_dram->read(m_tcb_tail, &prev, sizeof(prev));
-        prev.next = get_low_32(head);
-        m_dram->write(m_tcb_tail, &prev, sizeof(prev));
+        uint32_t next = get_low_32(head);
+        m_dram->write(m_tcb_tail + offsetof(tcb_t, next), &next, sizeof(next));
         m_tcb_tail = tail;
+        m_prod++;
+    }
+    void retire(uint32_t cnt)
+    {
+        assert(cnt <= in_flight());
+        m_cons += cnt;
+    }
+    uint32_t in_flight() const
+    {
+        return m_prod - m_cons;
+    }
+    bool drained() const
+    {
+        return m_prod == m_cons;
     }
 
 public:
-    CmdPool(MemoryBase* mem, DEV_PA_64 head, DEV_PA_64 tail)
+    CmdPool(MemoryBase* mem, DEV_PA_64 tail)
     {
         m_dram = mem;
-        m_tcb_head = head;
         m_tcb_tail = tail;
+        m_prod = 1;
+    }
+};
+
+#define Z5_SIM_CMD_WAIT_SIZE      16
+#define Z5_SIM_POLL_US            1000
+#define Z5_SIM_SCHED_TIMEOUT_MS   60000
+
+struct Z5SimJob
+{
+    aipu_job_status_desc status;
+    pthread_t thread;
+    DEV_PA_64 tcb_head;
+    DEV_PA_64 tcb_tail;
+};
+
+/**
+ * @brief jobs of a command pool: linked into its ring, or waiting to be linked when the
+ *        ring drains because Z5_SIM_CMD_RING_SIZE chains are linked already; at most
+ *        Z5_SIM_CMD_WAIT_SIZE jobs wait
+ */
+struct Z5SimCmdPool
+{
+    CmdPool* pool = nullptr;
+    std::deque<Z5SimJob> pending;
+    std::deque<Z5SimJob> waiting;
+    uint32_t occupancy() const
+    {
+        return pending.size() + waiting.size();
     }
 };
 
+/**
+ * @brief one simulated NPU of the farm, with the single command pool its registers
+ *        (TSM_CMD_SCHED_[*], CMD_POOL0_STATUS) control
+ *
+ * The simulator selects no other pool and reports no other pool status, so jobs overlap
+ * only across instances, not across pools of one instance.
+ * lock serializes register access of dispatch and status check; pending jobs are
+ * guarded by the farm lock.
+ */
+struct Z5SimInstance
+{
+    sim_aipu::Aipu* aipu = nullptr;
+    Z5SimCmdPool cmd_pool;
+    pthread_mutex_t lock;
+};
+
+/**
+ * @brief z5 simulator device: a farm of simulated NPUs sharing the simulated DRAM
+ *
+ * AIPU_UMD_SIM_INSTANCES (default 1) sim_aipu::Aipu instances are created on the first
+ * has_target(), each running one command pool: the farm scales by instances. Each scheduled
+ * job is dispatched to an idle instance, or to the one with the fewest pending jobs if none
+ * is idle, so jobs of different threads are simulated in parallel; when a pool turns idle,
+ * the jobs linked into its ring are reported done and the waiting ones are linked and
+ * dispatched. At most Z5_SIM_CMD_RING_SIZE chains are linked into a running ring, so it
+ * drains and reports its jobs even while it is fed. schedule() finding the ring full retires
+ * and refills it as soon as it drains, without waiting for a poller; when the waiting jobs are
+ * full too, it blocks for at most Z5_SIM_SCHED_TIMEOUT_MS. A job chained after a job of a
+ * pool goes to the same pool, and is run after it by the ring order.
+ */
 class Z5Simulator : public DeviceBase
 {
 private:
     sim_aipu::config_t m_config;
-    sim_aipu::Aipu*    m_aipu = nullptr;
+    std::vector<Z5SimInstance*> m_instances;
+    uint32_t m_instance_cnt = 1;
     uint32_t m_code = 0;
     uint32_t m_log_level;
     bool m_verbose;
-    std::vector<CmdPool> m_cmd_pools;
+    std::deque<Z5SimJob> m_done;
     pthread_rwlock_t m_lock;
+    pthread_mutex_t m_job_lock;
 
 private:
-    bool cmd_pool_created()
-    {
-        return m_cmd_pools.size();
-    }
+    void retire_jobs(Z5SimInstance* inst);
+    void collect_done_jobs(aipu_job_status_desc* status, uint32_t max_cnt, uint32_t* cnt,
+        bool of_this_thread);
+    Z5SimInstance* find_instance(uint32_t job_id);
 
 public:
     bool has_target(uint32_t arch, uint32_t version, uint32_t config, uint32_t rev);
     aipu_status_t schedule(const JobDesc& job);
     aipu_status_t get_simulation_instance(void** simulator, void** memory)
     {
-        if (m_aipu != nullptr)
+        if (!m_instances.empty())
         {
-            *(sim_aipu::Aipu**)simulator = m_aipu;
+            *(sim_aipu::Aipu**)simulator = m_instances[0]->aipu;
             *(sim_aipu::IMemEngine**)memory = static_cast<UMemory*>(m_dram);
             return AIPU_STATUS_SUCCESS;
         }
         return AIPU_STATUS_ERROR_INVALID_OP;
     }
-    aipu_ll_status_t get_status(std::vector<aipu_job_status_desc>& jobs_status,
-        uint32_t max_cnt);
-    aipu_ll_status_t poll_status(std::vector<aipu_job_status_desc>& jobs_status,
-        uint32_t max_cnt, int32_t time_out, bool of_this_thread);
+    aipu_ll_status_t get_status(aipu_job_status_desc* status, uint32_t max_cnt,
+        uint32_t* cnt);
+    aipu_ll_status_t poll_status(aipu_job_status_desc* status, uint32_t max_cnt,
+        uint32_t* cnt, int32_t time_out, bool of_this_thread);
     int get_config_code()
     {
         return m_config.code;
     }
+    bool can_chain_jobs()
+    {
+        return true;
+    }
 
 public:
     static Z5Simulator* get_z5_simulator(const aipu_global_config_simulation_t* cfg)
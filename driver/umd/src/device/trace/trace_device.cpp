@@ -0,0 +1,452 @@
+/**********************************************************************************
+ * This file is CONFIDENTIAL and any use by you is subject to the terms of the
+ * agreement between you and Arm China or the terms of the agreement between you
+ * and the party authorised by Arm China to disclose this file to you.
+ * The confidential and proprietary information contained in this file
+ * may only be used by a person authorised under and to the extent permitted
+ * by a subsisting licensing agreement from Arm China.
+ *
+ *        (C) Copyright 2020 Arm Technology (China) Co. Ltd.
+ *                    All rights reserved.
+ *
+ * This entire notice must be reproduced on all copies of this file and copies of
+ * this file may only be made by a person if such person is permitted to do so
+ * under the terms of a subsisting license agreement from Arm China.
+ *
+ *********************************************************************************/
+
+/**
+ * @file  trace_device.cpp
+ * @brief AIPU User Mode Driver (UMD) device trace record/replay module implementation
+ */
+
+#include <unistd.h>
+#include <cstring>
+#include <algorithm>
+#include "trace_device.h"
+#include "utils/helper.h"
+#include "utils/log.h"
+
+aipudrv::RecordDevice* aipudrv::RecordDevice::m_record = nullptr;
+
+aipudrv::RecordDevice::RecordDevice(DeviceBase* target)
+{
+    pthread_mutexattr_t attr;
+
+    m_target = target;
+    m_dev_type = target->get_dev_type();
+    m_dram = target->get_mem();
+    target->get_cluster_count(&m_cluster_cnt);
+    target->get_core_count(0, &m_core_cnt);
+
+    /* memory contents are read back under m_lock, which touches memory again */
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&m_lock, &attr);
+    pthread_mutexattr_destroy(&attr);
+}
+
+aipudrv::RecordDevice::~RecordDevice()
+{
+    m_dram->set_observer(nullptr);
+    m_trace.close();
+    pthread_mutex_destroy(&m_lock);
+    if (m_target->dec_ref_cnt() == 0)
+    {
+        delete m_target;
+    }
+    m_record = nullptr;
+}
+
+aipudrv::DeviceBase* aipudrv::RecordDevice::get_record_device(DeviceBase* target,
+    const char* trace_file)
+{
+    TraceHeader header;
+
+    if (nullptr == m_record)
+    {
+        std::ofstream trace(trace_file, std::ofstream::binary | std::ofstream::trunc);
+        if (!trace.is_open())
+        {
+            LOG(LOG_ERR, "open trace file %s failed: job stream is not recorded", trace_file);
+            return target;
+        }
+
+        /* the record device takes over the reference of target got by caller */
+        m_record = new RecordDevice(target);
+        m_record->m_trace = std::move(trace);
+        memset(&header, 0, sizeof(header));
+        strcpy(header.magic, TRACE_MAGIC);
+        header.version = TRACE_VERSION;
+        header.dev_type = target->get_dev_type();
+        m_record->m_trace.write((const char*)&header, sizeof(header));
+        m_record->m_start_ns = umd_get_time_ns_helper();
+        m_record->m_dram->set_observer(m_record);
+    }
+    else if (m_record->m_target == target)
+    {
+        target->dec_ref_cnt();
+    }
+    else
+    {
+        LOG(LOG_WARN, "another device is being recorded: job stream is not recorded");
+        return target;
+    }
+
+    m_record->inc_ref_cnt();
+    return m_record;
+}
+
+void aipudrv::RecordDevice::write_record(uint32_t type, uint32_t arg, uint64_t addr,
+    uint64_t size, const void* data)
+{
+    TraceRecord record;
+
+    record.type = type;
+    record.arg = arg;
+    record.time_ns = umd_get_time_ns_helper() - m_start_ns;
+    record.addr = addr;
+    record.size = size;
+    m_trace.write((const char*)&record, sizeof(record));
+    if (data != nullptr)
+    {
+        m_trace.write((const char*)data, size);
+    }
+}
+
+void aipudrv::RecordDevice::flush_dirty()
+{
+    uint64_t start = 0;
+    uint64_t end = 0;
+
+    if (m_dirty.empty())
+    {
+        return;
+    }
+
+    m_flushing = true;
+    std::sort(m_dirty.begin(), m_dirty.end());
+    for (uint32_t i = 0; i < m_dirty.size(); i++)
+    {
+        start = m_dirty[i].first;
+        end = start + m_dirty[i].second;
+
+        /* overlapped ranges are within one buffer and can be merged */
+        while (((i + 1) < m_dirty.size()) && (m_dirty[i + 1].first < end))
+        {
+            i++;
+            end = std::max(end, m_dirty[i].first + m_dirty[i].second);
+        }
+
+        m_data.resize(end - start);
+        if (m_dram->read(start, m_data.data(), end - start) == (int)(end - start))
+        {
+            write_record(TRACE_RECORD_WRITE, 0, start, end - start, m_data.data());
+        }
+    }
+    m_dirty.clear();
+    m_flushing = false;
+}
+
+void aipudrv::RecordDevice::record_done(const aipu_job_status_desc* status, uint32_t cnt)
+{
+    pthread_mutex_lock(&m_lock);
+    for (uint32_t i = 0; i < cnt; i++)
+    {
+        write_record(TRACE_RECORD_DONE, status[i].state, 0, 0, nullptr);
+    }
+    pthread_mutex_unlock(&m_lock);
+}
+
+void aipudrv::RecordDevice::on_alloc(const BufferDesc& buf, uint32_t align)
+{
+    pthread_mutex_lock(&m_lock);
+    write_record(TRACE_RECORD_ALLOC, align, buf.pa, buf.size, nullptr);
+    pthread_mutex_unlock(&m_lock);
+}
+
+void aipudrv::RecordDevice::on_free(const BufferDesc& buf)
+{
+    uint32_t kept = 0;
+
+    pthread_mutex_lock(&m_lock);
+    /* contents of a freed buffer are never seen by a job: drop them */
+    for (uint32_t i = 0; i < m_dirty.size(); i++)
+    {
+        if ((m_dirty[i].first < buf.pa) || (m_dirty[i].first >= (buf.pa + buf.size)))
+        {
+            m_dirty[kept++] = m_dirty[i];
+        }
+    }
+    m_dirty.resize(kept);
+    write_record(TRACE_RECORD_FREE, 0, buf.pa, buf.size, nullptr);
+    pthread_mutex_unlock(&m_lock);
+}
+
+void aipudrv::RecordDevice::on_touch(DEV_PA_64 addr, uint64_t size)
+{
+    pthread_mutex_lock(&m_lock);
+    if (!m_flushing &&
+        (m_dirty.empty() || (m_dirty.back().first != addr) || (m_dirty.back().second != size)))
+    {
+        m_dirty.push_back(std::make_pair(addr, size));
+    }
+    pthread_mutex_unlock(&m_lock);
+}
+
+aipu_status_t aipudrv::RecordDevice::schedule(const JobDesc& job)
+{
+    TraceJobDesc desc;
+
+    memset(&desc, 0, sizeof(desc));
+    desc.kdesc = job.kdesc;
+    desc.aipu_revision = job.aipu_revision;
+    desc.tcb_head = job.tcb_head;
+    desc.tcb_tail = job.tcb_tail;
+    desc.instruction_base_pa = job.instruction_base_pa;
+    desc.text_size = job.text_size;
+    desc.weight_pa = job.weight_pa;
+    desc.weight_size = job.weight_size;
+    desc.rodata_size = job.rodata_size;
+    desc.dcr_pa = job.dcr_pa;
+    desc.dcr_size = job.dcr_size;
+    desc.stack_size = job.stack_size;
+
+    pthread_mutex_lock(&m_lock);
+    flush_dirty();
+    write_record(TRACE_RECORD_SCHEDULE, 0, 0, sizeof(desc), &desc);
+    pthread_mutex_unlock(&m_lock);
+
+    return m_target->schedule(job);
+}
+
+aipu_ll_status_t aipudrv::RecordDevice::get_status(aipu_job_status_desc* status, uint32_t max_cnt,
+    uint32_t* cnt)
+{
+    aipu_ll_status_t ret = m_target->get_status(status, max_cnt, cnt);
+    record_done(status, *cnt);
+    return ret;
+}
+
+aipu_ll_status_t aipudrv::RecordDevice::poll_status(aipu_job_status_desc* status, uint32_t max_cnt,
+    uint32_t* cnt, int32_t time_out, bool of_this_thread)
+{
+    aipu_ll_status_t ret = m_target->poll_status(status, max_cnt, cnt, time_out, of_this_thread);
+    record_done(status, *cnt);
+    return ret;
+}
+
+aipudrv::TraceReplayer::TraceReplayer(DeviceBase* dev)
+{
+    m_dev = dev;
+    m_mem = dev->get_mem();
+}
+
+aipudrv::TraceReplayer::~TraceReplayer()
+{
+    for (auto iter = m_buffers.begin(); iter != m_buffers.end(); iter++)
+    {
+        m_mem->free(&iter->second);
+    }
+}
+
+aipu_status_t aipudrv::TraceReplayer::wait_done(aipu_replay_stat_t* stat, uint64_t* tot_latency_ns)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    aipu_job_status_desc status;
+    std::deque<std::pair<uint32_t, uint64_t>>::iterator iter;
+    uint64_t latency = 0;
+    uint64_t seq = 0;
+
+    if (m_inflight.empty())
+    {
+        return ret;
+    }
+
+    /* any replayed job in flight: completions are recorded in the order they come */
+    while (true)
+    {
+        seq = m_dev->get_done_seq();
+        for (iter = m_inflight.begin(); iter != m_inflight.end(); iter++)
+        {
+            if (m_dev->take_job_status(iter->first, &status))
+            {
+                break;
+            }
+        }
+        if (iter != m_inflight.end())
+        {
+            break;
+        }
+        ret = m_dev->wait_done_jobs(seq, -1);
+        if (ret != AIPU_STATUS_SUCCESS)
+        {
+            return ret;
+        }
+    }
+
+    latency = umd_get_time_ns_helper() - iter->second;
+    m_inflight.erase(iter);
+    *tot_latency_ns += latency;
+    if ((latency / 1000) > stat->max_latency_us)
+    {
+        stat->max_latency_us = latency / 1000;
+    }
+    if (AIPU_JOB_STATE_EXCEPTION == status.state)
+    {
+        stat->exception_cnt++;
+    }
+    return ret;
+}
+
+aipu_status_t aipudrv::TraceReplayer::replay(const char* trace_file, bool keep_timing,
+    aipu_replay_stat_t* stat)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    std::ifstream trace;
+    TraceHeader header;
+    TraceRecord record;
+    TraceJobDesc tdesc;
+    JobDesc desc;
+    BufferDesc buf;
+    std::map<DEV_PA_64, BufferDesc>::iterator iter;
+    uint64_t start = 0;
+    uint64_t now = 0;
+    uint64_t tot_latency = 0;
+
+    memset(stat, 0, sizeof(*stat));
+    trace.open(trace_file, std::ifstream::binary);
+    if (!trace.is_open())
+    {
+        return AIPU_STATUS_ERROR_OPEN_FILE_FAIL;
+    }
+
+    trace.read((char*)&header, sizeof(header));
+    if ((trace.gcount() != sizeof(header)) || (strncmp(header.magic, TRACE_MAGIC, 16) != 0) ||
+        (header.version != TRACE_VERSION))
+    {
+        ret = AIPU_STATUS_ERROR_UNKNOWN_BIN;
+        goto finish;
+    }
+
+    if (header.dev_type != m_dev->get_dev_type())
+    {
+        LOG(LOG_WARN, "trace recorded on device type %u is replayed on device type %u",
+            header.dev_type, m_dev->get_dev_type());
+    }
+
+    start = umd_get_time_ns_helper();
+    while (trace.read((char*)&record, sizeof(record)) && (trace.gcount() == sizeof(record)))
+    {
+        switch (record.type)
+        {
+            case TRACE_RECORD_ALLOC:
+                ret = m_mem->malloc(record.size, record.arg, &buf, "replay");
+                if (ret != AIPU_STATUS_SUCCESS)
+                {
+                    goto finish;
+                }
+                if (buf.pa != record.addr)
+                {
+                    LOG(LOG_ERR, "replayed buffer 0x%lx is allocated at 0x%lx: device memory is in use",
+                        record.addr, buf.pa);
+                    m_mem->free(&buf);
+                    ret = AIPU_STATUS_ERROR_BUF_ALLOC_FAIL;
+                    goto finish;
+                }
+                m_buffers[record.addr] = buf;
+                break;
+
+            case TRACE_RECORD_FREE:
+                iter = m_buffers.find(record.addr);
+                if (iter == m_buffers.end())
+                {
+                    ret = AIPU_STATUS_ERROR_INVALID_GBIN;
+                    goto finish;
+                }
+                m_mem->free(&iter->second);
+                m_buffers.erase(iter);
+                break;
+
+            case TRACE_RECORD_WRITE:
+                m_data.resize(record.size);
+                trace.read(m_data.data(), record.size);
+                if ((trace.gcount() != (int64_t)record.size) ||
+                    (m_mem->write(record.addr, m_data.data(), record.size) != (int)record.size))
+                {
+                    ret = AIPU_STATUS_ERROR_INVALID_GBIN;
+                    goto finish;
+                }
+                break;
+
+            case TRACE_RECORD_SCHEDULE:
+                trace.read((char*)&tdesc, sizeof(tdesc));
+                if ((record.size != sizeof(tdesc)) || (trace.gcount() != sizeof(tdesc)))
+                {
+                    ret = AIPU_STATUS_ERROR_INVALID_GBIN;
+                    goto finish;
+                }
+
+                /* keep the recorded gaps between jobs */
+                now = umd_get_time_ns_helper();
+                if (keep_timing && ((start + record.time_ns) > now))
+                {
+                    usleep((start + record.time_ns - now) / 1000);
+                }
+
+                desc.kdesc = tdesc.kdesc;
+                desc.kdesc.job_id = m_dev->alloc_job_id();
+                desc.aipu_revision = tdesc.aipu_revision;
+                desc.tcb_head = tdesc.tcb_head;
+                desc.tcb_tail = tdesc.tcb_tail;
+                desc.instruction_base_pa = tdesc.instruction_base_pa;
+                desc.text_size = tdesc.text_size;
+                desc.weight_pa = tdesc.weight_pa;
+                desc.weight_size = tdesc.weight_size;
+                desc.rodata_size = tdesc.rodata_size;
+                desc.dcr_pa = tdesc.dcr_pa;
+                desc.dcr_size = tdesc.dcr_size;
+                desc.stack_size = tdesc.stack_size;
+                ret = m_dev->schedule(desc);
+                if (ret != AIPU_STATUS_SUCCESS)
+                {
+                    goto finish;
+                }
+                m_inflight.push_back(std::make_pair(desc.kdesc.job_id, umd_get_time_ns_helper()));
+                stat->job_cnt++;
+                break;
+
+            case TRACE_RECORD_DONE:
+                ret = wait_done(stat, &tot_latency);
+                if (ret != AIPU_STATUS_SUCCESS)
+                {
+                    goto finish;
+                }
+                break;
+
+            default:
+                ret = AIPU_STATUS_ERROR_INVALID_GBIN;
+                goto finish;
+        }
+    }
+
+    /* jobs whose completion was not observed when recording stopped */
+    while (!m_inflight.empty())
+    {
+        ret = wait_done(stat, &tot_latency);
+        if (ret != AIPU_STATUS_SUCCESS)
+        {
+            goto finish;
+        }
+    }
+
+    stat->total_time_us = (umd_get_time_ns_helper() - start) / 1000;
+    if (stat->job_cnt != 0)
+    {
+        stat->avg_latency_us = tot_latency / 1000 / stat->job_cnt;
+    }
+
+finish:
+    trace.close();
+    return ret;
+}
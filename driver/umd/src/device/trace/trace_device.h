@@ -0,0 +1,208 @@
+/**********************************************************************************
+ * This file is CONFIDENTIAL and any use by you is subject to the terms of the
+ * agreement between you and Arm China or the terms of the agreement between you
+ * and the party authorised by Arm China to disclose this file to you.
+ * The confidential and proprietary information contained in this file
+ * may only be used by a person authorised under and to the extent permitted
+ * by a subsisting licensing agreement from Arm China.
+ *
+ *        (C) Copyright 2020 Arm Technology (China) Co. Ltd.
+ *                    All rights reserved.
+ *
+ * This entire notice must be reproduced on all copies of this file and copies of
+ * this file may only be made by a person if such person is permitted to do so
+ * under the terms of a subsisting license agreement from Arm China.
+ *
+ *********************************************************************************/
+
+/**
+ * @file  trace_device.h
+ * @brief AIPU User Mode Driver (UMD) device trace record/replay module header
+ */
+
+#ifndef _TRACE_DEVICE_H_
+#define _TRACE_DEVICE_H_
+
+#include <fstream>
+#include <map>
+#include <deque>
+#include <vector>
+#include <utility>
+#include <pthread.h>
+#include "standard_api.h"
+#include "device_base.h"
+#include "memory_base.h"
+#include "type.h"
+
+namespace aipudrv
+{
+#define TRACE_MAGIC   "AIPU TRACE"
+#define TRACE_VERSION 1
+
+enum TraceRecordType
+{
+    TRACE_RECORD_ALLOC    = 1,
+    TRACE_RECORD_FREE     = 2,
+    TRACE_RECORD_WRITE    = 3,
+    TRACE_RECORD_SCHEDULE = 4,
+    TRACE_RECORD_DONE     = 5,
+};
+
+struct TraceHeader
+{
+    char     magic[16];
+    uint32_t version;
+    uint32_t dev_type;
+};
+
+/**
+ * @brief trace record
+ *        ALLOC:    buffer addr/size, arg is alignment (in pages)
+ *        FREE:     buffer addr/size
+ *        WRITE:    memory addr/size, followed by size bytes of data
+ *        SCHEDULE: followed by a TraceJobDesc of size bytes
+ *        DONE:     arg is job state reported by device
+ */
+struct TraceRecord
+{
+    uint32_t type;
+    uint32_t arg;
+    uint64_t time_ns; /**< time since recording started */
+    uint64_t addr;
+    uint64_t size;
+};
+
+/**
+ * @brief the part of JobDesc consumed by devices, without the heap allocated members
+ */
+struct TraceJobDesc
+{
+    struct aipu_job_desc kdesc;
+    uint32_t aipu_revision;
+    DEV_PA_64 tcb_head;
+    DEV_PA_64 tcb_tail;
+    DEV_PA_64 instruction_base_pa;
+    uint32_t text_size;
+    DEV_PA_64 weight_pa;
+    uint32_t weight_size;
+    uint32_t rodata_size;
+    DEV_PA_64 dcr_pa;
+    uint32_t dcr_size;
+    uint32_t stack_size;
+};
+
+/**
+ * @brief Device wrapper which records the job stream scheduled onto the target device
+ *
+ * Allocations are recorded when they happen. Memory ranges touched by UMD are tracked
+ * and their contents are recorded right before the next job is scheduled, so that
+ * the trace holds the memory image every job sees without copying each write.
+ */
+class RecordDevice : public DeviceBase, public MemoryObserver
+{
+private:
+    DeviceBase* m_target;
+    std::ofstream m_trace;
+    uint64_t m_start_ns = 0;
+    std::vector<std::pair<DEV_PA_64, uint64_t>> m_dirty;
+    std::vector<char> m_data;
+    bool m_flushing = false;
+    pthread_mutex_t m_lock;
+
+private:
+    void write_record(uint32_t type, uint32_t arg, uint64_t addr, uint64_t size,
+        const void* data);
+    void flush_dirty();
+    void record_done(const aipu_job_status_desc* status, uint32_t cnt);
+
+public:
+    /* MemoryObserver */
+    void on_alloc(const BufferDesc& buf, uint32_t align);
+    void on_free(const BufferDesc& buf);
+    void on_touch(DEV_PA_64 addr, uint64_t size);
+
+public:
+    bool has_target(uint32_t arch, uint32_t version, uint32_t config, uint32_t rev)
+    {
+        return m_target->has_target(arch, version, config, rev);
+    }
+    uint32_t tec_cnt_per_core(uint32_t config)
+    {
+        return m_target->tec_cnt_per_core(config);
+    }
+    aipu_status_t get_simulation_instance(void** simulator, void** memory)
+    {
+        return m_target->get_simulation_instance(simulator, memory);
+    }
+    aipu_ll_status_t read_reg(uint32_t core_id, uint32_t offset, uint32_t* value)
+    {
+        return m_target->read_reg(core_id, offset, value);
+    }
+    aipu_ll_status_t write_reg(uint32_t core_id, uint32_t offset, uint32_t value)
+    {
+        return m_target->write_reg(core_id, offset, value);
+    }
+    int get_config_code()
+    {
+        return m_target->get_config_code();
+    }
+    DeviceBase* get_backend()
+    {
+        return m_target->get_backend();
+    }
+    bool can_chain_jobs()
+    {
+        return m_target->can_chain_jobs();
+    }
+    void release_job(JOB_ID id)
+    {
+        m_target->release_job(id);
+    }
+    aipu_status_t schedule(const JobDesc& job);
+    aipu_ll_status_t get_status(aipu_job_status_desc* status, uint32_t max_cnt,
+        uint32_t* cnt);
+    aipu_ll_status_t poll_status(aipu_job_status_desc* status, uint32_t max_cnt,
+        uint32_t* cnt, int32_t time_out, bool of_this_thread);
+
+public:
+    static DeviceBase* get_record_device(DeviceBase* target, const char* trace_file);
+    virtual ~RecordDevice();
+    RecordDevice(const RecordDevice& dev) = delete;
+    RecordDevice& operator=(const RecordDevice& dev) = delete;
+
+private:
+    RecordDevice(DeviceBase* target);
+    static RecordDevice* m_record;
+};
+
+/**
+ * @brief Re-issues a recorded job stream onto a device
+ *
+ * Buffers are re-allocated in the recorded order, which reproduces the recorded
+ * device addresses on a device without other allocations (e.g. a fresh mock device).
+ */
+class TraceReplayer
+{
+private:
+    DeviceBase* m_dev;
+    MemoryBase* m_mem;
+    std::map<DEV_PA_64, BufferDesc> m_buffers;
+    /* device tags and schedule times of the replayed jobs in flight */
+    std::deque<std::pair<uint32_t, uint64_t>> m_inflight;
+    std::vector<char> m_data;
+
+private:
+    aipu_status_t wait_done(aipu_replay_stat_t* stat, uint64_t* tot_latency_ns);
+
+public:
+    aipu_status_t replay(const char* trace_file, bool keep_timing, aipu_replay_stat_t* stat);
+
+public:
+    TraceReplayer(DeviceBase* dev);
+    ~TraceReplayer();
+    TraceReplayer(const TraceReplayer& replayer) = delete;
+    TraceReplayer& operator=(const TraceReplayer& replayer) = delete;
+};
+}
+
+#endif /* _TRACE_DEVICE_H_ */
@@ -0,0 +1,225 @@
+/**********************************************************************************
+ * This file is CONFIDENTIAL and any use by you is subject to the terms of the
+ * agreement between you and Arm China or the terms of the agreement between you
+ * and the party authorised by Arm China to disclose this file to you.
+ * The confidential and proprietary information contained in this file
+ * may only be used by a person authorised under and to the extent permitted
+ * by a subsisting licensing agreement from Arm China.
+ *
+ *        (C) Copyright 2020 Arm Technology (China) Co. Ltd.
+ *                    All rights reserved.
+ *
+ * This entire notice must be reproduced on all copies of this file and copies of
+ * this file may only be made by a person if such person is permitted to do so
+ * under the terms of a subsisting license agreement from Arm China.
+ *
+ *********************************************************************************/
+
+/**
+ * @file  device_base.cpp
+ * @brief AIPU User Mode Driver (UMD) device base module implementation
+ */
+
+#include <errno.h>
+#include <time.h>
+#include "device_base.h"
+#include "utils/helper.h"
+
+#define DEV_POLL_BATCH 16
+
+/* time left before deadline in ms, rounded up; keeps 0 and < 0 (no deadline) as they are */
+static int32_t get_time_left_ms(int32_t time_out, uint64_t deadline)
+{
+    uint64_t now = 0;
+
+    if (time_out <= 0)
+    {
+        return time_out;
+    }
+    now = umd_get_time_ns_helper();
+    return (now >= deadline) ? 0 : (int32_t)((deadline - now + 999999) / 1000000);
+}
+
+static bool remove_job_id(std::vector<uint32_t>& ids, uint32_t job_id)
+{
+    for (uint32_t i = 0; i < ids.size(); i++)
+    {
+        if (ids[i] == job_id)
+        {
+            ids[i] = ids.back();
+            ids.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool remove_job_status(std::vector<aipu_job_status_desc>& jobs, uint32_t job_id,
+    aipu_job_status_desc* status)
+{
+    for (uint32_t i = 0; i < jobs.size(); i++)
+    {
+        if (jobs[i].job_id == job_id)
+        {
+            *status = jobs[i];
+            jobs[i] = jobs.back();
+            jobs.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
+
+aipudrv::DeviceBase::DeviceBase()
+{
+    pthread_condattr_t attr;
+
+    m_next_job_id = 0;
+    pthread_mutex_init(&m_done_lock, NULL);
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&m_done_cond, &attr);
+    pthread_condattr_destroy(&attr);
+}
+
+aipudrv::DeviceBase::~DeviceBase()
+{
+    pthread_cond_destroy(&m_done_cond);
+    pthread_mutex_destroy(&m_done_lock);
+}
+
+uint32_t aipudrv::DeviceBase::alloc_job_id()
+{
+    uint32_t id = 0;
+
+    /* 0 is never used as a tag */
+    while (0 == id)
+    {
+        id = ++m_next_job_id;
+    }
+    return id;
+}
+
+bool aipudrv::DeviceBase::take_job_status(uint32_t job_id, aipu_job_status_desc* status)
+{
+    bool found = false;
+
+    pthread_mutex_lock(&m_done_lock);
+    found = remove_job_status(m_done_jobs, job_id, status);
+    pthread_mutex_unlock(&m_done_lock);
+    return found;
+}
+
+uint64_t aipudrv::DeviceBase::get_done_seq()
+{
+    uint64_t seq = 0;
+
+    pthread_mutex_lock(&m_done_lock);
+    seq = m_done_seq;
+    pthread_mutex_unlock(&m_done_lock);
+    return seq;
+}
+
+aipu_status_t aipudrv::DeviceBase::wait_done_jobs(uint64_t seq, int32_t time_out)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    aipu_job_status_desc done[DEV_POLL_BATCH];
+    uint64_t deadline = umd_get_time_ns_helper() + (uint64_t)((time_out > 0) ? time_out : 0) * 1000000;
+    struct timespec ts;
+    uint32_t cnt = 0;
+
+    ts.tv_sec = deadline / 1000000000ULL;
+    ts.tv_nsec = deadline % 1000000000ULL;
+
+    pthread_mutex_lock(&m_done_lock);
+    while (m_done_seq == seq)
+    {
+        if (!m_polling)
+        {
+            /* poll for all waiters: the lock is not held while the device blocks */
+            m_polling = true;
+            pthread_mutex_unlock(&m_done_lock);
+            ret = convert_ll_status(poll_status(done, DEV_POLL_BATCH, &cnt,
+                get_time_left_ms(time_out, deadline), false));
+            pthread_mutex_lock(&m_done_lock);
+            m_polling = false;
+
+            for (uint32_t i = 0; (AIPU_STATUS_SUCCESS == ret) && (i < cnt); i++)
+            {
+                if (!remove_job_id(m_dropped_jobs, done[i].job_id))
+                {
+                    m_done_jobs.push_back(done[i]);
+                    m_done_seq++;
+                }
+            }
+
+            /* wakes the others to check their jobs, or one of them to poll next */
+            pthread_cond_broadcast(&m_done_cond);
+            if ((AIPU_STATUS_SUCCESS != ret) || (0 == get_time_left_ms(time_out, deadline)))
+            {
+                break;
+            }
+        }
+        else if (0 == time_out)
+        {
+            break;
+        }
+        else if (time_out < 0)
+        {
+            pthread_cond_wait(&m_done_cond, &m_done_lock);
+        }
+        else if (pthread_cond_timedwait(&m_done_cond, &m_done_lock, &ts) == ETIMEDOUT)
+        {
+            break;
+        }
+    }
+    pthread_mutex_unlock(&m_done_lock);
+
+    return ret;
+}
+
+aipu_status_t aipudrv::DeviceBase::poll_job_status(uint32_t job_id, aipu_job_status_desc* status,
+    int32_t time_out, bool* done)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    uint64_t deadline = umd_get_time_ns_helper() + (uint64_t)((time_out > 0) ? time_out : 0) * 1000000;
+    uint64_t seq = 0;
+    bool last = false;
+
+    *done = false;
+    while (true)
+    {
+        /* read before taking: a completion kept after the take bumps it */
+        seq = get_done_seq();
+        if (take_job_status(job_id, status))
+        {
+            *done = true;
+            break;
+        }
+        if (last)
+        {
+            break;
+        }
+
+        ret = wait_done_jobs(seq, get_time_left_ms(time_out, deadline));
+        if (AIPU_STATUS_SUCCESS != ret)
+        {
+            break;
+        }
+        last = (0 == get_time_left_ms(time_out, deadline));
+    }
+
+    return ret;
+}
+
+void aipudrv::DeviceBase::drop_job_status(uint32_t job_id)
+{
+    aipu_job_status_desc status;
+
+    pthread_mutex_lock(&m_done_lock);
+    if (!remove_job_status(m_done_jobs, job_id, &status))
+    {
+        m_dropped_jobs.push_back(job_id);
+    }
+    pthread_mutex_unlock(&m_done_lock);
+}
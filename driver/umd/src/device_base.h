@@ -23,6 +23,9 @@
 #ifndef _DEVICE_BASE_H_
 #define _DEVICE_BASE_H_
 
+#include <vector>
+#include <atomic>
+#include <pthread.h>
 #include "kmd/armchina_aipu.h"
 #include "memory_base.h"
 #include "type.h"
@@ -80,11 +83,16 @@ struct JobDesc
     /* z5 only */
     DEV_PA_64 tcb_head;
     DEV_PA_64 tcb_tail;
+    /* device tag (kdesc.job_id) of the job to be queued behind, 0 for none */
+    uint32_t chain_after = 0;
 
     /* z1/2/3 only */
     DEV_PA_64 instruction_base_pa;
 
     /* z1/2/3 simulation only */
+    GRAPH_ID graph_id;
+    /* UMD job ID: unlike the device tag, the same for every schedule of the job */
+    JOB_ID job_id = 0;
     uint32_t text_size;
     DEV_PA_64 weight_pa;
     uint32_t weight_size;
@@ -105,8 +113,18 @@ enum DeviceType
     DEV_TYPE_SIMULATOR_LEGACY = 1,
     DEV_TYPE_SIMULATOR_Z5     = 2,
     DEV_TYPE_AIPU             = 3,
+    DEV_TYPE_MOCK             = 4,
 };
 
+/**
+ * @brief base of the devices
+ *
+ * Device status is reported by aipu_job_status_desc::job_id, a per-device tag given to
+ * each scheduled job by alloc_job_id(). Jobs of all threads wait for their own status by
+ * poll_job_status(): one caller at a time polls the device for all of them, and keeps
+ * completions of the others until their jobs take them. So poll_status(of_this_thread =
+ * false) of a device should be woken by the completion of a job of any thread.
+ */
 class DeviceBase
 {
 protected:
@@ -116,6 +134,21 @@ protected:
     uint32_t m_core_cnt = 1;
     uint32_t m_ref_cnt = 0;
 
+private:
+    std::atomic<uint32_t> m_next_job_id;
+    /**
+     * completions polled from the device and not taken yet, and tags of the jobs
+     * destroyed before their completion is polled; both are short and keep their
+     * capacity, so that steady polling does not allocate
+     */
+    std::vector<aipu_job_status_desc> m_done_jobs;
+    std::vector<uint32_t> m_dropped_jobs;
+    /* bumped whenever a completion is kept */
+    uint64_t m_done_seq = 0;
+    bool m_polling = false;
+    pthread_mutex_t m_done_lock;
+    pthread_cond_t  m_done_cond;
+
 public:
     virtual bool has_target(uint32_t arch, uint32_t version, uint32_t config, uint32_t rev) = 0;
     virtual uint32_t tec_cnt_per_core(uint32_t config)
@@ -139,16 +172,22 @@ public:
     {
         return AIPU_LL_STATUS_ERROR_OPERATION_UNSUPPORTED;
     }
+    /**
+     * status query: status[max_cnt] is provided by the caller and *cnt returns
+     * the number of valid elements so that polling never allocates
+     */
     /* non-blocking */
-    virtual aipu_ll_status_t get_status(std::vector<aipu_job_status_desc>& jobs_status,
-        uint32_t max_cnt)
+    virtual aipu_ll_status_t get_status(aipu_job_status_desc* status, uint32_t max_cnt,
+        uint32_t* cnt)
     {
+        *cnt = 0;
         return AIPU_LL_STATUS_SUCCESS;
     }
     /* blocking with timeout */
-    virtual aipu_ll_status_t poll_status(std::vector<aipu_job_status_desc>& jobs_status,
-        uint32_t max_cnt, int32_t time_out, bool of_this_thread)
+    virtual aipu_ll_status_t poll_status(aipu_job_status_desc* status, uint32_t max_cnt,
+        uint32_t* cnt, int32_t time_out, bool of_this_thread)
     {
+        *cnt = 0;
         return AIPU_LL_STATUS_SUCCESS;
     }
     int dec_ref_cnt()
@@ -163,6 +202,40 @@ public:
     {
         return 0;
     }
+    /**
+     * true if a job can be scheduled behind an unfinished job (JobDesc::chain_after)
+     * and is started by the device only after that job is done
+     */
+    virtual bool can_chain_jobs()
+    {
+        return false;
+    }
+    /**
+     * @brief release what the device keeps for a job which is destroyed (e.g. simulation files)
+     */
+    virtual void release_job(JOB_ID id)
+    {
+    }
+
+public:
+    /* completion routing, see the class description */
+    uint32_t alloc_job_id();
+    bool take_job_status(uint32_t job_id, aipu_job_status_desc* status);
+    uint64_t get_done_seq();
+    /**
+     * @brief return when a completion is kept after get_done_seq() returned seq, or when
+     *        time_out (ms; < 0 blocks, 0 polls once) expires
+     */
+    aipu_status_t wait_done_jobs(uint64_t seq, int32_t time_out);
+    /**
+     * @brief take the status of a job; *done is false if it is not done within time_out
+     */
+    aipu_status_t poll_job_status(uint32_t job_id, aipu_job_status_desc* status, int32_t time_out,
+        bool* done);
+    /**
+     * @brief discard the status of a scheduled job which is destroyed
+     */
+    void drop_job_status(uint32_t job_id);
 
 public:
     aipu_status_t get_cluster_count(uint32_t* cnt)
@@ -201,10 +274,15 @@ public:
     {
         return m_dev_type;
     }
+    /* device wrappers (e.g. trace recording) return the device they wrap */
+    virtual DeviceBase* get_backend()
+    {
+        return this;
+    }
 
 public:
-    DeviceBase(){};
-    virtual ~DeviceBase(){};
+    DeviceBase();
+    virtual ~DeviceBase();
     DeviceBase(const DeviceBase& dev) = delete;
     DeviceBase& operator=(const DeviceBase& dev) = delete;
 };
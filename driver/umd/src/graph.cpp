@@ -21,11 +21,14 @@
  */
 
 #include <cstring>
+#include <pthread.h>
 #include "graph.h"
 #include "parser_base.h"
 #include "utils/helper.h"
 #include "utils/log.h"
 
+#define DEFAULT_LOAD_CHUNK_SIZE (4 * MB_SIZE)
+
 aipudrv::Graph::Graph(GRAPH_ID id, DeviceBase* dev): GraphBase(id, dev)
 {
     m_btext.init(nullptr, 0);
@@ -41,6 +44,278 @@ aipudrv::Graph::~Graph()
 {
 }
 
+namespace
+{
+/**
+ * double-buffered staging state shared by the weight reader thread and the
+ * loading thread; host memory in use never exceeds 2 * chunk bytes
+ */
+struct WeightStream
+{
+    std::ifstream* gbin;
+    uint64_t offset;
+    uint64_t size;
+    uint64_t chunk;
+    char*    slot[2];
+    uint64_t len[2];
+    bool     full[2];
+    bool     error;
+    bool     abort;
+    pthread_mutex_t lock;
+    pthread_cond_t  cond;
+};
+
+void* weight_reader_thread(void* arg)
+{
+    WeightStream* ws = (WeightStream*)arg;
+    uint64_t done = 0;
+    uint32_t iter = 0;
+
+    ws->gbin->seekg(ws->offset, ws->gbin->beg);
+    while (done < ws->size)
+    {
+        uint32_t s = iter % 2;
+        uint64_t len = (ws->size - done) > ws->chunk ? ws->chunk : (ws->size - done);
+        bool abort = false;
+
+        pthread_mutex_lock(&ws->lock);
+        while (ws->full[s] && !ws->abort)
+        {
+            pthread_cond_wait(&ws->cond, &ws->lock);
+        }
+        abort = ws->abort;
+        pthread_mutex_unlock(&ws->lock);
+        if (abort)
+        {
+            break;
+        }
+
+        /* the slot is owned by this thread until it is marked full */
+        ws->gbin->read(ws->slot[s], len);
+        pthread_mutex_lock(&ws->lock);
+        if (ws->gbin->gcount() != (std::streamsize)len)
+        {
+            ws->error = true;
+        }
+        else
+        {
+            ws->len[s] = len;
+            ws->full[s] = true;
+        }
+        abort = ws->error;
+        pthread_cond_broadcast(&ws->cond);
+        pthread_mutex_unlock(&ws->lock);
+        if (abort)
+        {
+            break;
+        }
+
+        done += len;
+        iter++;
+    }
+
+    return nullptr;
+}
+
+/**
+ * memory read/write report the bytes done as int, so that a window of up to 4GB is
+ * written in pieces whose size the result can represent
+ */
+#define DEV_WRITE_PIECE_SIZE (1ULL << 30)
+
+bool write_dev_mem(aipudrv::MemoryBase* mem, aipudrv::DEV_PA_64 pa, const char* va, uint64_t size)
+{
+    for (uint64_t offset = 0; offset < size; offset += DEV_WRITE_PIECE_SIZE)
+    {
+        uint64_t len = (size - offset) > DEV_WRITE_PIECE_SIZE ? DEV_WRITE_PIECE_SIZE : (size - offset);
+        if ((uint64_t)mem->write(pa + offset, va + offset, len) != len)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+}
+
+aipu_status_t aipudrv::Graph::load_weight_stream(std::ifstream& gbin)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    WeightStream ws;
+    pthread_t reader;
+    bool async = m_wstream_cfg.async_read && (m_bweight.size > m_wstream_cfg.window_size / 2);
+    uint64_t done = 0;
+    uint32_t iter = 0;
+
+    ws.gbin = &gbin;
+    ws.offset = m_bweight_offset;
+    ws.size = m_bweight.size;
+    ws.chunk = async ? (m_wstream_cfg.window_size / 2) : m_wstream_cfg.window_size;
+    if (ws.chunk > m_bweight.size)
+    {
+        ws.chunk = m_bweight.size;
+    }
+    ws.slot[0] = new char[ws.chunk];
+    ws.slot[1] = async ? new char[ws.chunk] : nullptr;
+    ws.len[0] = ws.len[1] = 0;
+    ws.full[0] = ws.full[1] = false;
+    ws.error = false;
+    ws.abort = false;
+
+    if (!async)
+    {
+        gbin.seekg(m_bweight_offset, gbin.beg);
+        while (done < m_bweight.size)
+        {
+            uint64_t len = (m_bweight.size - done) > ws.chunk ? ws.chunk : (m_bweight.size - done);
+            gbin.read(ws.slot[0], len);
+            if (gbin.gcount() != (std::streamsize)len)
+            {
+                ret = AIPU_STATUS_ERROR_INVALID_GBIN;
+                goto finish;
+            }
+            if (!write_dev_mem(m_mem, m_weight.pa + done, ws.slot[0], len))
+            {
+                ret = AIPU_STATUS_ERROR_BUF_ALLOC_FAIL;
+                goto finish;
+            }
+            done += len;
+        }
+        goto finish;
+    }
+
+    pthread_mutex_init(&ws.lock, NULL);
+    pthread_cond_init(&ws.cond, NULL);
+    if (pthread_create(&reader, NULL, weight_reader_thread, &ws) != 0)
+    {
+        ret = AIPU_STATUS_ERROR_READ_FILE_FAIL;
+        goto destroy;
+    }
+
+    while (done < m_bweight.size)
+    {
+        uint32_t s = iter % 2;
+        bool full = false;
+
+        pthread_mutex_lock(&ws.lock);
+        while (!ws.full[s] && !ws.error)
+        {
+            pthread_cond_wait(&ws.cond, &ws.lock);
+        }
+        full = ws.full[s];
+        pthread_mutex_unlock(&ws.lock);
+        if (!full)
+        {
+            ret = AIPU_STATUS_ERROR_INVALID_GBIN;
+            break;
+        }
+
+        if (!write_dev_mem(m_mem, m_weight.pa + done, ws.slot[s], ws.len[s]))
+        {
+            ret = AIPU_STATUS_ERROR_BUF_ALLOC_FAIL;
+            break;
+        }
+        done += ws.len[s];
+
+        pthread_mutex_lock(&ws.lock);
+        ws.full[s] = false;
+        pthread_cond_broadcast(&ws.cond);
+        pthread_mutex_unlock(&ws.lock);
+        iter++;
+    }
+
+    pthread_mutex_lock(&ws.lock);
+    ws.abort = true;
+    pthread_cond_broadcast(&ws.cond);
+    pthread_mutex_unlock(&ws.lock);
+    pthread_join(reader, NULL);
+
+destroy:
+    pthread_cond_destroy(&ws.cond);
+    pthread_mutex_destroy(&ws.lock);
+
+finish:
+    delete[] ws.slot[0];
+    delete[] ws.slot[1];
+    return ret;
+}
+
+aipu_status_t aipudrv::Graph::load_weight(std::ifstream& gbin)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+
+    ret = m_mem->malloc(m_bweight.size, 0, &m_weight, "weight");
+    if (AIPU_STATUS_SUCCESS != ret)
+    {
+        goto finish;
+    }
+
+    if (nullptr == m_bweight.va)
+    {
+        ret = load_weight_stream(gbin);
+        goto finish;
+    }
+
+    if (!write_dev_mem(m_mem, m_weight.pa, m_bweight.va, m_bweight.size))
+    {
+        ret = AIPU_STATUS_ERROR_BUF_ALLOC_FAIL;
+    }
+
+finish:
+    return ret;
+}
+
+void aipudrv::Graph::write_section_chunks(TaskGroup* group, DEV_PA_64 pa, const char* va,
+    uint64_t size, std::atomic<uint32_t>* fail_cnt)
+{
+    uint64_t chunk = (m_load_chunk != 0) ? m_load_chunk : DEFAULT_LOAD_CHUNK_SIZE;
+
+    for (uint64_t offset = 0; offset < size; offset += chunk)
+    {
+        uint64_t len = (size - offset) > chunk ? chunk : (size - offset);
+        m_load_pool->submit(group, [this, pa, va, offset, len, fail_cnt]() {
+            if (!write_dev_mem(m_mem, pa + offset, va + offset, len))
+            {
+                (*fail_cnt)++;
+            }
+        });
+    }
+}
+
+aipu_status_t aipudrv::Graph::load_sections_parallel(std::ifstream& gbin)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    std::atomic<uint32_t> fail_cnt(0);
+    TaskGroup group;
+
+    write_section_chunks(&group, m_text.pa, m_btext.va, m_btext.size, &fail_cnt);
+
+    if (m_bweight.size != 0)
+    {
+        if (nullptr == m_bweight.va)
+        {
+            /* streamed weight is read by this thread while the text chunks are written */
+            ret = load_weight(gbin);
+        }
+        else
+        {
+            ret = m_mem->malloc(m_bweight.size, 0, &m_weight, "weight");
+            if (AIPU_STATUS_SUCCESS == ret)
+            {
+                write_section_chunks(&group, m_weight.pa, m_bweight.va, m_bweight.size, &fail_cnt);
+            }
+        }
+    }
+
+    /* always wait: queued chunks reference this graph */
+    m_load_pool->wait(&group);
+    if ((AIPU_STATUS_SUCCESS == ret) && (fail_cnt != 0))
+    {
+        ret = AIPU_STATUS_ERROR_BUF_ALLOC_FAIL;
+    }
+
+    return ret;
+}
+
 aipu_status_t aipudrv::Graph::load(std::ifstream& gbin, uint32_t size, bool ver_check)
 {
     aipu_status_t ret = AIPU_STATUS_SUCCESS;
@@ -65,17 +340,20 @@ aipu_status_t aipudrv::Graph::load(std::ifstream& gbin, uint32_t size, bool ver_
     {
         goto finish;
     }
+
+    /* copy text and weight buffers in chunks by the context load pool */
+    if (nullptr != m_load_pool)
+    {
+        ret = load_sections_parallel(gbin);
+        goto finish;
+    }
+
     assert(m_mem->write(m_text.pa, m_btext.va, m_btext.size) == (int)m_btext.size);
 
     /* alloc and load weight buffer */
     if (m_bweight.size != 0)
     {
-        ret = m_mem->malloc(m_bweight.size, 0, &m_weight, "weight");
-        if (AIPU_STATUS_SUCCESS != ret)
-        {
-            goto finish;
-        }
-        assert(m_mem->write(m_weight.pa, m_bweight.va, m_bweight.size) == (int)m_bweight.size);
+        ret = load_weight(gbin);
     }
 
 finish:
@@ -26,6 +26,7 @@
 #include <map>
 #include <vector>
 #include <deque>
+#include <atomic>
 #include <pthread.h>
 #include "standard_api.h"
 #include "graph_base.h"
@@ -99,6 +100,7 @@ protected:
     struct BinSection m_bdesc;
     struct BinSection m_bweight;
     struct BinSection m_bdata;
+    uint64_t m_bweight_offset = 0;
     std::vector<RemapEntry> m_remap;
 
 protected:
@@ -107,6 +109,13 @@ protected:
     BufferDesc m_weight;
     bool m_do_vcheck = true;
 
+protected:
+    aipu_status_t load_weight(std::ifstream& gbin);
+    aipu_status_t load_weight_stream(std::ifstream& gbin);
+    aipu_status_t load_sections_parallel(std::ifstream& gbin);
+    void write_section_chunks(TaskGroup* group, DEV_PA_64 pa, const char* va,
+        uint64_t size, std::atomic<uint32_t>* fail_cnt);
+
 public:
     virtual void set_stack(uint32_t sg_id, uint32_t size, uint32_t align) = 0;
     virtual void add_param(uint32_t sg_id, struct GraphParamMapLoadDesc param) = 0;
@@ -151,6 +160,12 @@ public:
     {
         m_bweight = weight;
     }
+    void set_graph_weight_stream(uint64_t offset, uint64_t size)
+    {
+        /* weight data stays in the graph binary and is streamed during load */
+        m_bweight.init(nullptr, size);
+        m_bweight_offset = offset;
+    }
     void add_remap(RemapEntry remap)
     {
         m_remap.push_back(remap);
@@ -22,12 +22,15 @@
 
 #include "graph_base.h"
 #include "job_base.h"
+#include "utils/log.h"
 
 aipudrv::GraphBase::GraphBase(GRAPH_ID id, DeviceBase* dev):
     m_id(id),
     m_dev(dev)
 {
     m_mem = m_dev->get_mem();
+    m_retired = false;
+    m_pin_cnt = 0;
     pthread_rwlock_init(&m_lock, NULL);
 }
 
@@ -36,43 +39,52 @@ aipudrv::GraphBase::~GraphBase()
     pthread_rwlock_destroy(&m_lock);
 }
 
-aipudrv::JOB_ID aipudrv::GraphBase::create_job_id_inner()
+aipu_status_t aipudrv::GraphBase::add_job(JobBase* job, JOB_ID* id)
 {
-    uint64_t id_candidate = create_full_job_id(m_id, 1);
+    uint32_t handle = 0;
 
-    while (m_jobs.count(id_candidate) == 1)
+    assert(job != nullptr);
+
+    /* reserve a handle first: job ID should be set before the job is visible */
+    handle = m_jobs.alloc(nullptr);
+    if (0 == handle)
     {
-        id_candidate++;
+        LOG(LOG_ERR, "graph 0x%lx: too many jobs", m_id);
+        return AIPU_STATUS_ERROR_BUF_ALLOC_FAIL;
     }
-    return id_candidate;
-}
 
-aipudrv::JOB_ID aipudrv::GraphBase::add_job(JobBase* job)
-{
-    assert(job != nullptr);
-    pthread_rwlock_wrlock(&m_lock);
-    job->set_id(create_job_id_inner());
-    m_jobs[job->get_id()] = job;
-    pthread_rwlock_unlock(&m_lock);
-    return job->get_id();
+    job->set_id(create_full_job_id(m_id, handle));
+    m_jobs.set(handle, job);
+    *id = job->get_id();
+    return AIPU_STATUS_SUCCESS;
 }
 
 aipu_status_t aipudrv::GraphBase::destroy_jobs()
 {
     aipu_status_t ret = AIPU_STATUS_SUCCESS;
-    auto iter = m_jobs.begin();
+    std::vector<uint32_t> handles;
+    JobBase* job = nullptr;
 
     pthread_rwlock_wrlock(&m_lock);
-    while(iter != m_jobs.end())
+    m_jobs.get_handles(handles);
+    for (uint32_t i = 0; i < handles.size(); i++)
     {
-        ret = iter->second->destroy();
+        /* unpublished before its buffers are freed: lock-free lookups cannot find it any more */
+        if (m_jobs.remove(handles[i], &job) && (nullptr != job))
+        {
+            m_released.push_back(job);
+        }
+    }
+    while (!m_released.empty())
+    {
+        job = m_released.back();
+        ret = job->destroy();
         if (ret != AIPU_STATUS_SUCCESS)
         {
             goto unlock;
         }
-        delete iter->second;
-        m_jobs.erase(iter);
-        iter = m_jobs.begin();
+        m_released.pop_back();
+        delete job;
     }
 
 unlock:
@@ -83,20 +95,115 @@ unlock:
 aipu_status_t aipudrv::GraphBase::destroy_job(JOB_ID id)
 {
     aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    uint32_t handle = get_job_handle(id);
+    JobBase* job = nullptr;
+
+    if ((job_id2graph_id(id) != m_id) || (nullptr == m_jobs.get(handle)))
+    {
+        return ret;
+    }
+
+    /**
+     * unpublished before its buffers are freed, without m_lock: remove() waits for the
+     * threads which got the job to put it back, and only one destroyer gets it
+     */
+    if (!m_jobs.remove(handle, &job) || (nullptr == job))
+    {
+        return ret;
+    }
 
     pthread_rwlock_wrlock(&m_lock);
-    if (m_jobs.count(id) != 0)
+    if (m_retired)
     {
-        ret = m_jobs[id]->destroy();
+        /* the handle is dead from now on; the reclaimer frees the buffers later */
+        m_released.push_back(job);
+    }
+    else
+    {
+        /* kept for destroy_jobs if that fails */
+        ret = job->destroy();
         if (ret != AIPU_STATUS_SUCCESS)
         {
+            m_released.push_back(job);
             goto unlock;
         }
-        delete m_jobs[id];
-        m_jobs.erase(id);
+        delete job;
     }
 
 unlock:
     pthread_rwlock_unlock(&m_lock);
     return ret;
 }
+
+bool aipudrv::GraphBase::poll_in_flight(JobBase* job)
+{
+    aipu_job_status_t status;
+
+    /* the completion of a job nobody waits for is taken here */
+    if (job->is_scheduled())
+    {
+        job->get_status(&status);
+    }
+    return job->is_in_flight();
+}
+
+aipu_status_t aipudrv::GraphBase::reclaim_jobs(uint32_t batch, uint32_t* left)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    std::vector<uint32_t> handles;
+    std::vector<JobBase*> jobs;
+    JobBase* job = nullptr;
+    uint32_t removed = 0;
+    bool idle = false;
+
+    /**
+     * every job of a retired graph is destroyed once it is not in flight, whether the
+     * application released it or not. Its handle is removed first, without m_lock: remove()
+     * waits for the threads using the job, which may schedule it again meanwhile.
+     */
+    m_jobs.get_handles(handles);
+    for (uint32_t i = 0; (i < handles.size()) && (removed < batch); i++)
+    {
+        job = m_jobs.acquire(handles[i]);
+        if (nullptr == job)
+        {
+            continue;
+        }
+        idle = !poll_in_flight(job);
+        m_jobs.release(handles[i]);
+
+        if (idle && m_jobs.remove(handles[i], &job) && (nullptr != job))
+        {
+            pthread_rwlock_wrlock(&m_lock);
+            m_released.push_back(job);
+            pthread_rwlock_unlock(&m_lock);
+            removed++;
+        }
+    }
+
+    /* detach the released jobs done under the lock and free buffers after unlocking */
+    pthread_rwlock_wrlock(&m_lock);
+    for (auto iter = m_released.begin(); (iter != m_released.end()) && (jobs.size() < batch); )
+    {
+        if (poll_in_flight(*iter))
+        {
+            iter++;
+            continue;
+        }
+        jobs.push_back(*iter);
+        iter = m_released.erase(iter);
+    }
+    *left = m_jobs.size() + m_released.size();
+    pthread_rwlock_unlock(&m_lock);
+
+    for (uint32_t i = 0; i < jobs.size(); i++)
+    {
+        if (jobs[i]->destroy() != AIPU_STATUS_SUCCESS)
+        {
+            ret = AIPU_STATUS_ERROR_BUF_FREE_FAIL;
+        }
+        delete jobs[i];
+    }
+
+    return ret;
+}
@@ -25,16 +25,22 @@
 
 #include <fstream>
 #include <map>
+#include <vector>
+#include <atomic>
 #include <pthread.h>
 #include <assert.h>
 #include "standard_api.h"
 #include "device_base.h"
 #include "memory_base.h"
 #include "type.h"
+#include "utils/thread_pool.h"
+#include "utils/handle_table.h"
 
 namespace aipudrv
 {
 class JobBase;
+typedef HandleTable<JobBase, 16> JobTable;
+
 class GraphBase
 {
 protected:
@@ -47,19 +53,29 @@ protected:
     uint32_t m_asid_flag = 0;
     uint32_t m_remap_flag = 0;
     uint32_t m_sram_flag = 0;
+    aipu_global_config_weight_streaming_t m_wstream_cfg = {0, false};
+    ThreadPool* m_load_pool = nullptr;
+    uint32_t m_load_chunk = 0;
 
 protected:
     DeviceBase* m_dev;
     MemoryBase* m_mem;
 
 protected:
-    std::map<JOB_ID, JobBase*> m_jobs;
+    /* m_lock serializes job destroy; job handles are resolved lock-free */
+    JobTable m_jobs;
     pthread_rwlock_t m_lock;
+    std::atomic<bool> m_retired;
+    /* jobs without a handle any more whose buffers are still to be freed: released from a
+     * retired graph (freed by the reclaimer), or failed to be destroyed */
+    std::vector<JobBase*> m_released;
+    /* number of super graphs this graph is a member of */
+    std::atomic<uint32_t> m_pin_cnt;
 
 protected:
-    virtual JOB_ID create_job_id_inner();
-    JOB_ID add_job(JobBase* job);
+    aipu_status_t add_job(JobBase* job, JOB_ID* id);
     aipu_status_t destroy_jobs();
+    bool poll_in_flight(JobBase* job);
 
 public:
     virtual void print_parse_info() = 0;
@@ -70,16 +86,56 @@ public:
     virtual aipu_status_t get_tensor_descriptor(aipu_tensor_type_t type,
         uint32_t tensor, aipu_tensor_desc_t* desc) = 0;
     virtual DEV_PA_64 debugger_get_instr_base() = 0;
+    /* device memory (in pages) allocated by this graph and by each of its jobs */
+    virtual void get_memory_info(aipu_graph_memory_info_t* info) = 0;
 
+    /* a job got is referenced until it is put back: it is not freed meanwhile */
     JobBase* get_job(JOB_ID id)
     {
-        JobBase* job = nullptr;
-        pthread_rwlock_rdlock(&m_lock);
-        job = (m_jobs.count(id) ? m_jobs[id]: nullptr);
-        pthread_rwlock_unlock(&m_lock);
-        return job;
+        if (job_id2graph_id(id) != m_id)
+        {
+            return nullptr;
+        }
+        return m_jobs.acquire(get_job_handle(id));
+    }
+    void put_job(JOB_ID id) const
+    {
+        m_jobs.release(get_job_handle(id));
     }
     aipu_status_t destroy_job(JOB_ID id);
+    uint64_t get_job_footprint()
+    {
+        aipu_graph_memory_info_t info;
+
+        get_memory_info(&info);
+        return info.job_size;
+    }
+    /**
+     * @brief destroy at most batch jobs of a retired graph which are not in flight; left
+     *        returns the number of jobs the graph still has
+     */
+    aipu_status_t reclaim_jobs(uint32_t batch, uint32_t* left);
+    bool retire()
+    {
+        /* true only for the caller which really retires this graph */
+        return !m_retired.exchange(true);
+    }
+    bool is_retired()
+    {
+        return m_retired;
+    }
+    void pin()
+    {
+        m_pin_cnt++;
+    }
+    void unpin()
+    {
+        m_pin_cnt--;
+    }
+    bool is_pinned()
+    {
+        return m_pin_cnt != 0;
+    }
 
 public:
     /* Set functions */
@@ -115,6 +171,15 @@ public:
     {
         m_remap_flag = flag;
     }
+    void set_weight_streaming(const aipu_global_config_weight_streaming_t& cfg)
+    {
+        m_wstream_cfg = cfg;
+    }
+    void set_load_pool(ThreadPool* pool, uint32_t chunk)
+    {
+        m_load_pool = pool;
+        m_load_chunk = chunk;
+    }
 
     /* Get functions */
     uint32_t get_gversion()
@@ -129,6 +194,18 @@ public:
     {
         return m_hw_config;
     }
+    bool is_weight_streaming()
+    {
+        return m_wstream_cfg.window_size != 0;
+    }
+    DeviceBase* get_device()
+    {
+        return m_dev;
+    }
+    GRAPH_ID get_id() const
+    {
+        return m_id;
+    }
 
 public:
     GraphBase(GRAPH_ID id, DeviceBase* dev);
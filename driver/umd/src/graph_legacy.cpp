@@ -46,13 +46,45 @@ aipu_status_t aipudrv::GraphLegacy::create_job(JOB_ID* id, const aipu_global_con
     ret = job->init(cfg);
     if (AIPU_STATUS_SUCCESS != ret)
     {
+        delete job;
         return ret;
     }
 
-    *id = add_job(job);
+    ret = add_job(job, id);
+    if (AIPU_STATUS_SUCCESS != ret)
+    {
+        job->destroy();
+        delete job;
+    }
     return ret;
 }
 
+void aipudrv::GraphLegacy::get_memory_info(aipu_graph_memory_info_t* info)
+{
+    memset(info, 0, sizeof(*info));
+    info->text_size = ALIGN_PAGE(m_btext.size);
+    info->weight_size = ALIGN_PAGE(m_bweight.size);
+    info->shared_size = info->text_size + info->weight_size;
+
+    /* the buffers allocated by JobLegacy::init */
+    info->rodata_size = ALIGN_PAGE(m_brodata.size);
+    info->dcr_size = ALIGN_PAGE(m_bdesc.size);
+    info->stack_size = ALIGN_PAGE(m_stack_size);
+    if (m_stack_align_in_page > 1)
+    {
+        info->align_slack += (m_stack_align_in_page - 1) * PAGE_SIZE;
+    }
+    for (uint32_t i = 0; i < m_reuse_sections.size(); i++)
+    {
+        info->reuse_size += ALIGN_PAGE(m_reuse_sections[i].size);
+        if ((m_reuse_sections[i].size != 0) && (m_reuse_sections[i].align_in_page > 1))
+        {
+            info->align_slack += (m_reuse_sections[i].align_in_page - 1) * PAGE_SIZE;
+        }
+    }
+    info->job_size = info->rodata_size + info->dcr_size + info->stack_size + info->reuse_size;
+}
+
 aipu_status_t aipudrv::GraphLegacy::get_tensor_count(aipu_tensor_type_t type, uint32_t* cnt)
 {
     if (nullptr == cnt)
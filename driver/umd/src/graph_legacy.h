@@ -49,6 +49,7 @@ public:
     virtual aipu_status_t get_tensor_count(aipu_tensor_type_t type, uint32_t* cnt);
     virtual aipu_status_t get_tensor_descriptor(aipu_tensor_type_t type,
         uint32_t tensor, aipu_tensor_desc_t* desc);
+    virtual void get_memory_info(aipu_graph_memory_info_t* info);
 
 public:
     void set_enrty(uint32_t offset)
@@ -93,13 +93,54 @@ aipu_status_t aipudrv::GraphZ5::create_job(JOB_ID* id, const aipu_global_config_
     ret = job->init(cfg);
     if (AIPU_STATUS_SUCCESS != ret)
     {
+        delete job;
         return ret;
     }
 
-    *id = add_job(job);
+    ret = add_job(job, id);
+    if (AIPU_STATUS_SUCCESS != ret)
+    {
+        job->destroy();
+        delete job;
+    }
     return ret;
 }
 
+void aipudrv::GraphZ5::get_memory_info(aipu_graph_memory_info_t* info)
+{
+    uint64_t task_per_sg = m_dev->tec_cnt_per_core(m_hw_config);
+
+    memset(info, 0, sizeof(*info));
+    info->text_size = ALIGN_PAGE(m_btext.size);
+    info->weight_size = ALIGN_PAGE(m_bweight.size);
+    info->shared_size = info->text_size + info->weight_size;
+
+    /* the buffers allocated by JobZ5::alloc_load_job_buffers */
+    info->rodata_size = ALIGN_PAGE(m_brodata.size);
+    info->dcr_size = ALIGN_PAGE(m_bdesc.size);
+    info->tcb_size = ALIGN_PAGE((m_subgraphs.size() * task_per_sg + 1) * sizeof(tcb_t));
+    for (uint32_t i = 0; i < m_subgraphs.size(); i++)
+    {
+        for (uint32_t k = 0; k < m_subgraphs[i].reuse_sections.size(); k++)
+        {
+            info->reuse_size += ALIGN_PAGE(m_subgraphs[i].reuse_sections[k].size);
+            if ((m_subgraphs[i].reuse_sections[k].size != 0) &&
+                (m_subgraphs[i].reuse_sections[k].align_in_page > 1))
+            {
+                info->align_slack += (m_subgraphs[i].reuse_sections[k].align_in_page - 1) * PAGE_SIZE;
+            }
+        }
+        info->stack_size += task_per_sg * ALIGN_PAGE(m_subgraphs[i].stack_size);
+        if (m_subgraphs[i].stack_align_in_page > 1)
+        {
+            info->align_slack += task_per_sg * (m_subgraphs[i].stack_align_in_page - 1) * PAGE_SIZE;
+        }
+        info->data_size += task_per_sg * ALIGN_PAGE(m_bdata.size);
+    }
+    info->job_size = info->rodata_size + info->dcr_size + info->tcb_size + info->reuse_size +
+        info->stack_size + info->data_size;
+}
+
 aipu_status_t aipudrv::GraphZ5::get_tensor_count(aipu_tensor_type_t type, uint32_t* cnt)
 {
     if (nullptr == cnt)
@@ -68,6 +68,7 @@ public:
     aipu_status_t create_job(JOB_ID* id, const aipu_global_config_simulation_t* cfg);
     aipu_status_t get_tensor_count(aipu_tensor_type_t type, uint32_t* cnt);
     aipu_status_t get_tensor_descriptor(aipu_tensor_type_t type, uint32_t tensor, aipu_tensor_desc_t* desc);
+    void get_memory_info(aipu_graph_memory_info_t* info);
 
 public:
     void set_subgraph(struct Subgraph sg)
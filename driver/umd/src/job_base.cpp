@@ -35,27 +35,37 @@ aipudrv::JobBase::JobBase(const GraphBase& graph, DeviceBase* dev):
 
 aipudrv::JobBase::~JobBase()
 {
+    if (is_scheduled())
+    {
+        m_dev->drop_job_status(m_dev_job_id);
+    }
+    m_dev->release_job(m_id);
 }
 
 aipu_status_t aipudrv::JobBase::get_status(aipu_job_status_t* status)
 {
     aipu_status_t ret = AIPU_STATUS_SUCCESS;
-    std::vector<aipu_job_status_desc> jobs_status;
+    aipu_job_status_desc job_status;
+    bool done = false;
 
-    ret = convert_ll_status(m_dev->get_status(jobs_status, 1));
-    if (ret != AIPU_STATUS_SUCCESS)
+    /* only the status of this job is taken: the others are kept for their owners */
+    if (is_scheduled())
     {
-        return ret;
+        ret = m_dev->poll_job_status(m_dev_job_id, &job_status, 0, &done);
+        if (ret != AIPU_STATUS_SUCCESS)
+        {
+            return ret;
+        }
     }
 
-    if (jobs_status.size() != 0)
+    if (done)
     {
-        m_status = jobs_status[0].state;
+        m_status = job_status.state;
     }
 
     if ((m_status == AIPU_JOB_STATUS_DONE) || (m_status == AIPU_JOB_STATUS_EXCEPTION))
     {
-        *status = (aipu_job_status_t)m_status;
+        *status = (aipu_job_status_t)m_status.load();
         dump_job_private_buffers_after_run(m_rodata, m_descriptor);
     }
     else
@@ -69,22 +79,27 @@ aipu_status_t aipudrv::JobBase::get_status(aipu_job_status_t* status)
 aipu_status_t aipudrv::JobBase::get_status_blocking(aipu_job_status_t* status, int32_t time_out)
 {
     aipu_status_t ret = AIPU_STATUS_SUCCESS;
-    std::vector<aipu_job_status_desc> jobs_status;
+    aipu_job_status_desc job_status;
+    bool done = false;
 
-    ret = convert_ll_status(m_dev->poll_status(jobs_status, 1, time_out, true));
-    if (ret != AIPU_STATUS_SUCCESS)
+    /* only the status of this job is taken: the others are kept for their owners */
+    if (is_scheduled())
     {
-        return ret;
+        ret = m_dev->poll_job_status(m_dev_job_id, &job_status, time_out, &done);
+        if (ret != AIPU_STATUS_SUCCESS)
+        {
+            return ret;
+        }
     }
 
-    if (jobs_status.size() != 0)
+    if (done)
     {
-        m_status = jobs_status[0].state;
+        m_status = job_status.state;
     }
 
     if ((m_status == AIPU_JOB_STATUS_DONE) || (m_status == AIPU_JOB_STATUS_EXCEPTION))
     {
-        *status = (aipu_job_status_t)m_status;
+        *status = (aipu_job_status_t)m_status.load();
         dump_job_private_buffers_after_run(m_rodata, m_descriptor);
     }
     else
@@ -97,6 +112,8 @@ aipu_status_t aipudrv::JobBase::get_status_blocking(aipu_job_status_t* status, i
 
 aipu_status_t aipudrv::JobBase::load_tensor(uint32_t tensor, const void* data)
 {
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+
     if (nullptr == data)
     {
         return AIPU_STATUS_ERROR_NULL_PTR;
@@ -115,6 +132,13 @@ aipu_status_t aipudrv::JobBase::load_tensor(uint32_t tensor, const void* data)
         return AIPU_STATUS_ERROR_INVALID_OP;
     }
 
+    /* the input buffers of a hibernated job are allocated again */
+    ret = wake();
+    if (AIPU_STATUS_SUCCESS != ret)
+    {
+        return ret;
+    }
+
     assert(m_mem->write(m_inputs[tensor].pa, (const char*)data, m_inputs[tensor].size)
         == (int)m_inputs[tensor].size);
     return AIPU_STATUS_SUCCESS;
@@ -130,8 +154,8 @@ aipu_status_t aipudrv::JobBase::get_tensor(aipu_tensor_type_t type, uint32_t ten
         return AIPU_STATUS_ERROR_NULL_PTR;
     }
 
-    /* Applications cannot get tensors if a job is not done status */
-    if (m_status != AIPU_JOB_STATUS_DONE)
+    /* Applications cannot get tensors if a job is not done status, or has lost them */
+    if ((m_status != AIPU_JOB_STATUS_DONE) || m_hibernated)
     {
         return AIPU_STATUS_ERROR_INVALID_OP;
     }
@@ -182,7 +206,8 @@ aipu_status_t aipudrv::JobBase::setup_rodata(
     const std::vector<BufferDesc>& reuse_buf,
     const std::vector<BufferDesc>& static_buf,
     BufferDesc rodata,
-    BufferDesc dcr
+    BufferDesc dcr,
+    bool reuse_only
 )
 {
     aipu_status_t ret = AIPU_STATUS_SUCCESS;
@@ -218,6 +243,12 @@ aipu_status_t aipudrv::JobBase::setup_rodata(
             entry = dcr_va + param_map[i].offset_in_map - rodata.req_size;
         }
 
+        /* weights do not move: only reuse relocations need patching again */
+        if (reuse_only && (param_map[i].load_type != PARAM_MAP_LOAD_TYPE_REUSE))
+        {
+            continue;
+        }
+
         if (param_map[i].load_type == PARAM_MAP_LOAD_TYPE_REUSE)
         {
             if (ref_iter >= reuse_buf.size())
@@ -255,6 +286,91 @@ finish:
     return ret;
 }
 
+aipu_status_t aipudrv::JobBase::rebind_input(uint32_t tensor, DEV_PA_64 pa,
+    const std::vector<struct GraphIOTensorDesc>& inputs,
+    const std::vector<struct GraphParamMapLoadDesc>& param_map,
+    BufferDesc rodata, BufferDesc dcr)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    char* ro_va = nullptr;
+    char* dcr_va = nullptr;
+    uint32_t patched = 0;
+    BufferDesc buf;
+
+    if ((tensor >= m_inputs.size()) || (tensor >= inputs.size()))
+    {
+        return AIPU_STATUS_ERROR_INVALID_TENSOR_ID;
+    }
+
+    ret = validate_schedule_status();
+    if (AIPU_STATUS_SUCCESS != ret)
+    {
+        return ret;
+    }
+
+    ret = wake();
+    if (AIPU_STATUS_SUCCESS != ret)
+    {
+        return ret;
+    }
+
+    m_mem->pa_to_va(rodata.pa, rodata.size, &ro_va);
+    if (dcr.size != 0)
+    {
+        m_mem->pa_to_va(dcr.pa, dcr.size, &dcr_va);
+    }
+
+    /* re-patch the parameters pointing into this input: the reuse section is left as it is */
+    for (uint32_t i = 0; i < param_map.size(); i++)
+    {
+        char* entry = nullptr;
+        uint32_t init_val = 0;
+        uint32_t finl_val = 0;
+        uint32_t sec_offset = param_map[i].sub_section_offset;
+        uint32_t pa_32 = 0;
+
+        if ((param_map[i].load_type != PARAM_MAP_LOAD_TYPE_REUSE) ||
+            (param_map[i].ref_section_iter != inputs[tensor].ref_section_iter) ||
+            (sec_offset < inputs[tensor].offset_in_section) ||
+            (sec_offset >= inputs[tensor].offset_in_section + inputs[tensor].size))
+        {
+            continue;
+        }
+
+        if (param_map[i].offset_in_map < rodata.req_size)
+        {
+            entry = ro_va + param_map[i].offset_in_map;
+        }
+        else if (dcr.size != 0)
+        {
+            entry = dcr_va + param_map[i].offset_in_map - rodata.req_size;
+        }
+        else
+        {
+            return AIPU_STATUS_ERROR_INVALID_GBIN;
+        }
+
+        pa_32 = get_low_32(pa + sec_offset - inputs[tensor].offset_in_section);
+        memcpy(&init_val, entry, 4);
+        finl_val = ((pa_32 & param_map[i].addr_mask) | (init_val & (~param_map[i].addr_mask)));
+        memcpy(entry, &finl_val, 4);
+        patched++;
+    }
+
+    /* the graph code reaches an input only through the parameters patched above: if none is,
+     * it would read the stale reuse buffer */
+    if (0 == patched)
+    {
+        LOG(LOG_DEBUG, "job 0x%lx: input %u is not addressed by any parameter", m_id, tensor);
+        return AIPU_STATUS_ERROR_OP_NOT_SUPPORTED;
+    }
+
+    m_inputs[tensor].pa = pa;
+    buf.init(pa, m_inputs[tensor].size, m_inputs[tensor].size);
+    m_bound_inputs.push_back(buf);
+    return ret;
+}
+
 aipudrv::DEV_PA_64 aipudrv::JobBase::get_base_pa(int sec_type, BufferDesc& rodata,
         BufferDesc& descriptor)
 {
@@ -308,6 +424,12 @@ void aipudrv::JobBase::create_io_buffers(std::vector<struct JobIOBuffer>& bufs,
 void aipudrv::JobBase::create_io_buffers(const struct GraphIOTensors& io,
     const std::vector<BufferDesc>& reuses)
 {
+    m_inputs.clear();
+    m_outputs.clear();
+    m_inter_dumps.clear();
+    m_profiler.clear();
+    m_printf.clear();
+    m_layer_counter.clear();
     create_io_buffers(m_inputs, io.inputs, reuses);
     create_io_buffers(m_outputs, io.outputs, reuses);
     create_io_buffers(m_inter_dumps, io.inter_dumps, reuses);
@@ -449,6 +571,45 @@ void aipudrv::JobBase::dump_job_private_buffers_after_run(BufferDesc& rodata, Bu
     }
 }
 
+aipu_status_t aipudrv::JobBase::fence()
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+
+    ret = validate_schedule_status();
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        return ret;
+    }
+
+    m_fenced_status = m_status;
+    m_status = AIPU_JOB_STATUS_FENCED;
+    return ret;
+}
+
+aipu_status_t aipudrv::JobBase::unfence(bool run)
+{
+    if (m_status != AIPU_JOB_STATUS_FENCED)
+    {
+        return AIPU_STATUS_ERROR_INVALID_OP;
+    }
+
+    /* a job waiting for a failed job is not run and fails as well */
+    if (!run)
+    {
+        m_status = AIPU_JOB_STATUS_EXCEPTION;
+        return AIPU_STATUS_SUCCESS;
+    }
+
+    m_status = m_fenced_status;
+    return schedule();
+}
+
+void aipudrv::JobBase::retire(uint32_t state)
+{
+    m_status = state;
+    dump_job_private_buffers_after_run(m_rodata, m_descriptor);
+}
+
 aipu_status_t aipudrv::JobBase::validate_schedule_status()
 {
     if ((m_status == AIPU_JOB_STATUS_INIT) ||
@@ -457,4 +618,17 @@ aipu_status_t aipudrv::JobBase::validate_schedule_status()
         return AIPU_STATUS_SUCCESS;
     }
     return AIPU_STATUS_ERROR_INVALID_OP;
+}
+
+aipu_status_t aipudrv::JobBase::validate_hibernate_status()
+{
+    /* inputs bound to buffers of other jobs were patched into the reuse relocations */
+    if (((m_status == AIPU_JOB_STATUS_INIT) ||
+        (m_status == AIPU_JOB_STATUS_DONE) ||
+        (m_status == AIPU_JOB_STATUS_EXCEPTION)) &&
+        m_bound_inputs.empty())
+    {
+        return AIPU_STATUS_SUCCESS;
+    }
+    return AIPU_STATUS_ERROR_INVALID_OP;
 }
\ No newline at end of file
@@ -24,6 +24,7 @@
 #define _JOB_BASE_H_
 
 #include <vector>
+#include <atomic>
 #include <pthread.h>
 #include "standard_api.h"
 #include "graph.h"
@@ -50,16 +51,19 @@ typedef enum {
     AIPU_JOB_STATUS_INIT  = 3,
     AIPU_JOB_STATUS_SCHED = 4,
     AIPU_JOB_STATUS_BIND  = 5,
+    AIPU_JOB_STATUS_FENCED = 6,
 } aipu_job_status_internal_t;
 
 class JobBase
 {
 protected:
-    JOB_ID            m_id;
+    JOB_ID            m_id = 0;
     const GraphBase&  m_graph;
     DeviceBase*       m_dev;
     MemoryBase*       m_mem;
     uint32_t          m_remap_flag = 0;
+    /* device tag of the last schedule, reported back as aipu_job_status_desc::job_id */
+    uint32_t          m_dev_job_id = 0;
 
 protected:
     /* shared buffers */
@@ -71,6 +75,8 @@ protected:
     std::vector<struct JobIOBuffer> m_profiler;
     std::vector<struct JobIOBuffer> m_printf;
     std::vector<struct JobIOBuffer> m_layer_counter;
+    /* input buffers not owned by this job, bound by bind_input() */
+    std::vector<BufferDesc> m_bound_inputs;
 
 protected:
     bool m_dump_text = false;
@@ -85,7 +91,13 @@ protected:
     std::string m_dump_prefix = "temp";
 
 protected:
-    uint32_t m_status = AIPU_JOB_STATUS_NO_STATUS;
+    /* written by scheduling/polling threads while the reclaimer and queues read it */
+    std::atomic<uint32_t> m_status{AIPU_JOB_STATUS_NO_STATUS};
+    /* status to be restored when the fence is released */
+    uint32_t m_fenced_status = AIPU_JOB_STATUS_NO_STATUS;
+    /* scratch buffers (reuse, stack, data) released while parked, and their size */
+    bool m_hibernated = false;
+    uint64_t m_scratch_size = 0;
 
 private:
     DEV_PA_64 get_base_pa(int sec_type, BufferDesc& rodata,
@@ -99,6 +111,10 @@ protected:
         const std::vector<struct GraphParamMapLoadDesc>& param_map,
         const std::vector<BufferDesc>& reuse_buf,
         const std::vector<BufferDesc>& static_buf,
+        BufferDesc rodata, BufferDesc dcr, bool reuse_only = false);
+    aipu_status_t rebind_input(uint32_t tensor, DEV_PA_64 pa,
+        const std::vector<struct GraphIOTensorDesc>& inputs,
+        const std::vector<struct GraphParamMapLoadDesc>& param_map,
         BufferDesc rodata, BufferDesc dcr);
     virtual const Graph& get_graph()
     {
@@ -112,6 +128,7 @@ protected:
     void dump_job_private_buffers(BufferDesc& rodata, BufferDesc& descriptor);
     void dump_job_private_buffers_after_run(BufferDesc& rodata, BufferDesc& descriptor);
     aipu_status_t validate_schedule_status();
+    aipu_status_t validate_hibernate_status();
 
 public:
     virtual aipu_status_t init(const aipu_global_config_simulation_t* cfg) = 0;
@@ -127,6 +144,56 @@ public:
         return AIPU_STATUS_SUCCESS;
     };
     virtual aipu_status_t bind_core(uint32_t core_id) = 0;
+    /**
+     * @brief let an input tensor be read from a buffer of the same size owned by someone
+     *        else (e.g. an output of another job), instead of the job's own reuse buffer;
+     *        not supported if the graph code does not reach the input by a patched parameter
+     */
+    virtual aipu_status_t bind_input(uint32_t tensor, DEV_PA_64 pa)
+    {
+        return AIPU_STATUS_ERROR_OP_NOT_SUPPORTED;
+    }
+    /**
+     * @brief schedule this job behind a scheduled job, to be started by the device only
+     *        after that job is done; not supported if the device cannot chain them
+     */
+    virtual aipu_status_t schedule_after(JobBase* dep)
+    {
+        return AIPU_STATUS_ERROR_OP_NOT_SUPPORTED;
+    }
+    /**
+     * @brief how the member jobs of a super graph job are fed and started
+     */
+    virtual aipu_status_t get_super_job_stat(aipu_super_job_stat_t* stat)
+    {
+        return AIPU_STATUS_ERROR_OP_NOT_SUPPORTED;
+    }
+    /**
+     * @brief release the scratch buffers of an idle job, to be allocated again and
+     *        re-patched by wake() before its tensors are loaded or it is scheduled
+     */
+    virtual aipu_status_t hibernate()
+    {
+        return AIPU_STATUS_ERROR_OP_NOT_SUPPORTED;
+    }
+    virtual aipu_status_t wake()
+    {
+        return AIPU_STATUS_SUCCESS;
+    }
+    aipu_status_t fence();
+    aipu_status_t unfence(bool run);
+    /**
+     * @brief end a scheduled job with a device status got by someone else
+     */
+    void retire(uint32_t state);
+    /**
+     * @brief hand the device completion of a scheduled job over to someone who takes it by
+     *        the device tag: it is not dropped when the job is destroyed, which ends with exception
+     */
+    void disown()
+    {
+        m_status = AIPU_JOB_STATUS_EXCEPTION;
+    }
     virtual aipu_status_t debugger_run()
     {
         return AIPU_STATUS_ERROR_OP_NOT_SUPPORTED;
@@ -143,6 +210,50 @@ public:
     {
         return m_id;
     }
+    uint32_t get_dev_job_id()
+    {
+        return m_dev_job_id;
+    }
+    bool is_in_flight()
+    {
+        return (m_status == AIPU_JOB_STATUS_SCHED) || (m_status == AIPU_JOB_STATUS_FENCED);
+    }
+    bool is_scheduled()
+    {
+        return m_status == AIPU_JOB_STATUS_SCHED;
+    }
+    bool is_fenced()
+    {
+        return m_status == AIPU_JOB_STATUS_FENCED;
+    }
+    bool is_finished()
+    {
+        return (m_status == AIPU_JOB_STATUS_DONE) || (m_status == AIPU_JOB_STATUS_EXCEPTION);
+    }
+    bool is_failed()
+    {
+        return m_status == AIPU_JOB_STATUS_EXCEPTION;
+    }
+    bool is_hibernated()
+    {
+        return m_hibernated;
+    }
+    DeviceBase* get_dev()
+    {
+        return m_dev;
+    }
+    const GraphBase& get_graph_base()
+    {
+        return m_graph;
+    }
+    const std::vector<struct JobIOBuffer>& get_inputs()
+    {
+        return m_inputs;
+    }
+    const std::vector<struct JobIOBuffer>& get_outputs()
+    {
+        return m_outputs;
+    }
 
 public:
     JobBase(const GraphBase& graph, DeviceBase* dev);
@@ -34,12 +34,12 @@ aipudrv::JobLegacy::~JobLegacy()
 {
 }
 
-aipu_status_t aipudrv::JobLegacy::setup_rodata_legacy()
+aipu_status_t aipudrv::JobLegacy::setup_rodata_legacy(bool reuse_only)
 {
     const std::vector<struct GraphParamMapLoadDesc>& param_map =
         get_graph().m_param_map;
 
-    return setup_rodata(param_map, m_reuses, m_weights, m_rodata, m_descriptor);
+    return setup_rodata(param_map, m_reuses, m_weights, m_rodata, m_descriptor, reuse_only);
 }
 
 aipu_status_t aipudrv::JobLegacy::init(const aipu_global_config_simulation_t* cfg)
@@ -180,7 +180,10 @@ aipu_status_t aipudrv::JobLegacy::free_job_buffers()
 
     for (uint32_t i = 0; i < m_reuses.size(); i++)
     {
-        m_mem->free(&m_reuses[i]);
+        if (m_reuses[i].size != 0)
+        {
+            m_mem->free(&m_reuses[i]);
+        }
     }
     m_reuses.clear();
 
@@ -190,6 +193,7 @@ aipu_status_t aipudrv::JobLegacy::free_job_buffers()
     m_profiler.clear();
     m_printf.clear();
     m_layer_counter.clear();
+    m_bound_inputs.clear();
 
     return ret;
 }
@@ -205,11 +209,18 @@ aipu_status_t aipudrv::JobLegacy::schedule()
         return ret;
     }
 
+    ret = wake();
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        return ret;
+    }
+
     dump_job_shared_buffers();
     dump_job_private_buffers(m_rodata, m_descriptor);
 
     memset(&desc.kdesc, 0, sizeof(desc.kdesc));
-    desc.kdesc.job_id = m_id;
+    m_dev_job_id = m_dev->alloc_job_id();
+    desc.kdesc.job_id = m_dev_job_id;
     desc.kdesc.is_defer_run = m_is_defer_run;
     desc.kdesc.do_trigger = m_do_trigger;
     desc.kdesc.core_id = m_bind_core_id;
@@ -226,6 +237,12 @@ aipu_status_t aipudrv::JobLegacy::schedule()
     desc.kdesc.enable_prof = 0;
     desc.kdesc.enable_asid = 1;
     desc.kdesc.exec_flag = AIPU_JOB_EXEC_FLAG_NONE;
+    desc.chain_after = m_chain_after;
+
+#if (defined SIMULATION)
+    /* simulation only: these copies allocate and are not needed by KMD */
+    desc.graph_id = get_graph().m_id;
+    desc.job_id = m_id;
     desc.text_size = get_graph().m_text.req_size;
     desc.weight_pa = get_graph().m_weight.pa;
     desc.weight_size = get_graph().m_weight.req_size;
@@ -234,6 +251,8 @@ aipu_status_t aipudrv::JobLegacy::schedule()
     desc.dcr_size = m_descriptor.req_size;
     desc.stack_size = m_stack.req_size;
     desc.reuses = m_reuses;
+    /* bound inputs live outside the reuse buffers and are loaded like them */
+    desc.reuses.insert(desc.reuses.end(), m_bound_inputs.begin(), m_bound_inputs.end());
     for (uint32_t i = 0; i < m_outputs.size(); i++)
     {
         BufferDesc buf;
@@ -255,6 +274,7 @@ aipu_status_t aipudrv::JobLegacy::schedule()
         desc.simulator = m_z3_sim;
     }
     desc.log_level = m_log_level;
+#endif
 
     if (get_graph().m_sram_flag)
     {
@@ -264,11 +284,7 @@ aipu_status_t aipudrv::JobLegacy::schedule()
     ret = m_dev->schedule(desc);
     if (AIPU_STATUS_SUCCESS == ret)
     {
-#if (defined SIMULATION)
-        m_status = AIPU_JOB_STATUS_DONE;
-#else
         m_status = AIPU_JOB_STATUS_SCHED;
-#endif
     }
     else
     {
@@ -283,6 +299,109 @@ aipu_status_t aipudrv::JobLegacy::destroy()
     return free_job_buffers();
 }
 
+void aipudrv::JobLegacy::release_scratch_buffers()
+{
+    if (m_stack.size != 0)
+    {
+        m_mem->free(&m_stack);
+        m_stack.reset();
+    }
+
+    for (uint32_t i = 0; i < m_reuses.size(); i++)
+    {
+        if (m_reuses[i].size != 0)
+        {
+            m_mem->free(&m_reuses[i]);
+            m_reuses[i].reset();
+        }
+    }
+}
+
+aipu_status_t aipudrv::JobLegacy::hibernate()
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+
+    ret = validate_hibernate_status();
+    if ((AIPU_STATUS_SUCCESS != ret) || m_hibernated)
+    {
+        return ret;
+    }
+
+    m_scratch_size = m_stack.size;
+    for (uint32_t i = 0; i < m_reuses.size(); i++)
+    {
+        m_scratch_size += m_reuses[i].size;
+    }
+
+    release_scratch_buffers();
+    m_hibernated = true;
+    return ret;
+}
+
+aipu_status_t aipudrv::JobLegacy::wake()
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+
+    if (!m_hibernated)
+    {
+        return ret;
+    }
+
+    /* admitted like the job creation, without waiting */
+    ret = m_mem->reserve(m_scratch_size, 0);
+    if (AIPU_STATUS_SUCCESS != ret)
+    {
+        return ret;
+    }
+
+    /* 1. allocate task stack and reuse buffers again, as init() does */
+    ret = m_mem->malloc(get_graph().m_stack_size, get_graph().m_stack_align_in_page,
+            &m_stack, "stack");
+    if (AIPU_STATUS_SUCCESS != ret)
+    {
+        goto finish;
+    }
+
+    for (uint32_t i = 0; i < m_reuses.size(); i++)
+    {
+        if (get_graph().m_reuse_sections[i].size != 0)
+        {
+            char str[20];
+            snprintf(str, 20, "reuse_%u", i);
+            ret = m_mem->malloc(get_graph().m_reuse_sections[i].size,
+                get_graph().m_reuse_sections[i].align_in_page, &m_reuses[i], str);
+            if (AIPU_STATUS_SUCCESS != ret)
+            {
+                goto finish;
+            }
+        }
+    }
+
+    /* 2. re-patch the reuse relocations of rodata & dcr */
+    ret = setup_rodata_legacy(true);
+    if (AIPU_STATUS_SUCCESS != ret)
+    {
+        goto finish;
+    }
+
+    /* 3. IO and printf buffers are in the reuse buffers */
+    create_io_buffers(get_graph().m_io, m_reuses);
+    for (uint32_t i = 0; i < m_printf.size(); i++)
+    {
+        uint32_t header_len = 8;
+        assert(m_mem->bzero(m_printf[i].pa, header_len) == (int)header_len);
+    }
+    m_hibernated = false;
+
+finish:
+    if (ret)
+    {
+        release_scratch_buffers();
+    }
+    m_mem->unreserve();
+    return ret;
+}
+
 aipu_status_t aipudrv::JobLegacy::config_simulation(uint64_t types, const aipu_job_config_simulation_t* config)
 {
     aipu_status_t ret = AIPU_STATUS_SUCCESS;
@@ -319,6 +438,29 @@ aipu_status_t aipudrv::JobLegacy::bind_core(uint32_t core_id)
     return ret;
 }
 
+aipu_status_t aipudrv::JobLegacy::schedule_after(JobBase* dep)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+
+    /* z1/2/3 have no TCB dependency: the device queues the job behind by itself */
+    if (!m_dev->can_chain_jobs() || (dep->get_dev() != m_dev) || !dep->is_scheduled() ||
+        (nullptr == dynamic_cast<JobLegacy*>(dep)))
+    {
+        return AIPU_STATUS_ERROR_OP_NOT_SUPPORTED;
+    }
+
+    m_chain_after = dep->get_dev_job_id();
+    ret = schedule();
+    m_chain_after = 0;
+    return ret;
+}
+
+aipu_status_t aipudrv::JobLegacy::bind_input(uint32_t tensor, DEV_PA_64 pa)
+{
+    return rebind_input(tensor, pa, get_graph().m_io.inputs, get_graph().m_param_map,
+        m_rodata, m_descriptor);
+}
+
 aipu_status_t aipudrv::JobLegacy::debugger_run()
 {
     aipu_status_t ret = AIPU_STATUS_SUCCESS;
@@ -48,6 +48,8 @@ private:
     bool m_is_defer_run = false;
     bool m_do_trigger = false;
     uint32_t m_bind_core_id = 0;
+    /* device tag of the job this one is chained after, 0 for none */
+    uint32_t m_chain_after = 0;
 
 private:
     const GraphLegacy& get_graph()
@@ -55,14 +57,19 @@ private:
         return static_cast<const GraphLegacy&>(m_graph);
     }
     aipu_status_t free_job_buffers();
-    aipu_status_t setup_rodata_legacy();
+    aipu_status_t setup_rodata_legacy(bool reuse_only = false);
+    void release_scratch_buffers();
 
 public:
     virtual aipu_status_t init(const aipu_global_config_simulation_t* cfg);
     virtual aipu_status_t schedule();
     virtual aipu_status_t destroy();
+    virtual aipu_status_t hibernate();
+    virtual aipu_status_t wake();
     aipu_status_t config_simulation(uint64_t types, const aipu_job_config_simulation_t* config);
     aipu_status_t bind_core(uint32_t core_id);
+    aipu_status_t bind_input(uint32_t tensor, DEV_PA_64 pa);
+    aipu_status_t schedule_after(JobBase* dep);
     aipu_status_t debugger_run();
 
 public:
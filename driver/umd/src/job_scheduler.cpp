@@ -0,0 +1,473 @@
+/**********************************************************************************
+ * This file is CONFIDENTIAL and any use by you is subject to the terms of the
+ * agreement between you and Arm China or the terms of the agreement between you
+ * and the party authorised by Arm China to disclose this file to you.
+ * The confidential and proprietary information contained in this file
+ * may only be used by a person authorised under and to the extent permitted
+ * by a subsisting licensing agreement from Arm China.
+ *
+ *        (C) Copyright 2020 Arm Technology (China) Co. Ltd.
+ *                    All rights reserved.
+ *
+ * This entire notice must be reproduced on all copies of this file and copies of
+ * this file may only be made by a person if such person is permitted to do so
+ * under the terms of a subsisting license agreement from Arm China.
+ *
+ *********************************************************************************/
+
+
+/**
+ * @file  job_scheduler.cpp
+ * @brief AIPU User Mode Driver (UMD) job scheduler module implementation
+ */
+
+#include <algorithm>
+#include <iterator>
+#include "job_scheduler.h"
+#include "utils/helper.h"
+#include "utils/log.h"
+
+/* stride of a queue of weight 1; the stride of weight w is SCHED_STRIDE_UNIT / w */
+#define SCHED_STRIDE_UNIT  (1ULL << 20)
+
+aipudrv::JobScheduler::JobScheduler()
+{
+    pthread_mutex_init(&m_lock, NULL);
+}
+
+aipudrv::JobScheduler::~JobScheduler()
+{
+    pthread_mutex_destroy(&m_lock);
+}
+
+aipu_status_t aipudrv::JobScheduler::config(const aipu_global_config_scheduler_t* config)
+{
+    if (nullptr == config)
+    {
+        return AIPU_STATUS_ERROR_NULL_PTR;
+    }
+
+    pthread_mutex_lock(&m_lock);
+    m_jobs_per_core = (config->jobs_per_core != 0) ? config->jobs_per_core : 1;
+    /* a raised limit admits queued jobs at once */
+    dispatch();
+    pthread_mutex_unlock(&m_lock);
+    return AIPU_STATUS_SUCCESS;
+}
+
+aipu_status_t aipudrv::JobScheduler::create_queue(const aipu_job_queue_config_t* config, QUEUE_ID* id)
+{
+    JobQueue queue;
+
+    if ((nullptr == config) || (nullptr == id))
+    {
+        return AIPU_STATUS_ERROR_NULL_PTR;
+    }
+
+    queue.cfg = *config;
+    queue.cfg.weight = (config->weight != 0) ? config->weight : 1;
+    queue.in_flight_cnt = 0;
+    queue.submitted_cnt = 0;
+    queue.dispatched_cnt = 0;
+    queue.done_cnt = 0;
+    queue.wait_ns = 0;
+    queue.max_wait_ns = 0;
+    queue.latency_ns = 0;
+    queue.max_latency_ns = 0;
+
+    pthread_mutex_lock(&m_lock);
+    queue.pass = m_vtime;
+    *id = m_next_queue_id++;
+    m_queues[*id] = queue;
+    pthread_mutex_unlock(&m_lock);
+    return AIPU_STATUS_SUCCESS;
+}
+
+aipu_status_t aipudrv::JobScheduler::destroy_queue(QUEUE_ID id)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    std::map<QUEUE_ID, JobQueue>::iterator iter;
+
+    pthread_mutex_lock(&m_lock);
+    iter = m_queues.find(id);
+    if (iter == m_queues.end())
+    {
+        ret = AIPU_STATUS_ERROR_INVALID_QUEUE_ID;
+        goto unlock;
+    }
+
+    if (!iter->second.jobs.empty() || (iter->second.in_flight_cnt != 0))
+    {
+        ret = AIPU_STATUS_ERROR_INVALID_OP;
+        goto unlock;
+    }
+
+    m_queues.erase(iter);
+    for (auto graph = m_graph_queues.begin(); graph != m_graph_queues.end();)
+    {
+        if (graph->second == id)
+        {
+            graph = m_graph_queues.erase(graph);
+        }
+        else
+        {
+            graph++;
+        }
+    }
+
+unlock:
+    pthread_mutex_unlock(&m_lock);
+    return ret;
+}
+
+aipu_status_t aipudrv::JobScheduler::set_graph_queue(GRAPH_ID graph, QUEUE_ID queue)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+
+    pthread_mutex_lock(&m_lock);
+    if (0 == queue)
+    {
+        m_graph_queues.erase(graph);
+    }
+    else if (m_queues.count(queue) == 0)
+    {
+        ret = AIPU_STATUS_ERROR_INVALID_QUEUE_ID;
+    }
+    else
+    {
+        m_graph_queues[graph] = queue;
+    }
+    pthread_mutex_unlock(&m_lock);
+    return ret;
+}
+
+aipu_status_t aipudrv::JobScheduler::get_stat(QUEUE_ID id, aipu_job_queue_stat_t* stat)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    std::map<QUEUE_ID, JobQueue>::iterator iter;
+
+    if (nullptr == stat)
+    {
+        return AIPU_STATUS_ERROR_NULL_PTR;
+    }
+
+    pthread_mutex_lock(&m_lock);
+    iter = m_queues.find(id);
+    if (iter == m_queues.end())
+    {
+        ret = AIPU_STATUS_ERROR_INVALID_QUEUE_ID;
+    }
+    else
+    {
+        const JobQueue& queue = iter->second;
+        stat->submitted_cnt = queue.submitted_cnt;
+        stat->dispatched_cnt = queue.dispatched_cnt;
+        stat->done_cnt = queue.done_cnt;
+        stat->queued_cnt = queue.jobs.size();
+        stat->in_flight_cnt = queue.in_flight_cnt;
+        stat->avg_wait_us = (queue.dispatched_cnt != 0) ? queue.wait_ns / queue.dispatched_cnt / 1000 : 0;
+        stat->max_wait_us = queue.max_wait_ns / 1000;
+        stat->avg_latency_us = (queue.done_cnt != 0) ? queue.latency_ns / queue.done_cnt / 1000 : 0;
+        stat->max_latency_us = queue.max_latency_ns / 1000;
+    }
+    pthread_mutex_unlock(&m_lock);
+    return ret;
+}
+
+bool aipudrv::JobScheduler::is_managed(JobBase* job)
+{
+    bool managed = false;
+
+    /* a job scheduled before its graph is assigned to a queue is left to itself */
+    pthread_mutex_lock(&m_lock);
+    managed = (m_jobs.count(job->get_id()) != 0) ||
+        ((m_graph_queues.count(job_id2graph_id(job->get_id())) != 0) && !job->is_scheduled());
+    pthread_mutex_unlock(&m_lock);
+    return managed;
+}
+
+uint32_t aipudrv::JobScheduler::get_capacity(DeviceBase* dev)
+{
+    uint32_t cluster_cnt = 0;
+    uint32_t core_cnt = 0;
+
+    if ((dev->get_cluster_count(&cluster_cnt) != AIPU_STATUS_SUCCESS) ||
+        (dev->get_core_count(0, &core_cnt) != AIPU_STATUS_SUCCESS))
+    {
+        return m_jobs_per_core;
+    }
+    return cluster_cnt * core_cnt * m_jobs_per_core;
+}
+
+void aipudrv::JobScheduler::dispatch()
+{
+    while (true)
+    {
+        std::map<QUEUE_ID, JobQueue>::iterator best = m_queues.end();
+        std::map<JOB_ID, QueuedJob>::iterator iter;
+        JOB_ID id = 0;
+        uint64_t wait = 0;
+
+        /* the highest priority first, then the least pass among queues of that priority */
+        for (auto queue = m_queues.begin(); queue != m_queues.end(); queue++)
+        {
+            if (queue->second.jobs.empty())
+            {
+                continue;
+            }
+
+            DeviceBase* dev = m_jobs[queue->second.jobs.front()].dev;
+            if (m_in_flight[dev].size() >= get_capacity(dev))
+            {
+                continue;
+            }
+
+            if ((best == m_queues.end()) ||
+                (queue->second.cfg.priority > best->second.cfg.priority) ||
+                ((queue->second.cfg.priority == best->second.cfg.priority) &&
+                 (queue->second.pass < best->second.pass)))
+            {
+                best = queue;
+            }
+        }
+
+        if (best == m_queues.end())
+        {
+            break;
+        }
+
+        JobQueue& queue = best->second;
+        id = queue.jobs.front();
+        queue.jobs.pop_front();
+        m_vtime = queue.pass;
+        queue.pass += SCHED_STRIDE_UNIT / queue.cfg.weight;
+
+        iter = m_jobs.find(id);
+        wait = umd_get_time_ns_helper() - iter->second.submit_ns;
+        queue.wait_ns += wait;
+        queue.max_wait_ns = std::max(queue.max_wait_ns, wait);
+        queue.dispatched_cnt++;
+
+        if (iter->second.job->unfence(true) != AIPU_STATUS_SUCCESS)
+        {
+            LOG(LOG_ERR, "job 0x%lx of queue %lu fails to be scheduled", (unsigned long)id,
+                (unsigned long)best->first);
+            iter->second.job->retire(AIPU_JOB_STATUS_EXCEPTION);
+            queue.done_cnt++;
+            m_jobs.erase(iter);
+            continue;
+        }
+
+        iter->second.dispatched = true;
+        m_in_flight[iter->second.dev].push_back({id, iter->second.job->get_dev_job_id(),
+            best->first, iter->second.submit_ns});
+        queue.in_flight_cnt++;
+    }
+}
+
+uint32_t aipudrv::JobScheduler::retire(DeviceBase* dev)
+{
+    std::deque<InFlightJob>& in_flight = m_in_flight[dev];
+    aipu_job_status_desc status;
+    uint64_t now = umd_get_time_ns_helper();
+    uint32_t cnt = 0;
+
+    /* jobs finish in any order: each one is matched by its own device tag */
+    for (auto done = in_flight.begin(); done != in_flight.end();)
+    {
+        if (!dev->take_job_status(done->dev_job_id, &status))
+        {
+            done++;
+            continue;
+        }
+
+        JobQueue& queue = m_queues[done->queue];
+        uint64_t latency = now - done->submit_ns;
+
+        queue.in_flight_cnt--;
+        queue.done_cnt++;
+        queue.latency_ns += latency;
+        queue.max_latency_ns = std::max(queue.max_latency_ns, latency);
+
+        if (done->job != 0)
+        {
+            auto iter = m_jobs.find(done->job);
+            iter->second.job->retire(status.state);
+            m_jobs.erase(iter);
+        }
+        done = in_flight.erase(done);
+        cnt++;
+    }
+    return cnt;
+}
+
+aipu_status_t aipudrv::JobScheduler::submit(JobBase* job, bool* queued)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    std::map<GRAPH_ID, QUEUE_ID>::iterator iter;
+    QueuedJob entry;
+
+    *queued = false;
+    pthread_mutex_lock(&m_lock);
+    iter = m_graph_queues.find(job_id2graph_id(job->get_id()));
+    if (iter == m_graph_queues.end())
+    {
+        goto unlock;
+    }
+
+    if (m_jobs.count(job->get_id()) != 0)
+    {
+        ret = AIPU_STATUS_ERROR_INVALID_OP;
+        goto unlock;
+    }
+
+    /* a job released by a fence is queued as it is */
+    if (!job->is_fenced())
+    {
+        ret = job->fence();
+        if (AIPU_STATUS_SUCCESS != ret)
+        {
+            goto unlock;
+        }
+    }
+
+    {
+        JobQueue& queue = m_queues[iter->second];
+
+        /* an idle queue does not bank the share it left unused */
+        if (queue.jobs.empty() && (queue.pass < m_vtime))
+        {
+            queue.pass = m_vtime;
+        }
+        queue.jobs.push_back(job->get_id());
+        queue.submitted_cnt++;
+    }
+
+    entry.job = job;
+    entry.queue = iter->second;
+    entry.dev = job->get_dev();
+    entry.submit_ns = umd_get_time_ns_helper();
+    entry.dispatched = false;
+    m_jobs[job->get_id()] = entry;
+    *queued = true;
+    dispatch();
+
+unlock:
+    pthread_mutex_unlock(&m_lock);
+    return ret;
+}
+
+aipu_status_t aipudrv::JobScheduler::get_status(JobBase* job, int32_t time_out, aipu_job_status_t* status)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    uint64_t deadline = umd_get_time_ns_helper() + (uint64_t)((time_out > 0) ? time_out : 0) * 1000000;
+    bool expired = false;
+
+    *status = AIPU_JOB_STATUS_NO_STATUS;
+    pthread_mutex_lock(&m_lock);
+    while (true)
+    {
+        auto iter = m_jobs.find(job->get_id());
+        DeviceBase* dev = nullptr;
+        uint64_t seq = 0;
+        int32_t wait = time_out;
+
+        if (iter == m_jobs.end())
+        {
+            if (job->is_finished())
+            {
+                *status = job->is_failed() ? AIPU_JOB_STATUS_EXCEPTION : AIPU_JOB_STATUS_DONE;
+            }
+            break;
+        }
+
+        dev = iter->second.dev;
+        if (m_in_flight[dev].empty())
+        {
+            break;
+        }
+
+        /* read before taking: a completion kept after the take bumps it */
+        seq = dev->get_done_seq();
+        if (retire(dev) != 0)
+        {
+            dispatch();
+            continue;
+        }
+        if (expired)
+        {
+            break;
+        }
+
+        if (time_out > 0)
+        {
+            uint64_t now = umd_get_time_ns_helper();
+            wait = (now < deadline) ? (deadline - now + 999999) / 1000000 : 0;
+        }
+
+        /* the device polls for all its waiters and keeps the completions of other jobs */
+        pthread_mutex_unlock(&m_lock);
+        ret = dev->wait_done_jobs(seq, wait);
+        pthread_mutex_lock(&m_lock);
+        if (AIPU_STATUS_SUCCESS != ret)
+        {
+            break;
+        }
+
+        expired = (0 == time_out) || ((time_out > 0) && (umd_get_time_ns_helper() >= deadline));
+    }
+    pthread_mutex_unlock(&m_lock);
+    return ret;
+}
+
+void aipudrv::JobScheduler::drop(std::map<JOB_ID, QueuedJob>::iterator iter)
+{
+    /* the device slot of a job in flight is kept until its completion is taken */
+    if (iter->second.dispatched)
+    {
+        std::deque<InFlightJob>& in_flight = m_in_flight[iter->second.dev];
+        for (uint32_t i = 0; i < in_flight.size(); i++)
+        {
+            if (in_flight[i].job == iter->first)
+            {
+                in_flight[i].job = 0;
+                iter->second.job->disown();
+            }
+        }
+    }
+    else
+    {
+        std::deque<JOB_ID>& jobs = m_queues[iter->second.queue].jobs;
+        jobs.erase(std::find(jobs.begin(), jobs.end(), iter->first));
+    }
+    m_jobs.erase(iter);
+}
+
+void aipudrv::JobScheduler::remove(JOB_ID id)
+{
+    std::map<JOB_ID, QueuedJob>::iterator iter;
+
+    pthread_mutex_lock(&m_lock);
+    iter = m_jobs.find(id);
+    if (iter != m_jobs.end())
+    {
+        drop(iter);
+    }
+    pthread_mutex_unlock(&m_lock);
+}
+
+void aipudrv::JobScheduler::remove_graph(GRAPH_ID graph)
+{
+    pthread_mutex_lock(&m_lock);
+    m_graph_queues.erase(graph);
+    for (auto iter = m_jobs.begin(); iter != m_jobs.end();)
+    {
+        auto next = std::next(iter);
+        if (job_id2graph_id(iter->first) == graph)
+        {
+            drop(iter);
+        }
+        iter = next;
+    }
+    pthread_mutex_unlock(&m_lock);
+}
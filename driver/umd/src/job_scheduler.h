@@ -0,0 +1,131 @@
+/**********************************************************************************
+ * This file is CONFIDENTIAL and any use by you is subject to the terms of the
+ * agreement between you and Arm China or the terms of the agreement between you
+ * and the party authorised by Arm China to disclose this file to you.
+ * The confidential and proprietary information contained in this file
+ * may only be used by a person authorised under and to the extent permitted
+ * by a subsisting licensing agreement from Arm China.
+ *
+ *        (C) Copyright 2020 Arm Technology (China) Co. Ltd.
+ *                    All rights reserved.
+ *
+ * This entire notice must be reproduced on all copies of this file and copies of
+ * this file may only be made by a person if such person is permitted to do so
+ * under the terms of a subsisting license agreement from Arm China.
+ *
+ *********************************************************************************/
+
+
+/**
+ * @file  job_scheduler.h
+ * @brief AIPU User Mode Driver (UMD) job scheduler module header
+ */
+
+#ifndef _JOB_SCHEDULER_H_
+#define _JOB_SCHEDULER_H_
+
+#include <map>
+#include <deque>
+#include <pthread.h>
+#include "standard_api.h"
+#include "job_base.h"
+#include "device_base.h"
+#include "type.h"
+
+namespace aipudrv
+{
+typedef uint64_t QUEUE_ID;
+
+/**
+ * @brief a job queue with its weighted fair queuing pass and statistics
+ */
+struct JobQueue
+{
+    aipu_job_queue_config_t cfg;
+    std::deque<JOB_ID> jobs;
+    /* virtual time of the next dispatch, advanced by a stride inversely proportional to weight */
+    uint64_t pass;
+    uint32_t in_flight_cnt;
+    uint64_t submitted_cnt;
+    uint64_t dispatched_cnt;
+    uint64_t done_cnt;
+    uint64_t wait_ns;
+    uint64_t max_wait_ns;
+    uint64_t latency_ns;
+    uint64_t max_latency_ns;
+};
+
+/**
+ * @brief a job flushed into a queue and not retired yet
+ */
+struct QueuedJob
+{
+    JobBase* job;
+    QUEUE_ID queue;
+    DeviceBase* dev;
+    uint64_t submit_ns;
+    bool dispatched;
+};
+
+/**
+ * @brief a job in flight on a device with its device tag; 0 job if it is cleaned meanwhile
+ */
+struct InFlightJob
+{
+    JOB_ID job;
+    uint32_t dev_job_id;
+    QUEUE_ID queue;
+    uint64_t submit_ns;
+};
+
+/**
+ * @brief UMD level admission of jobs onto the devices by job queues
+ *
+ * Jobs of graphs assigned to a queue are held fenced in it and admitted onto their device
+ * while it has less than jobs_per_core jobs in flight per core. A free slot goes to the
+ * queue of the highest priority with a job for that device; queues of the same priority
+ * are served by stride scheduling, a weighted fair queuing with unit job cost.
+ * The scheduler takes only the completions of the jobs it admitted from the device, by their
+ * device tags, in whatever order they finish; the completions of other jobs are left to them.
+ * A job cleaned while in flight hands its completion over, so that its slot is kept until
+ * the device is done with it.
+ */
+class JobScheduler
+{
+private:
+    std::map<QUEUE_ID, JobQueue> m_queues;
+    QUEUE_ID m_next_queue_id = 1;
+    std::map<GRAPH_ID, QUEUE_ID> m_graph_queues;
+    std::map<JOB_ID, QueuedJob> m_jobs;
+    std::map<DeviceBase*, std::deque<InFlightJob>> m_in_flight;
+    uint32_t m_jobs_per_core = 1;
+    uint64_t m_vtime = 0;
+    pthread_mutex_t m_lock;
+
+private:
+    uint32_t get_capacity(DeviceBase* dev);
+    void dispatch();
+    uint32_t retire(DeviceBase* dev);
+    void drop(std::map<JOB_ID, QueuedJob>::iterator iter);
+
+public:
+    aipu_status_t config(const aipu_global_config_scheduler_t* config);
+    aipu_status_t create_queue(const aipu_job_queue_config_t* config, QUEUE_ID* id);
+    aipu_status_t destroy_queue(QUEUE_ID id);
+    aipu_status_t set_graph_queue(GRAPH_ID graph, QUEUE_ID queue);
+    aipu_status_t get_stat(QUEUE_ID id, aipu_job_queue_stat_t* stat);
+    bool is_managed(JobBase* job);
+    aipu_status_t submit(JobBase* job, bool* queued);
+    aipu_status_t get_status(JobBase* job, int32_t time_out, aipu_job_status_t* status);
+    void remove(JOB_ID job);
+    void remove_graph(GRAPH_ID graph);
+
+public:
+    JobScheduler();
+    ~JobScheduler();
+    JobScheduler(const JobScheduler& sched) = delete;
+    JobScheduler& operator=(const JobScheduler& sched) = delete;
+};
+}
+
+#endif /* _JOB_SCHEDULER_H_ */
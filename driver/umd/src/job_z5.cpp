@@ -21,6 +21,7 @@
  */
 
 #include <cstring>
+#include <stddef.h>
 #include <assert.h>
 #include "job_z5.h"
 #include "graph_z5.h"
@@ -48,7 +49,7 @@ void aipudrv::JobZ5::set_job_params(uint32_t sg_cnt, uint32_t task_per_sg, uint3
     m_remap_flag = remap;
 }
 
-aipu_status_t aipudrv::JobZ5::setup_rodata_sg(uint32_t sg_id)
+aipu_status_t aipudrv::JobZ5::setup_rodata_sg(uint32_t sg_id, bool reuse_only)
 {
     const std::vector<struct GraphParamMapLoadDesc>& param_map =
         get_graph().m_subgraphs[sg_id].param_map;
@@ -63,7 +64,7 @@ aipu_status_t aipudrv::JobZ5::setup_rodata_sg(uint32_t sg_id)
         get_graph().m_subgraphs[sg_id].dcr.size,
         get_graph().m_subgraphs[sg_id].dcr.size);
 
-    return setup_rodata(param_map, reuse_buf, static_buf, rodata, dcr);
+    return setup_rodata(param_map, reuse_buf, static_buf, rodata, dcr, reuse_only);
 }
 
 aipu_status_t aipudrv::JobZ5::alloc_load_job_buffers()
@@ -217,6 +218,23 @@ void aipudrv::JobZ5::free_sg_buffers(const SubGraphTask& sg)
     }
 }
 
+void aipudrv::JobZ5::release_scratch_buffers()
+{
+    for (uint32_t i = 0; i < m_sg_job.size(); i++)
+    {
+        free_sg_buffers(m_sg_job[i]);
+        for (uint32_t k = 0; k < m_sg_job[i].reuses.size(); k++)
+        {
+            m_sg_job[i].reuses[k].reset();
+        }
+        for (uint32_t j = 0; j < m_sg_job[i].tasks.size(); j++)
+        {
+            m_sg_job[i].tasks[j].stack.reset();
+            m_sg_job[i].tasks[j].dp_cc.reset();
+        }
+    }
+}
+
 aipu_status_t aipudrv::JobZ5::free_job_buffers()
 {
     aipu_status_t ret = AIPU_STATUS_SUCCESS;
@@ -250,6 +268,7 @@ aipu_status_t aipudrv::JobZ5::free_job_buffers()
     m_profiler.clear();
     m_printf.clear();
     m_layer_counter.clear();
+    m_bound_inputs.clear();
 
     return ret;
 }
@@ -258,7 +277,8 @@ aipu_status_t aipudrv::JobZ5::setup_tcb_task(uint32_t sg_id, uint32_t task_id)
 {
     aipu_status_t ret = AIPU_STATUS_SUCCESS;
     Task& task = m_sg_job[sg_id].tasks[task_id];
-    tcb_t* tcb = new tcb_t;
+    tcb_t tcb_buf;
+    tcb_t* tcb = &tcb_buf;
     TCB*   next_tcb = nullptr;
 
     if (task_id != (m_task_per_sg - 1))
@@ -331,7 +351,6 @@ aipu_status_t aipudrv::JobZ5::setup_tcb_task(uint32_t sg_id, uint32_t task_id)
     assert(m_mem->write(task.tcb.pa, (const char*)tcb, sizeof(*tcb))
         == sizeof(*tcb));
 
-    delete tcb;
     return ret;
 }
 
@@ -355,7 +374,8 @@ aipu_status_t aipudrv::JobZ5::setup_tcb_sg(uint32_t sg_id)
 aipu_status_t aipudrv::JobZ5::setup_tcbs()
 {
     aipu_status_t ret = AIPU_STATUS_SUCCESS;
-    tcb_t* tcb = new tcb_t;
+    tcb_t tcb_buf;
+    tcb_t* tcb = &tcb_buf;
 
     /* setup init TCB */
     memset(tcb, 0, sizeof(tcb_t));
@@ -389,7 +409,6 @@ aipu_status_t aipudrv::JobZ5::setup_tcbs()
     m_status = AIPU_JOB_STATUS_INIT;
 
 finish:
-    delete tcb;
     return ret;
 }
 
@@ -428,6 +447,12 @@ aipu_status_t aipudrv::JobZ5::schedule()
         return ret;
     }
 
+    ret = wake();
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        return ret;
+    }
+
     if (m_status == AIPU_JOB_STATUS_DONE)
     {
         /* reload task TCBs because it was updated at runtime */
@@ -451,13 +476,22 @@ aipu_status_t aipudrv::JobZ5::schedule()
     }
 
     memset(&desc.kdesc, 0, sizeof(desc.kdesc));
-    desc.kdesc.job_id = m_id;
+    m_dev_job_id = m_dev->alloc_job_id();
+    desc.kdesc.job_id = m_dev_job_id;
     desc.kdesc.version_compatible = get_graph().m_do_vcheck;
     desc.kdesc.aipu_config = get_graph().m_hw_config;
     desc.tcb_head = m_init_tcb.pa;
     desc.tcb_tail = m_sg_job[m_sg_cnt-1].tasks[m_task_per_sg-1].tcb.pa;
+    desc.chain_after = m_chain_after;
+
+    /* a chained job does not start before the previous ones of its command pool are done */
+    m_mem->write32(m_init_tcb.pa + offsetof(tcb_t, flag), TCB_FLAG_TASK_TYPE_INIT |
+        ((m_chain_after != 0) ? TCB_FLAG_DEP_TYPE_PRE_ALL : TCB_FLAG_DEP_TYPE_NONE));
     ret = m_dev->schedule(desc);
-    m_status = AIPU_JOB_STATUS_SCHED;
+    if (AIPU_STATUS_SUCCESS == ret)
+    {
+        m_status = AIPU_JOB_STATUS_SCHED;
+    }
 
     return ret;
 }
@@ -467,6 +501,156 @@ aipu_status_t aipudrv::JobZ5::destroy()
     return free_job_buffers();
 }
 
+aipu_status_t aipudrv::JobZ5::hibernate()
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+
+    ret = validate_hibernate_status();
+    if ((AIPU_STATUS_SUCCESS != ret) || m_hibernated)
+    {
+        return ret;
+    }
+
+    m_scratch_size = 0;
+    for (uint32_t i = 0; i < m_sg_job.size(); i++)
+    {
+        for (uint32_t k = 0; k < m_sg_job[i].reuses.size(); k++)
+        {
+            m_scratch_size += m_sg_job[i].reuses[k].size;
+        }
+        for (uint32_t j = 0; j < m_sg_job[i].tasks.size(); j++)
+        {
+            m_scratch_size += m_sg_job[i].tasks[j].stack.size + m_sg_job[i].tasks[j].dp_cc.size;
+        }
+    }
+
+    release_scratch_buffers();
+    m_hibernated = true;
+    return ret;
+}
+
+aipu_status_t aipudrv::JobZ5::wake()
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+
+    if (!m_hibernated)
+    {
+        return ret;
+    }
+
+    /* admitted like the job creation, without waiting */
+    ret = m_mem->reserve(m_scratch_size, 0);
+    if (AIPU_STATUS_SUCCESS != ret)
+    {
+        return ret;
+    }
+
+    /* 1. allocate the scratch buffers again, as alloc_load_job_buffers does */
+    for (uint32_t i = 0; i < m_sg_cnt; i++)
+    {
+        for (uint32_t k = 0; k < m_sg_job[i].reuses.size(); k++)
+        {
+            if (get_graph().m_subgraphs[i].reuse_sections[k].size != 0)
+            {
+                char str[20];
+                snprintf(str, 20, "reuse_%u", k);
+                ret = m_mem->malloc(get_graph().m_subgraphs[i].reuse_sections[k].size,
+                    get_graph().m_subgraphs[i].reuse_sections[k].align_in_page, &m_sg_job[i].reuses[k], str);
+                if (AIPU_STATUS_SUCCESS != ret)
+                {
+                    goto finish;
+                }
+            }
+        }
+
+        for (uint32_t j = 0; j < m_task_per_sg; j++)
+        {
+            Task& task = m_sg_job[i].tasks[j];
+
+            ret = m_mem->malloc(get_graph().m_subgraphs[i].stack_size, get_graph().m_subgraphs[i].stack_align_in_page,
+                &task.stack, "stack");
+            if (AIPU_STATUS_SUCCESS != ret)
+            {
+                goto finish;
+            }
+
+            if (get_graph().m_bdata.size != 0)
+            {
+                ret = m_mem->malloc(get_graph().m_bdata.size, 0, &task.dp_cc, "data_cc");
+                if (AIPU_STATUS_SUCCESS != ret)
+                {
+                    goto finish;
+                }
+                assert(m_mem->write(task.dp_cc.pa, get_graph().m_bdata.va, get_graph().m_bdata.size)
+                    == (int)get_graph().m_bdata.size);
+            }
+        }
+    }
+
+    /* 2. re-patch the reuse relocations and the TCB sp/dp which point into them */
+    for (uint32_t i = 0; i < m_sg_cnt; i++)
+    {
+        ret = setup_rodata_sg(get_graph().m_subgraphs[i].id, true);
+        if (AIPU_STATUS_SUCCESS != ret)
+        {
+            goto finish;
+        }
+
+        for (uint32_t j = 0; j < m_task_per_sg; j++)
+        {
+            const Task& task = m_sg_job[i].tasks[j];
+
+            m_mem->write32(task.tcb.pa + offsetof(tcb_t, sp), get_low_32(task.stack.pa));
+            m_mem->write32(task.tcb.pa + offsetof(tcb_t, dp), get_low_32(task.dp_cc.pa));
+        }
+    }
+
+    /* 3. IO buffers are in the reuse buffers */
+    create_io_buffers(get_graph().m_subgraphs[0].io, m_sg_job[0].reuses);
+    m_hibernated = false;
+
+finish:
+    if (ret)
+    {
+        release_scratch_buffers();
+    }
+    m_mem->unreserve();
+    return ret;
+}
+
+aipu_status_t aipudrv::JobZ5::schedule_after(JobBase* dep)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+
+    if (!m_dev->can_chain_jobs() || (dep->get_dev() != m_dev) || !dep->is_scheduled() ||
+        (nullptr == dynamic_cast<JobZ5*>(dep)))
+    {
+        return AIPU_STATUS_ERROR_OP_NOT_SUPPORTED;
+    }
+
+    m_chain_after = dep->get_dev_job_id();
+    ret = schedule();
+    m_chain_after = 0;
+    return ret;
+}
+
+aipu_status_t aipudrv::JobZ5::bind_input(uint32_t tensor, DEV_PA_64 pa)
+{
+    /* only 1 sg */
+    BufferDesc rodata;
+    BufferDesc dcr;
+
+    rodata.init(m_rodata.pa + get_graph().m_subgraphs[0].rodata.offset,
+        get_graph().m_subgraphs[0].rodata.size,
+        get_graph().m_subgraphs[0].rodata.size);
+    dcr.init(m_descriptor.pa + get_graph().m_subgraphs[0].dcr.offset,
+        get_graph().m_subgraphs[0].dcr.size,
+        get_graph().m_subgraphs[0].dcr.size);
+
+    return rebind_input(tensor, pa, get_graph().m_subgraphs[0].io.inputs,
+        get_graph().m_subgraphs[0].param_map, rodata, dcr);
+}
+
 void aipudrv::JobZ5::dump_z5_specific_buffers()
 {
     DEV_PA_64 dump_pa;
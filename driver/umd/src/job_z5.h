@@ -74,6 +74,8 @@ private:
 
 private:
     const aipu_global_config_simulation_t* m_cfg;
+    /* device tag of the job this one is chained after, 0 for none */
+    uint32_t m_chain_after = 0;
 
 private:
     const GraphZ5& get_graph()
@@ -82,7 +84,7 @@ private:
     }
 
 private:
-    aipu_status_t setup_rodata_sg(uint32_t sg_id);
+    aipu_status_t setup_rodata_sg(uint32_t sg_id, bool reuse_only = false);
     aipu_status_t setup_tcb_task(uint32_t sg_id, uint32_t task_id);
     aipu_status_t setup_tcb_sg(uint32_t sg_id);
     void          set_job_params(uint32_t sg_cnt, uint32_t task_per_sg, uint32_t remap);
@@ -90,6 +92,7 @@ private:
     aipu_status_t free_job_buffers();
     aipu_status_t setup_tcbs();
     void free_sg_buffers(const SubGraphTask& sg);
+    void release_scratch_buffers();
     void dump_z5_specific_buffers();
     aipu_status_t dump_for_emulation();
 
@@ -97,10 +100,14 @@ public:
     aipu_status_t init(const aipu_global_config_simulation_t* cfg);
     aipu_status_t schedule();
     aipu_status_t destroy();
+    aipu_status_t hibernate();
+    aipu_status_t wake();
     aipu_status_t bind_core(uint32_t core_id)
     {
         return AIPU_STATUS_ERROR_OP_NOT_SUPPORTED;
     }
+    aipu_status_t bind_input(uint32_t tensor, DEV_PA_64 pa);
+    aipu_status_t schedule_after(JobBase* dep);
 
 public:
     /* Set functions */
@@ -20,15 +20,26 @@
  * @brief AIPU User Mode Driver (UMD) memory base module implementation
  */
 
+#include <assert.h>
 #include <cstring>
+#include <errno.h>
+#include <time.h>
 #include "memory_base.h"
 #include "utils/log.h"
 #include "utils/helper.h"
 
+thread_local aipudrv::MemoryBase::Reservation aipudrv::MemoryBase::m_reservation = {nullptr, 0};
+
 aipudrv::MemoryBase::MemoryBase()
 {
     pthread_rwlock_init(&m_tlock, NULL);
     pthread_rwlock_init(&m_lock, NULL);
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_mutex_init(&m_alock, NULL);
+    pthread_cond_init(&m_acond, &attr);
+    pthread_condattr_destroy(&attr);
     if (m_enable_mem_dump)
     {
         mem_dump.open(m_file_name.c_str(), std::ofstream::out | std::ofstream::trunc);
@@ -43,10 +54,111 @@ aipudrv::MemoryBase::~MemoryBase()
     {
         delete[] bm_iter->second.va;
     }
+    pthread_cond_destroy(&m_acond);
+    pthread_mutex_destroy(&m_alock);
     pthread_rwlock_destroy(&m_lock);
     pthread_rwlock_destroy(&m_tlock);
 }
 
+aipu_status_t aipudrv::MemoryBase::reserve(uint64_t bytes, int32_t time_out)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    uint64_t budget = 0;
+    struct timespec deadline;
+
+    if (time_out > 0)
+    {
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+        deadline.tv_sec += time_out / 1000;
+        deadline.tv_nsec += (long)(time_out % 1000) * 1000000;
+        if (deadline.tv_nsec >= 1000000000)
+        {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000;
+        }
+    }
+
+    pthread_mutex_lock(&m_alock);
+    budget = get_budget();
+
+    /* a job which could never fit is refused at once */
+    if ((budget != 0) && (bytes > budget))
+    {
+        ret = AIPU_STATUS_ERROR_BUF_ALLOC_FAIL;
+        goto unlock;
+    }
+
+    while ((budget != 0) && (m_used + m_reserved + bytes > budget))
+    {
+        if (0 == time_out)
+        {
+            ret = AIPU_STATUS_ERROR_BUF_ALLOC_FAIL;
+            goto unlock;
+        }
+
+        if (time_out < 0)
+        {
+            pthread_cond_wait(&m_acond, &m_alock);
+        }
+        else if ((pthread_cond_timedwait(&m_acond, &m_alock, &deadline) == ETIMEDOUT) &&
+            (m_used + m_reserved + bytes > budget))
+        {
+            ret = AIPU_STATUS_ERROR_BUF_ALLOC_FAIL;
+            goto unlock;
+        }
+    }
+    assert(nullptr == m_reservation.mem);
+    m_reserved += bytes;
+    m_reservation.mem = this;
+    m_reservation.left = bytes;
+
+unlock:
+    pthread_mutex_unlock(&m_alock);
+    return ret;
+}
+
+uint64_t aipudrv::MemoryBase::get_budget() const
+{
+    uint64_t budget = get_capacity();
+
+    if ((m_limit != 0) && ((0 == budget) || (m_limit < budget)))
+    {
+        budget = m_limit;
+    }
+    return budget;
+}
+
+void aipudrv::MemoryBase::get_usage(uint64_t* budget, uint64_t* used) const
+{
+    pthread_mutex_lock(&m_alock);
+    *budget = get_budget();
+    *used = m_used + m_reserved;
+    pthread_mutex_unlock(&m_alock);
+}
+
+void aipudrv::MemoryBase::unreserve()
+{
+    if (m_reservation.mem != this)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&m_alock);
+    m_reserved -= m_reservation.left;
+    m_reservation.mem = nullptr;
+    m_reservation.left = 0;
+    pthread_cond_broadcast(&m_acond);
+    pthread_mutex_unlock(&m_alock);
+}
+
+void aipudrv::MemoryBase::set_limit(uint64_t bytes)
+{
+    pthread_mutex_lock(&m_alock);
+    m_limit = bytes;
+    pthread_cond_broadcast(&m_acond);
+    pthread_mutex_unlock(&m_alock);
+}
+
 std::string aipudrv::MemoryBase::get_tracking_log(DEV_PA_64 pa) const
 {
     std::string log;
@@ -206,6 +318,10 @@ int aipudrv::MemoryBase::pa_to_va(uint64_t addr, uint64_t size, char** va) const
 
 unlock:
     pthread_rwlock_unlock(&m_lock);
+    if ((0 == ret) && (m_observer != nullptr))
+    {
+        m_observer->on_touch(addr, size);
+    }
     return ret;
 }
 
@@ -113,6 +113,21 @@ struct MemTracking
     }
 };
 
+/**
+ * @brief observer of device memory operations (e.g. trace recording)
+ *
+ * on_touch is called for every range accessed via PA, including direct VA access
+ * through pa_to_va; callbacks are invoked without memory locks held.
+ */
+class MemoryObserver
+{
+public:
+    virtual void on_alloc(const BufferDesc& buf, uint32_t align) = 0;
+    virtual void on_free(const BufferDesc& buf) = 0;
+    virtual void on_touch(DEV_PA_64 addr, uint64_t size) = 0;
+    virtual ~MemoryObserver(){};
+};
+
 class MemoryBase
 {
 private:
@@ -136,13 +151,34 @@ private:
     uint32_t m_enable_mem_dump = RTDEBUG_TRACKING_MEM_OPERATION;
     std::string m_file_name = "mem_info.log";
 
+private:
+    /**
+     * job admission: bytes allocated, bytes reserved by jobs being created and the budget;
+     * a buffer allocated by a thread holding a reservation is moved out of m_reserved into
+     * m_used, so that a job being created is never counted twice
+     */
+    mutable uint64_t m_used = 0;
+    mutable uint64_t m_reserved = 0;
+    uint64_t m_limit = 0;
+    mutable pthread_mutex_t m_alock;
+    mutable pthread_cond_t m_acond;
+    struct Reservation
+    {
+        const MemoryBase* mem;
+        uint64_t left;
+    };
+    /* what is left of the reservation of the calling thread, in m_reserved of mem */
+    static thread_local Reservation m_reservation;
+
 protected:
     std::map<DEV_PA_64, Buffer> m_allocated;
     mutable pthread_rwlock_t m_lock;
+    MemoryObserver* m_observer = nullptr;
 
 private:
     std::string get_tracking_log(DEV_PA_64 pa) const;
     auto get_allocated_buffer(uint64_t addr) const;
+    uint64_t get_budget() const;
 
 protected:
     uint64_t get_page_cnt(uint64_t bytes) const
@@ -160,6 +196,35 @@ protected:
     int mem_read(uint64_t addr, void *dest, size_t size) const;
     int mem_write(uint64_t addr, const void *src, size_t size);
     int mem_bzero(uint64_t addr, size_t size);
+    void notify_alloc(const BufferDesc& buf, uint32_t align) const
+    {
+        uint64_t taken = 0;
+
+        pthread_mutex_lock(&m_alock);
+        if (m_reservation.mem == this)
+        {
+            taken = (buf.size < m_reservation.left) ? buf.size : m_reservation.left;
+            m_reservation.left -= taken;
+            m_reserved -= taken;
+        }
+        m_used += buf.size;
+        pthread_mutex_unlock(&m_alock);
+        if (m_observer != nullptr)
+        {
+            m_observer->on_alloc(buf, align);
+        }
+    }
+    void notify_free(const BufferDesc& buf) const
+    {
+        pthread_mutex_lock(&m_alock);
+        m_used -= buf.size;
+        pthread_cond_broadcast(&m_acond);
+        pthread_mutex_unlock(&m_alock);
+        if (m_observer != nullptr)
+        {
+            m_observer->on_free(buf);
+        }
+    }
 
 public:
     void dump_tracking_log_start() const;
@@ -184,6 +249,33 @@ public:
     {
         return mem_read(src, (char*)desc, sizeof(*desc));
     }
+    void set_observer(MemoryObserver* observer)
+    {
+        m_observer = observer;
+    }
+
+public:
+    /**
+     * @brief size of the memory, or 0 if it is not known to UMD
+     */
+    virtual uint64_t get_capacity() const
+    {
+        return 0;
+    }
+    /**
+     * @brief admission of the buffers of a job before any of them is allocated
+     *
+     * reserve() waits until bytes fit into the budget besides the buffers allocated and
+     * the reservations of the other jobs being created (time_out: <0 infinite, 0 no wait,
+     * >0 in ms). The buffers then allocated by the calling thread use the reservation up;
+     * the caller unreserves what is left once they are allocated (or failed to be). A
+     * thread holds one reservation at a time.
+     * Without a known capacity or a configured limit every job is admitted.
+     */
+    aipu_status_t reserve(uint64_t bytes, int32_t time_out);
+    void unreserve();
+    void set_limit(uint64_t bytes);
+    void get_usage(uint64_t* budget, uint64_t* used) const;
 
 public:
     MemoryBase();
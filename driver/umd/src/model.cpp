@@ -0,0 +1,348 @@
+/**********************************************************************************
+ * This file is CONFIDENTIAL and any use by you is subject to the terms of the
+ * agreement between you and Arm China or the terms of the agreement between you
+ * and the party authorised by Arm China to disclose this file to you.
+ * The confidential and proprietary information contained in this file
+ * may only be used by a person authorised under and to the extent permitted
+ * by a subsisting licensing agreement from Arm China.
+ *
+ *        (C) Copyright 2020 Arm Technology (China) Co. Ltd.
+ *                    All rights reserved.
+ *
+ * This entire notice must be reproduced on all copies of this file and copies of
+ * this file may only be made by a person if such person is permitted to do so
+ * under the terms of a subsisting license agreement from Arm China.
+ *
+ *********************************************************************************/
+
+
+/**
+ * @file  model.cpp
+ * @brief AIPU User Mode Driver (UMD) model module implementation
+ */
+
+#include "model.h"
+#include "context.h"
+#include "utils/log.h"
+
+aipudrv::Model::Model(MODEL_ID id, MainContext& ctx, uint32_t job_cnt):
+    m_id(id),
+    m_ctx(ctx),
+    m_job_cnt(job_cnt)
+{
+    m_ref_cnt = 1;
+    pthread_mutex_init(&m_lock, NULL);
+    pthread_cond_init(&m_cond, NULL);
+    pthread_mutex_init(&m_swap_lock, NULL);
+}
+
+aipudrv::Model::~Model()
+{
+    pthread_mutex_destroy(&m_swap_lock);
+    pthread_cond_destroy(&m_cond);
+    pthread_mutex_destroy(&m_lock);
+}
+
+aipu_status_t aipudrv::Model::create_version(const char* graph_file, ModelVersion** version)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    ModelVersion* ver = new ModelVersion;
+    aipu_global_config_placement_t place = m_ctx.get_placement();
+    uint32_t dev_cnt = m_ctx.get_device_count();
+
+    ver->policy = place.policy;
+    ver->busy_cnt = 0;
+    ver->retired = false;
+
+    /* one replica per device so that jobs can be spread; pinned placement keeps a single one */
+    if (AIPU_PLACEMENT_PINNED == place.policy)
+    {
+        dev_cnt = 1;
+    }
+    ver->replicas.resize(dev_cnt);
+
+    for (uint32_t d = 0; d < dev_cnt; d++)
+    {
+        ModelReplica& replica = ver->replicas[d];
+
+        replica.graph = 0;
+        replica.busy_cnt = 0;
+        ret = m_ctx.load_graph(graph_file, &replica.graph, (dev_cnt > 1) ? (int32_t)d : -1);
+        if (AIPU_STATUS_SUCCESS != ret)
+        {
+            ver->replicas.resize(d);
+            destroy_version(ver);
+            goto finish;
+        }
+
+        /* pre-create the job pool so that the first requests after a swap run warm */
+        for (uint32_t i = 0; i < m_job_cnt; i++)
+        {
+            JOB_ID job = 0;
+            ret = m_ctx.create_job(replica.graph, &job);
+            if (AIPU_STATUS_SUCCESS != ret)
+            {
+                ver->replicas.resize(d + 1);
+                destroy_version(ver);
+                goto finish;
+            }
+            replica.idle_jobs.push_back(job);
+        }
+    }
+
+    *version = ver;
+
+finish:
+    return ret;
+}
+
+void aipudrv::Model::destroy_version(ModelVersion* version)
+{
+    /* jobs are destroyed together with the graphs */
+    for (uint32_t i = 0; i < version->replicas.size(); i++)
+    {
+        if (m_ctx.unload_graph(version->replicas[i].graph) != AIPU_STATUS_SUCCESS)
+        {
+            LOG(LOG_ERR, "model 0x%lx: unload graph 0x%lx failed", m_id, version->replicas[i].graph);
+        }
+    }
+    delete version;
+}
+
+void aipudrv::Model::retire_version(ModelVersion* version, std::vector<ModelVersion*>& reclaim)
+{
+    /* called with m_lock held */
+    version->retired = true;
+    if (0 == version->busy_cnt)
+    {
+        reclaim.push_back(version);
+    }
+    else
+    {
+        m_retired.push_back(version);
+    }
+}
+
+void aipudrv::Model::put_version(ModelVersion* version, std::vector<ModelVersion*>& reclaim)
+{
+    /* called with m_lock held: the last busy job of a retired version drains it */
+    version->busy_cnt--;
+    if (version->retired && (0 == version->busy_cnt))
+    {
+        for (auto iter = m_retired.begin(); iter != m_retired.end(); iter++)
+        {
+            if (*iter == version)
+            {
+                m_retired.erase(iter);
+                break;
+            }
+        }
+        reclaim.push_back(version);
+    }
+}
+
+aipudrv::ModelReplica* aipudrv::Model::select_replica(ModelVersion* version)
+{
+    uint32_t sel = 0;
+
+    /* called with m_lock held */
+    if (AIPU_PLACEMENT_LEAST_LOADED == version->policy)
+    {
+        for (uint32_t i = 1; i < version->replicas.size(); i++)
+        {
+            if (version->replicas[i].busy_cnt < version->replicas[sel].busy_cnt)
+            {
+                sel = i;
+            }
+        }
+    }
+    else
+    {
+        sel = m_next_replica++ % version->replicas.size();
+    }
+    return &version->replicas[sel];
+}
+
+aipu_status_t aipudrv::Model::load(const char* graph_file)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    ModelVersion* ver = nullptr;
+
+    ret = create_version(graph_file, &ver);
+    if (AIPU_STATUS_SUCCESS != ret)
+    {
+        return ret;
+    }
+
+    pthread_mutex_lock(&m_lock);
+    m_current = ver;
+    pthread_mutex_unlock(&m_lock);
+    return ret;
+}
+
+aipu_status_t aipudrv::Model::swap(const char* graph_file)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    ModelVersion* ver = nullptr;
+    std::vector<ModelVersion*> reclaim;
+
+    /* loading is done without m_lock: traffic keeps flowing to the current version */
+    pthread_mutex_lock(&m_swap_lock);
+    ret = create_version(graph_file, &ver);
+    if (AIPU_STATUS_SUCCESS != ret)
+    {
+        goto unlock;
+    }
+
+    pthread_mutex_lock(&m_lock);
+    if (m_current != nullptr)
+    {
+        retire_version(m_current, reclaim);
+    }
+    m_current = ver;
+    pthread_mutex_unlock(&m_lock);
+
+    for (uint32_t i = 0; i < reclaim.size(); i++)
+    {
+        destroy_version(reclaim[i]);
+    }
+
+unlock:
+    pthread_mutex_unlock(&m_swap_lock);
+    return ret;
+}
+
+aipu_status_t aipudrv::Model::unload()
+{
+    std::vector<ModelVersion*> reclaim;
+
+    pthread_mutex_lock(&m_swap_lock);
+    pthread_mutex_lock(&m_lock);
+    m_unloaded = true;
+    if (m_current != nullptr)
+    {
+        reclaim.push_back(m_current);
+        m_current = nullptr;
+    }
+
+    /* graphs are unloaded only after the jobs being created on them */
+    while (m_creating_cnt != 0)
+    {
+        pthread_cond_wait(&m_cond, &m_lock);
+    }
+    reclaim.insert(reclaim.end(), m_retired.begin(), m_retired.end());
+    m_retired.clear();
+    m_busy_jobs.clear();
+    pthread_mutex_unlock(&m_lock);
+
+    for (uint32_t i = 0; i < reclaim.size(); i++)
+    {
+        destroy_version(reclaim[i]);
+    }
+    pthread_mutex_unlock(&m_swap_lock);
+
+    return AIPU_STATUS_SUCCESS;
+}
+
+aipu_status_t aipudrv::Model::acquire_job(JOB_ID* job)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    ModelVersion* ver = nullptr;
+    ModelReplica* replica = nullptr;
+    std::vector<ModelVersion*> reclaim;
+    GRAPH_ID graph = 0;
+    JOB_ID id = 0;
+
+    pthread_mutex_lock(&m_lock);
+    ver = m_current;
+    if (nullptr == ver)
+    {
+        ret = AIPU_STATUS_ERROR_INVALID_OP;
+        goto unlock;
+    }
+
+    /* the busy count keeps the version from being reclaimed by a swap meanwhile */
+    replica = select_replica(ver);
+    replica->busy_cnt++;
+    ver->busy_cnt++;
+    if (!replica->idle_jobs.empty())
+    {
+        id = replica->idle_jobs.back();
+        replica->idle_jobs.pop_back();
+        m_busy_jobs[id] = ver;
+        *job = id;
+        goto unlock;
+    }
+
+    /* pool exhausted: grow it on the current graph, without blocking other acquirers */
+    graph = replica->graph;
+    m_creating_cnt++;
+    pthread_mutex_unlock(&m_lock);
+    ret = m_ctx.create_job(graph, &id);
+    pthread_mutex_lock(&m_lock);
+    m_creating_cnt--;
+    pthread_cond_broadcast(&m_cond);
+
+    if ((AIPU_STATUS_SUCCESS == ret) && m_unloaded)
+    {
+        /* the job is destroyed together with the graphs by unload */
+        ret = AIPU_STATUS_ERROR_INVALID_OP;
+    }
+    else if (AIPU_STATUS_SUCCESS == ret)
+    {
+        m_busy_jobs[id] = ver;
+        *job = id;
+        goto unlock;
+    }
+
+    if (!m_unloaded)
+    {
+        replica->busy_cnt--;
+        put_version(ver, reclaim);
+    }
+
+unlock:
+    pthread_mutex_unlock(&m_lock);
+
+    for (uint32_t i = 0; i < reclaim.size(); i++)
+    {
+        destroy_version(reclaim[i]);
+    }
+    return ret;
+}
+
+aipu_status_t aipudrv::Model::release_job(JOB_ID job)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    ModelVersion* ver = nullptr;
+    std::vector<ModelVersion*> reclaim;
+
+    pthread_mutex_lock(&m_lock);
+    if (m_busy_jobs.count(job) == 0)
+    {
+        ret = AIPU_STATUS_ERROR_INVALID_JOB_ID;
+        goto unlock;
+    }
+
+    ver = m_busy_jobs[job];
+    m_busy_jobs.erase(job);
+    for (uint32_t i = 0; i < ver->replicas.size(); i++)
+    {
+        if (ver->replicas[i].graph == job_id2graph_id(job))
+        {
+            ver->replicas[i].idle_jobs.push_back(job);
+            ver->replicas[i].busy_cnt--;
+            break;
+        }
+    }
+    put_version(ver, reclaim);
+
+unlock:
+    pthread_mutex_unlock(&m_lock);
+
+    for (uint32_t i = 0; i < reclaim.size(); i++)
+    {
+        destroy_version(reclaim[i]);
+    }
+    return ret;
+}
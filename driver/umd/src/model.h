@@ -0,0 +1,110 @@
+/**********************************************************************************
+ * This file is CONFIDENTIAL and any use by you is subject to the terms of the
+ * agreement between you and Arm China or the terms of the agreement between you
+ * and the party authorised by Arm China to disclose this file to you.
+ * The confidential and proprietary information contained in this file
+ * may only be used by a person authorised under and to the extent permitted
+ * by a subsisting licensing agreement from Arm China.
+ *
+ *        (C) Copyright 2020 Arm Technology (China) Co. Ltd.
+ *                    All rights reserved.
+ *
+ * This entire notice must be reproduced on all copies of this file and copies of
+ * this file may only be made by a person if such person is permitted to do so
+ * under the terms of a subsisting license agreement from Arm China.
+ *
+ *********************************************************************************/
+
+
+/**
+ * @file  model.h
+ * @brief AIPU User Mode Driver (UMD) model module header
+ */
+
+#ifndef _MODEL_H_
+#define _MODEL_H_
+
+#include <map>
+#include <vector>
+#include <atomic>
+#include <pthread.h>
+#include "standard_api.h"
+#include "type.h"
+
+namespace aipudrv
+{
+typedef uint64_t MODEL_ID;
+
+/**
+ * @brief the graph of a model version resident on one device, with its pre-created jobs
+ */
+struct ModelReplica
+{
+    GRAPH_ID graph;
+    std::vector<JOB_ID> idle_jobs;
+    uint32_t busy_cnt;
+};
+
+/**
+ * @brief one graph binary serving a model, loaded on every device unless placement is pinned
+ */
+struct ModelVersion
+{
+    std::vector<ModelReplica> replicas;
+    aipu_placement_policy_t policy;
+    uint32_t busy_cnt;
+    bool retired;
+};
+
+class MainContext;
+class Model
+{
+private:
+    MODEL_ID m_id;
+    MainContext& m_ctx;
+    uint32_t m_job_cnt;
+    ModelVersion* m_current = nullptr;
+    uint32_t m_next_replica = 0;
+    std::map<JOB_ID, ModelVersion*> m_busy_jobs;
+    std::vector<ModelVersion*> m_retired;
+    /* acquirers creating a job outside m_lock; unload waits for them on m_cond */
+    uint32_t m_creating_cnt = 0;
+    bool m_unloaded = false;
+    /* the model table and each API call in progress hold a reference */
+    std::atomic<uint32_t> m_ref_cnt;
+    pthread_mutex_t m_lock;
+    pthread_cond_t m_cond;
+    pthread_mutex_t m_swap_lock;
+
+private:
+    aipu_status_t create_version(const char* graph_file, ModelVersion** version);
+    void destroy_version(ModelVersion* version);
+    void retire_version(ModelVersion* version, std::vector<ModelVersion*>& reclaim);
+    void put_version(ModelVersion* version, std::vector<ModelVersion*>& reclaim);
+    ModelReplica* select_replica(ModelVersion* version);
+
+public:
+    aipu_status_t load(const char* graph_file);
+    aipu_status_t swap(const char* graph_file);
+    aipu_status_t unload();
+    aipu_status_t acquire_job(JOB_ID* job);
+    aipu_status_t release_job(JOB_ID job);
+    void get()
+    {
+        m_ref_cnt++;
+    }
+    /* true if the caller dropped the last reference and should delete the model */
+    bool put()
+    {
+        return --m_ref_cnt == 0;
+    }
+
+public:
+    Model(MODEL_ID id, MainContext& ctx, uint32_t job_cnt);
+    ~Model();
+    Model(const Model& model) = delete;
+    Model& operator=(const Model& model) = delete;
+};
+}
+
+#endif /* _MODEL_H_ */
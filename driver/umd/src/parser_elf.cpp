@@ -41,47 +41,67 @@ aipu_status_t aipudrv::ParserELF::parse_graph_header_bottom(std::ifstream& gbin)
     return AIPU_STATUS_SUCCESS;
 }
 
-aipudrv::BinSection aipudrv::ParserELF::get_bin_note(const std::string& note_name)
+void aipudrv::ParserELF::build_section_index()
 {
-    aipudrv::BinSection ro = {nullptr, 0};
+    ELFIO::Elf_Half no = m_elf.sections.size();
+
+    m_section_index.clear();
+    m_section_index.reserve(no);
+    for (ELFIO::Elf_Half i = 0; i < no; ++i)
+    {
+        ELFIO::section *sec = m_elf.sections[i];
+
+        /* keep the first one if there are sections with the same name */
+        m_section_index.emplace(sec->get_name(), sec);
+    }
+}
+
+void aipudrv::ParserELF::build_note_index()
+{
+    m_note_index.clear();
+    if (nullptr == m_note)
+    {
+        return;
+    }
 
-    if (m_note)
+    /* the accessor walks all the notes once on construction */
+    ELFIO::note_section_accessor notes(m_elf, m_note);
+    ELFIO::Elf_Word no_notes = notes.get_notes_num();
+    m_note_index.reserve(no_notes);
+    for (ELFIO::Elf_Word j = 0; j < no_notes; ++j)
     {
-        ELFIO::note_section_accessor notes(m_elf, m_note);
-        ELFIO::Elf_Word no_notes = notes.get_notes_num();
-        for (ELFIO::Elf_Word j = 0; j < no_notes; ++j)
+        ELFIO::Elf_Word type;
+        std::string name;
+        void *desc;
+        ELFIO::Elf_Word size;
+
+        if (notes.get_note(j, type, name, desc, size))
         {
-            ELFIO::Elf_Word type;
-            std::string name;
-            void *desc;
-            ELFIO::Elf_Word size;
-
-            if (notes.get_note(j, type, name, desc, size))
-            {
-                if (name == note_name)
-                {
-                    ro.va = (char *)desc;
-                    ro.size = size;
-                    break;
-                }
-            }
+            BinSection ro = {(char *)desc, size};
+            m_note_index.emplace(name, ro);
         }
     }
+}
+
+aipudrv::BinSection aipudrv::ParserELF::get_bin_note(const std::string& note_name)
+{
+    aipudrv::BinSection ro = {nullptr, 0};
+    auto iter = m_note_index.find(note_name);
+
+    if (iter != m_note_index.end())
+    {
+        ro = iter->second;
+    }
     return ro;
 }
 
 ELFIO::section* aipudrv::ParserELF::get_elf_section(const std::string& section_name)
 {
-    ELFIO::Elf_Half no = m_elf.sections.size();
+    auto iter = m_section_index.find(section_name);
 
-    for (ELFIO::Elf_Half i = 0; i < no; ++i)
+    if (iter != m_section_index.end())
     {
-        ELFIO::section *sec = m_elf.sections[i];
-
-        if (section_name == sec->get_name())
-        {
-            return sec;
-        }
+        return iter->second;
     }
     return nullptr;
 }
@@ -168,6 +188,7 @@ aipu_status_t aipudrv::ParserELF::parse_graph(std::ifstream& gbin, uint32_t size
         ret = AIPU_STATUS_ERROR_INVALID_GBIN;
         goto finish;
     }
+    build_section_index();
 
     /* .text section parse */
     m_text = get_elf_section(".text");
@@ -192,6 +213,7 @@ aipu_status_t aipudrv::ParserELF::parse_graph(std::ifstream& gbin, uint32_t size
         ret = AIPU_STATUS_ERROR_INVALID_GBIN;
         goto finish;
     }
+    build_note_index();
 
     for (uint32_t i = 0; i < ELFSectionCnt; i++)
     {
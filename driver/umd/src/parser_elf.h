@@ -24,6 +24,8 @@
 #define _PARSER_ELF_H_
 
 #include <fstream>
+#include <string>
+#include <unordered_map>
 #include "elfio/elfio.hpp"
 #include "parser_base.h"
 #include "graph_z5.h"
@@ -104,7 +106,13 @@ private:
     };
     uint32_t subgraph_cnt;
 
+    /* name indexes built in one pass after the ELF is loaded */
+    std::unordered_map<std::string, ELFIO::section*> m_section_index;
+    std::unordered_map<std::string, BinSection> m_note_index;
+
 private:
+    void build_section_index();
+    void build_note_index();
     BinSection get_bin_note(const std::string& note_name);
     ELFIO::section* get_elf_section(const std::string &section_name);
     aipu_status_t parse_subgraph(char* start, uint32_t id, GraphZ5& gobj,
@@ -92,8 +92,16 @@ aipu_status_t aipudrv::ParserLegacy::parse_graph(std::ifstream& gbin, uint32_t s
 
     for (uint32_t i = 0; i < SECTION_TYPE_MAX; i++)
     {
-        gbin.seekg(m_section_descs[i].offset, gbin.beg);
         section.size = m_section_descs[i].size;
+        if ((SECTION_TYPE_WEIGHT == i) && gobj.is_weight_streaming())
+        {
+            /* weight is streamed into device memory by the graph during loading */
+            section.va = nullptr;
+            m_sections.push_back(section);
+            continue;
+        }
+
+        gbin.seekg(m_section_descs[i].offset, gbin.beg);
         section.va = new char[section.size];
         gbin.read((char*)section.va, section.size);
         if (gbin.gcount() != (int)section.size)
@@ -105,7 +113,15 @@ aipu_status_t aipudrv::ParserLegacy::parse_graph(std::ifstream& gbin, uint32_t s
 
     gobj.set_graph_rodata(m_sections[SECTION_TYPE_RODATA]);
     gobj.set_graph_desc(m_sections[SECTION_TYPE_DESCRIPTOR]);
-    gobj.set_graph_weight(m_sections[SECTION_TYPE_WEIGHT]);
+    if (nullptr == m_sections[SECTION_TYPE_WEIGHT].va)
+    {
+        gobj.set_graph_weight_stream(m_section_descs[SECTION_TYPE_WEIGHT].offset,
+            m_sections[SECTION_TYPE_WEIGHT].size);
+    }
+    else
+    {
+        gobj.set_graph_weight(m_sections[SECTION_TYPE_WEIGHT]);
+    }
     gobj.set_graph_text(m_sections[SECTION_TYPE_TEXT].va, m_sections[SECTION_TYPE_TEXT].size);
 
     ret = parse_bss_section((char*)m_sections[SECTION_TYPE_BSS].va,
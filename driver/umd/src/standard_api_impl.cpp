@@ -49,7 +49,7 @@ static aipu_status_t api_get_graph(const aipu_ctx_handle_t* ctx, uint64_t graph_
     }
 
     *graph = p_ctx->get_graph_object(graph_id);
-    if (nullptr == graph)
+    if (nullptr == *graph)
     {
         return AIPU_STATUS_ERROR_INVALID_GRAPH_ID;
     }
@@ -77,7 +77,7 @@ static aipu_status_t api_get_job(const aipu_ctx_handle_t* ctx, uint64_t job_id,
     }
 
     *job = p_ctx->get_job_object(job_id);
-    if (nullptr == job)
+    if (nullptr == *job)
     {
         return AIPU_STATUS_ERROR_INVALID_JOB_ID;
     }
@@ -85,6 +85,103 @@ static aipu_status_t api_get_job(const aipu_ctx_handle_t* ctx, uint64_t job_id,
     return AIPU_STATUS_SUCCESS;
 }
 
+/**
+ * @brief put back a graph/job got by api_get_graph/api_get_job: it may be freed from then on
+ */
+static void api_put_graph(const aipu_ctx_handle_t* ctx, aipudrv::GraphBase* graph)
+{
+    aipudrv::CtxRefMap::get_ctx_map().get_ctx_ref(ctx->handle)->put_graph_object(graph);
+}
+
+static void api_put_job(const aipu_ctx_handle_t* ctx, aipudrv::JobBase* job)
+{
+    aipudrv::CtxRefMap::get_ctx_map().get_ctx_ref(ctx->handle)->put_job_object(job);
+}
+
+/**
+ * @brief release the fence of a job flushed by aipu_flush_job_after if the jobs it waits
+ *        for are done; they are waited for with time_out unless it is 0
+ */
+static aipu_status_t api_release_fence(aipudrv::MainContext* p_ctx, uint64_t job_id, int32_t time_out,
+    bool* fenced)
+{
+    /* a blocking wait returns only when the fence is released */
+    do
+    {
+        aipu_status_t ret = p_ctx->release_fence(job_id, time_out, fenced);
+        if (AIPU_STATUS_SUCCESS != ret)
+        {
+            return ret;
+        }
+    } while (*fenced && (time_out < 0));
+
+    return AIPU_STATUS_SUCCESS;
+}
+
+static aipu_status_t api_finish_job(aipudrv::MainContext* p_ctx, aipudrv::JobBase* job, int32_t time_out)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    aipu_job_status_t status;
+    bool fenced = false;
+
+    if (time_out <= 0)
+    {
+        time_out = -1;
+    }
+
+    /* a job flushed by aipu_flush_job_after is waited for, not scheduled again */
+    ret = api_release_fence(p_ctx, job->get_id(), time_out, &fenced);
+    if (AIPU_STATUS_SUCCESS != ret)
+    {
+        return ret;
+    }
+    if (fenced)
+    {
+        return AIPU_STATUS_ERROR_JOB_TIMEOUT;
+    }
+    if (!job->is_in_flight())
+    {
+        ret = p_ctx->flush_job(job);
+        if (AIPU_STATUS_SUCCESS != ret)
+        {
+            return ret;
+        }
+    }
+
+    ret = p_ctx->get_job_status(job, time_out, &status);
+    if ((AIPU_STATUS_SUCCESS == ret) && (AIPU_JOB_STATUS_NO_STATUS == status))
+    {
+        ret = AIPU_STATUS_ERROR_JOB_TIMEOUT;
+    }
+    else if ((AIPU_STATUS_SUCCESS == ret) && (AIPU_JOB_STATUS_DONE != status))
+    {
+        ret = AIPU_STATUS_ERROR_JOB_EXCEPTION;
+    }
+
+    return ret;
+}
+
+static aipu_status_t api_get_job_status(aipudrv::MainContext* p_ctx, aipudrv::JobBase* job,
+    aipu_job_status_t* status)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    bool fenced = false;
+
+    if (nullptr == status)
+    {
+        return AIPU_STATUS_ERROR_NULL_PTR;
+    }
+
+    ret = api_release_fence(p_ctx, job->get_id(), 0, &fenced);
+    if ((AIPU_STATUS_SUCCESS != ret) || fenced)
+    {
+        *status = AIPU_JOB_STATUS_NO_STATUS;
+        return ret;
+    }
+
+    return p_ctx->get_job_status(job, 0, status);
+}
+
 aipu_status_t aipu_get_error_message(const aipu_ctx_handle_t* ctx, aipu_status_t status, const char** msg)
 {
     aipu_status_t ret = AIPU_STATUS_SUCCESS;
@@ -111,48 +208,640 @@ finish:
     return ret;
 }
 
-aipu_status_t aipu_init_context(aipu_ctx_handle_t** ctx)
+aipu_status_t aipu_init_context(aipu_ctx_handle_t** ctx)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    aipudrv::CtxRefMap& ctx_map = aipudrv::CtxRefMap::get_ctx_map();
+    aipudrv::MainContext* p_ctx = nullptr;
+    aipu_ctx_handle_t* ctx_handle = nullptr;
+    uint32_t handle = 0;
+
+    if (nullptr == ctx)
+    {
+        ret = AIPU_STATUS_ERROR_NULL_PTR;
+        goto finish;
+    }
+
+    handle = ctx_map.create_ctx_ref();
+    if (0 == handle)
+    {
+        ret = AIPU_STATUS_ERROR_BUF_ALLOC_FAIL;
+        goto finish;
+    }
+    p_ctx = ctx_map.get_ctx_ref(handle);
+    assert(p_ctx != nullptr);
+
+    ret = p_ctx->init();
+    if (AIPU_STATUS_SUCCESS != ret)
+    {
+        ctx_map.destroy_ctx_ref(handle);
+    }
+    else
+    {
+        /* success */
+        ctx_handle = new aipu_ctx_handle_t;
+        ctx_handle->handle = handle;
+        *ctx = ctx_handle;
+    }
+
+finish:
+    return ret;
+}
+
+aipu_status_t aipu_deinit_context(const aipu_ctx_handle_t* ctx)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    aipudrv::CtxRefMap& ctx_map = aipudrv::CtxRefMap::get_ctx_map();
+    aipudrv::MainContext* p_ctx = nullptr;
+
+    if (nullptr == ctx)
+    {
+        ret = AIPU_STATUS_ERROR_NULL_PTR;
+        goto finish;
+    }
+
+    p_ctx = ctx_map.get_ctx_ref(ctx->handle);
+    if (nullptr == p_ctx)
+    {
+        ret = AIPU_STATUS_ERROR_INVALID_CTX;
+    }
+    else
+    {
+        ret = p_ctx->deinit();
+        if (AIPU_STATUS_SUCCESS == ret)
+        {
+            ctx_map.destroy_ctx_ref(ctx->handle);
+            delete ctx;
+        }
+    }
+
+finish:
+    return ret;
+}
+
+aipu_status_t aipu_load_graph(const aipu_ctx_handle_t* ctx, const char* graph_file, uint64_t* id)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    aipudrv::CtxRefMap& ctx_map = aipudrv::CtxRefMap::get_ctx_map();
+    aipudrv::MainContext* p_ctx = nullptr;
+
+    if (nullptr == ctx)
+    {
+        ret = AIPU_STATUS_ERROR_NULL_PTR;
+        goto finish;
+    }
+
+    p_ctx = ctx_map.get_ctx_ref(ctx->handle);
+    if (nullptr == p_ctx)
+    {
+        ret = AIPU_STATUS_ERROR_INVALID_CTX;
+    }
+    else
+    {
+        ret = p_ctx->load_graph(graph_file, id);
+    }
+
+finish:
+    return ret;
+}
+
+aipu_status_t aipu_load_graphs(const aipu_ctx_handle_t* ctx, const char* graphs[], uint32_t cnt, uint64_t ids[])
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    aipudrv::CtxRefMap& ctx_map = aipudrv::CtxRefMap::get_ctx_map();
+    aipudrv::MainContext* p_ctx = nullptr;
+
+    if ((nullptr == ctx) || (nullptr == graphs) || (nullptr == ids))
+    {
+        ret = AIPU_STATUS_ERROR_NULL_PTR;
+        goto finish;
+    }
+
+    p_ctx = ctx_map.get_ctx_ref(ctx->handle);
+    if (nullptr == p_ctx)
+    {
+        ret = AIPU_STATUS_ERROR_INVALID_CTX;
+    }
+    else
+    {
+        ret = p_ctx->load_graphs(graphs, cnt, ids);
+    }
+
+finish:
+    return ret;
+}
+
+aipu_status_t aipu_unload_graph(const aipu_ctx_handle_t* ctx, uint64_t graph)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    aipudrv::CtxRefMap& ctx_map = aipudrv::CtxRefMap::get_ctx_map();
+    aipudrv::MainContext* p_ctx = nullptr;
+
+    if (nullptr == ctx)
+    {
+        ret = AIPU_STATUS_ERROR_NULL_PTR;
+        goto finish;
+    }
+
+    p_ctx = ctx_map.get_ctx_ref(ctx->handle);
+    if (nullptr == p_ctx)
+    {
+        ret = AIPU_STATUS_ERROR_INVALID_CTX;
+    }
+    else
+    {
+        ret = p_ctx->unload_graph(graph);
+    }
+
+finish:
+    return ret;
+}
+
+aipu_status_t aipu_create_super_graph(const aipu_ctx_handle_t* ctx, const uint64_t graphs[], uint32_t cnt,
+    const aipu_tensor_binding_t bindings[], uint32_t binding_cnt, uint64_t* id)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    aipudrv::CtxRefMap& ctx_map = aipudrv::CtxRefMap::get_ctx_map();
+    aipudrv::MainContext* p_ctx = nullptr;
+
+    if (nullptr == ctx)
+    {
+        ret = AIPU_STATUS_ERROR_NULL_PTR;
+        goto finish;
+    }
+
+    p_ctx = ctx_map.get_ctx_ref(ctx->handle);
+    if (nullptr == p_ctx)
+    {
+        ret = AIPU_STATUS_ERROR_INVALID_CTX;
+    }
+    else
+    {
+        ret = p_ctx->create_super_graph(graphs, cnt, bindings, binding_cnt, id);
+    }
+
+finish:
+    return ret;
+}
+
+aipu_status_t aipu_load_model(const aipu_ctx_handle_t* ctx, const char* graph, uint32_t job_cnt, uint64_t* model)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    aipudrv::CtxRefMap& ctx_map = aipudrv::CtxRefMap::get_ctx_map();
+    aipudrv::MainContext* p_ctx = nullptr;
+
+    if ((nullptr == ctx) || (nullptr == graph) || (nullptr == model))
+    {
+        ret = AIPU_STATUS_ERROR_NULL_PTR;
+        goto finish;
+    }
+
+    p_ctx = ctx_map.get_ctx_ref(ctx->handle);
+    if (nullptr == p_ctx)
+    {
+        ret = AIPU_STATUS_ERROR_INVALID_CTX;
+    }
+    else
+    {
+        ret = p_ctx->load_model(graph, job_cnt, model);
+    }
+
+finish:
+    return ret;
+}
+
+aipu_status_t aipu_swap_model(const aipu_ctx_handle_t* ctx, uint64_t model, const char* graph)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    aipudrv::CtxRefMap& ctx_map = aipudrv::CtxRefMap::get_ctx_map();
+    aipudrv::MainContext* p_ctx = nullptr;
+
+    if ((nullptr == ctx) || (nullptr == graph))
+    {
+        ret = AIPU_STATUS_ERROR_NULL_PTR;
+        goto finish;
+    }
+
+    p_ctx = ctx_map.get_ctx_ref(ctx->handle);
+    if (nullptr == p_ctx)
+    {
+        ret = AIPU_STATUS_ERROR_INVALID_CTX;
+    }
+    else
+    {
+        ret = p_ctx->swap_model(model, graph);
+    }
+
+finish:
+    return ret;
+}
+
+aipu_status_t aipu_unload_model(const aipu_ctx_handle_t* ctx, uint64_t model)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    aipudrv::CtxRefMap& ctx_map = aipudrv::CtxRefMap::get_ctx_map();
+    aipudrv::MainContext* p_ctx = nullptr;
+
+    if (nullptr == ctx)
+    {
+        ret = AIPU_STATUS_ERROR_NULL_PTR;
+        goto finish;
+    }
+
+    p_ctx = ctx_map.get_ctx_ref(ctx->handle);
+    if (nullptr == p_ctx)
+    {
+        ret = AIPU_STATUS_ERROR_INVALID_CTX;
+    }
+    else
+    {
+        ret = p_ctx->unload_model(model);
+    }
+
+finish:
+    return ret;
+}
+
+aipu_status_t aipu_acquire_model_job(const aipu_ctx_handle_t* ctx, uint64_t model, uint64_t* job)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    aipudrv::CtxRefMap& ctx_map = aipudrv::CtxRefMap::get_ctx_map();
+    aipudrv::MainContext* p_ctx = nullptr;
+    aipudrv::Model* p_model = nullptr;
+
+    if ((nullptr == ctx) || (nullptr == job))
+    {
+        ret = AIPU_STATUS_ERROR_NULL_PTR;
+        goto finish;
+    }
+
+    p_ctx = ctx_map.get_ctx_ref(ctx->handle);
+    if (nullptr == p_ctx)
+    {
+        ret = AIPU_STATUS_ERROR_INVALID_CTX;
+        goto finish;
+    }
+
+    p_model = p_ctx->get_model_object(model);
+    if (nullptr == p_model)
+    {
+        ret = AIPU_STATUS_ERROR_INVALID_MODEL_ID;
+        goto finish;
+    }
+
+    ret = p_model->acquire_job(job);
+    p_ctx->put_model_object(p_model);
+
+finish:
+    return ret;
+}
+
+aipu_status_t aipu_release_model_job(const aipu_ctx_handle_t* ctx, uint64_t model, uint64_t job)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    aipudrv::CtxRefMap& ctx_map = aipudrv::CtxRefMap::get_ctx_map();
+    aipudrv::MainContext* p_ctx = nullptr;
+    aipudrv::Model* p_model = nullptr;
+
+    if (nullptr == ctx)
+    {
+        ret = AIPU_STATUS_ERROR_NULL_PTR;
+        goto finish;
+    }
+
+    p_ctx = ctx_map.get_ctx_ref(ctx->handle);
+    if (nullptr == p_ctx)
+    {
+        ret = AIPU_STATUS_ERROR_INVALID_CTX;
+        goto finish;
+    }
+
+    p_model = p_ctx->get_model_object(model);
+    if (nullptr == p_model)
+    {
+        ret = AIPU_STATUS_ERROR_INVALID_MODEL_ID;
+        goto finish;
+    }
+
+    ret = p_model->release_job(job);
+    p_ctx->put_model_object(p_model);
+
+finish:
+    return ret;
+}
+
+aipu_status_t aipu_create_batcher(const aipu_ctx_handle_t* ctx, uint64_t graph,
+    const aipu_batcher_config_t* config, uint64_t* batcher)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    aipudrv::CtxRefMap& ctx_map = aipudrv::CtxRefMap::get_ctx_map();
+    aipudrv::MainContext* p_ctx = nullptr;
+
+    if ((nullptr == ctx) || (nullptr == config) || (nullptr == batcher))
+    {
+        ret = AIPU_STATUS_ERROR_NULL_PTR;
+        goto finish;
+    }
+
+    p_ctx = ctx_map.get_ctx_ref(ctx->handle);
+    if (nullptr == p_ctx)
+    {
+        ret = AIPU_STATUS_ERROR_INVALID_CTX;
+    }
+    else
+    {
+        ret = p_ctx->create_batcher(graph, config, batcher);
+    }
+
+finish:
+    return ret;
+}
+
+aipu_status_t aipu_batcher_infer(const aipu_ctx_handle_t* ctx, uint64_t batcher, const void* const inputs[],
+    void* const outputs[])
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    aipudrv::CtxRefMap& ctx_map = aipudrv::CtxRefMap::get_ctx_map();
+    aipudrv::MainContext* p_ctx = nullptr;
+    aipudrv::Batcher* p_batcher = nullptr;
+
+    if (nullptr == ctx)
+    {
+        ret = AIPU_STATUS_ERROR_NULL_PTR;
+        goto finish;
+    }
+
+    p_ctx = ctx_map.get_ctx_ref(ctx->handle);
+    if (nullptr == p_ctx)
+    {
+        ret = AIPU_STATUS_ERROR_INVALID_CTX;
+        goto finish;
+    }
+
+    p_batcher = p_ctx->get_batcher_object(batcher);
+    if (nullptr == p_batcher)
+    {
+        ret = AIPU_STATUS_ERROR_INVALID_BATCHER_ID;
+        goto finish;
+    }
+
+    ret = p_batcher->infer(inputs, outputs);
+    p_ctx->put_batcher_object(p_batcher);
+
+finish:
+    return ret;
+}
+
+aipu_status_t aipu_get_batcher_stat(const aipu_ctx_handle_t* ctx, uint64_t batcher, aipu_batcher_stat_t* stat)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    aipudrv::CtxRefMap& ctx_map = aipudrv::CtxRefMap::get_ctx_map();
+    aipudrv::MainContext* p_ctx = nullptr;
+    aipudrv::Batcher* p_batcher = nullptr;
+
+    if ((nullptr == ctx) || (nullptr == stat))
+    {
+        ret = AIPU_STATUS_ERROR_NULL_PTR;
+        goto finish;
+    }
+
+    p_ctx = ctx_map.get_ctx_ref(ctx->handle);
+    if (nullptr == p_ctx)
+    {
+        ret = AIPU_STATUS_ERROR_INVALID_CTX;
+        goto finish;
+    }
+
+    p_batcher = p_ctx->get_batcher_object(batcher);
+    if (nullptr == p_batcher)
+    {
+        ret = AIPU_STATUS_ERROR_INVALID_BATCHER_ID;
+        goto finish;
+    }
+
+    ret = p_batcher->get_stat(stat);
+    p_ctx->put_batcher_object(p_batcher);
+
+finish:
+    return ret;
+}
+
+aipu_status_t aipu_destroy_batcher(const aipu_ctx_handle_t* ctx, uint64_t batcher)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    aipudrv::CtxRefMap& ctx_map = aipudrv::CtxRefMap::get_ctx_map();
+    aipudrv::MainContext* p_ctx = nullptr;
+
+    if (nullptr == ctx)
+    {
+        ret = AIPU_STATUS_ERROR_NULL_PTR;
+        goto finish;
+    }
+
+    p_ctx = ctx_map.get_ctx_ref(ctx->handle);
+    if (nullptr == p_ctx)
+    {
+        ret = AIPU_STATUS_ERROR_INVALID_CTX;
+    }
+    else
+    {
+        ret = p_ctx->destroy_batcher(batcher);
+    }
+
+finish:
+    return ret;
+}
+
+aipu_status_t aipu_create_job(const aipu_ctx_handle_t* ctx, uint64_t graph, uint64_t* job)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    aipudrv::CtxRefMap& ctx_map = aipudrv::CtxRefMap::get_ctx_map();
+    aipudrv::MainContext* p_ctx = nullptr;
+
+    if ((nullptr == ctx) || (nullptr == job))
+    {
+        ret = AIPU_STATUS_ERROR_NULL_PTR;
+        goto finish;
+    }
+
+    p_ctx = ctx_map.get_ctx_ref(ctx->handle);
+    if (nullptr == p_ctx)
+    {
+        ret = AIPU_STATUS_ERROR_INVALID_CTX;
+    }
+    else
+    {
+        ret = p_ctx->create_job(graph, job);
+    }
+
+finish:
+    return ret;
+}
+
+aipu_status_t aipu_create_job_timed(const aipu_ctx_handle_t* ctx, uint64_t graph, uint64_t* job,
+    int32_t time_out)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    aipudrv::CtxRefMap& ctx_map = aipudrv::CtxRefMap::get_ctx_map();
+    aipudrv::MainContext* p_ctx = nullptr;
+
+    if ((nullptr == ctx) || (nullptr == job))
+    {
+        ret = AIPU_STATUS_ERROR_NULL_PTR;
+        goto finish;
+    }
+
+    p_ctx = ctx_map.get_ctx_ref(ctx->handle);
+    if (nullptr == p_ctx)
+    {
+        ret = AIPU_STATUS_ERROR_INVALID_CTX;
+    }
+    else
+    {
+        ret = p_ctx->create_job(graph, job, time_out);
+    }
+
+finish:
+    return ret;
+}
+
+aipu_status_t aipu_finish_job(const aipu_ctx_handle_t* ctx, uint64_t job_id, int32_t time_out)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    aipudrv::JobBase* job = nullptr;
+
+    ret = api_get_job(ctx, job_id, &job);
+    if (AIPU_STATUS_SUCCESS != ret)
+    {
+        return ret;
+    }
+
+    ret = api_finish_job(aipudrv::CtxRefMap::get_ctx_map().get_ctx_ref(ctx->handle), job, time_out);
+    api_put_job(ctx, job);
+    return ret;
+}
+
+aipu_status_t aipu_flush_job(const aipu_ctx_handle_t* ctx, uint64_t id, aipu_job_handler_callback callback,
+    void* priv)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    aipudrv::JobBase* job = nullptr;
+
+    ret = api_get_job(ctx, id, &job);
+    if (AIPU_STATUS_SUCCESS != ret)
+    {
+        return ret;
+    }
+
+    /* callback to be implemented */
+    ret = aipudrv::CtxRefMap::get_ctx_map().get_ctx_ref(ctx->handle)->flush_job(job);
+    api_put_job(ctx, job);
+    return ret;
+}
+
+aipu_status_t aipu_flush_job_after(const aipu_ctx_handle_t* ctx, uint64_t id, const uint64_t deps[],
+    uint32_t cnt)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    aipudrv::CtxRefMap& ctx_map = aipudrv::CtxRefMap::get_ctx_map();
+    aipudrv::MainContext* p_ctx = nullptr;
+
+    if (nullptr == ctx)
+    {
+        ret = AIPU_STATUS_ERROR_NULL_PTR;
+        goto finish;
+    }
+
+    p_ctx = ctx_map.get_ctx_ref(ctx->handle);
+    if (nullptr == p_ctx)
+    {
+        ret = AIPU_STATUS_ERROR_INVALID_CTX;
+    }
+    else
+    {
+        ret = p_ctx->flush_job_after(id, deps, cnt);
+    }
+
+finish:
+    return ret;
+}
+
+aipu_status_t aipu_get_job_status(const aipu_ctx_handle_t* ctx, uint64_t id, aipu_job_status_t* status)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    aipudrv::JobBase* job = nullptr;
+
+    ret = api_get_job(ctx, id, &job);
+    if (AIPU_STATUS_SUCCESS != ret)
+    {
+        return ret;
+    }
+
+    ret = api_get_job_status(aipudrv::CtxRefMap::get_ctx_map().get_ctx_ref(ctx->handle), job, status);
+    api_put_job(ctx, job);
+    return ret;
+}
+
+aipu_status_t aipu_clean_job(const aipu_ctx_handle_t* ctx, uint64_t id)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    aipudrv::GraphBase* graph = nullptr;
+
+    ret = api_get_graph(ctx, aipudrv::get_graph_id(id), &graph);
+    if (AIPU_STATUS_SUCCESS != ret)
+    {
+        return ret;
+    }
+
+    aipudrv::CtxRefMap::get_ctx_map().get_ctx_ref(ctx->handle)->drop_fence(id);
+    aipudrv::CtxRefMap::get_ctx_map().get_ctx_ref(ctx->handle)->dequeue_job(id);
+
+    /* waits for the job to be put back by the other threads using it */
+    ret = graph->destroy_job(id);
+    api_put_graph(ctx, graph);
+    return ret;
+}
+
+aipu_status_t aipu_hibernate_job(const aipu_ctx_handle_t* ctx, uint64_t id)
 {
     aipu_status_t ret = AIPU_STATUS_SUCCESS;
-    aipudrv::CtxRefMap& ctx_map = aipudrv::CtxRefMap::get_ctx_map();
-    aipudrv::MainContext* p_ctx = nullptr;
-    aipu_ctx_handle_t* ctx_handle = nullptr;
-    uint32_t handle = 0;
+    aipudrv::JobBase* job = nullptr;
 
-    if (nullptr == ctx)
+    ret = api_get_job(ctx, id, &job);
+    if (AIPU_STATUS_SUCCESS != ret)
     {
-        ret = AIPU_STATUS_ERROR_NULL_PTR;
-        goto finish;
+        return ret;
     }
 
-    handle = ctx_map.create_ctx_ref();
-    p_ctx = ctx_map.get_ctx_ref(handle);
-    assert(p_ctx != nullptr);
+    ret = job->hibernate();
+    api_put_job(ctx, job);
+    return ret;
+}
 
-    ret = p_ctx->init();
+aipu_status_t aipu_get_super_job_stat(const aipu_ctx_handle_t* ctx, uint64_t job, aipu_super_job_stat_t* stat)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    aipudrv::JobBase* p_job = nullptr;
+
+    ret = api_get_job(ctx, job, &p_job);
     if (AIPU_STATUS_SUCCESS != ret)
     {
-        ctx_map.destroy_ctx_ref(handle);
-    }
-    else
-    {
-        /* success */
-        ctx_handle = new aipu_ctx_handle_t;
-        ctx_handle->handle = handle;
-        *ctx = ctx_handle;
+        return ret;
     }
 
-finish:
+    ret = p_job->get_super_job_stat(stat);
+    api_put_job(ctx, p_job);
     return ret;
 }
 
-aipu_status_t aipu_deinit_context(const aipu_ctx_handle_t* ctx)
+aipu_status_t aipu_create_job_queue(const aipu_ctx_handle_t* ctx, const aipu_job_queue_config_t* config,
+    uint64_t* queue)
 {
     aipu_status_t ret = AIPU_STATUS_SUCCESS;
     aipudrv::CtxRefMap& ctx_map = aipudrv::CtxRefMap::get_ctx_map();
     aipudrv::MainContext* p_ctx = nullptr;
 
-    if (nullptr == ctx)
+    if ((nullptr == ctx) || (nullptr == config) || (nullptr == queue))
     {
         ret = AIPU_STATUS_ERROR_NULL_PTR;
         goto finish;
@@ -165,19 +854,14 @@ aipu_status_t aipu_deinit_context(const aipu_ctx_handle_t* ctx)
     }
     else
     {
-        ret = p_ctx->deinit();
-        if (AIPU_STATUS_SUCCESS == ret)
-        {
-            ctx_map.destroy_ctx_ref(ctx->handle);
-            delete ctx;
-        }
+        ret = p_ctx->create_job_queue(config, queue);
     }
 
 finish:
     return ret;
 }
 
-aipu_status_t aipu_load_graph(const aipu_ctx_handle_t* ctx, const char* graph_file, uint64_t* id)
+aipu_status_t aipu_destroy_job_queue(const aipu_ctx_handle_t* ctx, uint64_t queue)
 {
     aipu_status_t ret = AIPU_STATUS_SUCCESS;
     aipudrv::CtxRefMap& ctx_map = aipudrv::CtxRefMap::get_ctx_map();
@@ -196,14 +880,14 @@ aipu_status_t aipu_load_graph(const aipu_ctx_handle_t* ctx, const char* graph_fi
     }
     else
     {
-        ret = p_ctx->load_graph(graph_file, id);
+        ret = p_ctx->destroy_job_queue(queue);
     }
 
 finish:
     return ret;
 }
 
-aipu_status_t aipu_unload_graph(const aipu_ctx_handle_t* ctx, uint64_t graph)
+aipu_status_t aipu_set_graph_queue(const aipu_ctx_handle_t* ctx, uint64_t graph, uint64_t queue)
 {
     aipu_status_t ret = AIPU_STATUS_SUCCESS;
     aipudrv::CtxRefMap& ctx_map = aipudrv::CtxRefMap::get_ctx_map();
@@ -222,20 +906,21 @@ aipu_status_t aipu_unload_graph(const aipu_ctx_handle_t* ctx, uint64_t graph)
     }
     else
     {
-        ret = p_ctx->unload_graph(graph);
+        ret = p_ctx->set_graph_queue(graph, queue);
     }
 
 finish:
     return ret;
 }
 
-aipu_status_t aipu_create_job(const aipu_ctx_handle_t* ctx, uint64_t graph, uint64_t* job)
+aipu_status_t aipu_get_job_queue_stat(const aipu_ctx_handle_t* ctx, uint64_t queue,
+    aipu_job_queue_stat_t* stat)
 {
     aipu_status_t ret = AIPU_STATUS_SUCCESS;
     aipudrv::CtxRefMap& ctx_map = aipudrv::CtxRefMap::get_ctx_map();
     aipudrv::MainContext* p_ctx = nullptr;
 
-    if ((nullptr == ctx) || (nullptr == job))
+    if ((nullptr == ctx) || (nullptr == stat))
     {
         ret = AIPU_STATUS_ERROR_NULL_PTR;
         goto finish;
@@ -248,146 +933,264 @@ aipu_status_t aipu_create_job(const aipu_ctx_handle_t* ctx, uint64_t graph, uint
     }
     else
     {
-        ret = p_ctx->create_job(graph, job);
+        ret = p_ctx->get_job_queue_stat(queue, stat);
     }
 
 finish:
     return ret;
 }
 
-aipu_status_t aipu_finish_job(const aipu_ctx_handle_t* ctx, uint64_t job_id, int32_t time_out)
+aipu_status_t aipu_get_tensor_count(const aipu_ctx_handle_t* ctx, uint64_t id, aipu_tensor_type_t type,
+    uint32_t* cnt)
 {
     aipu_status_t ret = AIPU_STATUS_SUCCESS;
-    aipudrv::JobBase* job = nullptr;
-    aipu_job_status_t status;
+    aipudrv::GraphBase* graph = nullptr;
 
-    ret = api_get_job(ctx, job_id, &job);
+    ret = api_get_graph(ctx, aipudrv::get_graph_id(id), &graph);
     if (AIPU_STATUS_SUCCESS != ret)
     {
         return ret;
     }
 
-    ret = job->schedule();
+    ret = graph->get_tensor_count(type, cnt);
+    api_put_graph(ctx, graph);
+    return ret;
+}
+
+aipu_status_t aipu_get_tensor_descriptor(const aipu_ctx_handle_t* ctx, uint64_t id, aipu_tensor_type_t type,
+    uint32_t tensor, aipu_tensor_desc_t* desc)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    aipudrv::GraphBase* graph = nullptr;
+
+    ret = api_get_graph(ctx, aipudrv::get_graph_id(id), &graph);
     if (AIPU_STATUS_SUCCESS != ret)
     {
         return ret;
     }
 
-    if (time_out <= 0)
+    ret = graph->get_tensor_descriptor(type, tensor, desc);
+    api_put_graph(ctx, graph);
+    return ret;
+}
+
+aipu_status_t aipu_get_graph_memory_info(const aipu_ctx_handle_t* ctx, uint64_t graph,
+    aipu_graph_memory_info_t* info)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    aipudrv::GraphBase* p_gobj = nullptr;
+
+    if (nullptr == info)
     {
-        time_out = -1;
+        return AIPU_STATUS_ERROR_NULL_PTR;
     }
 
-    ret = job->get_status_blocking(&status, time_out);
-    if ((AIPU_STATUS_SUCCESS == ret) && (AIPU_JOB_STATUS_DONE != status))
+    ret = api_get_graph(ctx, graph, &p_gobj);
+    if (AIPU_STATUS_SUCCESS != ret)
     {
-        ret = AIPU_STATUS_ERROR_JOB_EXCEPTION;
+        return ret;
     }
 
+    p_gobj->get_memory_info(info);
+    p_gobj->get_device()->get_mem()->get_usage(&info->dev_budget, &info->dev_used);
+    api_put_graph(ctx, p_gobj);
     return ret;
 }
 
-aipu_status_t aipu_flush_job(const aipu_ctx_handle_t* ctx, uint64_t id, aipu_job_handler_callback callback,
-    void* priv)
+aipu_status_t aipu_load_tensor(const aipu_ctx_handle_t* ctx, uint64_t job_id, uint32_t tensor, const void* data)
 {
     aipu_status_t ret = AIPU_STATUS_SUCCESS;
     aipudrv::JobBase* job = nullptr;
 
-    ret = api_get_job(ctx, id, &job);
+    ret = api_get_job(ctx, job_id, &job);
     if (AIPU_STATUS_SUCCESS != ret)
     {
         return ret;
     }
 
-    /* callback to be implemented */
-    return job->schedule();
+    ret = job->load_tensor(tensor, data);
+    api_put_job(ctx, job);
+    return ret;
 }
 
-aipu_status_t aipu_get_job_status(const aipu_ctx_handle_t* ctx, uint64_t id, aipu_job_status_t* status)
+aipu_status_t aipu_get_tensor(const aipu_ctx_handle_t* ctx, uint64_t job_id, aipu_tensor_type_t type, uint32_t tensor,
+    void* data)
 {
     aipu_status_t ret = AIPU_STATUS_SUCCESS;
     aipudrv::JobBase* job = nullptr;
 
-    ret = api_get_job(ctx, id, &job);
+    ret = api_get_job(ctx, job_id, &job);
     if (AIPU_STATUS_SUCCESS != ret)
     {
         return ret;
     }
 
-    return job->get_status(status);
+    ret = job->get_tensor(type, tensor, data);
+    api_put_job(ctx, job);
+    return ret;
 }
 
-aipu_status_t aipu_clean_job(const aipu_ctx_handle_t* ctx, uint64_t id)
+aipu_status_t aipu_get_job_ref(const aipu_ctx_handle_t* ctx, uint64_t job_id, aipu_job_ref_t* ref)
 {
     aipu_status_t ret = AIPU_STATUS_SUCCESS;
-    aipudrv::GraphBase* graph = nullptr;
+    aipudrv::JobBase* job = nullptr;
 
-    ret = api_get_graph(ctx, aipudrv::get_graph_id(id), &graph);
+    if (nullptr == ref)
+    {
+        return AIPU_STATUS_ERROR_NULL_PTR;
+    }
+
+    ret = api_get_job(ctx, job_id, &job);
     if (AIPU_STATUS_SUCCESS != ret)
     {
         return ret;
     }
 
-    return graph->destroy_job(id);
+    ref->ctx = aipudrv::CtxRefMap::get_ctx_map().get_ctx_ref(ctx->handle);
+    ref->job = job_id;
+    api_put_job(ctx, job);
+    return AIPU_STATUS_SUCCESS;
 }
 
-aipu_status_t aipu_get_tensor_count(const aipu_ctx_handle_t* ctx, uint64_t id, aipu_tensor_type_t type,
-    uint32_t* cnt)
+/**
+ * @brief get the job of a reference filled by aipu_get_job_ref; a stale reference fails
+ *        the generation check of the job ID as the ID based APIs do
+ *
+ * @note the job is held for one call only on purpose: a reference pinning it would block
+ *       aipu_clean_job/aipu_unload_graph until the application drops it
+ */
+static aipu_status_t api_get_job_by_ref(const aipu_job_ref_t* ref, aipudrv::MainContext** p_ctx,
+    aipudrv::JobBase** job)
+{
+    if (nullptr == ref)
+    {
+        return AIPU_STATUS_ERROR_NULL_PTR;
+    }
+
+    *p_ctx = (aipudrv::MainContext*)ref->ctx;
+    if (nullptr == *p_ctx)
+    {
+        return AIPU_STATUS_ERROR_INVALID_CTX;
+    }
+
+    *job = (*p_ctx)->get_job_object(ref->job);
+    if (nullptr == *job)
+    {
+        return AIPU_STATUS_ERROR_INVALID_JOB_ID;
+    }
+
+    return AIPU_STATUS_SUCCESS;
+}
+
+aipu_status_t aipu_job_ref_load_tensor(aipu_job_ref_t* ref, uint32_t tensor, const void* data)
 {
     aipu_status_t ret = AIPU_STATUS_SUCCESS;
-    aipudrv::GraphBase* graph = nullptr;
+    aipudrv::MainContext* p_ctx = nullptr;
+    aipudrv::JobBase* job = nullptr;
 
-    ret = api_get_graph(ctx, aipudrv::get_graph_id(id), &graph);
+    ret = api_get_job_by_ref(ref, &p_ctx, &job);
     if (AIPU_STATUS_SUCCESS != ret)
     {
         return ret;
     }
 
-    return graph->get_tensor_count(type, cnt);
+    ret = job->load_tensor(tensor, data);
+    p_ctx->put_job_object(job);
+    return ret;
 }
 
-aipu_status_t aipu_get_tensor_descriptor(const aipu_ctx_handle_t* ctx, uint64_t id, aipu_tensor_type_t type,
-    uint32_t tensor, aipu_tensor_desc_t* desc)
+aipu_status_t aipu_job_ref_get_tensor(aipu_job_ref_t* ref, aipu_tensor_type_t type, uint32_t tensor, void* data)
 {
     aipu_status_t ret = AIPU_STATUS_SUCCESS;
-    aipudrv::GraphBase* graph = nullptr;
+    aipudrv::MainContext* p_ctx = nullptr;
+    aipudrv::JobBase* job = nullptr;
 
-    ret = api_get_graph(ctx, aipudrv::get_graph_id(id), &graph);
+    ret = api_get_job_by_ref(ref, &p_ctx, &job);
     if (AIPU_STATUS_SUCCESS != ret)
     {
         return ret;
     }
 
-    return graph->get_tensor_descriptor(type, tensor, desc);
+    ret = job->get_tensor(type, tensor, data);
+    p_ctx->put_job_object(job);
+    return ret;
 }
 
-aipu_status_t aipu_load_tensor(const aipu_ctx_handle_t* ctx, uint64_t job_id, uint32_t tensor, const void* data)
+aipu_status_t aipu_job_ref_flush(aipu_job_ref_t* ref)
 {
     aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    aipudrv::MainContext* p_ctx = nullptr;
     aipudrv::JobBase* job = nullptr;
 
-    ret = api_get_job(ctx, job_id, &job);
+    ret = api_get_job_by_ref(ref, &p_ctx, &job);
     if (AIPU_STATUS_SUCCESS != ret)
     {
         return ret;
     }
 
-    return job->load_tensor(tensor, data);
+    ret = p_ctx->flush_job(job);
+    p_ctx->put_job_object(job);
+    return ret;
 }
 
-aipu_status_t aipu_get_tensor(const aipu_ctx_handle_t* ctx, uint64_t job_id, aipu_tensor_type_t type, uint32_t tensor,
-    void* data)
+aipu_status_t aipu_job_ref_finish(aipu_job_ref_t* ref, int32_t time_out)
 {
     aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    aipudrv::MainContext* p_ctx = nullptr;
     aipudrv::JobBase* job = nullptr;
 
-    ret = api_get_job(ctx, job_id, &job);
+    ret = api_get_job_by_ref(ref, &p_ctx, &job);
+    if (AIPU_STATUS_SUCCESS != ret)
+    {
+        return ret;
+    }
+
+    ret = api_finish_job(p_ctx, job, time_out);
+    p_ctx->put_job_object(job);
+    return ret;
+}
+
+aipu_status_t aipu_job_ref_get_status(aipu_job_ref_t* ref, aipu_job_status_t* status)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    aipudrv::MainContext* p_ctx = nullptr;
+    aipudrv::JobBase* job = nullptr;
+
+    ret = api_get_job_by_ref(ref, &p_ctx, &job);
     if (AIPU_STATUS_SUCCESS != ret)
     {
         return ret;
     }
 
-    return job->get_tensor(type, tensor, data);
+    ret = api_get_job_status(p_ctx, job, status);
+    p_ctx->put_job_object(job);
+    return ret;
+}
+
+aipu_status_t aipu_get_device_count(const aipu_ctx_handle_t* ctx, uint32_t* cnt)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    aipudrv::CtxRefMap& ctx_map = aipudrv::CtxRefMap::get_ctx_map();
+    aipudrv::MainContext* p_ctx = nullptr;
+
+    if ((nullptr == ctx) || (nullptr == cnt))
+    {
+        ret = AIPU_STATUS_ERROR_NULL_PTR;
+        goto finish;
+    }
+
+    p_ctx = ctx_map.get_ctx_ref(ctx->handle);
+    if (nullptr == p_ctx)
+    {
+        ret = AIPU_STATUS_ERROR_INVALID_CTX;
+    }
+    else
+    {
+        *cnt = p_ctx->get_device_count();
+    }
+
+finish:
+    return ret;
 }
 
 aipu_status_t aipu_get_cluster_count(const aipu_ctx_handle_t* ctx, uint32_t* cnt)
@@ -442,6 +1245,33 @@ finish:
     return ret;
 }
 
+aipu_status_t aipu_replay_trace(const aipu_ctx_handle_t* ctx, const char* trace, bool keep_timing,
+    aipu_replay_stat_t* stat)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    aipudrv::CtxRefMap& ctx_map = aipudrv::CtxRefMap::get_ctx_map();
+    aipudrv::MainContext* p_ctx = nullptr;
+
+    if ((nullptr == ctx) || (nullptr == trace) || (nullptr == stat))
+    {
+        ret = AIPU_STATUS_ERROR_NULL_PTR;
+        goto finish;
+    }
+
+    p_ctx = ctx_map.get_ctx_ref(ctx->handle);
+    if (nullptr == p_ctx)
+    {
+        ret = AIPU_STATUS_ERROR_INVALID_CTX;
+    }
+    else
+    {
+        ret = p_ctx->replay_trace(trace, keep_timing, stat);
+    }
+
+finish:
+    return ret;
+}
+
 aipu_status_t aipu_debugger_get_job_info(const aipu_ctx_handle_t* ctx,
     uint64_t job, aipu_debugger_job_info_t* info)
 {
@@ -480,7 +1310,9 @@ aipu_status_t aipu_debugger_bind_job(const aipu_ctx_handle_t* ctx, uint32_t core
         return ret;
     }
 
-    return job->bind_core(core_id);
+    ret = job->bind_core(core_id);
+    api_put_job(ctx, job);
+    return ret;
 }
 
 aipu_status_t aipu_debugger_run_job(const aipu_ctx_handle_t* ctx, uint32_t job_id)
@@ -494,7 +1326,9 @@ aipu_status_t aipu_debugger_run_job(const aipu_ctx_handle_t* ctx, uint32_t job_i
         return ret;
     }
 
-    return job->debugger_run();
+    ret = job->debugger_run();
+    api_put_job(ctx, job);
+    return ret;
 }
 
 aipu_status_t aipu_debugger_malloc(const aipu_ctx_handle_t* ctx, uint32_t size, void** va)
@@ -580,6 +1414,7 @@ aipu_status_t aipu_config_job(const aipu_ctx_handle_t* ctx, uint64_t job_id, uin
         ret = AIPU_STATUS_ERROR_INVALID_CONFIG;
     }
 
+    api_put_job(ctx, job);
     return ret;
 }
 
@@ -588,6 +1423,8 @@ aipu_status_t aipu_config_global(const aipu_ctx_handle_t* ctx, uint64_t types, v
     aipu_status_t ret = AIPU_STATUS_SUCCESS;
     aipudrv::CtxRefMap& ctx_map = aipudrv::CtxRefMap::get_ctx_map();
     aipudrv::MainContext* p_ctx = nullptr;
+    uint64_t config_types = types &
+        ~(uint64_t)(AIPU_GLOBAL_CONFIG_TYPE_DISABLE_VER_CHECK | AIPU_GLOBAL_CONFIG_TYPE_ENABLE_VER_CHECK);
 
     if (nullptr == ctx)
     {
@@ -595,6 +1432,13 @@ aipu_status_t aipu_config_global(const aipu_ctx_handle_t* ctx, uint64_t types, v
         goto finish;
     }
 
+    /* config points to the struct of a single type */
+    if ((config_types & (config_types - 1)) != 0)
+    {
+        ret = AIPU_STATUS_ERROR_INVALID_CONFIG;
+        goto finish;
+    }
+
     p_ctx = ctx_map.get_ctx_ref(ctx->handle);
     if (nullptr == p_ctx)
     {
@@ -624,6 +1468,76 @@ aipu_status_t aipu_config_global(const aipu_ctx_handle_t* ctx, uint64_t types, v
             types &= ~AIPU_GLOBAL_CONFIG_TYPE_ENABLE_VER_CHECK;
         }
 
+        if (types & AIPU_GLOBAL_CONFIG_TYPE_PARALLEL_LOAD)
+        {
+            ret = p_ctx->config_parallel_load((aipu_global_config_parallel_load_t*)config);
+            if (ret != AIPU_STATUS_SUCCESS)
+            {
+                goto finish;
+            }
+            types &= ~AIPU_GLOBAL_CONFIG_TYPE_PARALLEL_LOAD;
+        }
+
+        if (types & AIPU_GLOBAL_CONFIG_TYPE_WEIGHT_STREAMING)
+        {
+            ret = p_ctx->config_weight_streaming((aipu_global_config_weight_streaming_t*)config);
+            if (ret != AIPU_STATUS_SUCCESS)
+            {
+                goto finish;
+            }
+            types &= ~AIPU_GLOBAL_CONFIG_TYPE_WEIGHT_STREAMING;
+        }
+
+        if (types & AIPU_GLOBAL_CONFIG_TYPE_DEFERRED_UNLOAD)
+        {
+            ret = p_ctx->config_deferred_unload((aipu_global_config_deferred_unload_t*)config);
+            if (ret != AIPU_STATUS_SUCCESS)
+            {
+                goto finish;
+            }
+            types &= ~AIPU_GLOBAL_CONFIG_TYPE_DEFERRED_UNLOAD;
+        }
+
+        if (types & AIPU_GLOBAL_CONFIG_TYPE_MOCK_DEVICE)
+        {
+            ret = p_ctx->config_mock_device((aipu_global_config_mock_device_t*)config);
+            if (ret != AIPU_STATUS_SUCCESS)
+            {
+                goto finish;
+            }
+            types &= ~AIPU_GLOBAL_CONFIG_TYPE_MOCK_DEVICE;
+        }
+
+        if (types & AIPU_GLOBAL_CONFIG_TYPE_PLACEMENT)
+        {
+            ret = p_ctx->config_placement((aipu_global_config_placement_t*)config);
+            if (ret != AIPU_STATUS_SUCCESS)
+            {
+                goto finish;
+            }
+            types &= ~AIPU_GLOBAL_CONFIG_TYPE_PLACEMENT;
+        }
+
+        if (types & AIPU_GLOBAL_CONFIG_TYPE_SCHEDULER)
+        {
+            ret = p_ctx->config_scheduler((aipu_global_config_scheduler_t*)config);
+            if (ret != AIPU_STATUS_SUCCESS)
+            {
+                goto finish;
+            }
+            types &= ~AIPU_GLOBAL_CONFIG_TYPE_SCHEDULER;
+        }
+
+        if (types & AIPU_GLOBAL_CONFIG_TYPE_ADMISSION)
+        {
+            ret = p_ctx->config_admission((aipu_global_config_admission_t*)config);
+            if (ret != AIPU_STATUS_SUCCESS)
+            {
+                goto finish;
+            }
+            types &= ~AIPU_GLOBAL_CONFIG_TYPE_ADMISSION;
+        }
+
         if (types)
         {
             ret = AIPU_STATUS_ERROR_INVALID_CONFIG;
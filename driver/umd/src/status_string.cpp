@@ -47,5 +47,8 @@ char aipudrv::MainContext::umd_status_string[][1024] = {
     "The tensor ID application provides is invalid.",
     "The AIPU cluster ID application provides is invalid and cannot be found in system.",
     "UMD fails in parsing the printf buffer and print corresponding logs.",
+    "Model handle provided is an invalid one which has been unloaded or never existed.",
+    "Job queue ID provided is an invalid one which has been destroyed or never existed.",
+    "Batcher handle provided is an invalid one which has been destroyed or never existed.",
     "Status Max value which should not be returned to application.",
 };
\ No newline at end of file
@@ -0,0 +1,241 @@
+/**********************************************************************************
+ * This file is CONFIDENTIAL and any use by you is subject to the terms of the
+ * agreement between you and Arm China or the terms of the agreement between you
+ * and the party authorised by Arm China to disclose this file to you.
+ * The confidential and proprietary information contained in this file
+ * may only be used by a person authorised under and to the extent permitted
+ * by a subsisting licensing agreement from Arm China.
+ *
+ *        (C) Copyright 2020 Arm Technology (China) Co. Ltd.
+ *                    All rights reserved.
+ *
+ * This entire notice must be reproduced on all copies of this file and copies of
+ * this file may only be made by a person if such person is permitted to do so
+ * under the terms of a subsisting license agreement from Arm China.
+ *
+ *********************************************************************************/
+
+/**
+ * @file  super_graph.cpp
+ * @brief AIPU User Mode Driver (UMD) super graph module implementation
+ */
+
+#include <cstring>
+#include "super_graph.h"
+#include "super_job.h"
+#include "utils/log.h"
+
+aipudrv::SuperGraph::SuperGraph(GRAPH_ID id, DeviceBase* dev): GraphBase(id, dev)
+{
+}
+
+aipudrv::SuperGraph::~SuperGraph()
+{
+}
+
+aipu_status_t aipudrv::SuperGraph::init(const std::vector<GraphBase*>& members,
+    const std::vector<aipu_tensor_binding_t>& bindings)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    std::vector<std::vector<bool>> in_bound;
+    std::vector<std::vector<bool>> out_bound;
+
+    if (members.empty())
+    {
+        return AIPU_STATUS_ERROR_INVALID_SIZE;
+    }
+
+    for (uint32_t i = 0; i < members.size(); i++)
+    {
+        uint32_t in_cnt = 0;
+        uint32_t out_cnt = 0;
+
+        /* bound tensors are shared in the memory of one device */
+        if ((nullptr == members[i]) || (members[i]->get_device() != m_dev) ||
+            (nullptr != dynamic_cast<SuperGraph*>(members[i])))
+        {
+            return AIPU_STATUS_ERROR_INVALID_OP;
+        }
+        members[i]->get_tensor_count(AIPU_TENSOR_TYPE_INPUT, &in_cnt);
+        members[i]->get_tensor_count(AIPU_TENSOR_TYPE_OUTPUT, &out_cnt);
+        in_bound.push_back(std::vector<bool>(in_cnt, false));
+        out_bound.push_back(std::vector<bool>(out_cnt, false));
+    }
+
+    for (uint32_t i = 0; i < bindings.size(); i++)
+    {
+        const aipu_tensor_binding_t& b = bindings[i];
+        aipu_tensor_desc_t src;
+        aipu_tensor_desc_t dst;
+
+        /* a member is only fed by the ones running before it */
+        if ((b.src_graph >= b.dst_graph) || (b.dst_graph >= members.size()))
+        {
+            LOG(LOG_ERR, "binding %u: graph %u cannot feed graph %u", i, b.src_graph, b.dst_graph);
+            return AIPU_STATUS_ERROR_INVALID_OP;
+        }
+
+        ret = members[b.src_graph]->get_tensor_descriptor(AIPU_TENSOR_TYPE_OUTPUT, b.src_output, &src);
+        if (AIPU_STATUS_SUCCESS != ret)
+        {
+            return ret;
+        }
+        ret = members[b.dst_graph]->get_tensor_descriptor(AIPU_TENSOR_TYPE_INPUT, b.dst_input, &dst);
+        if (AIPU_STATUS_SUCCESS != ret)
+        {
+            return ret;
+        }
+        if ((src.size != dst.size) || in_bound[b.dst_graph][b.dst_input])
+        {
+            LOG(LOG_ERR, "binding %u: output %u of graph %u cannot be bound to input %u of graph %u",
+                i, b.src_output, b.src_graph, b.dst_input, b.dst_graph);
+            return AIPU_STATUS_ERROR_INVALID_OP;
+        }
+        in_bound[b.dst_graph][b.dst_input] = true;
+        out_bound[b.src_graph][b.src_output] = true;
+    }
+
+    for (uint32_t i = 0; i < members.size(); i++)
+    {
+        for (uint32_t j = 0; j < in_bound[i].size(); j++)
+        {
+            if (!in_bound[i][j])
+            {
+                m_inputs.push_back({i, j});
+            }
+        }
+        for (uint32_t j = 0; j < out_bound[i].size(); j++)
+        {
+            if (!out_bound[i][j])
+            {
+                m_outputs.push_back({i, j});
+            }
+        }
+    }
+
+    /* members cannot be unloaded before this super graph */
+    for (uint32_t i = 0; i < members.size(); i++)
+    {
+        members[i]->pin();
+    }
+    m_members = members;
+    m_bindings = bindings;
+    return ret;
+}
+
+aipu_status_t aipudrv::SuperGraph::unload()
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+
+    ret = destroy_jobs();
+    if (AIPU_STATUS_SUCCESS != ret)
+    {
+        return ret;
+    }
+
+    for (uint32_t i = 0; i < m_members.size(); i++)
+    {
+        m_members[i]->unpin();
+    }
+    m_members.clear();
+    return ret;
+}
+
+aipu_status_t aipudrv::SuperGraph::create_job(JOB_ID* id, const aipu_global_config_simulation_t* cfg)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    SuperJob* job = new SuperJob(*this, m_dev);
+
+    ret = job->init(cfg);
+    if (AIPU_STATUS_SUCCESS != ret)
+    {
+        delete job;
+        return ret;
+    }
+
+    ret = add_job(job, id);
+    if (AIPU_STATUS_SUCCESS != ret)
+    {
+        job->destroy();
+        delete job;
+    }
+    return ret;
+}
+
+void aipudrv::SuperGraph::get_memory_info(aipu_graph_memory_info_t* info)
+{
+    aipu_graph_memory_info_t member;
+
+    memset(info, 0, sizeof(*info));
+    for (uint32_t i = 0; i < m_members.size(); i++)
+    {
+        m_members[i]->get_memory_info(&member);
+        info->text_size += member.text_size;
+        info->weight_size += member.weight_size;
+        info->shared_size += member.shared_size;
+        info->rodata_size += member.rodata_size;
+        info->dcr_size += member.dcr_size;
+        info->tcb_size += member.tcb_size;
+        info->reuse_size += member.reuse_size;
+        info->stack_size += member.stack_size;
+        info->data_size += member.data_size;
+        info->job_size += member.job_size;
+        info->align_slack += member.align_slack;
+    }
+}
+
+aipu_status_t aipudrv::SuperGraph::get_tensor_count(aipu_tensor_type_t type, uint32_t* cnt)
+{
+    if (nullptr == cnt)
+    {
+        return AIPU_STATUS_ERROR_NULL_PTR;
+    }
+
+    /* printf/profiler data stays with the member jobs */
+    if (type == AIPU_TENSOR_TYPE_INPUT)
+    {
+        *cnt = (uint32_t)m_inputs.size();
+    }
+    else if (type == AIPU_TENSOR_TYPE_OUTPUT)
+    {
+        *cnt = (uint32_t)m_outputs.size();
+    }
+    else
+    {
+        *cnt = 0;
+    }
+
+    return AIPU_STATUS_SUCCESS;
+}
+
+aipu_status_t aipudrv::SuperGraph::get_tensor_descriptor(aipu_tensor_type_t type,
+    uint32_t tensor, aipu_tensor_desc_t* desc)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    SuperGraphTensor io;
+
+    if (nullptr == desc)
+    {
+        return AIPU_STATUS_ERROR_NULL_PTR;
+    }
+
+    if ((type == AIPU_TENSOR_TYPE_INPUT) && (tensor < m_inputs.size()))
+    {
+        io = m_inputs[tensor];
+    }
+    else if ((type == AIPU_TENSOR_TYPE_OUTPUT) && (tensor < m_outputs.size()))
+    {
+        io = m_outputs[tensor];
+    }
+    else
+    {
+        return AIPU_STATUS_ERROR_INVALID_TENSOR_ID;
+    }
+
+    ret = m_members[io.member]->get_tensor_descriptor(type, io.tensor, desc);
+    if (AIPU_STATUS_SUCCESS == ret)
+    {
+        desc->id = tensor;
+    }
+    return ret;
+}
@@ -16,36 +16,81 @@
  *********************************************************************************/
 
 /**
- * @file  super_base.h
- * @brief AIPU User Mode Driver (UMD) graph base module header
+ * @file  super_graph.h
+ * @brief AIPU User Mode Driver (UMD) super graph module header
  */
 
 #ifndef _SUPER_GRAPH_H_
 #define _SUPER_GRAPH_H_
 
 #include <fstream>
+#include <vector>
 #include "standard_api.h"
 #include "graph_base.h"
 
 namespace aipudrv
 {
+struct SuperGraphTensor
+{
+    uint32_t member;
+    uint32_t tensor;
+};
+
+/**
+ * @brief a pipeline of loaded graphs, in which some outputs of a graph are bound to inputs
+ *        of a later one; a job of it runs one job per member graph, and the bound tensors
+ *        are shared instead of being copied
+ */
 class SuperGraph: public GraphBase
 {
-    /* To be implemented! */
+private:
+    std::vector<GraphBase*> m_members;
+    std::vector<aipu_tensor_binding_t> m_bindings;
+    /* tensors not bound, which are the inputs/outputs of the super graph */
+    std::vector<SuperGraphTensor> m_inputs;
+    std::vector<SuperGraphTensor> m_outputs;
+
 public:
+    aipu_status_t init(const std::vector<GraphBase*>& members,
+        const std::vector<aipu_tensor_binding_t>& bindings);
     virtual void print_parse_info(){};
-    virtual aipu_status_t load(std::ifstream& gbin, uint32_t size, DeviceBase* dev){return AIPU_STATUS_SUCCESS;};
-    virtual aipu_status_t unload(){return AIPU_STATUS_SUCCESS;};
-    virtual aipu_status_t create_job(JOB_ID* id){return AIPU_STATUS_SUCCESS;};
-    virtual aipu_status_t destroy_job(JOB_ID id){return AIPU_STATUS_SUCCESS;};
-    virtual aipu_status_t get_tensor_count(aipu_tensor_type_t type, uint32_t* cnt){return AIPU_STATUS_SUCCESS;};
+    virtual aipu_status_t load(std::ifstream& gbin, uint32_t size, bool ver_check = true)
+    {
+        return AIPU_STATUS_ERROR_OP_NOT_SUPPORTED;
+    }
+    virtual aipu_status_t unload();
+    virtual aipu_status_t create_job(JOB_ID* id, const aipu_global_config_simulation_t* cfg);
+    virtual aipu_status_t get_tensor_count(aipu_tensor_type_t type, uint32_t* cnt);
     virtual aipu_status_t get_tensor_descriptor(aipu_tensor_type_t type,
-        uint32_t tensor, aipu_tensor_desc_t* desc){return AIPU_STATUS_SUCCESS;};
-    virtual JobBase* get_job_object(JOB_ID id){return nullptr;};
+        uint32_t tensor, aipu_tensor_desc_t* desc);
+    virtual DEV_PA_64 debugger_get_instr_base()
+    {
+        return 0;
+    }
+    virtual void get_memory_info(aipu_graph_memory_info_t* info);
+
+public:
+    /* Get functions */
+    const std::vector<GraphBase*>& get_members() const
+    {
+        return m_members;
+    }
+    const std::vector<aipu_tensor_binding_t>& get_bindings() const
+    {
+        return m_bindings;
+    }
+    const std::vector<SuperGraphTensor>& get_inputs() const
+    {
+        return m_inputs;
+    }
+    const std::vector<SuperGraphTensor>& get_outputs() const
+    {
+        return m_outputs;
+    }
 
 public:
-    SuperGraph(GRAPH_ID id, DeviceBase* dev): GraphBase(id, dev){};
-    virtual ~SuperGraph(){};
+    SuperGraph(GRAPH_ID id, DeviceBase* dev);
+    virtual ~SuperGraph();
     SuperGraph(const SuperGraph& base) = delete;
     SuperGraph& operator=(const SuperGraph& base) = delete;
 };
@@ -0,0 +1,372 @@
+/**********************************************************************************
+ * This file is CONFIDENTIAL and any use by you is subject to the terms of the
+ * agreement between you and Arm China or the terms of the agreement between you
+ * and the party authorised by Arm China to disclose this file to you.
+ * The confidential and proprietary information contained in this file
+ * may only be used by a person authorised under and to the extent permitted
+ * by a subsisting licensing agreement from Arm China.
+ *
+ *        (C) Copyright 2020 Arm Technology (China) Co. Ltd.
+ *                    All rights reserved.
+ *
+ * This entire notice must be reproduced on all copies of this file and copies of
+ * this file may only be made by a person if such person is permitted to do so
+ * under the terms of a subsisting license agreement from Arm China.
+ *
+ *********************************************************************************/
+
+/**
+ * @file  super_job.cpp
+ * @brief AIPU User Mode Driver (UMD) super job module implementation
+ */
+
+#include <time.h>
+#include "super_job.h"
+#include "utils/log.h"
+
+aipudrv::SuperJob::SuperJob(const GraphBase& graph, DeviceBase* dev):
+    JobBase(graph, dev)
+{
+}
+
+aipudrv::SuperJob::~SuperJob()
+{
+}
+
+aipu_status_t aipudrv::SuperJob::init(const aipu_global_config_simulation_t* cfg)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    const std::vector<GraphBase*>& members = get_super_graph().get_members();
+    const std::vector<aipu_tensor_binding_t>& bindings = get_super_graph().get_bindings();
+    const std::vector<SuperGraphTensor>& inputs = get_super_graph().get_inputs();
+    const std::vector<SuperGraphTensor>& outputs = get_super_graph().get_outputs();
+    JOB_ID id = 0;
+
+    /* 1. create a job for every member */
+    for (uint32_t i = 0; i < members.size(); i++)
+    {
+        ret = members[i]->create_job(&id, cfg);
+        if (AIPU_STATUS_SUCCESS != ret)
+        {
+            goto finish;
+        }
+        m_stage_ids.push_back(id);
+
+        /* owned by this super job until it is destroyed: no reference is kept */
+        m_stages.push_back(members[i]->get_job(id));
+        members[i]->put_job(id);
+    }
+
+    /* 2. feed bound inputs from the outputs of earlier members in place, or by a copy */
+    for (uint32_t i = 0; i < bindings.size(); i++)
+    {
+        const JobIOBuffer& src = m_stages[bindings[i].src_graph]->get_outputs()[bindings[i].src_output];
+
+        ret = m_stages[bindings[i].dst_graph]->bind_input(bindings[i].dst_input, src.pa);
+        if (AIPU_STATUS_ERROR_OP_NOT_SUPPORTED == ret)
+        {
+            m_copies.push_back(bindings[i]);
+            ret = AIPU_STATUS_SUCCESS;
+        }
+        if (AIPU_STATUS_SUCCESS != ret)
+        {
+            goto finish;
+        }
+    }
+
+    /* 3. the unbound tensors are accessed in the member job buffers directly */
+    for (uint32_t i = 0; i < inputs.size(); i++)
+    {
+        JobIOBuffer buf = m_stages[inputs[i].member]->get_inputs()[inputs[i].tensor];
+        buf.id = i;
+        m_inputs.push_back(buf);
+    }
+    for (uint32_t i = 0; i < outputs.size(); i++)
+    {
+        JobIOBuffer buf = m_stages[outputs[i].member]->get_outputs()[outputs[i].tensor];
+        buf.id = i;
+        m_outputs.push_back(buf);
+    }
+
+    /* success */
+    m_status = AIPU_JOB_STATUS_INIT;
+
+finish:
+    if (ret)
+    {
+        free_stage_jobs();
+    }
+    return ret;
+}
+
+aipu_status_t aipudrv::SuperJob::free_stage_jobs()
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    const std::vector<GraphBase*>& members = get_super_graph().get_members();
+
+    for (uint32_t i = 0; i < m_stage_ids.size(); i++)
+    {
+        if (members[i]->destroy_job(m_stage_ids[i]) != AIPU_STATUS_SUCCESS)
+        {
+            ret = AIPU_STATUS_ERROR_BUF_FREE_FAIL;
+        }
+    }
+    m_stages.clear();
+    m_stage_ids.clear();
+    m_copies.clear();
+    m_inputs.clear();
+    m_outputs.clear();
+
+    return ret;
+}
+
+aipu_status_t aipudrv::SuperJob::copy_inputs(uint32_t stage)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    char* va = nullptr;
+
+    for (uint32_t i = 0; i < m_copies.size(); i++)
+    {
+        JobBase* dst = m_stages[m_copies[i].dst_graph];
+
+        if (m_copies[i].dst_graph != stage)
+        {
+            continue;
+        }
+
+        /* the consumer input buffer is its own: allocated again if it is hibernated */
+        ret = dst->wake();
+        if (AIPU_STATUS_SUCCESS != ret)
+        {
+            return ret;
+        }
+
+        const JobIOBuffer& in = dst->get_inputs()[m_copies[i].dst_input];
+        if (m_mem->pa_to_va(in.pa, in.size, &va) != 0)
+        {
+            return AIPU_STATUS_ERROR_INVALID_OP;
+        }
+        ret = m_stages[m_copies[i].src_graph]->get_tensor(AIPU_TENSOR_TYPE_OUTPUT,
+            m_copies[i].src_output, va);
+        if (AIPU_STATUS_SUCCESS != ret)
+        {
+            return ret;
+        }
+    }
+
+    return ret;
+}
+
+bool aipudrv::SuperJob::is_copied(uint32_t stage)
+{
+    for (uint32_t i = 0; i < m_copies.size(); i++)
+    {
+        if (m_copies[i].dst_graph == stage)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+aipu_status_t aipudrv::SuperJob::chain_stages()
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+
+    /* a member job fed by a copy is started only after its producer is found done */
+    while ((m_scheduled + 1 < m_stages.size()) && !is_copied(m_scheduled + 1))
+    {
+        ret = m_stages[m_scheduled + 1]->schedule_after(m_stages[m_scheduled]);
+        if (AIPU_STATUS_ERROR_OP_NOT_SUPPORTED == ret)
+        {
+            return AIPU_STATUS_SUCCESS;
+        }
+        if (AIPU_STATUS_SUCCESS != ret)
+        {
+            return ret;
+        }
+        m_scheduled++;
+        m_chained++;
+    }
+
+    return ret;
+}
+
+aipu_status_t aipudrv::SuperJob::schedule()
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+
+    ret = validate_schedule_status();
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        return ret;
+    }
+
+    m_stage = 0;
+    m_scheduled = 0;
+    m_chained = 0;
+    m_failed = false;
+    ret = m_stages[0]->schedule();
+    if (AIPU_STATUS_SUCCESS == ret)
+    {
+        ret = chain_stages();
+    }
+    if (AIPU_STATUS_SUCCESS == ret)
+    {
+        m_status = AIPU_JOB_STATUS_SCHED;
+    }
+    else
+    {
+        m_status = AIPU_JOB_STATUS_EXCEPTION;
+    }
+
+    return ret;
+}
+
+aipu_status_t aipudrv::SuperJob::advance(aipu_job_status_t stage_status, aipu_job_status_t* status)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+
+    *status = AIPU_JOB_STATUS_NO_STATUS;
+    if ((AIPU_JOB_STATUS_EXCEPTION == stage_status) || (AIPU_JOB_STATUS_DONE == stage_status))
+    {
+        if (AIPU_JOB_STATUS_EXCEPTION == stage_status)
+        {
+            LOG(LOG_ERR, "job 0x%lx: member %u ended with exception", m_id, m_stage);
+            m_failed = true;
+        }
+
+        if (m_stage < m_scheduled)
+        {
+            /* the next member job is chained on the device already: its status is got next */
+            m_stage++;
+        }
+        else if (m_failed)
+        {
+            m_status = AIPU_JOB_STATUS_EXCEPTION;
+        }
+        else if (m_stage + 1 == m_stages.size())
+        {
+            m_status = AIPU_JOB_STATUS_DONE;
+        }
+        else
+        {
+            /* outputs of the done member are read in place by the next one, or copied */
+            m_stage++;
+            ret = copy_inputs(m_stage);
+            if (AIPU_STATUS_SUCCESS == ret)
+            {
+                ret = m_stages[m_stage]->schedule();
+            }
+            if (AIPU_STATUS_SUCCESS == ret)
+            {
+                m_scheduled = m_stage;
+                ret = chain_stages();
+            }
+            if (AIPU_STATUS_SUCCESS != ret)
+            {
+                m_status = AIPU_JOB_STATUS_EXCEPTION;
+            }
+        }
+    }
+
+    if ((AIPU_JOB_STATUS_DONE == m_status) || (AIPU_JOB_STATUS_EXCEPTION == m_status))
+    {
+        *status = (aipu_job_status_t)m_status.load();
+    }
+    return ret;
+}
+
+aipu_status_t aipudrv::SuperJob::get_status(aipu_job_status_t* status)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    aipu_job_status_t stage_status = AIPU_JOB_STATUS_NO_STATUS;
+
+    /* chained member jobs may be done already: their statuses are taken in one go */
+    while (m_status == AIPU_JOB_STATUS_SCHED)
+    {
+        ret = m_stages[m_stage]->get_status(&stage_status);
+        if (AIPU_STATUS_SUCCESS != ret)
+        {
+            return ret;
+        }
+        ret = advance(stage_status, status);
+        if ((AIPU_STATUS_SUCCESS != ret) || (AIPU_JOB_STATUS_NO_STATUS == stage_status))
+        {
+            return ret;
+        }
+    }
+
+    return advance(AIPU_JOB_STATUS_NO_STATUS, status);
+}
+
+aipu_status_t aipudrv::SuperJob::get_status_blocking(aipu_job_status_t* status, int32_t time_out)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    aipu_job_status_t stage_status = AIPU_JOB_STATUS_NO_STATUS;
+    struct timespec start, now;
+    int32_t left = time_out;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    while (m_status == AIPU_JOB_STATUS_SCHED)
+    {
+        ret = m_stages[m_stage]->get_status_blocking(&stage_status, left);
+        if (AIPU_STATUS_SUCCESS != ret)
+        {
+            return ret;
+        }
+        ret = advance(stage_status, status);
+        if ((AIPU_STATUS_SUCCESS != ret) || (AIPU_JOB_STATUS_NO_STATUS == stage_status))
+        {
+            return ret;
+        }
+
+        /* time_out (in ms) covers the whole chain; negative values wait forever */
+        if (time_out >= 0)
+        {
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            left = time_out - (int32_t)((now.tv_sec - start.tv_sec) * 1000 +
+                (now.tv_nsec - start.tv_nsec) / 1000000);
+            if (left <= 0)
+            {
+                left = 0;
+            }
+        }
+    }
+
+    return advance(AIPU_JOB_STATUS_NO_STATUS, status);
+}
+
+aipu_status_t aipudrv::SuperJob::config_simulation(uint64_t types, const aipu_job_config_simulation_t* config)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+
+    for (uint32_t i = 0; i < m_stages.size(); i++)
+    {
+        ret = m_stages[i]->config_simulation(types, config);
+        if (AIPU_STATUS_SUCCESS != ret)
+        {
+            break;
+        }
+    }
+    return ret;
+}
+
+aipu_status_t aipudrv::SuperJob::get_super_job_stat(aipu_super_job_stat_t* stat)
+{
+    if (nullptr == stat)
+    {
+        return AIPU_STATUS_ERROR_NULL_PTR;
+    }
+
+    stat->stage_cnt = (uint32_t)m_stages.size();
+    stat->copied_cnt = (uint32_t)m_copies.size();
+    stat->bound_cnt = (uint32_t)get_super_graph().get_bindings().size() - stat->copied_cnt;
+    stat->chained_cnt = m_chained;
+    return AIPU_STATUS_SUCCESS;
+}
+
+aipu_status_t aipudrv::SuperJob::destroy()
+{
+    return free_stage_jobs();
+}
@@ -0,0 +1,85 @@
+/**********************************************************************************
+ * This file is CONFIDENTIAL and any use by you is subject to the terms of the
+ * agreement between you and Arm China or the terms of the agreement between you
+ * and the party authorised by Arm China to disclose this file to you.
+ * The confidential and proprietary information contained in this file
+ * may only be used by a person authorised under and to the extent permitted
+ * by a subsisting licensing agreement from Arm China.
+ *
+ *        (C) Copyright 2020 Arm Technology (China) Co. Ltd.
+ *                    All rights reserved.
+ *
+ * This entire notice must be reproduced on all copies of this file and copies of
+ * this file may only be made by a person if such person is permitted to do so
+ * under the terms of a subsisting license agreement from Arm China.
+ *
+ *********************************************************************************/
+
+/**
+ * @file  super_job.h
+ * @brief AIPU User Mode Driver (UMD) super job class header
+ */
+
+#ifndef _SUPER_JOB_H_
+#define _SUPER_JOB_H_
+
+#include <vector>
+#include "standard_api.h"
+#include "super_graph.h"
+#include "job_base.h"
+#include "type.h"
+
+namespace aipudrv
+{
+/**
+ * @brief a job of a super graph: one job per member graph, run one after another; member jobs
+ *        are chained on the device behind the previous one when they are scheduled, and the
+ *        rest (those fed by a copy, or all of them if the device cannot chain jobs) are
+ *        scheduled when the previous one is found done by a status query
+ */
+class SuperJob: public JobBase
+{
+private:
+    std::vector<JobBase*> m_stages;
+    std::vector<JOB_ID> m_stage_ids;
+    /* the member job whose status is waited for, and the last one scheduled */
+    uint32_t m_stage = 0;
+    uint32_t m_scheduled = 0;
+    uint32_t m_chained = 0;
+    bool m_failed = false;
+    /* bindings which cannot be read in place: copied before their consumer is scheduled */
+    std::vector<aipu_tensor_binding_t> m_copies;
+
+private:
+    const SuperGraph& get_super_graph()
+    {
+        return static_cast<const SuperGraph&>(m_graph);
+    }
+    aipu_status_t free_stage_jobs();
+    aipu_status_t copy_inputs(uint32_t stage);
+    bool is_copied(uint32_t stage);
+    aipu_status_t chain_stages();
+    aipu_status_t advance(aipu_job_status_t stage_status, aipu_job_status_t* status);
+
+public:
+    virtual aipu_status_t init(const aipu_global_config_simulation_t* cfg);
+    virtual aipu_status_t schedule();
+    virtual aipu_status_t destroy();
+    virtual aipu_status_t get_status(aipu_job_status_t* status);
+    virtual aipu_status_t get_status_blocking(aipu_job_status_t* status, int32_t time_out);
+    virtual aipu_status_t config_simulation(uint64_t types, const aipu_job_config_simulation_t* config);
+    virtual aipu_status_t bind_core(uint32_t core_id)
+    {
+        return AIPU_STATUS_ERROR_OP_NOT_SUPPORTED;
+    }
+    virtual aipu_status_t get_super_job_stat(aipu_super_job_stat_t* stat);
+
+public:
+    SuperJob(const GraphBase& graph, DeviceBase* dev);
+    virtual ~SuperJob();
+    SuperJob(const SuperJob& job) = delete;
+    SuperJob& operator=(const SuperJob& job) = delete;
+};
+}
+
+#endif /* _SUPER_JOB_H_ */
@@ -40,19 +40,39 @@ inline DEV_PA_32 get_low_32(DEV_PA_64 pa)
 typedef uint64_t GRAPH_ID;
 typedef uint64_t JOB_ID;
 
-inline GRAPH_ID job_id2graph_id(JOB_ID id)
+/**
+ * graph ID: graph handle in high 32 bits and 0 in low 32 bits;
+ * job ID: graph handle in high 32 bits and job handle in low 32 bits;
+ * handles are never 0.
+ */
+inline GRAPH_ID create_graph_id(uint32_t graph_handle)
+{
+    return (GRAPH_ID)graph_handle << 32;
+}
+
+inline uint32_t get_graph_handle(GRAPH_ID id)
 {
     return id >> 32;
 }
 
-inline JOB_ID create_full_job_id(GRAPH_ID g, JOB_ID id)
+inline uint32_t get_job_handle(JOB_ID id)
+{
+    return id & 0xFFFFFFFF;
+}
+
+inline GRAPH_ID job_id2graph_id(JOB_ID id)
+{
+    return id & 0xFFFFFFFF00000000UL;
+}
+
+inline JOB_ID create_full_job_id(GRAPH_ID g, uint32_t job_handle)
 {
-    return (g << 32) + id;
+    return g | job_handle;
 }
 
 inline GRAPH_ID get_graph_id(uint64_t id)
 {
-    return (id & 0xFFFFFFFF) ? (id >> 32) : id;
+    return job_id2graph_id(id);
 }
 
 }
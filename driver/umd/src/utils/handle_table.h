@@ -0,0 +1,361 @@
+/**********************************************************************************
+ * This file is CONFIDENTIAL and any use by you is subject to the terms of the
+ * agreement between you and Arm China or the terms of the agreement between you
+ * and the party authorised by Arm China to disclose this file to you.
+ * The confidential and proprietary information contained in this file
+ * may only be used by a person authorised under and to the extent permitted
+ * by a subsisting licensing agreement from Arm China.
+ *
+ *        (C) Copyright 2020 Arm Technology (China) Co. Ltd.
+ *                    All rights reserved.
+ *
+ * This entire notice must be reproduced on all copies of this file and copies of
+ * this file may only be made by a person if such person is permitted to do so
+ * under the terms of a subsisting license agreement from Arm China.
+ *
+ *********************************************************************************/
+
+/**
+ * @file  handle_table.h
+ * @brief UMD internal generation-indexed handle table header
+ */
+
+#ifndef _HANDLE_TABLE_H_
+#define _HANDLE_TABLE_H_
+
+#include <vector>
+#include <atomic>
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+
+namespace aipudrv
+{
+/**
+ * @brief Slab of object pointers addressed by 32-bit handles
+ *
+ * A handle is (generation << INDEX_BITS | slot index). The generation of a slot is
+ * bumped whenever the slot is freed, so a stale handle never resolves to the object
+ * which reuses its slot. Slots are kept in chunks which are never freed before the
+ * table itself, so that get() resolves a handle without taking any lock; alloc/set/
+ * remove are serialized by a mutex. Generation 0 is never used, so 0 is never a
+ * valid handle.
+ *
+ * get() alone does not keep the object alive: it is for callers which own the object.
+ * Other threads resolve a handle by acquire(), which counts a reader in the slot until
+ * release(). remove() unpublishes the handle and then waits for the readers of the slot
+ * to finish before returning, so the caller may free the object it got back. A thread
+ * must release its own reference before it removes the same handle.
+ *
+ * Freed slots are queued in a FIFO free list: alloc/remove are O(1), and a slot is
+ * reused only after all slots freed before it, which keeps stale handles detectable
+ * for as long as possible under high create/destroy churn.
+ *
+ * The generation has (32 - INDEX_BITS) bits and wraps (skipping 0): a stale handle is
+ * accepted again once its slot has been reused GEN_MASK times, i.e. after at least
+ * GEN_MASK x (number of free slots) removes in the table. Handles held that long
+ * after their object is destroyed are not detected.
+ */
+template <typename T, uint32_t INDEX_BITS>
+class HandleTable
+{
+private:
+    static const uint32_t CHUNK_BITS = 8;
+    static const uint32_t CHUNK_SIZE = 1U << CHUNK_BITS;
+    static const uint32_t CAPACITY = 1U << INDEX_BITS;
+    static const uint32_t CHUNK_CNT = CAPACITY >> CHUNK_BITS;
+    static const uint32_t INDEX_MASK = CAPACITY - 1;
+    static const uint32_t GEN_MASK = 0xFFFFFFFFU >> INDEX_BITS;
+    static const uint32_t INVALID_INDEX = CAPACITY;
+    static_assert((INDEX_BITS >= CHUNK_BITS) && (INDEX_BITS < 32), "invalid handle index bits");
+
+    struct Slot
+    {
+        /* generation of the live handle; 0 if the slot is free */
+        std::atomic<uint32_t> gen;
+        std::atomic<T*> obj;
+        /* threads between acquire() and release() */
+        std::atomic<uint32_t> readers;
+        /* below are only accessed with m_lock held */
+        uint32_t next_gen;
+        uint32_t next_free;
+        bool used;
+    };
+
+private:
+    std::atomic<Slot*> m_chunks[CHUNK_CNT];
+    uint32_t m_slot_cnt = 0;
+    uint32_t m_used_cnt = 0;
+    uint32_t m_free_head = INVALID_INDEX;
+    uint32_t m_free_tail = INVALID_INDEX;
+    pthread_mutex_t m_lock;
+
+private:
+    Slot* get_slot(uint32_t index) const
+    {
+        Slot* chunk = m_chunks[index >> CHUNK_BITS].load(std::memory_order_acquire);
+        return (chunk == nullptr) ? nullptr : &chunk[index & (CHUNK_SIZE - 1)];
+    }
+    Slot* get_live_slot(uint32_t handle) const
+    {
+        Slot* slot = nullptr;
+        uint32_t gen = handle >> INDEX_BITS;
+
+        if (gen == 0)
+        {
+            return nullptr;
+        }
+        slot = get_slot(handle & INDEX_MASK);
+        if ((slot == nullptr) || (slot->gen.load(std::memory_order_acquire) != gen))
+        {
+            return nullptr;
+        }
+        return slot;
+    }
+    Slot* grow(uint32_t* out_index)
+    {
+        uint32_t index = m_slot_cnt;
+        Slot* chunk = nullptr;
+
+        if (index == CAPACITY)
+        {
+            return nullptr;
+        }
+        if ((index & (CHUNK_SIZE - 1)) == 0)
+        {
+            chunk = new Slot[CHUNK_SIZE];
+            for (uint32_t i = 0; i < CHUNK_SIZE; i++)
+            {
+                chunk[i].gen.store(0, std::memory_order_relaxed);
+                chunk[i].obj.store(nullptr, std::memory_order_relaxed);
+                chunk[i].readers.store(0, std::memory_order_relaxed);
+                chunk[i].next_gen = 1;
+                chunk[i].next_free = INVALID_INDEX;
+                chunk[i].used = false;
+            }
+            m_chunks[index >> CHUNK_BITS].store(chunk, std::memory_order_release);
+        }
+        m_slot_cnt++;
+        *out_index = index;
+        return get_slot(index);
+    }
+
+public:
+    /**
+     * @brief allocate a handle for obj (nullptr reserves a handle to be set later)
+     *
+     * @retval 0 if the table is full
+     */
+    uint32_t alloc(T* obj)
+    {
+        Slot* slot = nullptr;
+        uint32_t index = 0;
+        uint32_t handle = 0;
+
+        pthread_mutex_lock(&m_lock);
+        if (m_free_head != INVALID_INDEX)
+        {
+            index = m_free_head;
+            slot = get_slot(index);
+            m_free_head = slot->next_free;
+            if (m_free_head == INVALID_INDEX)
+            {
+                m_free_tail = INVALID_INDEX;
+            }
+            slot->next_free = INVALID_INDEX;
+        }
+        else
+        {
+            slot = grow(&index);
+            if (slot == nullptr)
+            {
+                goto unlock;
+            }
+        }
+        slot->used = true;
+        slot->obj.store(obj, std::memory_order_relaxed);
+        /* publish the generation after the object so that readers never see a stale one */
+        slot->gen.store(slot->next_gen, std::memory_order_release);
+        handle = (slot->next_gen << INDEX_BITS) | index;
+        m_used_cnt++;
+
+    unlock:
+        pthread_mutex_unlock(&m_lock);
+        return handle;
+    }
+    bool set(uint32_t handle, T* obj)
+    {
+        Slot* slot = nullptr;
+
+        pthread_mutex_lock(&m_lock);
+        slot = get_live_slot(handle);
+        if (slot != nullptr)
+        {
+            slot->obj.store(obj, std::memory_order_release);
+        }
+        pthread_mutex_unlock(&m_lock);
+        return slot != nullptr;
+    }
+    /**
+     * @brief resolve a handle without locking
+     *
+     * @retval nullptr if the handle is stale/invalid or only reserved
+     */
+    T* get(uint32_t handle) const
+    {
+        Slot* slot = get_live_slot(handle);
+        T* obj = nullptr;
+
+        if (slot == nullptr)
+        {
+            return nullptr;
+        }
+        obj = slot->obj.load(std::memory_order_acquire);
+
+        /* a concurrent remove invalidates the generation before clearing the object */
+        if (slot->gen.load(std::memory_order_acquire) != (handle >> INDEX_BITS))
+        {
+            return nullptr;
+        }
+        return obj;
+    }
+    /**
+     * @brief resolve a handle and keep the object alive until release()
+     *
+     * @retval nullptr if the handle is stale/invalid or only reserved; nothing to release
+     */
+    T* acquire(uint32_t handle)
+    {
+        Slot* slot = get_live_slot(handle);
+        T* obj = nullptr;
+
+        if (slot == nullptr)
+        {
+            return nullptr;
+        }
+
+        /**
+         * seq_cst pairs with remove(): either the generation is seen invalidated here, or
+         * this reader is seen by remove() and waited for
+         */
+        slot->readers.fetch_add(1);
+        obj = slot->obj.load();
+        if ((slot->gen.load() != (handle >> INDEX_BITS)) || (obj == nullptr))
+        {
+            slot->readers.fetch_sub(1, std::memory_order_release);
+            return nullptr;
+        }
+        return obj;
+    }
+    void release(uint32_t handle) const
+    {
+        Slot* slot = get_slot(handle & INDEX_MASK);
+
+        if (slot != nullptr)
+        {
+            slot->readers.fetch_sub(1, std::memory_order_release);
+        }
+    }
+    bool remove(uint32_t handle, T** obj = nullptr)
+    {
+        Slot* slot = nullptr;
+        uint32_t index = handle & INDEX_MASK;
+
+        pthread_mutex_lock(&m_lock);
+        slot = get_live_slot(handle);
+        if (slot != nullptr)
+        {
+            if (obj != nullptr)
+            {
+                *obj = slot->obj.load(std::memory_order_relaxed);
+            }
+            slot->gen.store(0);
+            slot->obj.store(nullptr, std::memory_order_release);
+        }
+        pthread_mutex_unlock(&m_lock);
+        if (slot == nullptr)
+        {
+            return false;
+        }
+
+        /* readers which resolved the handle before it was unpublished still use the object */
+        while (slot->readers.load() != 0)
+        {
+            sched_yield();
+        }
+
+        pthread_mutex_lock(&m_lock);
+        slot->next_gen = (slot->next_gen + 1) & GEN_MASK;
+        if (slot->next_gen == 0)
+        {
+            slot->next_gen = 1;
+        }
+        slot->used = false;
+        m_used_cnt--;
+
+        /* queue at tail: the least recently freed slot is reused first */
+        if (m_free_tail == INVALID_INDEX)
+        {
+            m_free_head = index;
+        }
+        else
+        {
+            get_slot(m_free_tail)->next_free = index;
+        }
+        m_free_tail = index;
+        pthread_mutex_unlock(&m_lock);
+        return true;
+    }
+    /**
+     * @brief snapshot the handles in use
+     */
+    void get_handles(std::vector<uint32_t>& handles)
+    {
+        Slot* slot = nullptr;
+
+        handles.clear();
+        pthread_mutex_lock(&m_lock);
+        for (uint32_t index = 0; index < m_slot_cnt; index++)
+        {
+            slot = get_slot(index);
+
+            /* a slot being removed is still used, with its generation already invalidated */
+            if (slot->used && (slot->gen.load(std::memory_order_relaxed) != 0))
+            {
+                handles.push_back((slot->gen.load(std::memory_order_relaxed) << INDEX_BITS) | index);
+            }
+        }
+        pthread_mutex_unlock(&m_lock);
+    }
+    uint32_t size()
+    {
+        uint32_t cnt = 0;
+        pthread_mutex_lock(&m_lock);
+        cnt = m_used_cnt;
+        pthread_mutex_unlock(&m_lock);
+        return cnt;
+    }
+
+public:
+    HandleTable()
+    {
+        for (uint32_t i = 0; i < CHUNK_CNT; i++)
+        {
+            m_chunks[i].store(nullptr, std::memory_order_relaxed);
+        }
+        pthread_mutex_init(&m_lock, NULL);
+    }
+    ~HandleTable()
+    {
+        for (uint32_t i = 0; i < CHUNK_CNT; i++)
+        {
+            delete[] m_chunks[i].load(std::memory_order_relaxed);
+        }
+        pthread_mutex_destroy(&m_lock);
+    }
+    HandleTable(const HandleTable& table) = delete;
+    HandleTable& operator=(const HandleTable& table) = delete;
+};
+}
+
+#endif /* _HANDLE_TABLE_H_ */
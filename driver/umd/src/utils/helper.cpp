@@ -25,6 +25,7 @@
 #include <unistd.h>
 #include <fcntl.h>
 #include <errno.h>
+#include <time.h>
 #include <cstring>
 #include "standard_api.h"
 #include "log.h"
@@ -197,4 +198,30 @@ bool umd_is_valid_ptr(const void* lower_bound, const void* upper_bound,
 {
     return ((unsigned long)ptr >= (unsigned long)lower_bound) &&
             (((unsigned long)ptr + size) < (unsigned long)upper_bound);
-}
\ No newline at end of file
+}
+uint64_t umd_hash64_helper(const void* data, uint64_t size)
+{
+    const unsigned char* p = (const unsigned char*)data;
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    uint64_t word = 0;
+
+    /* FNV-1a over 64-bit words, then the tail bytes */
+    for (; size >= sizeof(word); size -= sizeof(word), p += sizeof(word))
+    {
+        memcpy(&word, p, sizeof(word));
+        hash = (hash ^ word) * 0x100000001b3ULL;
+        hash ^= hash >> 29;
+    }
+    for (; size > 0; size--, p++)
+    {
+        hash = (hash ^ *p) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+uint64_t umd_get_time_ns_helper()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
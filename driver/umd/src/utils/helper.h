@@ -94,5 +94,19 @@ void umd_draw_line_helper(std::ofstream& file, char ch, uint32_t num);
  */
 bool umd_is_valid_ptr(const void* lower_bound, const void* upper_bound,
         const void* ptr, uint32_t size = 0);
+/**
+ * @brief This function is used to compute a 64-bit hash of a memory region
+ *        (content identity, not cryptographic)
+ *
+ * @param[in] data Start of the region
+ * @param[in] size Region size in bytes
+ *
+ */
+uint64_t umd_hash64_helper(const void* data, uint64_t size);
+/**
+ * @brief This function is used to get the monotonic clock time in nanoseconds
+ *
+ */
+uint64_t umd_get_time_ns_helper();
 
 #endif /* _HELPER_H_ */
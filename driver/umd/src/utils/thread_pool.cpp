@@ -0,0 +1,176 @@
+/**********************************************************************************
+ * This file is CONFIDENTIAL and any use by you is subject to the terms of the
+ * agreement between you and Arm China or the terms of the agreement between you
+ * and the party authorised by Arm China to disclose this file to you.
+ * The confidential and proprietary information contained in this file
+ * may only be used by a person authorised under and to the extent permitted
+ * by a subsisting licensing agreement from Arm China.
+ *
+ *        (C) Copyright 2020 Arm Technology (China) Co. Ltd.
+ *                    All rights reserved.
+ *
+ * This entire notice must be reproduced on all copies of this file and copies of
+ * this file may only be made by a person if such person is permitted to do so
+ * under the terms of a subsisting license agreement from Arm China.
+ *
+ *********************************************************************************/
+
+
+/**
+ * @file  thread_pool.cpp
+ * @brief UMD internal worker thread pool implementation
+ */
+
+#include "thread_pool.h"
+
+aipudrv::ThreadPool::ThreadPool()
+{
+    pthread_mutex_init(&m_lock, NULL);
+    pthread_cond_init(&m_task_cond, NULL);
+    pthread_cond_init(&m_done_cond, NULL);
+}
+
+aipudrv::ThreadPool::~ThreadPool()
+{
+    deinit();
+    pthread_cond_destroy(&m_done_cond);
+    pthread_cond_destroy(&m_task_cond);
+    pthread_mutex_destroy(&m_lock);
+}
+
+void aipudrv::ThreadPool::run_locked(PoolEntry& entry)
+{
+    /* called with m_lock held; the task itself runs unlocked */
+    pthread_mutex_unlock(&m_lock);
+    entry.task();
+    pthread_mutex_lock(&m_lock);
+    if (entry.group != nullptr)
+    {
+        entry.group->pending--;
+    }
+    pthread_cond_broadcast(&m_done_cond);
+}
+
+void* aipudrv::ThreadPool::worker_loop(void* arg)
+{
+    ThreadPool* pool = (ThreadPool*)arg;
+
+    pthread_mutex_lock(&pool->m_lock);
+    while (true)
+    {
+        while (pool->m_tasks.empty() && !pool->m_exit)
+        {
+            pthread_cond_wait(&pool->m_task_cond, &pool->m_lock);
+        }
+
+        if (pool->m_tasks.empty())
+        {
+            break;
+        }
+
+        PoolEntry entry = pool->m_tasks.front();
+        pool->m_tasks.pop_front();
+        pool->run_locked(entry);
+    }
+    pthread_mutex_unlock(&pool->m_lock);
+
+    return nullptr;
+}
+
+aipu_status_t aipudrv::ThreadPool::init(uint32_t thread_cnt)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+
+    deinit();
+
+    pthread_mutex_lock(&m_lock);
+    m_exit = false;
+    pthread_mutex_unlock(&m_lock);
+
+    for (uint32_t i = 0; i < thread_cnt; i++)
+    {
+        pthread_t tid;
+        if (pthread_create(&tid, NULL, worker_loop, this) != 0)
+        {
+            deinit();
+            ret = AIPU_STATUS_ERROR_INVALID_CONFIG;
+            break;
+        }
+        m_workers.push_back(tid);
+    }
+
+    return ret;
+}
+
+void aipudrv::ThreadPool::deinit()
+{
+    /* pending tasks are drained by the workers before they exit */
+    pthread_mutex_lock(&m_lock);
+    m_exit = true;
+    pthread_cond_broadcast(&m_task_cond);
+    pthread_mutex_unlock(&m_lock);
+
+    for (uint32_t i = 0; i < m_workers.size(); i++)
+    {
+        pthread_join(m_workers[i], NULL);
+    }
+    m_workers.clear();
+}
+
+void aipudrv::ThreadPool::submit(TaskGroup* group, PoolTask task)
+{
+    PoolEntry entry = {task, group};
+
+    pthread_mutex_lock(&m_lock);
+    if (group != nullptr)
+    {
+        group->pending++;
+    }
+
+    /* no worker: run in the caller's context */
+    if (m_workers.empty())
+    {
+        run_locked(entry);
+    }
+    else
+    {
+        m_tasks.push_back(entry);
+        pthread_cond_signal(&m_task_cond);
+    }
+    pthread_mutex_unlock(&m_lock);
+}
+
+void aipudrv::ThreadPool::wait(TaskGroup* group)
+{
+    if (nullptr == group)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&m_lock);
+    while (group->pending != 0)
+    {
+        /**
+         * help with the queued tasks of this group instead of sleeping so that a task
+         * waiting for its own sub-tasks never starves the pool; tasks of other callers
+         * are left to the workers, as the caller may hold locks they depend on
+         */
+        auto iter = m_tasks.begin();
+        while ((iter != m_tasks.end()) && (iter->group != group))
+        {
+            iter++;
+        }
+
+        if (iter != m_tasks.end())
+        {
+            PoolEntry entry = *iter;
+            m_tasks.erase(iter);
+            run_locked(entry);
+        }
+        else
+        {
+            pthread_cond_wait(&m_done_cond, &m_lock);
+        }
+    }
+    pthread_mutex_unlock(&m_lock);
+}
@@ -0,0 +1,85 @@
+/**********************************************************************************
+ * This file is CONFIDENTIAL and any use by you is subject to the terms of the
+ * agreement between you and Arm China or the terms of the agreement between you
+ * and the party authorised by Arm China to disclose this file to you.
+ * The confidential and proprietary information contained in this file
+ * may only be used by a person authorised under and to the extent permitted
+ * by a subsisting licensing agreement from Arm China.
+ *
+ *        (C) Copyright 2020 Arm Technology (China) Co. Ltd.
+ *                    All rights reserved.
+ *
+ * This entire notice must be reproduced on all copies of this file and copies of
+ * this file may only be made by a person if such person is permitted to do so
+ * under the terms of a subsisting license agreement from Arm China.
+ *
+ *********************************************************************************/
+
+
+/**
+ * @file  thread_pool.h
+ * @brief UMD internal worker thread pool header
+ */
+
+#ifndef _THREAD_POOL_H_
+#define _THREAD_POOL_H_
+
+#include <deque>
+#include <vector>
+#include <functional>
+#include <pthread.h>
+#include "standard_api.h"
+
+namespace aipudrv
+{
+typedef std::function<void()> PoolTask;
+
+/**
+ * @brief tasks submitted with the same group can be waited for together
+ */
+struct TaskGroup
+{
+    uint32_t pending = 0;
+};
+
+class ThreadPool
+{
+private:
+    struct PoolEntry
+    {
+        PoolTask task;
+        TaskGroup* group;
+    };
+
+private:
+    std::vector<pthread_t> m_workers;
+    std::deque<PoolEntry> m_tasks;
+    pthread_mutex_t m_lock;
+    pthread_cond_t  m_task_cond;
+    pthread_cond_t  m_done_cond;
+    bool m_exit = false;
+
+private:
+    static void* worker_loop(void* arg);
+    void run_locked(PoolEntry& entry);
+
+public:
+    /* (re)start/stop the workers: callers make sure no task is submitted or waited for meanwhile */
+    aipu_status_t init(uint32_t thread_cnt);
+    void deinit();
+    void submit(TaskGroup* group, PoolTask task);
+    void wait(TaskGroup* group);
+    uint32_t get_thread_count() const
+    {
+        return m_workers.size();
+    }
+
+public:
+    ThreadPool();
+    ~ThreadPool();
+    ThreadPool(const ThreadPool& pool) = delete;
+    ThreadPool& operator=(const ThreadPool& pool) = delete;
+};
+}
+
+#endif /* _THREAD_POOL_H_ */
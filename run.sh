@@ -23,6 +23,19 @@ test_run_help() {
     echo "-t, --test        test case to run (by default simulation test)"
     echo "                    - simulation"
     echo "                    - benchmark"
+    echo "                    - perf (streaming part measures z5 rings: -p sim with a z5 case)"
+    echo "                    - alloc"
+    echo "                    - replay"
+    echo "                    - multidev"
+    echo "                    - supergraph"
+    echo "                    - fence"
+    echo "                    - sched"
+    echo "                    - batch"
+    echo "                    - admit"
+    echo "                    - hibernate"
+    echo "                    - unload"
+    echo "                    - wstream"
+    echo "                    - swap"
     echo "-c, --case        benchmark case dir which contains [aipu.bin]"
     echo "-d, --deubg       run debug version UMD"
     echo "-l, --log_level   simulator log level"
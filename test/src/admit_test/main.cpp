@@ -0,0 +1,289 @@
+/**********************************************************************************
+ * This file is CONFIDENTIAL and any use by you is subject to the terms of the
+ * agreement between you and Arm China or the terms of the agreement between you
+ * and the party authorised by Arm China to disclose this file to you.
+ * The confidential and proprietary information contained in this file
+ * may only be used by a person authorised under and to the extent permitted
+ * by a subsisting licensing agreement from Arm China.
+ *
+ *        (C) Copyright 2020 Arm Technology (China) Co. Ltd.
+ *                    All rights reserved.
+ *
+ * This entire notice must be reproduced on all copies of this file and copies of
+ * this file may only be made by a person if such person is permitted to do so
+ * under the terms of a subsisting license agreement from Arm China.
+ *
+ *********************************************************************************/
+
+/**
+ * @file  main.cpp
+ * @brief AIPU UMD test application: job admission against a device memory budget on mock NPU
+ *
+ * @note jobs are created until the budget is used up, as many as predicted by the graph memory
+ *       info; a further job should be refused at once, time out when waited for, and be
+ *       admitted once another thread cleans a job. The last jobs fitting into the budget
+ *       should then be admitted at once as well when threads create them together
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <vector>
+#include "standard_api.h"
+#include "common/cmd_line_parsing.h"
+#include "common/helper.h"
+
+using namespace std;
+
+#define ADMIT_TEST_MEM_LIMIT      (8 * 1024 * 1024)
+#define ADMIT_TEST_MAX_JOB_CNT    4096
+#define ADMIT_TEST_TIME_OUT_MS    20
+#define ADMIT_TEST_CLEAN_DELAY_US 30000
+#define ADMIT_TEST_THREAD_CNT     8
+#define ADMIT_TEST_ROUND_CNT      100
+
+typedef struct cleaner {
+    const aipu_ctx_handle_t* ctx;
+    uint64_t job;
+    aipu_status_t ret;
+} cleaner_t;
+
+typedef struct creator {
+    const aipu_ctx_handle_t* ctx;
+    uint64_t graph;
+    pthread_barrier_t* barrier;
+    uint64_t job;
+    aipu_status_t ret;
+} creator_t;
+
+static void* clean_later(void* arg)
+{
+    cleaner_t* cleaner = (cleaner_t*)arg;
+
+    usleep(ADMIT_TEST_CLEAN_DELAY_US);
+    cleaner->ret = aipu_clean_job(cleaner->ctx, cleaner->job);
+    return nullptr;
+}
+
+static void* create_together(void* arg)
+{
+    creator_t* creator = (creator_t*)arg;
+
+    pthread_barrier_wait(creator->barrier);
+    creator->ret = aipu_create_job(creator->ctx, creator->graph, &creator->job);
+    return nullptr;
+}
+
+int main(int argc, char* argv[])
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    aipu_ctx_handle_t* ctx = nullptr;
+    const char* msg = nullptr;
+    aipu_global_config_admission_t admit_config;
+    aipu_graph_memory_info_t info;
+    uint64_t predicted = 0;
+    uint64_t graph = 0;
+    uint64_t job = 0;
+    vector<uint64_t> jobs;
+    pthread_t thread;
+    cleaner_t cleaner;
+    pthread_t threads[ADMIT_TEST_THREAD_CNT];
+    creator_t creators[ADMIT_TEST_THREAD_CNT];
+    pthread_barrier_t barrier;
+    uint32_t refused = 0;
+    double start = 0, elapsed = 0;
+    cmd_opt_t opt;
+    int pass = 0;
+
+    if (init_test_bench(argc, argv, &opt, "admit_test"))
+    {
+        fprintf(stderr, "[TEST ERROR] invalid command line options/args\n");
+        pass = -1;
+        goto finish;
+    }
+
+    ret = aipu_init_context(&ctx);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_init_context: %s\n", msg);
+        goto finish;
+    }
+
+    admit_config.mem_limit = ADMIT_TEST_MEM_LIMIT;
+    ret = aipu_config_global(ctx, AIPU_GLOBAL_CONFIG_TYPE_ADMISSION, &admit_config);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_config_global: %s\n", msg);
+        goto deinit_ctx;
+    }
+
+    ret = aipu_load_graph(ctx, opt.bin_file_name, &graph);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_load_graph: %s (%s)\n", msg, opt.bin_file_name);
+        goto deinit_ctx;
+    }
+
+    ret = aipu_get_graph_memory_info(ctx, graph, &info);
+    if ((ret != AIPU_STATUS_SUCCESS) || (0 == info.job_size))
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_get_graph_memory_info: %s\n", msg);
+        pass = -1;
+        goto clean_jobs;
+    }
+    fprintf(stdout, "[TEST INFO] graph: shared %lu bytes (text %lu, weight %lu)\n",
+        (unsigned long)info.shared_size, (unsigned long)info.text_size, (unsigned long)info.weight_size);
+    fprintf(stdout, "[TEST INFO] job: %lu bytes (rodata %lu, dcr %lu, tcb %lu, reuse %lu, stack %lu, "
+        "data %lu), align slack %lu\n", (unsigned long)info.job_size, (unsigned long)info.rodata_size,
+        (unsigned long)info.dcr_size, (unsigned long)info.tcb_size, (unsigned long)info.reuse_size,
+        (unsigned long)info.stack_size, (unsigned long)info.data_size, (unsigned long)info.align_slack);
+    predicted = (info.dev_budget - info.dev_used) / info.job_size;
+
+    /* use up the budget */
+    while (jobs.size() < ADMIT_TEST_MAX_JOB_CNT)
+    {
+        ret = aipu_create_job(ctx, graph, &job);
+        if (ret != AIPU_STATUS_SUCCESS)
+        {
+            break;
+        }
+        jobs.push_back(job);
+    }
+    if ((ret != AIPU_STATUS_ERROR_BUF_ALLOC_FAIL) || jobs.empty())
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] %u jobs created within %u bytes: %s\n",
+            (uint32_t)jobs.size(), ADMIT_TEST_MEM_LIMIT, msg);
+        ret = (AIPU_STATUS_SUCCESS == ret) ? AIPU_STATUS_ERROR_INVALID_SIZE : ret;
+        goto clean_jobs;
+    }
+    fprintf(stdout, "[TEST INFO] %u jobs admitted within %u bytes (%lu predicted)\n", (uint32_t)jobs.size(),
+        ADMIT_TEST_MEM_LIMIT, (unsigned long)predicted);
+    if (jobs.size() != predicted)
+    {
+        fprintf(stderr, "[TEST ERROR] jobs admitted differ from the prediction\n");
+        pass = -1;
+    }
+
+    /* a timed creation waits for the budget and then gives up */
+    start = get_time_ms_helper();
+    ret = aipu_create_job_timed(ctx, graph, &job, ADMIT_TEST_TIME_OUT_MS);
+    elapsed = get_time_ms_helper() - start;
+    fprintf(stdout, "[TEST INFO] timed creation: %s after %.3f ms\n",
+        (ret == AIPU_STATUS_SUCCESS) ? "admitted" : "refused", elapsed);
+    if ((ret != AIPU_STATUS_ERROR_BUF_ALLOC_FAIL) || (elapsed < ADMIT_TEST_TIME_OUT_MS))
+    {
+        fprintf(stderr, "[TEST ERROR] timed creation does not wait for its time out\n");
+        pass = -1;
+    }
+    if (AIPU_STATUS_SUCCESS == ret)
+    {
+        jobs.push_back(job);
+    }
+
+    /* a blocking creation is admitted once another thread cleans a job */
+    cleaner.ctx = ctx;
+    cleaner.job = jobs.back();
+    cleaner.ret = AIPU_STATUS_SUCCESS;
+    jobs.pop_back();
+    pthread_create(&thread, NULL, clean_later, &cleaner);
+    start = get_time_ms_helper();
+    ret = aipu_create_job_timed(ctx, graph, &job, -1);
+    elapsed = get_time_ms_helper() - start;
+    pthread_join(thread, NULL);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_create_job_timed: %s\n", msg);
+        goto clean_jobs;
+    }
+    jobs.push_back(job);
+    fprintf(stdout, "[TEST INFO] blocking creation: admitted after %.3f ms\n", elapsed);
+    if ((cleaner.ret != AIPU_STATUS_SUCCESS) || (elapsed * 1000 < ADMIT_TEST_CLEAN_DELAY_US / 2))
+    {
+        fprintf(stderr, "[TEST ERROR] blocking creation is not admitted by the job cleaned\n");
+        pass = -1;
+    }
+
+    /* the admitted job runs */
+    for (uint32_t i = 0; i < opt.inputs.size(); i++)
+    {
+        ret = aipu_load_tensor(ctx, job, i, opt.inputs[i]);
+        if (ret != AIPU_STATUS_SUCCESS)
+        {
+            aipu_get_error_message(ctx, ret, &msg);
+            fprintf(stderr, "[TEST ERROR] aipu_load_tensor: %s\n", msg);
+            goto clean_jobs;
+        }
+    }
+    ret = aipu_finish_job(ctx, job, -1);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_finish_job: %s\n", msg);
+        goto clean_jobs;
+    }
+
+    /* the last jobs fitting into the budget are created together, each without waiting */
+    pthread_barrier_init(&barrier, NULL, ADMIT_TEST_THREAD_CNT);
+    for (uint32_t round = 0; round < ADMIT_TEST_ROUND_CNT; round++)
+    {
+        while (jobs.size() > predicted - ADMIT_TEST_THREAD_CNT)
+        {
+            aipu_clean_job(ctx, jobs.back());
+            jobs.pop_back();
+        }
+        for (uint32_t i = 0; i < ADMIT_TEST_THREAD_CNT; i++)
+        {
+            creators[i].ctx = ctx;
+            creators[i].graph = graph;
+            creators[i].barrier = &barrier;
+            creators[i].ret = AIPU_STATUS_SUCCESS;
+            pthread_create(&threads[i], NULL, create_together, &creators[i]);
+        }
+        for (uint32_t i = 0; i < ADMIT_TEST_THREAD_CNT; i++)
+        {
+            pthread_join(threads[i], NULL);
+            if (creators[i].ret == AIPU_STATUS_SUCCESS)
+            {
+                jobs.push_back(creators[i].job);
+            }
+            else
+            {
+                refused++;
+            }
+        }
+    }
+    pthread_barrier_destroy(&barrier);
+    fprintf(stdout, "[TEST INFO] %u rounds of %u jobs created together: %u refused\n",
+        ADMIT_TEST_ROUND_CNT, ADMIT_TEST_THREAD_CNT, refused);
+    if (refused != 0)
+    {
+        fprintf(stderr, "[TEST ERROR] jobs fitting into the budget are refused when created together\n");
+        pass = -1;
+    }
+
+clean_jobs:
+    for (uint32_t i = 0; i < jobs.size(); i++)
+    {
+        aipu_clean_job(ctx, jobs[i]);
+    }
+    aipu_unload_graph(ctx, graph);
+
+deinit_ctx:
+    aipu_deinit_context(ctx);
+
+finish:
+    if (AIPU_STATUS_SUCCESS != ret)
+    {
+        pass = -1;
+    }
+    deinit_test_bench(&opt);
+    return pass;
+}
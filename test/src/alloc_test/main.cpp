@@ -0,0 +1,245 @@
+/**********************************************************************************
+ * This file is CONFIDENTIAL and any use by you is subject to the terms of the
+ * agreement between you and Arm China or the terms of the agreement between you
+ * and the party authorised by Arm China to disclose this file to you.
+ * The confidential and proprietary information contained in this file
+ * may only be used by a person authorised under and to the extent permitted
+ * by a subsisting licensing agreement from Arm China.
+ *
+ *        (C) Copyright 2020 Arm Technology (China) Co. Ltd.
+ *                    All rights reserved.
+ *
+ * This entire notice must be reproduced on all copies of this file and copies of
+ * this file may only be made by a person if such person is permitted to do so
+ * under the terms of a subsisting license agreement from Arm China.
+ *
+ *********************************************************************************/
+
+/**
+ * @file  main.cpp
+ * @brief AIPU UMD test application: steady-state inference allocation check
+ *
+ * @note malloc family is interposed in this executable so that every heap
+ *       allocation from UMD (including operator new) is counted while a
+ *       warmed-up job is re-run; any allocation fails the test
+ * @note a debug UMD (RTDEBUG=1) logs every memory operation to mem_info.log through
+ *       iostreams, so its allocations are only reported, not checked
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include "standard_api.h"
+#include "common/cmd_line_parsing.h"
+#include "common/helper.h"
+
+using namespace std;
+
+#define ALLOC_TEST_FRAME_CNT   1000
+
+#if ((defined RTDEBUG) && (RTDEBUG == 1))
+#define ALLOC_TEST_CHECK       0
+#else
+#define ALLOC_TEST_CHECK       1
+#endif
+
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t nmemb, size_t size);
+extern "C" void* __libc_realloc(void* ptr, size_t size);
+extern "C" void  __libc_free(void* ptr);
+
+static volatile bool g_counting = false;
+static volatile uint64_t g_alloc_cnt = 0;
+
+extern "C" void* malloc(size_t size)
+{
+    if (g_counting)
+    {
+        __atomic_add_fetch(&g_alloc_cnt, 1, __ATOMIC_RELAXED);
+    }
+    return __libc_malloc(size);
+}
+
+extern "C" void* calloc(size_t nmemb, size_t size)
+{
+    if (g_counting)
+    {
+        __atomic_add_fetch(&g_alloc_cnt, 1, __ATOMIC_RELAXED);
+    }
+    return __libc_calloc(nmemb, size);
+}
+
+extern "C" void* realloc(void* ptr, size_t size)
+{
+    if (g_counting)
+    {
+        __atomic_add_fetch(&g_alloc_cnt, 1, __ATOMIC_RELAXED);
+    }
+    return __libc_realloc(ptr, size);
+}
+
+extern "C" void free(void* ptr)
+{
+    __libc_free(ptr);
+}
+
+static aipu_status_t run_frame(const aipu_ctx_handle_t* ctx, uint64_t job_id,
+    const cmd_opt_t& opt, vector<aipu_tensor_desc_t>& output_desc, vector<char*>& output_data)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+
+    for (uint32_t i = 0; i < opt.inputs.size(); i++)
+    {
+        ret = aipu_load_tensor(ctx, job_id, i, opt.inputs[i]);
+        if (ret != AIPU_STATUS_SUCCESS)
+        {
+            goto finish;
+        }
+    }
+
+    ret = aipu_finish_job(ctx, job_id, -1);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        goto finish;
+    }
+
+    for (uint32_t i = 0; i < output_desc.size(); i++)
+    {
+        ret = aipu_get_tensor(ctx, job_id, AIPU_TENSOR_TYPE_OUTPUT, i, output_data[i]);
+        if (ret != AIPU_STATUS_SUCCESS)
+        {
+            goto finish;
+        }
+    }
+
+finish:
+    return ret;
+}
+
+int main(int argc, char* argv[])
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    aipu_ctx_handle_t* ctx = nullptr;
+    const char* msg = nullptr;
+    uint64_t graph_id = 0, job_id = 0;
+    uint32_t output_cnt = 0;
+    vector<aipu_tensor_desc_t> output_desc;
+    vector<char*> output_data;
+    uint64_t alloc_cnt = 0;
+    cmd_opt_t opt;
+    int pass = -1;
+
+    if (init_test_bench(argc, argv, &opt, "alloc_test"))
+    {
+        fprintf(stderr, "[TEST ERROR] invalid command line options/args\n");
+        goto finish;
+    }
+
+    ret = aipu_init_context(&ctx);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_init_context: %s\n", msg);
+        goto finish;
+    }
+
+    ret = aipu_load_graph(ctx, opt.bin_file_name, &graph_id);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_load_graph: %s (%s)\n", msg, opt.bin_file_name);
+        goto deinit_ctx;
+    }
+
+    ret = aipu_get_tensor_count(ctx, graph_id, AIPU_TENSOR_TYPE_OUTPUT, &output_cnt);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_get_tensor_count: %s\n", msg);
+        goto unload_graph;
+    }
+
+    for (uint32_t i = 0; i < output_cnt; i++)
+    {
+        aipu_tensor_desc_t desc;
+        ret = aipu_get_tensor_descriptor(ctx, graph_id, AIPU_TENSOR_TYPE_OUTPUT, i, &desc);
+        if (ret != AIPU_STATUS_SUCCESS)
+        {
+            aipu_get_error_message(ctx, ret, &msg);
+            fprintf(stderr, "[TEST ERROR] aipu_get_tensor_descriptor: %s\n", msg);
+            goto clean_outputs;
+        }
+        output_desc.push_back(desc);
+        output_data.push_back(new char[desc.size]);
+    }
+
+    ret = aipu_create_job(ctx, graph_id, &job_id);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_create_job: %s\n", msg);
+        goto clean_outputs;
+    }
+
+    /* warm-up frame: lazily created resources are allowed to be allocated here */
+    ret = run_frame(ctx, job_id, opt, output_desc, output_data);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] warm-up frame: %s\n", msg);
+        goto clean_job;
+    }
+
+    g_counting = true;
+    for (uint32_t frame = 0; frame < ALLOC_TEST_FRAME_CNT; frame++)
+    {
+        ret = run_frame(ctx, job_id, opt, output_desc, output_data);
+        if (ret != AIPU_STATUS_SUCCESS)
+        {
+            break;
+        }
+    }
+    g_counting = false;
+    alloc_cnt = g_alloc_cnt;
+
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] steady-state frame: %s\n", msg);
+        goto clean_job;
+    }
+
+    fprintf(stdout, "[TEST INFO] %u frames, %lu heap allocations\n",
+        ALLOC_TEST_FRAME_CNT, (unsigned long)alloc_cnt);
+    if ((alloc_cnt == 0) || !ALLOC_TEST_CHECK)
+    {
+        pass = 0;
+    }
+    else
+    {
+        fprintf(stderr, "[TEST ERROR] steady-state inference path allocated memory\n");
+    }
+
+clean_job:
+    aipu_clean_job(ctx, job_id);
+
+clean_outputs:
+    for (uint32_t i = 0; i < output_data.size(); i++)
+    {
+        delete[] output_data[i];
+    }
+
+unload_graph:
+    aipu_unload_graph(ctx, graph_id);
+
+deinit_ctx:
+    aipu_deinit_context(ctx);
+
+finish:
+    if (AIPU_STATUS_SUCCESS != ret)
+    {
+        pass = -1;
+    }
+    deinit_test_bench(&opt);
+    return pass;
+}
@@ -0,0 +1,362 @@
+/**********************************************************************************
+ * This file is CONFIDENTIAL and any use by you is subject to the terms of the
+ * agreement between you and Arm China or the terms of the agreement between you
+ * and the party authorised by Arm China to disclose this file to you.
+ * The confidential and proprietary information contained in this file
+ * may only be used by a person authorised under and to the extent permitted
+ * by a subsisting licensing agreement from Arm China.
+ *
+ *        (C) Copyright 2020 Arm Technology (China) Co. Ltd.
+ *                    All rights reserved.
+ *
+ * This entire notice must be reproduced on all copies of this file and copies of
+ * this file may only be made by a person if such person is permitted to do so
+ * under the terms of a subsisting license agreement from Arm China.
+ *
+ *********************************************************************************/
+
+/**
+ * @file  main.cpp
+ * @brief AIPU UMD test application: dynamic batching of single-frame requests on mock NPU
+ *
+ * @note frames are first run one by one through a single job, then submitted by several
+ *       requester threads through a batcher; every batched frame should get the same outputs
+ *       as the reference frame and the batcher should serve them faster; at last a batcher
+ *       is destroyed while requesters wait in it, which should serve them before it is freed
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <vector>
+#include "standard_api.h"
+#include "common/cmd_line_parsing.h"
+#include "common/helper.h"
+
+using namespace std;
+
+#define BATCH_TEST_CORE_CNT       4
+#define BATCH_TEST_SERVICE_US     500
+#define BATCH_TEST_THREAD_CNT     8
+#define BATCH_TEST_FRAME_CNT      8
+#define BATCH_TEST_MAX_DELAY_US   1000
+#define BATCH_TEST_PATTERN        0xA5
+#define BATCH_TEST_DESTROY_DELAY_US  200000
+
+typedef struct requester {
+    const aipu_ctx_handle_t* ctx;
+    uint64_t batcher;
+    const vector<const void*>* inputs;
+    const vector<char*>* ref;
+    const vector<aipu_tensor_desc_t>* descs;
+    uint32_t frame_cnt;
+    aipu_status_t ret;
+    uint32_t mismatch;
+} requester_t;
+
+static void* requester_loop(void* arg)
+{
+    requester_t* req = (requester_t*)arg;
+    vector<char*> outputs;
+
+    for (uint32_t i = 0; i < req->descs->size(); i++)
+    {
+        outputs.push_back(new char[(*req->descs)[i].size]);
+    }
+
+    for (uint32_t f = 0; f < req->frame_cnt; f++)
+    {
+        for (uint32_t i = 0; i < outputs.size(); i++)
+        {
+            memset(outputs[i], BATCH_TEST_PATTERN, (*req->descs)[i].size);
+        }
+
+        req->ret = aipu_batcher_infer(req->ctx, req->batcher, req->inputs->data(),
+            (void* const*)outputs.data());
+        if (req->ret != AIPU_STATUS_SUCCESS)
+        {
+            break;
+        }
+
+        for (uint32_t i = 0; i < outputs.size(); i++)
+        {
+            if (memcmp(outputs[i], (*req->ref)[i], (*req->descs)[i].size) != 0)
+            {
+                req->mismatch++;
+            }
+        }
+    }
+
+    for (uint32_t i = 0; i < outputs.size(); i++)
+    {
+        delete[] outputs[i];
+    }
+    return nullptr;
+}
+
+/**
+ * @brief run frames one by one through a single job; the outputs of the last one are the reference
+ */
+static aipu_status_t run_serial(const aipu_ctx_handle_t* ctx, uint64_t graph, const cmd_opt_t& opt,
+    const vector<char*>& ref, uint32_t frame_cnt, double* elapsed_ms)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    const char* msg = nullptr;
+    uint64_t job = 0;
+    double start = 0;
+
+    ret = aipu_create_job(ctx, graph, &job);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_create_job: %s\n", msg);
+        return ret;
+    }
+
+    start = get_time_ms_helper();
+    for (uint32_t f = 0; f < frame_cnt; f++)
+    {
+        for (uint32_t i = 0; i < opt.inputs.size(); i++)
+        {
+            ret = aipu_load_tensor(ctx, job, i, opt.inputs[i]);
+            if (ret != AIPU_STATUS_SUCCESS)
+            {
+                aipu_get_error_message(ctx, ret, &msg);
+                fprintf(stderr, "[TEST ERROR] aipu_load_tensor: %s\n", msg);
+                goto clean_job;
+            }
+        }
+
+        ret = aipu_finish_job(ctx, job, -1);
+        if (ret != AIPU_STATUS_SUCCESS)
+        {
+            aipu_get_error_message(ctx, ret, &msg);
+            fprintf(stderr, "[TEST ERROR] aipu_finish_job: %s\n", msg);
+            goto clean_job;
+        }
+
+        for (uint32_t i = 0; i < ref.size(); i++)
+        {
+            ret = aipu_get_tensor(ctx, job, AIPU_TENSOR_TYPE_OUTPUT, i, ref[i]);
+            if (ret != AIPU_STATUS_SUCCESS)
+            {
+                aipu_get_error_message(ctx, ret, &msg);
+                fprintf(stderr, "[TEST ERROR] aipu_get_tensor: %s\n", msg);
+                goto clean_job;
+            }
+        }
+    }
+    *elapsed_ms = get_time_ms_helper() - start;
+
+clean_job:
+    aipu_clean_job(ctx, job);
+    return ret;
+}
+
+int main(int argc, char* argv[])
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    aipu_ctx_handle_t* ctx = nullptr;
+    const char* msg = nullptr;
+    aipu_global_config_mock_device_t mock_config;
+    aipu_batcher_config_t batch_config;
+    aipu_batcher_stat_t stat;
+    uint64_t graph = 0;
+    uint64_t batcher = 0;
+    uint32_t in_cnt = 0, out_cnt = 0;
+    vector<aipu_tensor_desc_t> descs;
+    vector<char*> ref;
+    vector<const void*> inputs;
+    pthread_t threads[BATCH_TEST_THREAD_CNT];
+    requester_t reqs[BATCH_TEST_THREAD_CNT];
+    uint32_t frame_cnt = BATCH_TEST_THREAD_CNT * BATCH_TEST_FRAME_CNT;
+    double serial_ms = 0, batch_ms = 0, start = 0;
+    cmd_opt_t opt;
+    int pass = 0;
+
+    if (init_test_bench(argc, argv, &opt, "batch_test"))
+    {
+        fprintf(stderr, "[TEST ERROR] invalid command line options/args\n");
+        pass = -1;
+        goto finish;
+    }
+
+    ret = aipu_init_context(&ctx);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_init_context: %s\n", msg);
+        goto finish;
+    }
+
+    memset(&mock_config, 0, sizeof(mock_config));
+    mock_config.core_cnt = BATCH_TEST_CORE_CNT;
+    mock_config.service_time_us = BATCH_TEST_SERVICE_US;
+    ret = aipu_config_global(ctx, AIPU_GLOBAL_CONFIG_TYPE_MOCK_DEVICE, &mock_config);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_config_global: %s\n", msg);
+        goto deinit_ctx;
+    }
+
+    ret = aipu_load_graph(ctx, opt.bin_file_name, &graph);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_load_graph: %s (%s)\n", msg, opt.bin_file_name);
+        goto deinit_ctx;
+    }
+
+    aipu_get_tensor_count(ctx, graph, AIPU_TENSOR_TYPE_INPUT, &in_cnt);
+    aipu_get_tensor_count(ctx, graph, AIPU_TENSOR_TYPE_OUTPUT, &out_cnt);
+    if (in_cnt != opt.inputs.size())
+    {
+        fprintf(stderr, "[TEST ERROR] graph takes %u inputs but %u are provided\n",
+            in_cnt, (uint32_t)opt.inputs.size());
+        ret = AIPU_STATUS_ERROR_INVALID_SIZE;
+        goto unload_graph;
+    }
+    for (uint32_t i = 0; i < out_cnt; i++)
+    {
+        aipu_tensor_desc_t desc;
+
+        aipu_get_tensor_descriptor(ctx, graph, AIPU_TENSOR_TYPE_OUTPUT, i, &desc);
+        descs.push_back(desc);
+        ref.push_back(new char[desc.size]);
+    }
+    for (uint32_t i = 0; i < in_cnt; i++)
+    {
+        inputs.push_back(opt.inputs[i]);
+    }
+
+    ret = run_serial(ctx, graph, opt, ref, frame_cnt, &serial_ms);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        goto unload_graph;
+    }
+    fprintf(stdout, "[TEST INFO] serial: %u frames in %.3f ms\n", frame_cnt, serial_ms);
+
+    batch_config.max_batch_size = BATCH_TEST_CORE_CNT;
+    batch_config.max_delay_us = BATCH_TEST_MAX_DELAY_US;
+    ret = aipu_create_batcher(ctx, graph, &batch_config, &batcher);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_create_batcher: %s\n", msg);
+        goto unload_graph;
+    }
+
+    start = get_time_ms_helper();
+    for (uint32_t i = 0; i < BATCH_TEST_THREAD_CNT; i++)
+    {
+        reqs[i].ctx = ctx;
+        reqs[i].batcher = batcher;
+        reqs[i].inputs = &inputs;
+        reqs[i].ref = &ref;
+        reqs[i].descs = &descs;
+        reqs[i].frame_cnt = BATCH_TEST_FRAME_CNT;
+        reqs[i].ret = AIPU_STATUS_SUCCESS;
+        reqs[i].mismatch = 0;
+        pthread_create(&threads[i], NULL, requester_loop, &reqs[i]);
+    }
+    for (uint32_t i = 0; i < BATCH_TEST_THREAD_CNT; i++)
+    {
+        pthread_join(threads[i], NULL);
+        if (reqs[i].ret != AIPU_STATUS_SUCCESS)
+        {
+            aipu_get_error_message(ctx, reqs[i].ret, &msg);
+            fprintf(stderr, "[TEST ERROR] aipu_batcher_infer: %s\n", msg);
+            ret = reqs[i].ret;
+        }
+        if (reqs[i].mismatch != 0)
+        {
+            fprintf(stderr, "[TEST ERROR] requester %u: %u frames with wrong outputs\n", i, reqs[i].mismatch);
+            pass = -1;
+        }
+    }
+    batch_ms = get_time_ms_helper() - start;
+
+    aipu_get_batcher_stat(ctx, batcher, &stat);
+    fprintf(stdout, "[TEST INFO] batched: %u frames from %u threads in %.3f ms\n",
+        frame_cnt, BATCH_TEST_THREAD_CNT, batch_ms);
+    fprintf(stdout, "[TEST INFO]     %lu requests in %lu batches, delay avg %lu us max %lu us\n",
+        (unsigned long)stat.request_cnt, (unsigned long)stat.batch_cnt,
+        (unsigned long)stat.avg_delay_us, (unsigned long)stat.max_delay_us);
+    if ((stat.request_cnt != frame_cnt) || (stat.batch_cnt * 2 > stat.request_cnt))
+    {
+        fprintf(stderr, "[TEST ERROR] requests are not coalesced into batches\n");
+        pass = -1;
+    }
+    if (batch_ms * 2 > serial_ms)
+    {
+        fprintf(stderr, "[TEST ERROR] batched frames are not served faster than serial ones\n");
+        pass = -1;
+    }
+
+    aipu_destroy_batcher(ctx, batcher);
+    if (aipu_batcher_infer(ctx, batcher, inputs.data(), (void* const*)ref.data()) !=
+        AIPU_STATUS_ERROR_INVALID_BATCHER_ID)
+    {
+        fprintf(stderr, "[TEST ERROR] a destroyed batcher still takes requests\n");
+        pass = -1;
+    }
+
+    /* requesters still waiting for a batch when the batcher is destroyed */
+    batch_config.max_delay_us = BATCH_TEST_DESTROY_DELAY_US;
+    batch_config.max_batch_size = BATCH_TEST_THREAD_CNT * 2;
+    ret = aipu_create_batcher(ctx, graph, &batch_config, &batcher);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_create_batcher: %s\n", msg);
+        goto unload_graph;
+    }
+    for (uint32_t i = 0; i < BATCH_TEST_THREAD_CNT; i++)
+    {
+        reqs[i].batcher = batcher;
+        reqs[i].frame_cnt = 1;
+        reqs[i].ret = AIPU_STATUS_SUCCESS;
+        reqs[i].mismatch = 0;
+        pthread_create(&threads[i], NULL, requester_loop, &reqs[i]);
+    }
+    usleep(BATCH_TEST_DESTROY_DELAY_US / 4);
+    aipu_destroy_batcher(ctx, batcher);
+    for (uint32_t i = 0; i < BATCH_TEST_THREAD_CNT; i++)
+    {
+        pthread_join(threads[i], NULL);
+        if ((reqs[i].ret != AIPU_STATUS_SUCCESS) && (reqs[i].ret != AIPU_STATUS_ERROR_INVALID_BATCHER_ID))
+        {
+            aipu_get_error_message(ctx, reqs[i].ret, &msg);
+            fprintf(stderr, "[TEST ERROR] aipu_batcher_infer on a destroyed batcher: %s\n", msg);
+            pass = -1;
+        }
+        if (reqs[i].mismatch != 0)
+        {
+            fprintf(stderr, "[TEST ERROR] requester %u: wrong outputs from a destroyed batcher\n", i);
+            pass = -1;
+        }
+    }
+    fprintf(stdout, "[TEST INFO] batcher destroyed with %u requesters waiting in it\n",
+        BATCH_TEST_THREAD_CNT);
+
+unload_graph:
+    aipu_unload_graph(ctx, graph);
+    for (uint32_t i = 0; i < ref.size(); i++)
+    {
+        delete[] ref[i];
+    }
+
+deinit_ctx:
+    aipu_deinit_context(ctx);
+
+finish:
+    if (AIPU_STATUS_SUCCESS != ret)
+    {
+        pass = -1;
+    }
+    deinit_test_bench(&opt);
+    return pass;
+}
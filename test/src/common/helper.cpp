@@ -22,6 +22,7 @@
 #include <iostream>
 #include <string.h>
 #include <errno.h>
+#include <time.h>
 #include "helper.h"
 
 static bool is_output_correct(volatile char* src1, char* src2, uint32_t cnt)
@@ -182,4 +183,11 @@ int check_result_helper(const std::vector<char*>& outputs, const std::vector<aip
     }
 
     return pass;
+}
+
+double get_time_ms_helper()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
 }
\ No newline at end of file
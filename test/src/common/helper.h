@@ -25,5 +25,6 @@ int load_file_helper(const char* fname, char** dest, uint32_t* size);
 int unload_file_helper(char* data);
 int check_result_helper(const std::vector<char*>& outputs,
     const std::vector<aipu_tensor_desc_t>& descs, char* gt, uint32_t gt_size);
+double get_time_ms_helper();
 
 #endif /* _HELPER_H_ */
\ No newline at end of file
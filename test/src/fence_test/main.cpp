@@ -0,0 +1,357 @@
+/**********************************************************************************
+ * This file is CONFIDENTIAL and any use by you is subject to the terms of the
+ * agreement between you and Arm China or the terms of the agreement between you
+ * and the party authorised by Arm China to disclose this file to you.
+ * The confidential and proprietary information contained in this file
+ * may only be used by a person authorised under and to the extent permitted
+ * by a subsisting licensing agreement from Arm China.
+ *
+ *        (C) Copyright 2020 Arm Technology (China) Co. Ltd.
+ *                    All rights reserved.
+ *
+ * This entire notice must be reproduced on all copies of this file and copies of
+ * this file may only be made by a person if such person is permitted to do so
+ * under the terms of a subsisting license agreement from Arm China.
+ *
+ *********************************************************************************/
+
+/**
+ * @file  main.cpp
+ * @brief AIPU UMD test application: job dependency fences on mock NPU
+ *
+ * @note FENCE_TEST_JOB_CNT jobs of the graph are run in a chain, each of them after the
+ *       previous one; the end-to-end latency of the application waiting for every job
+ *       before flushing the next is compared with that of flushing the whole chain with
+ *       aipu_flush_job_after and waiting for its last job only
+ * @note the mock NPU chains jobs like the z5 command pools do: a chained job is queued
+ *       behind the job it waits for, so the chain never overlaps on the FENCE_TEST_CORE_CNT
+ *       cores and runs to its end without being polled
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <vector>
+#include "standard_api.h"
+#include "common/cmd_line_parsing.h"
+#include "common/helper.h"
+
+using namespace std;
+
+#define FENCE_TEST_JOB_CNT      4
+#define FENCE_TEST_FRAME_CNT    100
+#define FENCE_TEST_SERVICE_US   200
+#define FENCE_TEST_CORE_CNT     4
+
+static aipu_status_t load_inputs(const aipu_ctx_handle_t* ctx, const cmd_opt_t& opt,
+    const vector<uint64_t>& jobs)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    const char* msg = nullptr;
+
+    for (uint32_t i = 0; i < jobs.size(); i++)
+    {
+        for (uint32_t j = 0; j < opt.inputs.size(); j++)
+        {
+            ret = aipu_load_tensor(ctx, jobs[i], j, opt.inputs[j]);
+            if (ret != AIPU_STATUS_SUCCESS)
+            {
+                aipu_get_error_message(ctx, ret, &msg);
+                fprintf(stderr, "[TEST ERROR] aipu_load_tensor: %s\n", msg);
+                return ret;
+            }
+        }
+    }
+    return ret;
+}
+
+static aipu_status_t run_host_chain(const aipu_ctx_handle_t* ctx, const vector<uint64_t>& jobs,
+    double* latency_ms)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    const char* msg = nullptr;
+    double start = get_time_ms_helper();
+
+    for (uint32_t i = 0; i < jobs.size(); i++)
+    {
+        ret = aipu_finish_job(ctx, jobs[i], -1);
+        if (ret != AIPU_STATUS_SUCCESS)
+        {
+            aipu_get_error_message(ctx, ret, &msg);
+            fprintf(stderr, "[TEST ERROR] aipu_finish_job: %s\n", msg);
+            return ret;
+        }
+    }
+    *latency_ms += get_time_ms_helper() - start;
+    return ret;
+}
+
+static aipu_status_t run_fenced_chain(const aipu_ctx_handle_t* ctx, const vector<uint64_t>& jobs,
+    double* latency_ms)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    aipu_job_status_t status = AIPU_JOB_STATUS_NO_STATUS;
+    const char* msg = nullptr;
+    double start = get_time_ms_helper();
+
+    /* the first job has nothing to wait for */
+    for (uint32_t i = 0; i < jobs.size(); i++)
+    {
+        ret = aipu_flush_job_after(ctx, jobs[i], (i == 0) ? nullptr : &jobs[i - 1], (i == 0) ? 0 : 1);
+        if (ret != AIPU_STATUS_SUCCESS)
+        {
+            aipu_get_error_message(ctx, ret, &msg);
+            fprintf(stderr, "[TEST ERROR] aipu_flush_job_after: %s\n", msg);
+            return ret;
+        }
+    }
+
+    ret = aipu_finish_job(ctx, jobs.back(), -1);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_finish_job: %s\n", msg);
+        return ret;
+    }
+    *latency_ms += get_time_ms_helper() - start;
+
+    /* the last job is done only after all the jobs it waits for */
+    for (uint32_t i = 0; i + 1 < jobs.size(); i++)
+    {
+        ret = aipu_get_job_status(ctx, jobs[i], &status);
+        if ((ret != AIPU_STATUS_SUCCESS) || (status != AIPU_JOB_STATUS_DONE))
+        {
+            fprintf(stderr, "[TEST ERROR] job %u of the chain is not done (status %d)\n", i, status);
+            return AIPU_STATUS_ERROR_JOB_EXCEPTION;
+        }
+    }
+    return ret;
+}
+
+static aipu_status_t run_device_chain(const aipu_ctx_handle_t* ctx, const vector<uint64_t>& jobs)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    aipu_job_status_t status = AIPU_JOB_STATUS_NO_STATUS;
+    const char* msg = nullptr;
+
+    for (uint32_t i = 0; i < jobs.size(); i++)
+    {
+        ret = aipu_flush_job_after(ctx, jobs[i], (i == 0) ? nullptr : &jobs[i - 1], (i == 0) ? 0 : 1);
+        if (ret != AIPU_STATUS_SUCCESS)
+        {
+            aipu_get_error_message(ctx, ret, &msg);
+            fprintf(stderr, "[TEST ERROR] aipu_flush_job_after: %s\n", msg);
+            return ret;
+        }
+    }
+
+    /* a chain held by UMD fences would still wait for its first job to be polled */
+    usleep(2 * FENCE_TEST_SERVICE_US * jobs.size());
+    ret = aipu_get_job_status(ctx, jobs.back(), &status);
+    if ((ret != AIPU_STATUS_SUCCESS) || (status != AIPU_JOB_STATUS_DONE))
+    {
+        fprintf(stderr, "[TEST ERROR] chain is not run by the device (status %d)\n", status);
+        return AIPU_STATUS_ERROR_JOB_EXCEPTION;
+    }
+
+    for (uint32_t i = 0; i + 1 < jobs.size(); i++)
+    {
+        ret = aipu_finish_job(ctx, jobs[i], -1);
+        if (ret != AIPU_STATUS_SUCCESS)
+        {
+            aipu_get_error_message(ctx, ret, &msg);
+            fprintf(stderr, "[TEST ERROR] aipu_finish_job: %s\n", msg);
+            return ret;
+        }
+    }
+    return ret;
+}
+
+static int check_outputs(const aipu_ctx_handle_t* ctx, const cmd_opt_t& opt,
+    const vector<uint64_t>& jobs, vector<aipu_tensor_desc_t>& desc, vector<char*>& data)
+{
+    for (uint32_t i = 0; i < jobs.size(); i++)
+    {
+        for (uint32_t j = 0; j < desc.size(); j++)
+        {
+            if (aipu_get_tensor(ctx, jobs[i], AIPU_TENSOR_TYPE_OUTPUT, j, data[j]) != AIPU_STATUS_SUCCESS)
+            {
+                fprintf(stderr, "[TEST ERROR] aipu_get_tensor fails\n");
+                return -1;
+            }
+        }
+        if (check_result_helper(data, desc, opt.gt, opt.gt_size) != 0)
+        {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    aipu_ctx_handle_t* ctx = nullptr;
+    const char* msg = nullptr;
+    aipu_global_config_mock_device_t mock_config;
+    vector<aipu_tensor_desc_t> output_desc;
+    vector<char*> output_data;
+    vector<uint64_t> jobs;
+    uint64_t graph_id = 0;
+    uint32_t output_cnt = 0;
+    double host_ms = 0, fence_ms = 0;
+    cmd_opt_t opt;
+    int pass = 0;
+
+    if (init_test_bench(argc, argv, &opt, "fence_test"))
+    {
+        fprintf(stderr, "[TEST ERROR] invalid command line options/args\n");
+        pass = -1;
+        goto finish;
+    }
+
+    setenv("AIPU_UMD_DEVICE", "mock", 1);
+    ret = aipu_init_context(&ctx);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_init_context: %s\n", msg);
+        goto finish;
+    }
+
+    memset(&mock_config, 0, sizeof(mock_config));
+    mock_config.core_cnt = FENCE_TEST_CORE_CNT;
+    mock_config.service_time_us = FENCE_TEST_SERVICE_US;
+    ret = aipu_config_global(ctx, AIPU_GLOBAL_CONFIG_TYPE_MOCK_DEVICE, &mock_config);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_config_global: %s\n", msg);
+        goto deinit_ctx;
+    }
+
+    ret = aipu_load_graph(ctx, opt.bin_file_name, &graph_id);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_load_graph: %s (%s)\n", msg, opt.bin_file_name);
+        goto deinit_ctx;
+    }
+
+    ret = aipu_get_tensor_count(ctx, graph_id, AIPU_TENSOR_TYPE_OUTPUT, &output_cnt);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_get_tensor_count: %s\n", msg);
+        goto unload_graph;
+    }
+
+    for (uint32_t i = 0; i < output_cnt; i++)
+    {
+        aipu_tensor_desc_t desc;
+        ret = aipu_get_tensor_descriptor(ctx, graph_id, AIPU_TENSOR_TYPE_OUTPUT, i, &desc);
+        if (ret != AIPU_STATUS_SUCCESS)
+        {
+            aipu_get_error_message(ctx, ret, &msg);
+            fprintf(stderr, "[TEST ERROR] aipu_get_tensor_descriptor: %s\n", msg);
+            goto unload_graph;
+        }
+        output_desc.push_back(desc);
+        output_data.push_back(new char[desc.size]);
+    }
+
+    for (uint32_t i = 0; i < FENCE_TEST_JOB_CNT; i++)
+    {
+        uint64_t job = 0;
+
+        ret = aipu_create_job(ctx, graph_id, &job);
+        if (ret != AIPU_STATUS_SUCCESS)
+        {
+            aipu_get_error_message(ctx, ret, &msg);
+            fprintf(stderr, "[TEST ERROR] aipu_create_job: %s\n", msg);
+            goto clean_jobs;
+        }
+        jobs.push_back(job);
+    }
+
+    /* a job cannot wait for itself */
+    if (aipu_flush_job_after(ctx, jobs[0], &jobs[0], 1) != AIPU_STATUS_ERROR_INVALID_JOB_ID)
+    {
+        fprintf(stderr, "[TEST ERROR] a job is flushed after itself\n");
+        ret = AIPU_STATUS_ERROR_INVALID_OP;
+        goto clean_jobs;
+    }
+
+    /* nor for a job which is never flushed */
+    if (aipu_flush_job_after(ctx, jobs[0], &jobs[1], 1) != AIPU_STATUS_ERROR_INVALID_OP)
+    {
+        fprintf(stderr, "[TEST ERROR] a job is flushed after a job never flushed\n");
+        ret = AIPU_STATUS_ERROR_INVALID_OP;
+        goto clean_jobs;
+    }
+
+    ret = load_inputs(ctx, opt, jobs);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        goto clean_jobs;
+    }
+
+    for (uint32_t frame = 0; frame < FENCE_TEST_FRAME_CNT; frame++)
+    {
+        ret = run_host_chain(ctx, jobs, &host_ms);
+        if (ret != AIPU_STATUS_SUCCESS)
+        {
+            goto clean_jobs;
+        }
+        ret = run_fenced_chain(ctx, jobs, &fence_ms);
+        if (ret != AIPU_STATUS_SUCCESS)
+        {
+            goto clean_jobs;
+        }
+    }
+
+    /* jobs of a chain overlapping on the free cores would end it sooner */
+    if (fence_ms / FENCE_TEST_FRAME_CNT < FENCE_TEST_JOB_CNT * FENCE_TEST_SERVICE_US / 1000.0)
+    {
+        fprintf(stderr, "[TEST ERROR] fenced chain of %u jobs is done in %.3f ms\n",
+            FENCE_TEST_JOB_CNT, fence_ms / FENCE_TEST_FRAME_CNT);
+        ret = AIPU_STATUS_ERROR_JOB_EXCEPTION;
+        goto clean_jobs;
+    }
+
+    ret = run_device_chain(ctx, jobs);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        goto clean_jobs;
+    }
+
+    fprintf(stdout, "[TEST INFO] %u-job chain, %u frames: host wait avg latency %.3f ms, "
+        "fenced avg latency %.3f ms\n", FENCE_TEST_JOB_CNT, FENCE_TEST_FRAME_CNT,
+        host_ms / FENCE_TEST_FRAME_CNT, fence_ms / FENCE_TEST_FRAME_CNT);
+    pass = check_outputs(ctx, opt, jobs, output_desc, output_data);
+
+clean_jobs:
+    for (uint32_t i = 0; i < jobs.size(); i++)
+    {
+        aipu_clean_job(ctx, jobs[i]);
+    }
+
+unload_graph:
+    aipu_unload_graph(ctx, graph_id);
+
+deinit_ctx:
+    aipu_deinit_context(ctx);
+
+finish:
+    for (uint32_t i = 0; i < output_data.size(); i++)
+    {
+        delete[] output_data[i];
+    }
+    if (AIPU_STATUS_SUCCESS != ret)
+    {
+        pass = -1;
+    }
+    deinit_test_bench(&opt);
+    return pass;
+}
@@ -0,0 +1,296 @@
+/**********************************************************************************
+ * This file is CONFIDENTIAL and any use by you is subject to the terms of the
+ * agreement between you and Arm China or the terms of the agreement between you
+ * and the party authorised by Arm China to disclose this file to you.
+ * The confidential and proprietary information contained in this file
+ * may only be used by a person authorised under and to the extent permitted
+ * by a subsisting licensing agreement from Arm China.
+ *
+ *        (C) Copyright 2020 Arm Technology (China) Co. Ltd.
+ *                    All rights reserved.
+ *
+ * This entire notice must be reproduced on all copies of this file and copies of
+ * this file may only be made by a person if such person is permitted to do so
+ * under the terms of a subsisting license agreement from Arm China.
+ *
+ *********************************************************************************/
+
+
+/**
+ * @file  main.cpp
+ * @brief AIPU UMD test application: idle job hibernation under a device memory budget on mock NPU
+ *
+ * @note jobs are created until the budget is used up and then hibernated: the memory released
+ *       should admit more jobs, and a hibernated job should be woken up by loading its inputs
+ *       and run as usual
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "standard_api.h"
+#include "common/cmd_line_parsing.h"
+#include "common/helper.h"
+
+using namespace std;
+
+#define HIBERNATE_TEST_MEM_LIMIT   (8 * 1024 * 1024)
+#define HIBERNATE_TEST_MAX_JOB_CNT 4096
+
+static aipu_status_t fill_budget(const aipu_ctx_handle_t* ctx, uint64_t graph, vector<uint64_t>& jobs)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    uint64_t job = 0;
+    uint32_t cnt = 0;
+
+    while (cnt < HIBERNATE_TEST_MAX_JOB_CNT)
+    {
+        ret = aipu_create_job(ctx, graph, &job);
+        if (ret != AIPU_STATUS_SUCCESS)
+        {
+            break;
+        }
+        jobs.push_back(job);
+        cnt++;
+    }
+
+    /* the budget is used up only if a job is refused for it */
+    if ((ret == AIPU_STATUS_ERROR_BUF_ALLOC_FAIL) && (cnt != 0))
+    {
+        return AIPU_STATUS_SUCCESS;
+    }
+    return (AIPU_STATUS_SUCCESS == ret) ? AIPU_STATUS_ERROR_INVALID_SIZE : ret;
+}
+
+static aipu_status_t get_dev_used(const aipu_ctx_handle_t* ctx, uint64_t graph, uint64_t* used)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    aipu_graph_memory_info_t info;
+
+    ret = aipu_get_graph_memory_info(ctx, graph, &info);
+    *used = info.dev_used;
+    return ret;
+}
+
+static aipu_status_t run_job(const aipu_ctx_handle_t* ctx, const cmd_opt_t& opt, uint64_t job,
+    vector<aipu_tensor_desc_t>& desc, vector<char*>& data, int* pass)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    const char* msg = nullptr;
+
+    for (uint32_t i = 0; i < opt.inputs.size(); i++)
+    {
+        ret = aipu_load_tensor(ctx, job, i, opt.inputs[i]);
+        if (ret != AIPU_STATUS_SUCCESS)
+        {
+            aipu_get_error_message(ctx, ret, &msg);
+            fprintf(stderr, "[TEST ERROR] aipu_load_tensor: %s\n", msg);
+            return ret;
+        }
+    }
+
+    ret = aipu_finish_job(ctx, job, -1);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_finish_job: %s\n", msg);
+        return ret;
+    }
+
+    for (uint32_t i = 0; i < desc.size(); i++)
+    {
+        ret = aipu_get_tensor(ctx, job, AIPU_TENSOR_TYPE_OUTPUT, i, data[i]);
+        if (ret != AIPU_STATUS_SUCCESS)
+        {
+            aipu_get_error_message(ctx, ret, &msg);
+            fprintf(stderr, "[TEST ERROR] aipu_get_tensor: %s\n", msg);
+            return ret;
+        }
+    }
+    if (check_result_helper(data, desc, opt.gt, opt.gt_size) != 0)
+    {
+        *pass = -1;
+    }
+    return ret;
+}
+
+int main(int argc, char* argv[])
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    aipu_ctx_handle_t* ctx = nullptr;
+    const char* msg = nullptr;
+    aipu_global_config_admission_t admit_config;
+    aipu_graph_memory_info_t info;
+    uint32_t output_cnt = 0;
+    vector<aipu_tensor_desc_t> output_desc;
+    vector<char*> output_data;
+    vector<uint64_t> parked;
+    vector<uint64_t> extra;
+    uint64_t used = 0, hibernated_used = 0, released = 0;
+    uint64_t graph = 0;
+    cmd_opt_t opt;
+    int pass = 0;
+
+    if (init_test_bench(argc, argv, &opt, "hibernate_test"))
+    {
+        fprintf(stderr, "[TEST ERROR] invalid command line options/args\n");
+        pass = -1;
+        goto finish;
+    }
+
+    ret = aipu_init_context(&ctx);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_init_context: %s\n", msg);
+        goto finish;
+    }
+
+    admit_config.mem_limit = HIBERNATE_TEST_MEM_LIMIT;
+    ret = aipu_config_global(ctx, AIPU_GLOBAL_CONFIG_TYPE_ADMISSION, &admit_config);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_config_global: %s\n", msg);
+        goto deinit_ctx;
+    }
+
+    ret = aipu_load_graph(ctx, opt.bin_file_name, &graph);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_load_graph: %s (%s)\n", msg, opt.bin_file_name);
+        goto deinit_ctx;
+    }
+
+    ret = aipu_get_graph_memory_info(ctx, graph, &info);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_get_graph_memory_info: %s\n", msg);
+        goto clean_jobs;
+    }
+
+    ret = aipu_get_tensor_count(ctx, graph, AIPU_TENSOR_TYPE_OUTPUT, &output_cnt);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_get_tensor_count: %s\n", msg);
+        goto clean_jobs;
+    }
+
+    for (uint32_t i = 0; i < output_cnt; i++)
+    {
+        aipu_tensor_desc_t desc;
+        ret = aipu_get_tensor_descriptor(ctx, graph, AIPU_TENSOR_TYPE_OUTPUT, i, &desc);
+        if (ret != AIPU_STATUS_SUCCESS)
+        {
+            aipu_get_error_message(ctx, ret, &msg);
+            fprintf(stderr, "[TEST ERROR] aipu_get_tensor_descriptor: %s\n", msg);
+            goto clean_jobs;
+        }
+        output_desc.push_back(desc);
+        output_data.push_back(new char[desc.size]);
+    }
+
+    /* use up the budget, with the first job run before being parked */
+    ret = fill_budget(ctx, graph, parked);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] %u jobs created within %u bytes: %s\n",
+            (uint32_t)parked.size(), HIBERNATE_TEST_MEM_LIMIT, msg);
+        goto clean_jobs;
+    }
+    ret = run_job(ctx, opt, parked[0], output_desc, output_data, &pass);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        goto clean_jobs;
+    }
+
+    /* park them all */
+    ret = get_dev_used(ctx, graph, &used);
+    for (uint32_t i = 0; (ret == AIPU_STATUS_SUCCESS) && (i < parked.size()); i++)
+    {
+        ret = aipu_hibernate_job(ctx, parked[i]);
+    }
+    if (ret == AIPU_STATUS_SUCCESS)
+    {
+        ret = get_dev_used(ctx, graph, &hibernated_used);
+    }
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_hibernate_job: %s\n", msg);
+        goto clean_jobs;
+    }
+    released = used - hibernated_used;
+    fprintf(stdout, "[TEST INFO] %u jobs hibernated: %lu of %lu bytes released (%lu expected)\n",
+        (uint32_t)parked.size(), (unsigned long)released, (unsigned long)used,
+        (unsigned long)(parked.size() * (info.reuse_size + info.stack_size)));
+    if (released != parked.size() * (info.reuse_size + info.stack_size))
+    {
+        fprintf(stderr, "[TEST ERROR] hibernated jobs do not release their scratch buffers\n");
+        pass = -1;
+    }
+
+    /* a hibernated job has no outputs to read, and is hibernated only once */
+    if ((aipu_get_tensor(ctx, parked[0], AIPU_TENSOR_TYPE_OUTPUT, 0, output_data[0]) !=
+        AIPU_STATUS_ERROR_INVALID_OP) ||
+        (aipu_hibernate_job(ctx, parked[0]) != AIPU_STATUS_SUCCESS))
+    {
+        fprintf(stderr, "[TEST ERROR] hibernated job is still accessible\n");
+        pass = -1;
+    }
+
+    /* the memory released admits more jobs */
+    ret = fill_budget(ctx, graph, extra);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] no more jobs admitted after hibernation: %s\n", msg);
+        goto clean_jobs;
+    }
+    fprintf(stdout, "[TEST INFO] %u more jobs admitted within %u bytes\n", (uint32_t)extra.size(),
+        HIBERNATE_TEST_MEM_LIMIT);
+
+    /* a job cleaned makes room for 2 hibernated jobs to wake up and run, done and new */
+    aipu_clean_job(ctx, extra.back());
+    extra.pop_back();
+    ret = run_job(ctx, opt, parked[0], output_desc, output_data, &pass);
+    if (ret == AIPU_STATUS_SUCCESS)
+    {
+        ret = run_job(ctx, opt, parked.back(), output_desc, output_data, &pass);
+    }
+    if (ret == AIPU_STATUS_SUCCESS)
+    {
+        fprintf(stdout, "[TEST INFO] hibernated jobs woken up and run\n");
+    }
+
+clean_jobs:
+    for (uint32_t i = 0; i < parked.size(); i++)
+    {
+        aipu_clean_job(ctx, parked[i]);
+    }
+    for (uint32_t i = 0; i < extra.size(); i++)
+    {
+        aipu_clean_job(ctx, extra[i]);
+    }
+    aipu_unload_graph(ctx, graph);
+
+deinit_ctx:
+    aipu_deinit_context(ctx);
+
+finish:
+    if (AIPU_STATUS_SUCCESS != ret)
+    {
+        pass = -1;
+    }
+    for (uint32_t i = 0; i < output_data.size(); i++)
+    {
+        delete[] output_data[i];
+    }
+    deinit_test_bench(&opt);
+    return pass;
+}
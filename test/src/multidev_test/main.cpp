@@ -0,0 +1,219 @@
+/**********************************************************************************
+ * This file is CONFIDENTIAL and any use by you is subject to the terms of the
+ * agreement between you and Arm China or the terms of the agreement between you
+ * and the party authorised by Arm China to disclose this file to you.
+ * The confidential and proprietary information contained in this file
+ * may only be used by a person authorised under and to the extent permitted
+ * by a subsisting licensing agreement from Arm China.
+ *
+ *        (C) Copyright 2020 Arm Technology (China) Co. Ltd.
+ *                    All rights reserved.
+ *
+ * This entire notice must be reproduced on all copies of this file and copies of
+ * this file may only be made by a person if such person is permitted to do so
+ * under the terms of a subsisting license agreement from Arm China.
+ *
+ *********************************************************************************/
+
+/**
+ * @file  main.cpp
+ * @brief AIPU UMD test application: multi-device placement on mock NPUs
+ *
+ * @note a model is run on MULTIDEV_TEST_DEVICE_CNT mock devices with each placement
+ *       policy; spreading jobs over the devices should scale throughput against
+ *       pinning them to one device
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "standard_api.h"
+#include "common/cmd_line_parsing.h"
+#include "common/helper.h"
+
+using namespace std;
+
+#define MULTIDEV_TEST_DEVICE_CNT   4
+#define MULTIDEV_TEST_DEPTH        8
+#define MULTIDEV_TEST_JOB_CNT      400
+#define MULTIDEV_TEST_SERVICE_US   500
+#define MULTIDEV_TEST_MIN_SPEEDUP  2.0
+
+static aipu_status_t run_model(const aipu_ctx_handle_t* ctx, const cmd_opt_t& opt,
+    aipu_placement_policy_t policy, double* elapsed_ms)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    const char* msg = nullptr;
+    aipu_global_config_placement_t place;
+    uint64_t model = 0;
+    vector<uint64_t> jobs;
+    vector<bool> in_flight(MULTIDEV_TEST_DEPTH, false);
+    aipu_job_status_t status;
+    uint32_t submitted = 0;
+    uint32_t completed = 0;
+    double start = 0;
+
+    memset(&place, 0, sizeof(place));
+    place.policy = policy;
+    ret = aipu_config_global(ctx, AIPU_GLOBAL_CONFIG_TYPE_PLACEMENT, &place);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_config_global: %s\n", msg);
+        return ret;
+    }
+
+    ret = aipu_load_model(ctx, opt.bin_file_name, 2, &model);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_load_model: %s (%s)\n", msg, opt.bin_file_name);
+        return ret;
+    }
+
+    for (uint32_t i = 0; i < MULTIDEV_TEST_DEPTH; i++)
+    {
+        uint64_t job = 0;
+        ret = aipu_acquire_model_job(ctx, model, &job);
+        if (ret != AIPU_STATUS_SUCCESS)
+        {
+            aipu_get_error_message(ctx, ret, &msg);
+            fprintf(stderr, "[TEST ERROR] aipu_acquire_model_job: %s\n", msg);
+            goto unload;
+        }
+        jobs.push_back(job);
+    }
+
+    /* keep MULTIDEV_TEST_DEPTH jobs in flight: a job is flushed again once it completes */
+    start = get_time_ms_helper();
+    for (uint32_t i = 0; completed < MULTIDEV_TEST_JOB_CNT; i = (i + 1) % jobs.size())
+    {
+        if (in_flight[i])
+        {
+            ret = aipu_get_job_status(ctx, jobs[i], &status);
+            if (ret != AIPU_STATUS_SUCCESS)
+            {
+                aipu_get_error_message(ctx, ret, &msg);
+                fprintf(stderr, "[TEST ERROR] aipu_get_job_status: %s\n", msg);
+                goto unload;
+            }
+            if (status == AIPU_JOB_STATUS_NO_STATUS)
+            {
+                continue;
+            }
+            in_flight[i] = false;
+            completed++;
+        }
+
+        if (submitted < MULTIDEV_TEST_JOB_CNT)
+        {
+            ret = aipu_flush_job(ctx, jobs[i], NULL, NULL);
+            if (ret != AIPU_STATUS_SUCCESS)
+            {
+                aipu_get_error_message(ctx, ret, &msg);
+                fprintf(stderr, "[TEST ERROR] aipu_flush_job: %s\n", msg);
+                goto unload;
+            }
+            in_flight[i] = true;
+            submitted++;
+        }
+    }
+    *elapsed_ms = get_time_ms_helper() - start;
+
+unload:
+    for (uint32_t i = 0; i < jobs.size(); i++)
+    {
+        aipu_release_model_job(ctx, model, jobs[i]);
+    }
+    aipu_unload_model(ctx, model);
+    return ret;
+}
+
+int main(int argc, char* argv[])
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    aipu_ctx_handle_t* ctx = nullptr;
+    const char* msg = nullptr;
+    aipu_global_config_mock_device_t mock_config;
+    const char* names[] = {"pinned", "round-robin", "least-loaded"};
+    aipu_placement_policy_t policies[] = {AIPU_PLACEMENT_PINNED, AIPU_PLACEMENT_ROUND_ROBIN,
+        AIPU_PLACEMENT_LEAST_LOADED};
+    double elapsed[3] = {0};
+    uint32_t dev_cnt = 0;
+    char cnt[8];
+    cmd_opt_t opt;
+    int pass = 0;
+
+    if (init_test_bench(argc, argv, &opt, "multidev_test"))
+    {
+        fprintf(stderr, "[TEST ERROR] invalid command line options/args\n");
+        pass = -1;
+        goto finish;
+    }
+
+    snprintf(cnt, sizeof(cnt), "%u", MULTIDEV_TEST_DEVICE_CNT);
+    setenv("AIPU_UMD_DEVICE", "mock", 1);
+    setenv("AIPU_UMD_MOCK_DEVICES", cnt, 1);
+
+    ret = aipu_init_context(&ctx);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_init_context: %s\n", msg);
+        goto finish;
+    }
+
+    ret = aipu_get_device_count(ctx, &dev_cnt);
+    if ((ret != AIPU_STATUS_SUCCESS) || (dev_cnt != MULTIDEV_TEST_DEVICE_CNT))
+    {
+        fprintf(stderr, "[TEST ERROR] aipu_get_device_count: %u devices\n", dev_cnt);
+        ret = AIPU_STATUS_ERROR_TARGET_NOT_FOUND;
+        goto deinit_ctx;
+    }
+
+    /* every mock device completes one job per service time */
+    memset(&mock_config, 0, sizeof(mock_config));
+    mock_config.core_cnt = 1;
+    mock_config.service_time_us = MULTIDEV_TEST_SERVICE_US;
+    ret = aipu_config_global(ctx, AIPU_GLOBAL_CONFIG_TYPE_MOCK_DEVICE, &mock_config);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_config_global: %s\n", msg);
+        goto deinit_ctx;
+    }
+
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        ret = run_model(ctx, opt, policies[i], &elapsed[i]);
+        if (ret != AIPU_STATUS_SUCCESS)
+        {
+            goto deinit_ctx;
+        }
+        fprintf(stdout, "[TEST INFO] %s placement on %u devices: %u jobs in %.3f ms, %.1f jobs/s\n",
+            names[i], dev_cnt, MULTIDEV_TEST_JOB_CNT, elapsed[i],
+            MULTIDEV_TEST_JOB_CNT * 1000.0 / elapsed[i]);
+    }
+
+    for (uint32_t i = 1; i < 3; i++)
+    {
+        if (elapsed[0] < elapsed[i] * MULTIDEV_TEST_MIN_SPEEDUP)
+        {
+            fprintf(stderr, "[TEST ERROR] %s placement does not scale: %.2fx of pinned\n",
+                names[i], elapsed[0] / elapsed[i]);
+            pass = -1;
+        }
+    }
+
+deinit_ctx:
+    aipu_deinit_context(ctx);
+
+finish:
+    if (AIPU_STATUS_SUCCESS != ret)
+    {
+        pass = -1;
+    }
+    deinit_test_bench(&opt);
+    return pass;
+}
@@ -0,0 +1,654 @@
+/**********************************************************************************
+ * This file is CONFIDENTIAL and any use by you is subject to the terms of the
+ * agreement between you and Arm China or the terms of the agreement between you
+ * and the party authorised by Arm China to disclose this file to you.
+ * The confidential and proprietary information contained in this file
+ * may only be used by a person authorised under and to the extent permitted
+ * by a subsisting licensing agreement from Arm China.
+ *
+ *        (C) Copyright 2020 Arm Technology (China) Co. Ltd.
+ *                    All rights reserved.
+ *
+ * This entire notice must be reproduced on all copies of this file and copies of
+ * this file may only be made by a person if such person is permitted to do so
+ * under the terms of a subsisting license agreement from Arm China.
+ *
+ *********************************************************************************/
+
+
+/**
+ * @file  main.cpp
+ * @brief AIPU UMD test application: runtime performance benchmarks
+ *
+ * @note graph load throughput mostly reflects graph parsing cost if the graph
+ *       binary provided has many notes/sections and small text/weight
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include "standard_api.h"
+#include "aipu_api.hpp"
+#include "common/cmd_line_parsing.h"
+#include "common/helper.h"
+
+using namespace std;
+
+#define LOAD_BENCH_ITERATIONS  100
+#define LOAD_BENCH_BATCH_CNT   4
+#define JOB_CHURN_ITERATIONS   10000
+#define JOB_CHURN_LIVE_CNT     256
+#define API_BENCH_ITERATIONS   100000
+#define MOCK_BENCH_ROUNDS      200
+#define MOCK_BENCH_JOB_CNT     8
+#define MOCK_BENCH_CORE_CNT    4
+#define MOCK_BENCH_SERVICE_US  100
+#define MOCK_BENCH_JITTER_US   20
+#define STREAM_BENCH_DEPTH     8
+#define STREAM_BENCH_JOB_CNT   2000
+
+static void report(const char* name, uint32_t iterations, double elapsed_ms)
+{
+    fprintf(stdout, "[TEST INFO] %s: %u iterations, avg %.3f us, %.1f ops/s\n",
+        name, iterations, elapsed_ms * 1000.0 / iterations, iterations * 1000.0 / elapsed_ms);
+}
+
+static aipu_status_t bench_graph_load(const aipu_ctx_handle_t* ctx, const cmd_opt_t& opt)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    const char* msg = nullptr;
+    uint64_t graph_id = 0;
+    uint64_t ids[LOAD_BENCH_BATCH_CNT] = {0};
+    const char* files[LOAD_BENCH_BATCH_CNT];
+    aipu_global_config_parallel_load_t pload_config;
+    double start = 0;
+
+    /* serial load/unload: parsing dominates for binaries with many notes */
+    start = get_time_ms_helper();
+    for (uint32_t i = 0; i < LOAD_BENCH_ITERATIONS; i++)
+    {
+        ret = aipu_load_graph(ctx, opt.bin_file_name, &graph_id);
+        if (ret != AIPU_STATUS_SUCCESS)
+        {
+            aipu_get_error_message(ctx, ret, &msg);
+            fprintf(stderr, "[TEST ERROR] aipu_load_graph: %s (%s)\n", msg, opt.bin_file_name);
+            goto finish;
+        }
+        ret = aipu_unload_graph(ctx, graph_id);
+        if (ret != AIPU_STATUS_SUCCESS)
+        {
+            aipu_get_error_message(ctx, ret, &msg);
+            fprintf(stderr, "[TEST ERROR] aipu_unload_graph: %s\n", msg);
+            goto finish;
+        }
+    }
+    report("graph load/unload", LOAD_BENCH_ITERATIONS, get_time_ms_helper() - start);
+
+    /* batch load with UMD internal threads */
+    memset(&pload_config, 0, sizeof(pload_config));
+    pload_config.thread_cnt = LOAD_BENCH_BATCH_CNT;
+    ret = aipu_config_global(ctx, AIPU_GLOBAL_CONFIG_TYPE_PARALLEL_LOAD, &pload_config);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_config_global: %s\n", msg);
+        goto finish;
+    }
+
+    for (uint32_t i = 0; i < LOAD_BENCH_BATCH_CNT; i++)
+    {
+        files[i] = opt.bin_file_name;
+    }
+
+    start = get_time_ms_helper();
+    for (uint32_t i = 0; i < LOAD_BENCH_ITERATIONS / LOAD_BENCH_BATCH_CNT; i++)
+    {
+        ret = aipu_load_graphs(ctx, files, LOAD_BENCH_BATCH_CNT, ids);
+        if (ret != AIPU_STATUS_SUCCESS)
+        {
+            aipu_get_error_message(ctx, ret, &msg);
+            fprintf(stderr, "[TEST ERROR] aipu_load_graphs: %s (%s)\n", msg, opt.bin_file_name);
+            goto finish;
+        }
+        for (uint32_t j = 0; j < LOAD_BENCH_BATCH_CNT; j++)
+        {
+            ret = aipu_unload_graph(ctx, ids[j]);
+            if (ret != AIPU_STATUS_SUCCESS)
+            {
+                aipu_get_error_message(ctx, ret, &msg);
+                fprintf(stderr, "[TEST ERROR] aipu_unload_graph: %s\n", msg);
+                goto finish;
+            }
+        }
+    }
+    report("batch graph load/unload (per graph)", LOAD_BENCH_ITERATIONS, get_time_ms_helper() - start);
+
+finish:
+    return ret;
+}
+
+static aipu_status_t bench_job_churn(const aipu_ctx_handle_t* ctx, const cmd_opt_t& opt)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    const char* msg = nullptr;
+    uint64_t graph_id = 0;
+    uint64_t job_id = 0;
+    vector<uint64_t> live_jobs;
+    double start = 0;
+
+    ret = aipu_load_graph(ctx, opt.bin_file_name, &graph_id);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_load_graph: %s (%s)\n", msg, opt.bin_file_name);
+        return ret;
+    }
+
+    /* keep some jobs alive so that IDs are allocated from a partially used table */
+    for (uint32_t i = 0; i < JOB_CHURN_LIVE_CNT; i++)
+    {
+        ret = aipu_create_job(ctx, graph_id, &job_id);
+        if (ret != AIPU_STATUS_SUCCESS)
+        {
+            aipu_get_error_message(ctx, ret, &msg);
+            fprintf(stderr, "[TEST ERROR] aipu_create_job: %s\n", msg);
+            goto clean;
+        }
+        live_jobs.push_back(job_id);
+    }
+
+    start = get_time_ms_helper();
+    for (uint32_t i = 0; i < JOB_CHURN_ITERATIONS; i++)
+    {
+        ret = aipu_create_job(ctx, graph_id, &job_id);
+        if (ret != AIPU_STATUS_SUCCESS)
+        {
+            aipu_get_error_message(ctx, ret, &msg);
+            fprintf(stderr, "[TEST ERROR] aipu_create_job: %s\n", msg);
+            goto clean;
+        }
+
+        /* recycle a long-lived job as well so that freed IDs are interleaved */
+        ret = aipu_clean_job(ctx, live_jobs[i % JOB_CHURN_LIVE_CNT]);
+        if (ret != AIPU_STATUS_SUCCESS)
+        {
+            aipu_get_error_message(ctx, ret, &msg);
+            fprintf(stderr, "[TEST ERROR] aipu_clean_job: %s\n", msg);
+            goto clean;
+        }
+        live_jobs[i % JOB_CHURN_LIVE_CNT] = job_id;
+    }
+    report("job create/clean churn", JOB_CHURN_ITERATIONS, get_time_ms_helper() - start);
+
+clean:
+    for (uint32_t i = 0; i < live_jobs.size(); i++)
+    {
+        aipu_clean_job(ctx, live_jobs[i]);
+    }
+    aipu_unload_graph(ctx, graph_id);
+    return ret;
+}
+
+static aipu_status_t bench_c_api(const aipu_ctx_handle_t* ctx, const cmd_opt_t& opt)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    const char* msg = nullptr;
+    uint64_t graph_id = 0;
+    uint64_t job_id = 0;
+    aipu_job_ref_t ref;
+    aipu_job_status_t status;
+    aipu_tensor_desc_t desc;
+    vector<char> buf;
+    double start = 0;
+
+    ret = aipu_load_graph(ctx, opt.bin_file_name, &graph_id);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_load_graph: %s (%s)\n", msg, opt.bin_file_name);
+        return ret;
+    }
+
+    ret = aipu_create_job(ctx, graph_id, &job_id);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_create_job: %s\n", msg);
+        goto unload;
+    }
+
+    ret = aipu_get_tensor_descriptor(ctx, job_id, AIPU_TENSOR_TYPE_INPUT, 0, &desc);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_get_tensor_descriptor: %s\n", msg);
+        goto clean;
+    }
+    buf.resize(desc.size);
+
+    /* a C application typically queries the descriptor to size/check its buffer */
+    start = get_time_ms_helper();
+    for (uint32_t i = 0; i < API_BENCH_ITERATIONS; i++)
+    {
+        aipu_get_tensor_descriptor(ctx, job_id, AIPU_TENSOR_TYPE_INPUT, 0, &desc);
+        ret = aipu_load_tensor(ctx, job_id, 0, buf.data());
+    }
+    report("C API descriptor + load tensor", API_BENCH_ITERATIONS, get_time_ms_helper() - start);
+
+    start = get_time_ms_helper();
+    for (uint32_t i = 0; i < API_BENCH_ITERATIONS; i++)
+    {
+        ret = aipu_load_tensor(ctx, job_id, 0, buf.data());
+    }
+    report("C API load tensor", API_BENCH_ITERATIONS, get_time_ms_helper() - start);
+
+    ret = aipu_get_job_ref(ctx, job_id, &ref);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_get_job_ref: %s\n", msg);
+        goto clean;
+    }
+    start = get_time_ms_helper();
+    for (uint32_t i = 0; i < API_BENCH_ITERATIONS; i++)
+    {
+        ret = aipu_job_ref_load_tensor(&ref, 0, buf.data());
+    }
+    report("C API load tensor by job reference", API_BENCH_ITERATIONS, get_time_ms_helper() - start);
+
+    /* the status of a job never flushed is not polled: what is left is the lookup of the job */
+    start = get_time_ms_helper();
+    for (uint32_t i = 0; i < API_BENCH_ITERATIONS; i++)
+    {
+        aipu_get_job_status(ctx, job_id, &status);
+    }
+    report("C API job lookup by ID", API_BENCH_ITERATIONS, get_time_ms_helper() - start);
+
+    start = get_time_ms_helper();
+    for (uint32_t i = 0; i < API_BENCH_ITERATIONS; i++)
+    {
+        aipu_job_ref_get_status(&ref, &status);
+    }
+    report("C API job lookup by job reference", API_BENCH_ITERATIONS, get_time_ms_helper() - start);
+
+clean:
+    aipu_clean_job(ctx, job_id);
+unload:
+    aipu_unload_graph(ctx, graph_id);
+    return ret;
+}
+
+static aipu_status_t bench_cpp_api(const cmd_opt_t& opt)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    aipu::Context ctx;
+    aipu::Graph graph;
+    aipu::Graph moved;
+    aipu::Job job;
+    vector<char> buf;
+    double start = 0;
+
+    ret = ctx.init();
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        fprintf(stderr, "[TEST ERROR] aipu::Context::init: %s\n", ctx.error_message(ret));
+        return ret;
+    }
+
+    ret = ctx.load_graph(opt.bin_file_name, graph);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        fprintf(stderr, "[TEST ERROR] aipu::Context::load_graph: %s\n", ctx.error_message(ret));
+        return ret;
+    }
+
+    ret = graph.create_job(job);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        fprintf(stderr, "[TEST ERROR] aipu::Graph::create_job: %s\n", ctx.error_message(ret));
+        return ret;
+    }
+    if (graph.inputs().empty())
+    {
+        fprintf(stderr, "[TEST ERROR] graph has no input tensor\n");
+        return AIPU_STATUS_ERROR_INVALID_TENSOR_ID;
+    }
+    buf.resize(graph.inputs()[0].size);
+
+    /* jobs keep working when their graph is moved */
+    moved = std::move(graph);
+    ret = job.load_input(0, buf);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        fprintf(stderr, "[TEST ERROR] aipu::Job::load_input after graph move: %s\n", ctx.error_message(ret));
+        return ret;
+    }
+
+    /* tensor sizes are checked against descriptors cached at graph load */
+    start = get_time_ms_helper();
+    for (uint32_t i = 0; i < API_BENCH_ITERATIONS; i++)
+    {
+        ret = job.load_input(0, buf);
+    }
+    report("C++ API load tensor", API_BENCH_ITERATIONS, get_time_ms_helper() - start);
+
+    /* a job may outlive its graph: its calls then fail instead of using the freed job */
+    moved.reset();
+    if (job.load_input(0, buf) != AIPU_STATUS_ERROR_INVALID_JOB_ID)
+    {
+        fprintf(stderr, "[TEST ERROR] aipu::Job::load_input after graph unload\n");
+        return AIPU_STATUS_ERROR_INVALID_OP;
+    }
+
+    /* job is released before the context by declaration order */
+    return ret;
+}
+
+static aipu_status_t bench_mock_device(const aipu_ctx_handle_t* ctx, const cmd_opt_t& opt)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    const char* msg = nullptr;
+    uint64_t graph_id = 0;
+    uint64_t job_id = 0;
+    vector<uint64_t> jobs;
+    aipu_job_status_t status;
+    aipu_global_config_mock_device_t mock_config;
+    double start = 0;
+    double ideal = 0;
+
+    /* only meaningful on the mock device: the latency model makes the run reproducible */
+    memset(&mock_config, 0, sizeof(mock_config));
+    mock_config.core_cnt = MOCK_BENCH_CORE_CNT;
+    mock_config.service_time_us = MOCK_BENCH_SERVICE_US;
+    mock_config.jitter = AIPU_MOCK_JITTER_UNIFORM;
+    mock_config.jitter_us = MOCK_BENCH_JITTER_US;
+    mock_config.seed = 1;
+    if (aipu_config_global(ctx, AIPU_GLOBAL_CONFIG_TYPE_MOCK_DEVICE, &mock_config) != AIPU_STATUS_SUCCESS)
+    {
+        fprintf(stdout, "[TEST INFO] not running on mock device: skip scheduling benchmark\n");
+        return ret;
+    }
+
+    ret = aipu_load_graph(ctx, opt.bin_file_name, &graph_id);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_load_graph: %s (%s)\n", msg, opt.bin_file_name);
+        goto reset;
+    }
+
+    for (uint32_t i = 0; i < MOCK_BENCH_JOB_CNT; i++)
+    {
+        ret = aipu_create_job(ctx, graph_id, &job_id);
+        if (ret != AIPU_STATUS_SUCCESS)
+        {
+            aipu_get_error_message(ctx, ret, &msg);
+            fprintf(stderr, "[TEST ERROR] aipu_create_job: %s\n", msg);
+            goto clean;
+        }
+        jobs.push_back(job_id);
+    }
+
+    /* jobs complete out of order across cores: the last job flushed, second on its core,
+     * should not be reported done by the completion of any other job */
+    start = get_time_ms_helper();
+    for (uint32_t i = 0; i < jobs.size(); i++)
+    {
+        ret = aipu_flush_job(ctx, jobs[i], NULL, NULL);
+        if (ret != AIPU_STATUS_SUCCESS)
+        {
+            aipu_get_error_message(ctx, ret, &msg);
+            fprintf(stderr, "[TEST ERROR] aipu_flush_job: %s\n", msg);
+            goto clean;
+        }
+    }
+    for (uint32_t i = jobs.size(); i > 0; i--)
+    {
+        ret = aipu_finish_job(ctx, jobs[i - 1], -1);
+        if (ret != AIPU_STATUS_SUCCESS)
+        {
+            aipu_get_error_message(ctx, ret, &msg);
+            fprintf(stderr, "[TEST ERROR] aipu_finish_job: %s\n", msg);
+            goto clean;
+        }
+        if ((i == jobs.size()) && ((get_time_ms_helper() - start) * 1000 <
+            (MOCK_BENCH_JOB_CNT / MOCK_BENCH_CORE_CNT) * (MOCK_BENCH_SERVICE_US - MOCK_BENCH_JITTER_US)))
+        {
+            fprintf(stderr, "[TEST ERROR] job reported done before it completes\n");
+            ret = AIPU_STATUS_ERROR_JOB_EXCEPTION;
+            goto clean;
+        }
+    }
+
+    /* keep all virtual cores busy: flush a batch of jobs and wait for all of them */
+    start = get_time_ms_helper();
+    for (uint32_t round = 0; round < MOCK_BENCH_ROUNDS; round++)
+    {
+        for (uint32_t i = 0; i < jobs.size(); i++)
+        {
+            ret = aipu_flush_job(ctx, jobs[i], NULL, NULL);
+            if (ret != AIPU_STATUS_SUCCESS)
+            {
+                aipu_get_error_message(ctx, ret, &msg);
+                fprintf(stderr, "[TEST ERROR] aipu_flush_job: %s\n", msg);
+                goto clean;
+            }
+        }
+        for (uint32_t i = 0; i < jobs.size(); i++)
+        {
+            do
+            {
+                ret = aipu_get_job_status(ctx, jobs[i], &status);
+            } while ((ret == AIPU_STATUS_SUCCESS) && (status == AIPU_JOB_STATUS_NO_STATUS));
+            if (ret != AIPU_STATUS_SUCCESS)
+            {
+                aipu_get_error_message(ctx, ret, &msg);
+                fprintf(stderr, "[TEST ERROR] aipu_get_job_status: %s\n", msg);
+                goto clean;
+            }
+        }
+    }
+    report("mock device job flush/complete", MOCK_BENCH_ROUNDS * MOCK_BENCH_JOB_CNT, get_time_ms_helper() - start);
+    ideal = MOCK_BENCH_ROUNDS * MOCK_BENCH_JOB_CNT * MOCK_BENCH_SERVICE_US / 1000.0 / MOCK_BENCH_CORE_CNT;
+    fprintf(stdout, "[TEST INFO] mock device: %u cores x %u us service, ideal %.3f ms\n",
+        MOCK_BENCH_CORE_CNT, MOCK_BENCH_SERVICE_US, ideal);
+
+clean:
+    for (uint32_t i = 0; i < jobs.size(); i++)
+    {
+        aipu_clean_job(ctx, jobs[i]);
+    }
+    aipu_unload_graph(ctx, graph_id);
+
+reset:
+    /* restore zero latency for the other benchmarks */
+    memset(&mock_config, 0, sizeof(mock_config));
+    aipu_config_global(ctx, AIPU_GLOBAL_CONFIG_TYPE_MOCK_DEVICE, &mock_config);
+    return ret;
+}
+
+static aipu_status_t bench_stream(const aipu_ctx_handle_t* ctx, const cmd_opt_t& opt)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    const char* msg = nullptr;
+    uint64_t graph_id = 0;
+    uint64_t job_id = 0;
+    vector<uint64_t> jobs;
+    vector<bool> in_flight(STREAM_BENCH_DEPTH, false);
+    aipu_job_status_t status;
+    aipu_global_config_mock_device_t mock_config;
+    uint32_t submitted = 0;
+    uint32_t completed = 0;
+    double start = 0;
+
+    /* measures the command rings of the device (z5 simulator): meaningless on the mock device */
+    memset(&mock_config, 0, sizeof(mock_config));
+    if (aipu_config_global(ctx, AIPU_GLOBAL_CONFIG_TYPE_MOCK_DEVICE, &mock_config) == AIPU_STATUS_SUCCESS)
+    {
+        fprintf(stdout, "[TEST INFO] running on mock device: skip streaming benchmark\n");
+        return ret;
+    }
+
+    ret = aipu_load_graph(ctx, opt.bin_file_name, &graph_id);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_load_graph: %s (%s)\n", msg, opt.bin_file_name);
+        return ret;
+    }
+
+    for (uint32_t i = 0; i < STREAM_BENCH_DEPTH; i++)
+    {
+        ret = aipu_create_job(ctx, graph_id, &job_id);
+        if (ret != AIPU_STATUS_SUCCESS)
+        {
+            aipu_get_error_message(ctx, ret, &msg);
+            fprintf(stderr, "[TEST ERROR] aipu_create_job: %s\n", msg);
+            goto clean;
+        }
+        jobs.push_back(job_id);
+    }
+
+    /* continuous stream: a job is flushed again as soon as it completes, so the device
+     * command rings are fed while they run */
+    start = get_time_ms_helper();
+    for (uint32_t i = 0; i < jobs.size(); i++, submitted++)
+    {
+        ret = aipu_flush_job(ctx, jobs[i], NULL, NULL);
+        if (ret != AIPU_STATUS_SUCCESS)
+        {
+            aipu_get_error_message(ctx, ret, &msg);
+            fprintf(stderr, "[TEST ERROR] aipu_flush_job: %s\n", msg);
+            goto clean;
+        }
+        in_flight[i] = true;
+    }
+    for (uint32_t i = 0; completed < STREAM_BENCH_JOB_CNT; i = (i + 1) % jobs.size())
+    {
+        if (!in_flight[i])
+        {
+            continue;
+        }
+
+        /* done only when the completion of jobs[i] itself is got: it is matched by job ID */
+        ret = aipu_get_job_status(ctx, jobs[i], &status);
+        if (ret != AIPU_STATUS_SUCCESS)
+        {
+            aipu_get_error_message(ctx, ret, &msg);
+            fprintf(stderr, "[TEST ERROR] aipu_get_job_status: %s\n", msg);
+            goto clean;
+        }
+        if (status == AIPU_JOB_STATUS_NO_STATUS)
+        {
+            continue;
+        }
+        if (status != AIPU_JOB_STATUS_DONE)
+        {
+            fprintf(stderr, "[TEST ERROR] streaming job ends with status %d\n", status);
+            ret = AIPU_STATUS_ERROR_JOB_EXCEPTION;
+            goto clean;
+        }
+
+        completed++;
+        in_flight[i] = false;
+        if (submitted < STREAM_BENCH_JOB_CNT)
+        {
+            ret = aipu_flush_job(ctx, jobs[i], NULL, NULL);
+            if (ret != AIPU_STATUS_SUCCESS)
+            {
+                aipu_get_error_message(ctx, ret, &msg);
+                fprintf(stderr, "[TEST ERROR] aipu_flush_job: %s\n", msg);
+                goto clean;
+            }
+            in_flight[i] = true;
+            submitted++;
+        }
+    }
+    report("streaming job throughput", STREAM_BENCH_JOB_CNT, get_time_ms_helper() - start);
+
+clean:
+    for (uint32_t i = 0; i < jobs.size(); i++)
+    {
+        aipu_clean_job(ctx, jobs[i]);
+    }
+    aipu_unload_graph(ctx, graph_id);
+    return ret;
+}
+
+int main(int argc, char* argv[])
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    aipu_ctx_handle_t* ctx = nullptr;
+    const char* msg = nullptr;
+    cmd_opt_t opt;
+    aipu_global_config_simulation_t sim_glb_config;
+    int pass = 0;
+
+    memset(&sim_glb_config, 0, sizeof(sim_glb_config));
+    if (init_test_bench(argc, argv, &opt, "perf_test"))
+    {
+        fprintf(stderr, "[TEST ERROR] invalid command line options/args\n");
+        pass = -1;
+        goto finish;
+    }
+
+    ret = aipu_init_context(&ctx);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_init_context: %s\n", msg);
+        goto finish;
+    }
+    fprintf(stdout, "[TEST INFO] aipu_init_context success\n");
+
+    /* works for simulation only: on the sim platform the streaming benchmark runs on the
+     * z5 simulator when the case is a z5 graph */
+    sim_glb_config.z1_simulator = opt.z1_simulator;
+    sim_glb_config.z2_simulator = opt.z2_simulator;
+    sim_glb_config.z3_simulator = opt.z3_simulator;
+    sim_glb_config.log_level = opt.log_level_set ? opt.log_level : 0;
+    sim_glb_config.verbose = opt.verbose;
+    ret = aipu_config_global(ctx, AIPU_CONFIG_TYPE_SIMULATION, &sim_glb_config);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_config_global: %s\n", msg);
+        goto deinit;
+    }
+
+    ret = bench_graph_load(ctx, opt);
+    if (ret == AIPU_STATUS_SUCCESS)
+    {
+        ret = bench_job_churn(ctx, opt);
+    }
+    if (ret == AIPU_STATUS_SUCCESS)
+    {
+        ret = bench_c_api(ctx, opt);
+    }
+    if (ret == AIPU_STATUS_SUCCESS)
+    {
+        ret = bench_cpp_api(opt);
+    }
+    if (ret == AIPU_STATUS_SUCCESS)
+    {
+        ret = bench_mock_device(ctx, opt);
+    }
+    if (ret == AIPU_STATUS_SUCCESS)
+    {
+        ret = bench_stream(ctx, opt);
+    }
+
+deinit:
+    if (aipu_deinit_context(ctx) != AIPU_STATUS_SUCCESS)
+    {
+        fprintf(stderr, "[TEST ERROR] aipu_deinit_ctx failed\n");
+    }
+
+finish:
+    if (AIPU_STATUS_SUCCESS != ret)
+    {
+        pass = -1;
+    }
+    deinit_test_bench(&opt);
+    return pass;
+}
@@ -0,0 +1,227 @@
+/**********************************************************************************
+ * This file is CONFIDENTIAL and any use by you is subject to the terms of the
+ * agreement between you and Arm China or the terms of the agreement between you
+ * and the party authorised by Arm China to disclose this file to you.
+ * The confidential and proprietary information contained in this file
+ * may only be used by a person authorised under and to the extent permitted
+ * by a subsisting licensing agreement from Arm China.
+ *
+ *        (C) Copyright 2020 Arm Technology (China) Co. Ltd.
+ *                    All rights reserved.
+ *
+ * This entire notice must be reproduced on all copies of this file and copies of
+ * this file may only be made by a person if such person is permitted to do so
+ * under the terms of a subsisting license agreement from Arm China.
+ *
+ *********************************************************************************/
+
+/**
+ * @file  main.cpp
+ * @brief AIPU UMD test application: device trace record & replay
+ *
+ * @note frames are run with the device job stream recorded into
+ *       <dump_dir>/aipu_trace.bin, which is then replayed by a new context
+ *       both back-to-back and with the recorded timing
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "standard_api.h"
+#include "common/cmd_line_parsing.h"
+#include "common/helper.h"
+
+using namespace std;
+
+#define REPLAY_TEST_FRAME_CNT 100
+
+static aipu_status_t record(const cmd_opt_t& opt, vector<aipu_tensor_desc_t>& output_desc,
+    vector<char*>& output_data)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    aipu_ctx_handle_t* ctx = nullptr;
+    const char* msg = nullptr;
+    uint64_t graph_id = 0, job_id = 0;
+    uint32_t output_cnt = 0;
+
+    ret = aipu_init_context(&ctx);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_init_context: %s\n", msg);
+        return ret;
+    }
+
+    ret = aipu_load_graph(ctx, opt.bin_file_name, &graph_id);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_load_graph: %s (%s)\n", msg, opt.bin_file_name);
+        goto deinit_ctx;
+    }
+
+    ret = aipu_get_tensor_count(ctx, graph_id, AIPU_TENSOR_TYPE_OUTPUT, &output_cnt);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_get_tensor_count: %s\n", msg);
+        goto unload_graph;
+    }
+
+    for (uint32_t i = 0; i < output_cnt; i++)
+    {
+        aipu_tensor_desc_t desc;
+        ret = aipu_get_tensor_descriptor(ctx, graph_id, AIPU_TENSOR_TYPE_OUTPUT, i, &desc);
+        if (ret != AIPU_STATUS_SUCCESS)
+        {
+            aipu_get_error_message(ctx, ret, &msg);
+            fprintf(stderr, "[TEST ERROR] aipu_get_tensor_descriptor: %s\n", msg);
+            goto unload_graph;
+        }
+        output_desc.push_back(desc);
+        output_data.push_back(new char[desc.size]);
+    }
+
+    ret = aipu_create_job(ctx, graph_id, &job_id);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_create_job: %s\n", msg);
+        goto unload_graph;
+    }
+
+    for (uint32_t frame = 0; frame < REPLAY_TEST_FRAME_CNT; frame++)
+    {
+        for (uint32_t i = 0; i < opt.inputs.size(); i++)
+        {
+            ret = aipu_load_tensor(ctx, job_id, i, opt.inputs[i]);
+            if (ret != AIPU_STATUS_SUCCESS)
+            {
+                aipu_get_error_message(ctx, ret, &msg);
+                fprintf(stderr, "[TEST ERROR] aipu_load_tensor: %s\n", msg);
+                goto clean_job;
+            }
+        }
+
+        ret = aipu_finish_job(ctx, job_id, -1);
+        if (ret != AIPU_STATUS_SUCCESS)
+        {
+            aipu_get_error_message(ctx, ret, &msg);
+            fprintf(stderr, "[TEST ERROR] aipu_finish_job: %s\n", msg);
+            goto clean_job;
+        }
+
+        for (uint32_t i = 0; i < output_desc.size(); i++)
+        {
+            ret = aipu_get_tensor(ctx, job_id, AIPU_TENSOR_TYPE_OUTPUT, i, output_data[i]);
+            if (ret != AIPU_STATUS_SUCCESS)
+            {
+                aipu_get_error_message(ctx, ret, &msg);
+                fprintf(stderr, "[TEST ERROR] aipu_get_tensor: %s\n", msg);
+                goto clean_job;
+            }
+        }
+    }
+    fprintf(stdout, "[TEST INFO] %u frames recorded\n", REPLAY_TEST_FRAME_CNT);
+
+clean_job:
+    aipu_clean_job(ctx, job_id);
+
+unload_graph:
+    aipu_unload_graph(ctx, graph_id);
+
+deinit_ctx:
+    /* trace file is closed when the device is released */
+    aipu_deinit_context(ctx);
+    return ret;
+}
+
+static aipu_status_t replay(const char* trace, bool keep_timing)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    aipu_ctx_handle_t* ctx = nullptr;
+    const char* msg = nullptr;
+    aipu_replay_stat_t stat;
+
+    ret = aipu_init_context(&ctx);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_init_context: %s\n", msg);
+        return ret;
+    }
+
+    ret = aipu_replay_trace(ctx, trace, keep_timing, &stat);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_replay_trace: %s (%s)\n", msg, trace);
+        goto deinit_ctx;
+    }
+
+    fprintf(stdout, "[TEST INFO] replay (%s): %u jobs, %u exceptions, %lu us, latency avg %lu us max %lu us\n",
+        keep_timing ? "recorded timing" : "back-to-back", stat.job_cnt, stat.exception_cnt,
+        (unsigned long)stat.total_time_us, (unsigned long)stat.avg_latency_us,
+        (unsigned long)stat.max_latency_us);
+    if ((stat.job_cnt != REPLAY_TEST_FRAME_CNT) || (stat.exception_cnt != 0))
+    {
+        fprintf(stderr, "[TEST ERROR] replayed job stream does not match the recorded one\n");
+        ret = AIPU_STATUS_ERROR_INVALID_OP;
+    }
+
+deinit_ctx:
+    aipu_deinit_context(ctx);
+    return ret;
+}
+
+int main(int argc, char* argv[])
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    vector<aipu_tensor_desc_t> output_desc;
+    vector<char*> output_data;
+    string trace;
+    cmd_opt_t opt;
+    int pass = -1;
+
+    if (init_test_bench(argc, argv, &opt, "replay_test"))
+    {
+        fprintf(stderr, "[TEST ERROR] invalid command line options/args\n");
+        goto finish;
+    }
+
+    trace = string(opt.dump_dir) + "/aipu_trace.bin";
+    setenv("AIPU_UMD_RECORD", trace.c_str(), 1);
+    ret = record(opt, output_desc, output_data);
+    unsetenv("AIPU_UMD_RECORD");
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        goto finish;
+    }
+
+    pass = check_result_helper(output_data, output_desc, opt.gt, opt.gt_size);
+    if (pass != 0)
+    {
+        goto finish;
+    }
+
+    ret = replay(trace.c_str(), false);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        goto finish;
+    }
+    ret = replay(trace.c_str(), true);
+
+finish:
+    for (uint32_t i = 0; i < output_data.size(); i++)
+    {
+        delete[] output_data[i];
+    }
+    if (AIPU_STATUS_SUCCESS != ret)
+    {
+        pass = -1;
+    }
+    deinit_test_bench(&opt);
+    return pass;
+}
@@ -0,0 +1,369 @@
+/**********************************************************************************
+ * This file is CONFIDENTIAL and any use by you is subject to the terms of the
+ * agreement between you and Arm China or the terms of the agreement between you
+ * and the party authorised by Arm China to disclose this file to you.
+ * The confidential and proprietary information contained in this file
+ * may only be used by a person authorised under and to the extent permitted
+ * by a subsisting licensing agreement from Arm China.
+ *
+ *        (C) Copyright 2020 Arm Technology (China) Co. Ltd.
+ *                    All rights reserved.
+ *
+ * This entire notice must be reproduced on all copies of this file and copies of
+ * this file may only be made by a person if such person is permitted to do so
+ * under the terms of a subsisting license agreement from Arm China.
+ *
+ *********************************************************************************/
+
+/**
+ * @file  main.cpp
+ * @brief AIPU UMD test application: job queues with priorities and weighted fair sharing
+ *        on mock NPU
+ *
+ * @note an interactive job is flushed behind a burst of batch jobs, first with both graphs
+ *       in one FIFO queue and then with the interactive graph in a queue of higher priority;
+ *       then two batch graphs in queues of weights 3:1 share the NPU; at last a job out of any
+ *       queue runs among queued jobs, and its completion is not taken by the scheduler
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <vector>
+#include "standard_api.h"
+#include "common/cmd_line_parsing.h"
+#include "common/helper.h"
+
+using namespace std;
+
+#define SCHED_TEST_BATCH_JOB_CNT  16
+#define SCHED_TEST_SERVICE_US     200
+#define SCHED_TEST_WEIGHT_A       3
+#define SCHED_TEST_WEIGHT_B       1
+#define SCHED_TEST_POLL_US        50
+#define SCHED_TEST_FINISH_MS      1000
+
+static aipu_status_t flush_jobs(const aipu_ctx_handle_t* ctx, const vector<uint64_t>& jobs)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    const char* msg = nullptr;
+
+    for (uint32_t i = 0; i < jobs.size(); i++)
+    {
+        ret = aipu_flush_job(ctx, jobs[i], nullptr, nullptr);
+        if (ret != AIPU_STATUS_SUCCESS)
+        {
+            aipu_get_error_message(ctx, ret, &msg);
+            fprintf(stderr, "[TEST ERROR] aipu_flush_job: %s\n", msg);
+            return ret;
+        }
+    }
+    return ret;
+}
+
+/**
+ * @brief wait for flushed jobs by their status, as aipu_finish_job would flush a done job again
+ */
+static aipu_status_t wait_jobs(const aipu_ctx_handle_t* ctx, const vector<uint64_t>& jobs)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    aipu_job_status_t status = AIPU_JOB_STATUS_NO_STATUS;
+    const char* msg = nullptr;
+
+    for (uint32_t i = 0; i < jobs.size(); i++)
+    {
+        do
+        {
+            ret = aipu_get_job_status(ctx, jobs[i], &status);
+            if (ret != AIPU_STATUS_SUCCESS)
+            {
+                aipu_get_error_message(ctx, ret, &msg);
+                fprintf(stderr, "[TEST ERROR] aipu_get_job_status: %s\n", msg);
+                return ret;
+            }
+            if (AIPU_JOB_STATUS_NO_STATUS == status)
+            {
+                usleep(SCHED_TEST_POLL_US);
+            }
+        } while (AIPU_JOB_STATUS_NO_STATUS == status);
+
+        if (AIPU_JOB_STATUS_DONE != status)
+        {
+            fprintf(stderr, "[TEST ERROR] job 0x%lx ends with exception\n", (unsigned long)jobs[i]);
+            return AIPU_STATUS_ERROR_JOB_EXCEPTION;
+        }
+    }
+    return ret;
+}
+
+static void print_queue_stat(const aipu_ctx_handle_t* ctx, uint64_t queue, const char* name)
+{
+    aipu_job_queue_stat_t stat;
+
+    if (aipu_get_job_queue_stat(ctx, queue, &stat) == AIPU_STATUS_SUCCESS)
+    {
+        fprintf(stdout, "[TEST INFO]     queue %-11s: %lu jobs, wait avg %lu us max %lu us, "
+            "latency avg %lu us max %lu us\n", name, (unsigned long)stat.done_cnt,
+            (unsigned long)stat.avg_wait_us, (unsigned long)stat.max_wait_us,
+            (unsigned long)stat.avg_latency_us, (unsigned long)stat.max_latency_us);
+    }
+}
+
+/**
+ * @brief latency of an interactive job flushed right after a burst of batch jobs
+ */
+static aipu_status_t run_burst(const aipu_ctx_handle_t* ctx, const vector<uint64_t>& batch,
+    uint64_t interactive, double* latency_ms)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    const char* msg = nullptr;
+    double start = 0;
+
+    ret = flush_jobs(ctx, batch);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        return ret;
+    }
+
+    start = get_time_ms_helper();
+    ret = aipu_finish_job(ctx, interactive, -1);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_finish_job: %s\n", msg);
+        return ret;
+    }
+    *latency_ms = get_time_ms_helper() - start;
+
+    return wait_jobs(ctx, batch);
+}
+
+static aipu_status_t create_queue(const aipu_ctx_handle_t* ctx, uint32_t priority, uint32_t weight,
+    const vector<uint64_t>& graphs, uint64_t* queue)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    aipu_job_queue_config_t config;
+    const char* msg = nullptr;
+
+    config.priority = priority;
+    config.weight = weight;
+    ret = aipu_create_job_queue(ctx, &config, queue);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_create_job_queue: %s\n", msg);
+        return ret;
+    }
+
+    for (uint32_t i = 0; i < graphs.size(); i++)
+    {
+        ret = aipu_set_graph_queue(ctx, graphs[i], *queue);
+        if (ret != AIPU_STATUS_SUCCESS)
+        {
+            aipu_get_error_message(ctx, ret, &msg);
+            fprintf(stderr, "[TEST ERROR] aipu_set_graph_queue: %s\n", msg);
+            return ret;
+        }
+    }
+    return ret;
+}
+
+int main(int argc, char* argv[])
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    aipu_ctx_handle_t* ctx = nullptr;
+    const char* msg = nullptr;
+    aipu_global_config_mock_device_t mock_config;
+    aipu_job_queue_stat_t stat;
+    vector<uint64_t> graphs;
+    vector<uint64_t> queues;
+    vector<uint64_t> batch_a, batch_b;
+    uint64_t interactive = 0;
+    uint64_t q_fifo = 0, q_int = 0, q_batch = 0, q_a = 0, q_b = 0;
+    double fifo_ms = 0, prio_ms = 0;
+    uint32_t expected = 0;
+    cmd_opt_t opt;
+    int pass = 0;
+
+    if (init_test_bench(argc, argv, &opt, "sched_test"))
+    {
+        fprintf(stderr, "[TEST ERROR] invalid command line options/args\n");
+        pass = -1;
+        goto finish;
+    }
+
+    setenv("AIPU_UMD_DEVICE", "mock", 1);
+    ret = aipu_init_context(&ctx);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_init_context: %s\n", msg);
+        goto finish;
+    }
+
+    memset(&mock_config, 0, sizeof(mock_config));
+    mock_config.core_cnt = 1;
+    mock_config.service_time_us = SCHED_TEST_SERVICE_US;
+    ret = aipu_config_global(ctx, AIPU_GLOBAL_CONFIG_TYPE_MOCK_DEVICE, &mock_config);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_config_global: %s\n", msg);
+        goto deinit_ctx;
+    }
+
+    /* graphs[0]: interactive, graphs[1]/[2]: batch A/B */
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        uint64_t graph = 0;
+
+        ret = aipu_load_graph(ctx, opt.bin_file_name, &graph);
+        if (ret != AIPU_STATUS_SUCCESS)
+        {
+            aipu_get_error_message(ctx, ret, &msg);
+            fprintf(stderr, "[TEST ERROR] aipu_load_graph: %s (%s)\n", msg, opt.bin_file_name);
+            goto unload_graphs;
+        }
+        graphs.push_back(graph);
+
+        for (uint32_t j = 0; j < ((0 == i) ? 1 : SCHED_TEST_BATCH_JOB_CNT); j++)
+        {
+            uint64_t job = 0;
+
+            ret = aipu_create_job(ctx, graph, &job);
+            if (ret != AIPU_STATUS_SUCCESS)
+            {
+                aipu_get_error_message(ctx, ret, &msg);
+                fprintf(stderr, "[TEST ERROR] aipu_create_job: %s\n", msg);
+                goto unload_graphs;
+            }
+            (0 == i) ? (void)(interactive = job) : (1 == i) ? batch_a.push_back(job) : batch_b.push_back(job);
+        }
+    }
+
+    /* all jobs in one queue: the interactive job waits for the whole burst */
+    ret = create_queue(ctx, 0, 1, {graphs[0], graphs[1]}, &q_fifo);
+    queues.push_back(q_fifo);
+    if ((ret != AIPU_STATUS_SUCCESS) ||
+        ((ret = run_burst(ctx, batch_a, interactive, &fifo_ms)) != AIPU_STATUS_SUCCESS))
+    {
+        goto destroy_queues;
+    }
+    fprintf(stdout, "[TEST INFO] FIFO: interactive job latency %.3f ms behind %u batch jobs\n",
+        fifo_ms, SCHED_TEST_BATCH_JOB_CNT);
+    print_queue_stat(ctx, q_fifo, "fifo");
+
+    /* the interactive queue takes the first free slot */
+    ret = create_queue(ctx, 1, 1, {graphs[0]}, &q_int);
+    queues.push_back(q_int);
+    if (ret == AIPU_STATUS_SUCCESS)
+    {
+        ret = create_queue(ctx, 0, 1, {graphs[1]}, &q_batch);
+        queues.push_back(q_batch);
+    }
+    if ((ret != AIPU_STATUS_SUCCESS) ||
+        ((ret = run_burst(ctx, batch_a, interactive, &prio_ms)) != AIPU_STATUS_SUCCESS))
+    {
+        goto destroy_queues;
+    }
+    fprintf(stdout, "[TEST INFO] priority: interactive job latency %.3f ms behind %u batch jobs\n",
+        prio_ms, SCHED_TEST_BATCH_JOB_CNT);
+    print_queue_stat(ctx, q_int, "interactive");
+    print_queue_stat(ctx, q_batch, "batch");
+    if (prio_ms * 2 > fifo_ms)
+    {
+        fprintf(stderr, "[TEST ERROR] interactive job is not admitted before the batch burst\n");
+        pass = -1;
+    }
+
+    /* backlogged queues of the same priority share the NPU by weight */
+    ret = create_queue(ctx, 0, SCHED_TEST_WEIGHT_A, {graphs[1]}, &q_a);
+    queues.push_back(q_a);
+    if (ret == AIPU_STATUS_SUCCESS)
+    {
+        ret = create_queue(ctx, 0, SCHED_TEST_WEIGHT_B, {graphs[2]}, &q_b);
+        queues.push_back(q_b);
+    }
+    if ((ret != AIPU_STATUS_SUCCESS) ||
+        ((ret = flush_jobs(ctx, batch_a)) != AIPU_STATUS_SUCCESS) ||
+        ((ret = flush_jobs(ctx, batch_b)) != AIPU_STATUS_SUCCESS))
+    {
+        goto destroy_queues;
+    }
+
+    if (aipu_destroy_job_queue(ctx, q_b) != AIPU_STATUS_ERROR_INVALID_OP)
+    {
+        fprintf(stderr, "[TEST ERROR] a queue with jobs is destroyed\n");
+        pass = -1;
+    }
+
+    ret = wait_jobs(ctx, batch_a);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        goto destroy_queues;
+    }
+    aipu_get_job_queue_stat(ctx, q_b, &stat);
+    fprintf(stdout, "[TEST INFO] WFQ %u:%u: %u jobs of A done with %lu jobs of B admitted\n",
+        SCHED_TEST_WEIGHT_A, SCHED_TEST_WEIGHT_B, SCHED_TEST_BATCH_JOB_CNT,
+        (unsigned long)stat.dispatched_cnt);
+    expected = SCHED_TEST_BATCH_JOB_CNT * SCHED_TEST_WEIGHT_B / SCHED_TEST_WEIGHT_A;
+    if ((stat.dispatched_cnt + 2 < expected) || (stat.dispatched_cnt > expected + 2))
+    {
+        fprintf(stderr, "[TEST ERROR] NPU is not shared by weight\n");
+        pass = -1;
+    }
+
+    ret = wait_jobs(ctx, batch_b);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        goto destroy_queues;
+    }
+    print_queue_stat(ctx, q_a, "A");
+    print_queue_stat(ctx, q_b, "B");
+
+    /* the interactive job leaves the queues and finishes before the batch jobs it shares the NPU with */
+    ret = aipu_set_graph_queue(ctx, graphs[0], 0);
+    if (ret == AIPU_STATUS_SUCCESS)
+    {
+        ret = aipu_flush_job(ctx, interactive, nullptr, nullptr);
+    }
+    if ((ret != AIPU_STATUS_SUCCESS) ||
+        ((ret = flush_jobs(ctx, batch_a)) != AIPU_STATUS_SUCCESS) ||
+        ((ret = wait_jobs(ctx, batch_a)) != AIPU_STATUS_SUCCESS))
+    {
+        goto destroy_queues;
+    }
+    ret = aipu_finish_job(ctx, interactive, SCHED_TEST_FINISH_MS);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] job out of the queues is not finished: %s\n", msg);
+        goto destroy_queues;
+    }
+    fprintf(stdout, "[TEST INFO] job out of the queues finished among %u queued jobs\n",
+        SCHED_TEST_BATCH_JOB_CNT);
+
+destroy_queues:
+    for (uint32_t i = 0; i < queues.size(); i++)
+    {
+        aipu_destroy_job_queue(ctx, queues[i]);
+    }
+
+unload_graphs:
+    for (uint32_t i = 0; i < graphs.size(); i++)
+    {
+        aipu_unload_graph(ctx, graphs[i]);
+    }
+
+deinit_ctx:
+    aipu_deinit_context(ctx);
+
+finish:
+    if (AIPU_STATUS_SUCCESS != ret)
+    {
+        pass = -1;
+    }
+    deinit_test_bench(&opt);
+    return pass;
+}
@@ -0,0 +1,306 @@
+/**********************************************************************************
+ * This file is CONFIDENTIAL and any use by you is subject to the terms of the
+ * agreement between you and Arm China or the terms of the agreement between you
+ * and the party authorised by Arm China to disclose this file to you.
+ * The confidential and proprietary information contained in this file
+ * may only be used by a person authorised under and to the extent permitted
+ * by a subsisting licensing agreement from Arm China.
+ *
+ *        (C) Copyright 2020 Arm Technology (China) Co. Ltd.
+ *                    All rights reserved.
+ *
+ * This entire notice must be reproduced on all copies of this file and copies of
+ * this file may only be made by a person if such person is permitted to do so
+ * under the terms of a subsisting license agreement from Arm China.
+ *
+ *********************************************************************************/
+
+/**
+ * @file  main.cpp
+ * @brief AIPU UMD test application: super graph pipeline on mock NPU
+ *
+ * @note the graph is chained SUPERGRAPH_TEST_STAGE_CNT times with each output fed into the
+ *       next stage; the end-to-end latency of copying tensors through the host between the
+ *       stage jobs is compared with that of one super graph job binding them
+ * @note the super graph job must read every bound input in place and have the stages chained
+ *       on the mock device, so the graph code has to reach input 0 by a patched parameter;
+ *       a graph whose bindings fall back to copies in UMD fails the test
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "standard_api.h"
+#include "common/cmd_line_parsing.h"
+#include "common/helper.h"
+
+using namespace std;
+
+#define SUPERGRAPH_TEST_STAGE_CNT   3
+#define SUPERGRAPH_TEST_FRAME_CNT   100
+#define SUPERGRAPH_TEST_SERVICE_US  200
+
+static aipu_status_t run_host_pipeline(const aipu_ctx_handle_t* ctx, const cmd_opt_t& opt,
+    const vector<uint64_t>& jobs, char* tensor, char* output, double* latency_ms)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    const char* msg = nullptr;
+    double start = get_time_ms_helper();
+
+    /* every stage output is read back and written into the next stage */
+    for (uint32_t i = 0; i < jobs.size(); i++)
+    {
+        ret = aipu_load_tensor(ctx, jobs[i], 0, (i == 0) ? opt.inputs[0] : tensor);
+        if (ret != AIPU_STATUS_SUCCESS)
+        {
+            aipu_get_error_message(ctx, ret, &msg);
+            fprintf(stderr, "[TEST ERROR] aipu_load_tensor: %s\n", msg);
+            return ret;
+        }
+
+        ret = aipu_finish_job(ctx, jobs[i], -1);
+        if (ret != AIPU_STATUS_SUCCESS)
+        {
+            aipu_get_error_message(ctx, ret, &msg);
+            fprintf(stderr, "[TEST ERROR] aipu_finish_job: %s\n", msg);
+            return ret;
+        }
+
+        ret = aipu_get_tensor(ctx, jobs[i], AIPU_TENSOR_TYPE_OUTPUT, 0,
+            (i + 1 == jobs.size()) ? output : tensor);
+        if (ret != AIPU_STATUS_SUCCESS)
+        {
+            aipu_get_error_message(ctx, ret, &msg);
+            fprintf(stderr, "[TEST ERROR] aipu_get_tensor: %s\n", msg);
+            return ret;
+        }
+    }
+    *latency_ms += get_time_ms_helper() - start;
+    return ret;
+}
+
+static aipu_status_t run_super_graph(const aipu_ctx_handle_t* ctx, const cmd_opt_t& opt,
+    uint64_t job, char* output, double* latency_ms)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    const char* msg = nullptr;
+    double start = get_time_ms_helper();
+
+    ret = aipu_load_tensor(ctx, job, 0, opt.inputs[0]);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_load_tensor: %s\n", msg);
+        return ret;
+    }
+
+    ret = aipu_finish_job(ctx, job, -1);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_finish_job: %s\n", msg);
+        return ret;
+    }
+
+    ret = aipu_get_tensor(ctx, job, AIPU_TENSOR_TYPE_OUTPUT, 0, output);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_get_tensor: %s\n", msg);
+        return ret;
+    }
+    *latency_ms += get_time_ms_helper() - start;
+    return ret;
+}
+
+int main(int argc, char* argv[])
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    aipu_ctx_handle_t* ctx = nullptr;
+    const char* msg = nullptr;
+    aipu_global_config_mock_device_t mock_config;
+    vector<uint64_t> graphs;
+    vector<uint64_t> jobs;
+    vector<aipu_tensor_binding_t> bindings;
+    aipu_tensor_desc_t in_desc, out_desc;
+    aipu_super_job_stat_t stat;
+    uint64_t super_graph = 0, super_job = 0;
+    uint32_t in_cnt = 0, out_cnt = 0;
+    double host_ms = 0, super_ms = 0;
+    char* tensor = nullptr;
+    char* host_output = nullptr;
+    char* super_output = nullptr;
+    cmd_opt_t opt;
+    int pass = 0;
+
+    if (init_test_bench(argc, argv, &opt, "supergraph_test"))
+    {
+        fprintf(stderr, "[TEST ERROR] invalid command line options/args\n");
+        pass = -1;
+        goto finish;
+    }
+
+    setenv("AIPU_UMD_DEVICE", "mock", 1);
+    ret = aipu_init_context(&ctx);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_init_context: %s\n", msg);
+        goto finish;
+    }
+
+    memset(&mock_config, 0, sizeof(mock_config));
+    mock_config.core_cnt = 1;
+    mock_config.service_time_us = SUPERGRAPH_TEST_SERVICE_US;
+    ret = aipu_config_global(ctx, AIPU_GLOBAL_CONFIG_TYPE_MOCK_DEVICE, &mock_config);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_config_global: %s\n", msg);
+        goto deinit_ctx;
+    }
+
+    for (uint32_t i = 0; i < SUPERGRAPH_TEST_STAGE_CNT; i++)
+    {
+        uint64_t graph = 0, job = 0;
+
+        ret = aipu_load_graph(ctx, opt.bin_file_name, &graph);
+        if (ret != AIPU_STATUS_SUCCESS)
+        {
+            aipu_get_error_message(ctx, ret, &msg);
+            fprintf(stderr, "[TEST ERROR] aipu_load_graph: %s (%s)\n", msg, opt.bin_file_name);
+            goto unload_graphs;
+        }
+        graphs.push_back(graph);
+
+        ret = aipu_create_job(ctx, graph, &job);
+        if (ret != AIPU_STATUS_SUCCESS)
+        {
+            aipu_get_error_message(ctx, ret, &msg);
+            fprintf(stderr, "[TEST ERROR] aipu_create_job: %s\n", msg);
+            goto unload_graphs;
+        }
+        jobs.push_back(job);
+
+        if (i != 0)
+        {
+            bindings.push_back({i - 1, 0, i, 0});
+        }
+    }
+
+    /* the graph can be chained with itself only if its output 0 fits its input 0 */
+    aipu_get_tensor_count(ctx, graphs[0], AIPU_TENSOR_TYPE_INPUT, &in_cnt);
+    aipu_get_tensor_count(ctx, graphs[0], AIPU_TENSOR_TYPE_OUTPUT, &out_cnt);
+    if ((in_cnt != 1) || (out_cnt == 0) || opt.inputs.empty() ||
+        (aipu_get_tensor_descriptor(ctx, graphs[0], AIPU_TENSOR_TYPE_INPUT, 0, &in_desc) != AIPU_STATUS_SUCCESS) ||
+        (aipu_get_tensor_descriptor(ctx, graphs[0], AIPU_TENSOR_TYPE_OUTPUT, 0, &out_desc) != AIPU_STATUS_SUCCESS) ||
+        (in_desc.size != out_desc.size))
+    {
+        fprintf(stderr, "[TEST ERROR] graph cannot be chained: %u inputs, %u outputs\n", in_cnt, out_cnt);
+        ret = AIPU_STATUS_ERROR_INVALID_GBIN;
+        goto unload_graphs;
+    }
+
+    ret = aipu_create_super_graph(ctx, graphs.data(), graphs.size(), bindings.data(),
+        bindings.size(), &super_graph);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_create_super_graph: %s\n", msg);
+        goto unload_graphs;
+    }
+
+    ret = aipu_create_job(ctx, super_graph, &super_job);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_create_job: %s\n", msg);
+        goto unload_super_graph;
+    }
+
+    /* member graphs are pinned by the super graph */
+    if (aipu_unload_graph(ctx, graphs[0]) != AIPU_STATUS_ERROR_INVALID_OP)
+    {
+        fprintf(stderr, "[TEST ERROR] a member graph is unloaded before its super graph\n");
+        ret = AIPU_STATUS_ERROR_INVALID_OP;
+        goto clean_super_job;
+    }
+
+    tensor = new char[in_desc.size];
+    host_output = new char[out_desc.size];
+    super_output = new char[out_desc.size];
+    for (uint32_t frame = 0; frame < SUPERGRAPH_TEST_FRAME_CNT; frame++)
+    {
+        ret = run_host_pipeline(ctx, opt, jobs, tensor, host_output, &host_ms);
+        if (ret != AIPU_STATUS_SUCCESS)
+        {
+            goto clean_super_job;
+        }
+        ret = run_super_graph(ctx, opt, super_job, super_output, &super_ms);
+        if (ret != AIPU_STATUS_SUCCESS)
+        {
+            goto clean_super_job;
+        }
+    }
+
+    ret = aipu_get_super_job_stat(ctx, super_job, &stat);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_get_super_job_stat: %s\n", msg);
+        goto clean_super_job;
+    }
+
+    fprintf(stdout, "[TEST INFO] %u-stage pipeline, %u frames: host copy avg latency %.3f ms, "
+        "super graph avg latency %.3f ms (%u bindings in place, %u copied, %u stages chained)\n",
+        SUPERGRAPH_TEST_STAGE_CNT, SUPERGRAPH_TEST_FRAME_CNT, host_ms / SUPERGRAPH_TEST_FRAME_CNT,
+        super_ms / SUPERGRAPH_TEST_FRAME_CNT, stat.bound_cnt, stat.copied_cnt, stat.chained_cnt);
+    if ((stat.bound_cnt != SUPERGRAPH_TEST_STAGE_CNT - 1) || (stat.copied_cnt != 0))
+    {
+        fprintf(stderr, "[TEST ERROR] bound inputs are copied: input 0 is not reached by a patched "
+            "parameter of the graph, the in-place path is not tested\n");
+        pass = -1;
+    }
+    if (stat.chained_cnt != SUPERGRAPH_TEST_STAGE_CNT - 1)
+    {
+        fprintf(stderr, "[TEST ERROR] %u of %u stages chained on the device\n",
+            stat.chained_cnt, SUPERGRAPH_TEST_STAGE_CNT - 1);
+        pass = -1;
+    }
+    if (memcmp(host_output, super_output, out_desc.size) != 0)
+    {
+        fprintf(stderr, "[TEST ERROR] super graph output mismatches the host copy pipeline\n");
+        pass = -1;
+    }
+
+clean_super_job:
+    aipu_clean_job(ctx, super_job);
+
+unload_super_graph:
+    aipu_unload_graph(ctx, super_graph);
+
+unload_graphs:
+    for (uint32_t i = 0; i < jobs.size(); i++)
+    {
+        aipu_clean_job(ctx, jobs[i]);
+    }
+    for (uint32_t i = 0; i < graphs.size(); i++)
+    {
+        aipu_unload_graph(ctx, graphs[i]);
+    }
+
+deinit_ctx:
+    aipu_deinit_context(ctx);
+
+finish:
+    delete[] tensor;
+    delete[] host_output;
+    delete[] super_output;
+    if (AIPU_STATUS_SUCCESS != ret)
+    {
+        pass = -1;
+    }
+    deinit_test_bench(&opt);
+    return pass;
+}
@@ -0,0 +1,259 @@
+/**********************************************************************************
+ * This file is CONFIDENTIAL and any use by you is subject to the terms of the
+ * agreement between you and Arm China or the terms of the agreement between you
+ * and the party authorised by Arm China to disclose this file to you.
+ * The confidential and proprietary information contained in this file
+ * may only be used by a person authorised under and to the extent permitted
+ * by a subsisting licensing agreement from Arm China.
+ *
+ *        (C) Copyright 2020 Arm Technology (China) Co. Ltd.
+ *                    All rights reserved.
+ *
+ * This entire notice must be reproduced on all copies of this file and copies of
+ * this file may only be made by a person if such person is permitted to do so
+ * under the terms of a subsisting license agreement from Arm China.
+ *
+ *********************************************************************************/
+
+
+/**
+ * @file  main.cpp
+ * @brief AIPU UMD test application: model hot swap under traffic on mock NPU
+ *
+ * @note threads keep acquiring, running and releasing jobs of a model while it is swapped
+ *       to new versions: no job should fail, a job acquired before a swap should still run,
+ *       and the old version should be retired (its jobs destroyed with its graph) once its
+ *       last job is released
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <atomic>
+#include <vector>
+#include "standard_api.h"
+#include "common/cmd_line_parsing.h"
+#include "common/helper.h"
+
+using namespace std;
+
+#define SWAP_TEST_SWAP_CNT       10
+#define SWAP_TEST_THREAD_CNT     4
+#define SWAP_TEST_POOL_JOB_CNT   2
+#define SWAP_TEST_SWAP_US        5000
+#define SWAP_TEST_RETIRE_MS      5000
+
+typedef struct runner {
+    const aipu_ctx_handle_t* ctx;
+    const cmd_opt_t* opt;
+    uint64_t model;
+    std::atomic<bool>* stop;
+    uint32_t run;
+    aipu_status_t ret;
+} runner_t;
+
+static aipu_status_t run_job(const aipu_ctx_handle_t* ctx, const cmd_opt_t& opt, uint64_t job)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+
+    for (uint32_t i = 0; (i < opt.inputs.size()) && (AIPU_STATUS_SUCCESS == ret); i++)
+    {
+        ret = aipu_load_tensor(ctx, job, i, opt.inputs[i]);
+    }
+    if (AIPU_STATUS_SUCCESS == ret)
+    {
+        ret = aipu_finish_job(ctx, job, -1);
+    }
+    return ret;
+}
+
+static void* run_model_jobs(void* arg)
+{
+    runner_t* runner = (runner_t*)arg;
+    uint64_t job = 0;
+
+    while (!runner->stop->load() && (AIPU_STATUS_SUCCESS == runner->ret))
+    {
+        runner->ret = aipu_acquire_model_job(runner->ctx, runner->model, &job);
+        if (AIPU_STATUS_SUCCESS != runner->ret)
+        {
+            break;
+        }
+        runner->ret = run_job(runner->ctx, *runner->opt, job);
+        if (aipu_release_model_job(runner->ctx, runner->model, job) != AIPU_STATUS_SUCCESS)
+        {
+            runner->ret = AIPU_STATUS_ERROR_INVALID_JOB_ID;
+        }
+        runner->run++;
+    }
+    return nullptr;
+}
+
+/* the old version is retired when the jobs of its graph are destroyed */
+static aipu_status_t wait_retired(const aipu_ctx_handle_t* ctx, uint64_t job)
+{
+    aipu_job_ref_t ref;
+
+    for (uint32_t waited_ms = 0; waited_ms < SWAP_TEST_RETIRE_MS; waited_ms++)
+    {
+        if (aipu_get_job_ref(ctx, job, &ref) == AIPU_STATUS_ERROR_INVALID_JOB_ID)
+        {
+            return AIPU_STATUS_SUCCESS;
+        }
+        usleep(1000);
+    }
+    fprintf(stderr, "[TEST ERROR] old version (job 0x%lx) not retired in %u ms\n",
+        (unsigned long)job, SWAP_TEST_RETIRE_MS);
+    return AIPU_STATUS_ERROR_INVALID_OP;
+}
+
+static aipu_status_t swap_once(const aipu_ctx_handle_t* ctx, const cmd_opt_t& opt, uint64_t model)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    const char* msg = nullptr;
+    uint64_t old_job = 0, new_job = 0;
+
+    /* held across the swap: the old version cannot be retired before it is released */
+    ret = aipu_acquire_model_job(ctx, model, &old_job);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_acquire_model_job: %s\n", msg);
+        return ret;
+    }
+
+    ret = aipu_swap_model(ctx, model, opt.bin_file_name);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_swap_model: %s\n", msg);
+        aipu_release_model_job(ctx, model, old_job);
+        return ret;
+    }
+
+    ret = run_job(ctx, opt, old_job);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] job acquired before the swap: %s\n", msg);
+        aipu_release_model_job(ctx, model, old_job);
+        return ret;
+    }
+
+    ret = aipu_acquire_model_job(ctx, model, &new_job);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_acquire_model_job: %s\n", msg);
+        aipu_release_model_job(ctx, model, old_job);
+        return ret;
+    }
+    aipu_release_model_job(ctx, model, new_job);
+
+    ret = aipu_release_model_job(ctx, model, old_job);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_release_model_job: %s\n", msg);
+        return ret;
+    }
+    if (new_job == old_job)
+    {
+        fprintf(stderr, "[TEST ERROR] job 0x%lx acquired from both versions\n", (unsigned long)old_job);
+        return AIPU_STATUS_ERROR_INVALID_JOB_ID;
+    }
+    return wait_retired(ctx, old_job);
+}
+
+int main(int argc, char* argv[])
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    aipu_ctx_handle_t* ctx = nullptr;
+    const char* msg = nullptr;
+    uint64_t model = 0;
+    vector<runner_t> runners(SWAP_TEST_THREAD_CNT);
+    vector<pthread_t> threads(SWAP_TEST_THREAD_CNT);
+    std::atomic<bool> stop(false);
+    uint32_t swapped = 0;
+    uint32_t run = 0;
+    cmd_opt_t opt;
+    int pass = 0;
+
+    if (init_test_bench(argc, argv, &opt, "swap_test"))
+    {
+        fprintf(stderr, "[TEST ERROR] invalid command line options/args\n");
+        pass = -1;
+        goto finish;
+    }
+
+    ret = aipu_init_context(&ctx);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_init_context: %s\n", msg);
+        goto finish;
+    }
+
+    ret = aipu_load_model(ctx, opt.bin_file_name, SWAP_TEST_POOL_JOB_CNT, &model);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_load_model: %s (%s)\n", msg, opt.bin_file_name);
+        goto deinit_ctx;
+    }
+
+    for (uint32_t i = 0; i < SWAP_TEST_THREAD_CNT; i++)
+    {
+        runners[i].ctx = ctx;
+        runners[i].opt = &opt;
+        runners[i].model = model;
+        runners[i].stop = &stop;
+        runners[i].run = 0;
+        runners[i].ret = AIPU_STATUS_SUCCESS;
+        pthread_create(&threads[i], NULL, run_model_jobs, &runners[i]);
+    }
+
+    for (swapped = 0; (swapped < SWAP_TEST_SWAP_CNT) && (AIPU_STATUS_SUCCESS == ret); swapped++)
+    {
+        usleep(SWAP_TEST_SWAP_US);
+        ret = swap_once(ctx, opt, model);
+    }
+
+    stop.store(true);
+    for (uint32_t i = 0; i < SWAP_TEST_THREAD_CNT; i++)
+    {
+        pthread_join(threads[i], NULL);
+        if (runners[i].ret != AIPU_STATUS_SUCCESS)
+        {
+            aipu_get_error_message(ctx, runners[i].ret, &msg);
+            fprintf(stderr, "[TEST ERROR] thread %u: job failed after %u jobs: %s\n",
+                i, runners[i].run, msg);
+            ret = runners[i].ret;
+        }
+        run += runners[i].run;
+    }
+
+    if (aipu_unload_model(ctx, model) != AIPU_STATUS_SUCCESS)
+    {
+        fprintf(stderr, "[TEST ERROR] aipu_unload_model failed\n");
+        ret = AIPU_STATUS_ERROR_INVALID_MODEL_ID;
+    }
+    if (AIPU_STATUS_SUCCESS == ret)
+    {
+        fprintf(stdout, "[TEST INFO] %u swaps: %u jobs run by %u threads, old versions retired\n",
+            swapped, run, SWAP_TEST_THREAD_CNT);
+    }
+
+deinit_ctx:
+    aipu_deinit_context(ctx);
+
+finish:
+    if (AIPU_STATUS_SUCCESS != ret)
+    {
+        pass = -1;
+    }
+    deinit_test_bench(&opt);
+    return pass;
+}
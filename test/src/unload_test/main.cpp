@@ -0,0 +1,335 @@
+/**********************************************************************************
+ * This file is CONFIDENTIAL and any use by you is subject to the terms of the
+ * agreement between you and Arm China or the terms of the agreement between you
+ * and the party authorised by Arm China to disclose this file to you.
+ * The confidential and proprietary information contained in this file
+ * may only be used by a person authorised under and to the extent permitted
+ * by a subsisting licensing agreement from Arm China.
+ *
+ *        (C) Copyright 2020 Arm Technology (China) Co. Ltd.
+ *                    All rights reserved.
+ *
+ * This entire notice must be reproduced on all copies of this file and copies of
+ * this file may only be made by a person if such person is permitted to do so
+ * under the terms of a subsisting license agreement from Arm China.
+ *
+ *********************************************************************************/
+
+/**
+ * @file  main.cpp
+ * @brief AIPU UMD test application: graph unload racing handle lookups on mock NPU
+ *
+ * @note threads keep resolving a graph and its job by their IDs while the graph is
+ *       unloaded; every call should either use a live graph/job or fail with an invalid
+ *       ID, and the IDs (and job references) should stay invalid after the unload returns
+ * @note with deferred unload, jobs never cleaned by the application are reclaimed in
+ *       background once they are not in flight, whether they were flushed or not
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <atomic>
+#include <vector>
+#include "standard_api.h"
+#include "common/cmd_line_parsing.h"
+#include "common/helper.h"
+
+using namespace std;
+
+#define UNLOAD_TEST_ROUND_CNT     50
+#define UNLOAD_TEST_THREAD_CNT    4
+#define UNLOAD_TEST_UNLOAD_US     2000
+#define UNLOAD_TEST_RECLAIM_MS    5000
+
+typedef struct resolver {
+    const aipu_ctx_handle_t* ctx;
+    const cmd_opt_t* opt;
+    uint64_t graph;
+    uint64_t job;
+    aipu_job_ref_t ref;
+    std::atomic<bool>* started;
+    uint32_t resolved;
+    aipu_status_t ret;
+} resolver_t;
+
+/* graph calls end with an invalid graph ID, job calls with an invalid job ID */
+static void* resolve_graph(void* arg)
+{
+    resolver_t* resolver = (resolver_t*)arg;
+    aipu_graph_memory_info_t info;
+    aipu_tensor_desc_t desc;
+    uint32_t cnt = 0;
+
+    resolver->started->store(true);
+    while (true)
+    {
+        resolver->ret = aipu_get_tensor_count(resolver->ctx, resolver->graph, AIPU_TENSOR_TYPE_INPUT, &cnt);
+        if ((AIPU_STATUS_SUCCESS == resolver->ret) && (cnt != 0))
+        {
+            resolver->ret = aipu_get_tensor_descriptor(resolver->ctx, resolver->graph,
+                AIPU_TENSOR_TYPE_INPUT, 0, &desc);
+        }
+        if (AIPU_STATUS_SUCCESS == resolver->ret)
+        {
+            resolver->ret = aipu_get_graph_memory_info(resolver->ctx, resolver->graph, &info);
+        }
+        if (AIPU_STATUS_SUCCESS != resolver->ret)
+        {
+            break;
+        }
+        resolver->resolved++;
+    }
+    if (AIPU_STATUS_ERROR_INVALID_GRAPH_ID == resolver->ret)
+    {
+        resolver->ret = AIPU_STATUS_SUCCESS;
+    }
+    return nullptr;
+}
+
+static void* resolve_job(void* arg)
+{
+    resolver_t* resolver = (resolver_t*)arg;
+    aipu_job_status_t status;
+
+    resolver->started->store(true);
+    while (true)
+    {
+        for (uint32_t i = 0; (i < resolver->opt->inputs.size()) && (AIPU_STATUS_SUCCESS == resolver->ret); i++)
+        {
+            resolver->ret = aipu_load_tensor(resolver->ctx, resolver->job, i, resolver->opt->inputs[i]);
+        }
+        if (AIPU_STATUS_SUCCESS == resolver->ret)
+        {
+            resolver->ret = aipu_get_job_status(resolver->ctx, resolver->job, &status);
+        }
+        if (AIPU_STATUS_SUCCESS == resolver->ret)
+        {
+            resolver->ret = aipu_job_ref_get_status(&resolver->ref, &status);
+        }
+        if (AIPU_STATUS_SUCCESS != resolver->ret)
+        {
+            break;
+        }
+        resolver->resolved++;
+    }
+    if (AIPU_STATUS_ERROR_INVALID_JOB_ID == resolver->ret)
+    {
+        resolver->ret = AIPU_STATUS_SUCCESS;
+    }
+    return nullptr;
+}
+
+static aipu_status_t run_round(const aipu_ctx_handle_t* ctx, const cmd_opt_t& opt, uint32_t* resolved)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    const char* msg = nullptr;
+    vector<resolver_t> resolvers(UNLOAD_TEST_THREAD_CNT);
+    vector<pthread_t> threads(UNLOAD_TEST_THREAD_CNT);
+    std::atomic<bool> started[UNLOAD_TEST_THREAD_CNT];
+    uint64_t graph = 0;
+    uint64_t job = 0;
+    aipu_job_ref_t ref;
+    uint32_t cnt = 0;
+
+    ret = aipu_load_graph(ctx, opt.bin_file_name, &graph);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_load_graph: %s (%s)\n", msg, opt.bin_file_name);
+        return ret;
+    }
+    ret = aipu_create_job(ctx, graph, &job);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_create_job: %s\n", msg);
+        aipu_unload_graph(ctx, graph);
+        return ret;
+    }
+    ret = aipu_get_job_ref(ctx, job, &ref);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_get_job_ref: %s\n", msg);
+        aipu_unload_graph(ctx, graph);
+        return ret;
+    }
+
+    /* half of the threads resolve the graph, the others its job */
+    for (uint32_t i = 0; i < UNLOAD_TEST_THREAD_CNT; i++)
+    {
+        started[i].store(false);
+        resolvers[i].ctx = ctx;
+        resolvers[i].opt = &opt;
+        resolvers[i].graph = graph;
+        resolvers[i].job = job;
+        resolvers[i].ref = ref;
+        resolvers[i].started = &started[i];
+        resolvers[i].resolved = 0;
+        resolvers[i].ret = AIPU_STATUS_SUCCESS;
+        pthread_create(&threads[i], NULL, (i & 1) ? resolve_job : resolve_graph, &resolvers[i]);
+    }
+    for (uint32_t i = 0; i < UNLOAD_TEST_THREAD_CNT; i++)
+    {
+        while (!started[i].load())
+        {
+            usleep(10);
+        }
+    }
+    usleep(UNLOAD_TEST_UNLOAD_US);
+
+    /* the job is freed together with the graph while the threads still look them up */
+    ret = aipu_unload_graph(ctx, graph);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_unload_graph: %s\n", msg);
+    }
+    for (uint32_t i = 0; i < UNLOAD_TEST_THREAD_CNT; i++)
+    {
+        pthread_join(threads[i], NULL);
+        if (resolvers[i].ret != AIPU_STATUS_SUCCESS)
+        {
+            aipu_get_error_message(ctx, resolvers[i].ret, &msg);
+            fprintf(stderr, "[TEST ERROR] thread %u: %s\n", i, msg);
+            ret = resolvers[i].ret;
+        }
+        *resolved += resolvers[i].resolved;
+    }
+
+    /* stale IDs stay invalid */
+    if ((aipu_get_tensor_count(ctx, graph, AIPU_TENSOR_TYPE_INPUT, &cnt) != AIPU_STATUS_ERROR_INVALID_GRAPH_ID) ||
+        (aipu_load_tensor(ctx, job, 0, opt.inputs[0]) != AIPU_STATUS_ERROR_INVALID_JOB_ID) ||
+        (aipu_job_ref_load_tensor(&ref, 0, opt.inputs[0]) != AIPU_STATUS_ERROR_INVALID_JOB_ID))
+    {
+        fprintf(stderr, "[TEST ERROR] graph/job resolved after unload\n");
+        ret = (AIPU_STATUS_SUCCESS == ret) ? AIPU_STATUS_ERROR_INVALID_OP : ret;
+    }
+    return ret;
+}
+
+static aipu_status_t check_deferred_unload(const aipu_ctx_handle_t* ctx, const cmd_opt_t& opt)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    aipu_global_config_deferred_unload_t cfg;
+    const char* msg = nullptr;
+    aipu_job_ref_t ref;
+    uint64_t graph = 0;
+    uint64_t jobs[2] = {0, 0};
+    uint32_t waited_ms = 0;
+    bool reclaimed = false;
+
+    cfg.enable = true;
+    cfg.batch_cnt = 0;
+    ret = aipu_config_global(ctx, AIPU_GLOBAL_CONFIG_TYPE_DEFERRED_UNLOAD, &cfg);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_config_global: %s\n", msg);
+        return ret;
+    }
+
+    ret = aipu_load_graph(ctx, opt.bin_file_name, &graph);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_load_graph: %s (%s)\n", msg, opt.bin_file_name);
+        return ret;
+    }
+    for (uint32_t i = 0; (i < 2) && (AIPU_STATUS_SUCCESS == ret); i++)
+    {
+        ret = aipu_create_job(ctx, graph, &jobs[i]);
+    }
+    for (uint32_t i = 0; (i < opt.inputs.size()) && (AIPU_STATUS_SUCCESS == ret); i++)
+    {
+        ret = aipu_load_tensor(ctx, jobs[0], i, opt.inputs[i]);
+    }
+    if (AIPU_STATUS_SUCCESS == ret)
+    {
+        ret = aipu_flush_job(ctx, jobs[0], nullptr, nullptr);
+    }
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] job setup: %s\n", msg);
+        aipu_unload_graph(ctx, graph);
+        return ret;
+    }
+
+    /* one job in flight, one never flushed: neither is waited for nor cleaned */
+    ret = aipu_unload_graph(ctx, graph);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_unload_graph: %s\n", msg);
+        return ret;
+    }
+    while (!reclaimed && (waited_ms < UNLOAD_TEST_RECLAIM_MS))
+    {
+        reclaimed = (aipu_get_job_ref(ctx, jobs[0], &ref) == AIPU_STATUS_ERROR_INVALID_JOB_ID) &&
+            (aipu_get_job_ref(ctx, jobs[1], &ref) == AIPU_STATUS_ERROR_INVALID_JOB_ID);
+        usleep(1000);
+        waited_ms++;
+    }
+    if (!reclaimed)
+    {
+        fprintf(stderr, "[TEST ERROR] jobs of a retired graph not reclaimed in %u ms\n",
+            UNLOAD_TEST_RECLAIM_MS);
+        return AIPU_STATUS_ERROR_INVALID_OP;
+    }
+    fprintf(stdout, "[TEST INFO] deferred unload: uncleaned jobs reclaimed\n");
+    return AIPU_STATUS_SUCCESS;
+}
+
+int main(int argc, char* argv[])
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    aipu_ctx_handle_t* ctx = nullptr;
+    const char* msg = nullptr;
+    uint32_t resolved = 0;
+    cmd_opt_t opt;
+    int pass = 0;
+
+    if (init_test_bench(argc, argv, &opt, "unload_test"))
+    {
+        fprintf(stderr, "[TEST ERROR] invalid command line options/args\n");
+        pass = -1;
+        goto finish;
+    }
+
+    ret = aipu_init_context(&ctx);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_init_context: %s\n", msg);
+        goto finish;
+    }
+
+    for (uint32_t i = 0; i < UNLOAD_TEST_ROUND_CNT; i++)
+    {
+        ret = run_round(ctx, opt, &resolved);
+        if (ret != AIPU_STATUS_SUCCESS)
+        {
+            fprintf(stderr, "[TEST ERROR] round %u of %u failed\n", i + 1, UNLOAD_TEST_ROUND_CNT);
+            break;
+        }
+    }
+    if (AIPU_STATUS_SUCCESS == ret)
+    {
+        fprintf(stdout, "[TEST INFO] %u rounds: %u lookups raced with unload\n", UNLOAD_TEST_ROUND_CNT, resolved);
+        ret = check_deferred_unload(ctx, opt);
+    }
+
+    aipu_deinit_context(ctx);
+
+finish:
+    if (AIPU_STATUS_SUCCESS != ret)
+    {
+        pass = -1;
+    }
+    deinit_test_bench(&opt);
+    return pass;
+}
@@ -0,0 +1,268 @@
+/**********************************************************************************
+ * This file is CONFIDENTIAL and any use by you is subject to the terms of the
+ * agreement between you and Arm China or the terms of the agreement between you
+ * and the party authorised by Arm China to disclose this file to you.
+ * The confidential and proprietary information contained in this file
+ * may only be used by a person authorised under and to the extent permitted
+ * by a subsisting licensing agreement from Arm China.
+ *
+ *        (C) Copyright 2020 Arm Technology (China) Co. Ltd.
+ *                    All rights reserved.
+ *
+ * This entire notice must be reproduced on all copies of this file and copies of
+ * this file may only be made by a person if such person is permitted to do so
+ * under the terms of a subsisting license agreement from Arm China.
+ *
+ *********************************************************************************/
+
+
+/**
+ * @file  main.cpp
+ * @brief AIPU UMD test application: weight streaming during graph loading on mock NPU
+ *
+ * @note the graph is loaded with its weight section streamed through a host window, read
+ *       synchronously and by a reader thread, and a job of it is run and checked each time;
+ *       windows too small to hold a page per staging chunk should be refused
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include "standard_api.h"
+#include "common/cmd_line_parsing.h"
+#include "common/helper.h"
+
+using namespace std;
+
+#define WSTREAM_TEST_PAGE_SIZE (4 * 1024)
+
+typedef struct {
+    const char* name;
+    uint32_t window_size;
+    bool async_read;
+} wstream_case_t;
+
+static aipu_status_t config_wstream(const aipu_ctx_handle_t* ctx, uint32_t window_size, bool async_read)
+{
+    aipu_global_config_weight_streaming_t cfg;
+
+    cfg.window_size = window_size;
+    cfg.async_read = async_read;
+    return aipu_config_global(ctx, AIPU_GLOBAL_CONFIG_TYPE_WEIGHT_STREAMING, &cfg);
+}
+
+static aipu_status_t check_rejected(const aipu_ctx_handle_t* ctx)
+{
+    const wstream_case_t cases[] = {
+        {"sync, less than a page", WSTREAM_TEST_PAGE_SIZE - 1, false},
+        {"async, one page", WSTREAM_TEST_PAGE_SIZE, true},
+        {"async, less than two pages", 2 * WSTREAM_TEST_PAGE_SIZE - 1, true},
+    };
+
+    for (uint32_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+    {
+        if (config_wstream(ctx, cases[i].window_size, cases[i].async_read) !=
+            AIPU_STATUS_ERROR_INVALID_CONFIG)
+        {
+            fprintf(stderr, "[TEST ERROR] window accepted (%s: %u bytes)\n",
+                cases[i].name, cases[i].window_size);
+            return AIPU_STATUS_ERROR_INVALID_CONFIG;
+        }
+    }
+    return AIPU_STATUS_SUCCESS;
+}
+
+static aipu_status_t run_graph(const aipu_ctx_handle_t* ctx, const cmd_opt_t& opt,
+    uint64_t* weight_size, int* pass)
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    const char* msg = nullptr;
+    aipu_graph_memory_info_t info;
+    uint64_t graph = 0, job = 0;
+    uint32_t output_cnt = 0;
+    vector<aipu_tensor_desc_t> output_desc;
+    vector<char*> output_data;
+
+    ret = aipu_load_graph(ctx, opt.bin_file_name, &graph);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_load_graph: %s (%s)\n", msg, opt.bin_file_name);
+        return ret;
+    }
+
+    ret = aipu_get_graph_memory_info(ctx, graph, &info);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_get_graph_memory_info: %s\n", msg);
+        goto unload_graph;
+    }
+    *weight_size = info.weight_size;
+
+    ret = aipu_get_tensor_count(ctx, graph, AIPU_TENSOR_TYPE_OUTPUT, &output_cnt);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_get_tensor_count: %s\n", msg);
+        goto unload_graph;
+    }
+    for (uint32_t i = 0; i < output_cnt; i++)
+    {
+        aipu_tensor_desc_t desc;
+        ret = aipu_get_tensor_descriptor(ctx, graph, AIPU_TENSOR_TYPE_OUTPUT, i, &desc);
+        if (ret != AIPU_STATUS_SUCCESS)
+        {
+            aipu_get_error_message(ctx, ret, &msg);
+            fprintf(stderr, "[TEST ERROR] aipu_get_tensor_descriptor: %s\n", msg);
+            goto clean_outputs;
+        }
+        output_desc.push_back(desc);
+        output_data.push_back(new char[desc.size]);
+    }
+
+    ret = aipu_create_job(ctx, graph, &job);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_create_job: %s\n", msg);
+        goto clean_outputs;
+    }
+
+    for (uint32_t i = 0; i < opt.inputs.size(); i++)
+    {
+        ret = aipu_load_tensor(ctx, job, i, opt.inputs[i]);
+        if (ret != AIPU_STATUS_SUCCESS)
+        {
+            aipu_get_error_message(ctx, ret, &msg);
+            fprintf(stderr, "[TEST ERROR] aipu_load_tensor: %s\n", msg);
+            goto clean_job;
+        }
+    }
+
+    ret = aipu_finish_job(ctx, job, -1);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_finish_job: %s\n", msg);
+        goto clean_job;
+    }
+
+    for (uint32_t i = 0; i < output_cnt; i++)
+    {
+        ret = aipu_get_tensor(ctx, job, AIPU_TENSOR_TYPE_OUTPUT, i, output_data[i]);
+        if (ret != AIPU_STATUS_SUCCESS)
+        {
+            aipu_get_error_message(ctx, ret, &msg);
+            fprintf(stderr, "[TEST ERROR] aipu_get_tensor: %s\n", msg);
+            goto clean_job;
+        }
+    }
+    if (check_result_helper(output_data, output_desc, opt.gt, opt.gt_size) != 0)
+    {
+        *pass = -1;
+    }
+
+clean_job:
+    aipu_clean_job(ctx, job);
+
+clean_outputs:
+    for (uint32_t i = 0; i < output_data.size(); i++)
+    {
+        delete[] output_data[i];
+    }
+
+unload_graph:
+    aipu_unload_graph(ctx, graph);
+    return ret;
+}
+
+int main(int argc, char* argv[])
+{
+    aipu_status_t ret = AIPU_STATUS_SUCCESS;
+    aipu_ctx_handle_t* ctx = nullptr;
+    const char* msg = nullptr;
+    uint64_t weight_size = 0, streamed_size = 0;
+    cmd_opt_t opt;
+    int pass = 0;
+
+    if (init_test_bench(argc, argv, &opt, "wstream_test"))
+    {
+        fprintf(stderr, "[TEST ERROR] invalid command line options/args\n");
+        pass = -1;
+        goto finish;
+    }
+
+    ret = aipu_init_context(&ctx);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        aipu_get_error_message(ctx, ret, &msg);
+        fprintf(stderr, "[TEST ERROR] aipu_init_context: %s\n", msg);
+        goto finish;
+    }
+
+    ret = check_rejected(ctx);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        goto deinit_ctx;
+    }
+
+    /* the whole weight section read at once: what the streamed loads are compared with */
+    ret = run_graph(ctx, opt, &weight_size, &pass);
+    if (ret != AIPU_STATUS_SUCCESS)
+    {
+        goto deinit_ctx;
+    }
+
+    {
+        /* windows smaller than the weight section are streamed in several chunks; an async
+         * window is split in two chunks, so it is read by the reader thread only if the
+         * section does not fit in one of them */
+        const wstream_case_t cases[] = {
+            {"sync, one page", WSTREAM_TEST_PAGE_SIZE, false},
+            {"sync, window over the section", (uint32_t)weight_size + WSTREAM_TEST_PAGE_SIZE, false},
+            {"async, two pages", 2 * WSTREAM_TEST_PAGE_SIZE, true},
+            {"async, window over the section", 2 * ((uint32_t)weight_size + WSTREAM_TEST_PAGE_SIZE), true},
+        };
+
+        for (uint32_t i = 0; (i < sizeof(cases) / sizeof(cases[0])) && (AIPU_STATUS_SUCCESS == ret); i++)
+        {
+            ret = config_wstream(ctx, cases[i].window_size, cases[i].async_read);
+            if (ret != AIPU_STATUS_SUCCESS)
+            {
+                aipu_get_error_message(ctx, ret, &msg);
+                fprintf(stderr, "[TEST ERROR] aipu_config_global (%s): %s\n", cases[i].name, msg);
+                break;
+            }
+            ret = run_graph(ctx, opt, &streamed_size, &pass);
+            if ((ret == AIPU_STATUS_SUCCESS) && (streamed_size != weight_size))
+            {
+                fprintf(stderr, "[TEST ERROR] %s: %lu weight bytes streamed, %lu expected\n",
+                    cases[i].name, (unsigned long)streamed_size, (unsigned long)weight_size);
+                ret = AIPU_STATUS_ERROR_INVALID_SIZE;
+            }
+            if (ret == AIPU_STATUS_SUCCESS)
+            {
+                fprintf(stdout, "[TEST INFO] %s (%u bytes): %lu weight bytes streamed\n",
+                    cases[i].name, cases[i].window_size, (unsigned long)streamed_size);
+            }
+        }
+    }
+
+    /* streaming switched off again: back to the whole section read at once */
+    if (AIPU_STATUS_SUCCESS == ret)
+    {
+        ret = config_wstream(ctx, 0, false);
+    }
+
+deinit_ctx:
+    aipu_deinit_context(ctx);
+
+finish:
+    if (AIPU_STATUS_SUCCESS != ret)
+    {
+        pass = -1;
+    }
+    deinit_test_bench(&opt);
+    return pass;
+}